@@ -0,0 +1,67 @@
+#ifndef PERSPECTIVE_AUDIOCONFIG_H
+#define PERSPECTIVE_AUDIOCONFIG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Audio block size and sample rate. Small blocks keep the dry path's latency
+// down; large ones cost less per sample, for CPU-hungry presets. Every effect
+// processes any block up to MAX_BLOCK_SIZE (in chunks of its own where needed)
+// and sizes its delay memory for the highest rate.
+struct AudioConfig {
+    enum class Rate : uint8_t { KHZ_32 = 1, KHZ_48, KHZ_96 };
+
+    static constexpr size_t MIN_BLOCK_SIZE = 4;
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+    static constexpr size_t BLOCK_STEP = 4;  // Block sizes are multiples of this
+
+    // Group delay of the codec's ADC and DAC filters together, in samples
+    // (approximate; the same at every rate for a delta-sigma codec)
+    static constexpr size_t CODEC_LATENCY = 38;
+
+    size_t blockSize;
+    Rate rate;
+
+    inline float GetSampleRate() const {
+        return rate == Rate::KHZ_32 ? 32000.0f : (rate == Rate::KHZ_96 ? 96000.0f : 48000.0f);
+    }
+
+    // Block size clamped to MIN_BLOCK_SIZE-MAX_BLOCK_SIZE and rounded down to a BLOCK_STEP multiple
+    inline AudioConfig Validated() const {
+        AudioConfig config = *this;
+        if (config.blockSize < MIN_BLOCK_SIZE) config.blockSize = MIN_BLOCK_SIZE;
+        if (config.blockSize > MAX_BLOCK_SIZE) config.blockSize = MAX_BLOCK_SIZE;
+        config.blockSize -= config.blockSize % BLOCK_STEP;
+        if (config.rate != Rate::KHZ_32 && config.rate != Rate::KHZ_96) config.rate = Rate::KHZ_48;
+        return config;
+    }
+
+    // Input to output: the DMA fills one block before the callback sees it and
+    // plays one block after, plus the converters
+    inline size_t GetRoundTripLatency() const { return 2 * blockSize + CODEC_LATENCY; }
+    inline float GetRoundTripLatencyMs() const {
+        return static_cast<float>(GetRoundTripLatency()) * 1000.0f / GetSampleRate();
+    }
+
+    // One byte for preset records: rate in the top 2 bits, block size / 4 - 1
+    // in the low 6. 0 means no setting (records saved before it was stored).
+    inline uint8_t Pack() const {
+        AudioConfig config = Validated();
+        return static_cast<uint8_t>((static_cast<uint8_t>(config.rate) << 6) | (config.blockSize / BLOCK_STEP - 1));
+    }
+    static inline bool Unpack(uint8_t packed, AudioConfig* config) {
+        if ((packed >> 6) == 0) return false;
+        config->rate = static_cast<Rate>(packed >> 6);
+        config->blockSize = ((packed & 0x3F) + 1) * BLOCK_STEP;
+        return true;
+    }
+
+    inline bool operator==(const AudioConfig& other) const { return blockSize == other.blockSize && rate == other.rate; }
+    inline bool operator!=(const AudioConfig& other) const { return !(*this == other); }
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_AUDIOCONFIG_H
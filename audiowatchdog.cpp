@@ -0,0 +1,81 @@
+#include "audiowatchdog.h"
+
+using namespace perspective;
+
+AudioWatchdog::AudioWatchdog()
+    : sampleRate_(48000.0f),
+      pendingLevels_(-1),
+      levels_(1),
+      step_(0),
+      overruns_(0),
+      degrades_(0),
+      load_(0.0f),
+      peakLoad_(0.0f),
+      settle_(0.0f),
+      hot_(0.0f),
+      calm_(0.0f),
+      recoverTime_(RECOVER_S),
+      sinceRecover_(RELAPSE_S) {
+}
+
+void AudioWatchdog::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+    overruns_.store(0);
+    degrades_.store(0);
+    peakLoad_ = 0.0f;
+    Reset(1);
+}
+
+void AudioWatchdog::Reset(int levels) {
+    pendingLevels_.store(levels > 0 ? levels : 1);
+}
+
+void AudioWatchdog::Measure(uint32_t elapsedUs, size_t size, uint32_t backgroundUs) {
+    if (size == 0) return;
+
+    int levels = pendingLevels_.exchange(-1);
+    if (levels > 0) {
+        levels_.store(levels, std::memory_order_relaxed);
+        step_.store(0, std::memory_order_relaxed);
+        load_ = 0.0f;
+        settle_ = SETTLE_S;
+        hot_ = 0.0f;
+        calm_ = 0.0f;
+        recoverTime_ = RECOVER_S;
+        sinceRecover_ = RELAPSE_S;
+    }
+
+    float seconds = static_cast<float>(size) / sampleRate_;
+    float load = static_cast<float>(elapsedUs) * 1e-6f / seconds;
+    if (load > 1.0f) overruns_.fetch_add(1, std::memory_order_relaxed);
+    load += static_cast<float>(backgroundUs) * 1e-6f / seconds;
+    if (load > peakLoad_) peakLoad_ = load;
+
+    // One-pole smoothing, with the coefficient scaled to the block length
+    float k = seconds / SMOOTHING_S;
+    load_ += (load - load_) * (k < 1.0f ? k : 1.0f);
+
+    settle_ -= seconds;
+    sinceRecover_ += seconds;
+    hot_ = load_ > DEGRADE_LOAD ? hot_ + seconds : 0.0f;
+    calm_ = load_ < RECOVER_LOAD ? calm_ + seconds : 0.0f;
+
+    int step = step_.load(std::memory_order_relaxed);
+    levels = levels_.load(std::memory_order_relaxed);
+    if (hot_ >= SUSTAIN_S && settle_ <= 0.0f && step < levels) {
+        // A relapse soon after stepping up: wait longer before the next try
+        if (sinceRecover_ < RELAPSE_S) {
+            recoverTime_ = recoverTime_ * 2.0f < MAX_RECOVER_S ? recoverTime_ * 2.0f : MAX_RECOVER_S;
+        }
+        step_.store(step + 1, std::memory_order_relaxed);
+        degrades_.fetch_add(1, std::memory_order_relaxed);
+        settle_ = SETTLE_S;
+        hot_ = 0.0f;
+        calm_ = 0.0f;
+    } else if (calm_ >= recoverTime_ && step > 0) {
+        step_.store(step - 1, std::memory_order_relaxed);
+        settle_ = SETTLE_S;
+        calm_ = 0.0f;
+        sinceRecover_ = 0.0f;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef PERSPECTIVE_AUDIOWATCHDOG_H
+#define PERSPECTIVE_AUDIOWATCHDOG_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Audio callback overrun detector.
+// Measure() is given the time the callback spent on each block, plus any
+// background audio work done for it at a lower priority (the large-block
+// worker); the load (time over the block period) is smoothed over SMOOTHING_S. When it stays above
+// DEGRADE_LOAD for SUSTAIN_S the effect steps down one quality level (Effect::SetQuality),
+// and from its cheapest level to bypass. Once the load has stayed below
+// RECOVER_LOAD for the recover time the last step is undone. A step that
+// overloads again within RELAPSE_S of a recovery doubles the recover time, so
+// an effect that cannot run at full quality settles instead of cycling.
+//
+// Measure() and IsBypassed() run in the audio callback; the main loop polls
+// GetQuality() and applies it to the effect. Reset() may be called from either.
+class AudioWatchdog {
+public:
+    AudioWatchdog();
+
+    void Init(float sampleRate);
+
+    // New effect: back to full quality. levels is the effect's GetQualityLevels().
+    void Reset(int levels);
+
+    // Audio side: microseconds spent on a block of size samples, in the
+    // callback and in the background. Only the callback's own time can
+    // overrun the block; both count towards the load.
+    void Measure(uint32_t elapsedUs, size_t size, uint32_t backgroundUs = 0);
+
+    // Quality level the effect should run at
+    inline int GetQuality() const {
+        if (pendingLevels_.load(std::memory_order_relaxed) > 0) return 0;
+        int step = step_.load(std::memory_order_relaxed);
+        int levels = levels_.load(std::memory_order_relaxed);
+        return step < levels ? step : levels - 1;
+    }
+    // Even the cheapest level overran: fade the effect out and stop running it
+    inline bool IsBypassed() const {
+        return pendingLevels_.load(std::memory_order_relaxed) <= 0 &&
+               step_.load(std::memory_order_relaxed) >= levels_.load(std::memory_order_relaxed);
+    }
+
+    // Blocks that took longer than their period
+    inline uint32_t GetOverruns() const { return overruns_.load(std::memory_order_relaxed); }
+    // Steps down, to a cheaper level or bypass
+    inline uint32_t GetDegrades() const { return degrades_.load(std::memory_order_relaxed); }
+    inline float GetLoad() const { return load_; }
+    inline float GetPeakLoad() const { return peakLoad_; }
+
+    static constexpr float DEGRADE_LOAD = 0.9f;
+    static constexpr float RECOVER_LOAD = 0.6f;
+    static constexpr float SMOOTHING_S = 0.02f;
+    static constexpr float SUSTAIN_S = 0.03f;  // Above DEGRADE_LOAD, before a step down
+    static constexpr float SETTLE_S = 0.1f;   // After a step, before the next step down
+    static constexpr float RECOVER_S = 2.0f;  // Below RECOVER_LOAD, before a step up
+    static constexpr float MAX_RECOVER_S = 32.0f;
+    static constexpr float RELAPSE_S = 1.0f;
+
+private:
+    float sampleRate_;
+
+    // Written by Reset(), picked up by the next Measure()
+    std::atomic<int> pendingLevels_;
+
+    std::atomic<int> levels_;
+    std::atomic<int> step_;  // 0 to levels_ - 1 are quality levels, levels_ is bypass
+    std::atomic<uint32_t> overruns_;
+    std::atomic<uint32_t> degrades_;
+
+    float load_;
+    float peakLoad_;
+    float settle_;       // Seconds until another step down is allowed
+    float hot_;          // Seconds spent above DEGRADE_LOAD
+    float calm_;         // Seconds spent below RECOVER_LOAD
+    float recoverTime_;  // Current recover time, RECOVER_S to MAX_RECOVER_S
+    float sinceRecover_; // Seconds since the last step up
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_AUDIOWATCHDOG_H
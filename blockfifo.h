@@ -0,0 +1,64 @@
+#ifndef PERSPECTIVE_BLOCKFIFO_H
+#define PERSPECTIVE_BLOCKFIFO_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Lock-free single-producer single-consumer queue of stereo audio blocks,
+// for handing whole blocks between two interrupt priorities (or an interrupt
+// and the main loop). The producer fills the block BeginWrite() gives it in
+// place and publishes it with EndWrite(); the consumer reads Front() in place
+// and frees it with Pop(). Neither side copies through the queue or waits.
+// DEPTH must be a power of two.
+template <size_t BLOCK_SIZE, uint32_t DEPTH>
+class BlockFifo {
+public:
+    static_assert(DEPTH > 0 && (DEPTH & (DEPTH - 1)) == 0, "DEPTH must be a power of two");
+
+    struct Block {
+        float left[BLOCK_SIZE];
+        float right[BLOCK_SIZE];
+        uint32_t sequence;  // Set by the producer, e.g. which input block this came from
+        bool process;
+    };
+
+    BlockFifo() : write_(0), read_(0) {}
+
+    // Empties the queue. Only while neither side is using it.
+    void Reset() {
+        write_.store(0, std::memory_order_relaxed);
+        read_.store(0, std::memory_order_release);
+    }
+
+    // Producer side: the next free block, or nullptr when the queue is full
+    inline Block* BeginWrite() {
+        uint32_t write = write_.load(std::memory_order_relaxed);
+        if (write - read_.load(std::memory_order_acquire) >= DEPTH) return nullptr;
+        return &blocks_[write & (DEPTH - 1)];
+    }
+    inline void EndWrite() { write_.store(write_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer side: the oldest block, or nullptr when the queue is empty
+    inline Block* Front() {
+        uint32_t read = read_.load(std::memory_order_relaxed);
+        if (read == write_.load(std::memory_order_acquire)) return nullptr;
+        return &blocks_[read & (DEPTH - 1)];
+    }
+    inline void Pop() { read_.store(read_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    inline uint32_t GetCount() const {
+        return write_.load(std::memory_order_acquire) - read_.load(std::memory_order_acquire);
+    }
+
+private:
+    Block blocks_[DEPTH];
+    std::atomic<uint32_t> write_;
+    std::atomic<uint32_t> read_;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_BLOCKFIFO_H
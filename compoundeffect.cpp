@@ -1,4 +1,5 @@
 #include "compoundeffect.h"
+#include "audioconfig.h"
 #include <cstring>
 #include <algorithm>
 
@@ -33,17 +34,20 @@ CompoundEffect::~CompoundEffect() {
 void CompoundEffect::Init(float sampleRate) {
     sampleRate_ = sampleRate;
     
-    // Initialize all child effects
+    // Initialize all child effects, keeping their values when this is a re-init
     for (Effect* effect : effects_) {
         if (effect) {
-            effect->Init(sampleRate);
+            effect->SetSampleRate(sampleRate);
         }
     }
     
-    // Allocate temporary buffers (assuming max 128 samples per block)
-    bufferSize_ = 128;
-    tempBufferL_ = new float[bufferSize_];
-    tempBufferR_ = new float[bufferSize_];
+    // Temporary buffers for the largest block; Init runs again when the
+    // sample rate changes, so they are only allocated the first time
+    if (!tempBufferL_) {
+        bufferSize_ = AudioConfig::MAX_BLOCK_SIZE;
+        tempBufferL_ = new float[bufferSize_];
+        tempBufferR_ = new float[bufferSize_];
+    }
 }
 
 void CompoundEffect::Process(float* in, float* out, size_t size) {
@@ -52,6 +56,14 @@ void CompoundEffect::Process(float* in, float* out, size_t size) {
         std::memcpy(out, in, size * sizeof(float));
         return;
     }
+
+    // Anything longer than the temporary buffers runs in pieces
+    if (size > bufferSize_) {
+        for (size_t offset = 0; offset < size; offset += bufferSize_) {
+            Process(in + offset, out + offset, std::min(bufferSize_, size - offset));
+        }
+        return;
+    }
     
     if (routingMode_ == RoutingMode::SERIES) {
         // Series processing: output of one effect feeds into next
@@ -97,13 +109,13 @@ void CompoundEffect::ProcessStereo(float* inL, float* inR, float* outL, float* o
         return;
     }
     
-    // Reallocate buffers if needed
+    // Anything longer than the temporary buffers runs in pieces (no allocation in the audio callback)
     if (size > bufferSize_) {
-        if (tempBufferL_) delete[] tempBufferL_;
-        if (tempBufferR_) delete[] tempBufferR_;
-        bufferSize_ = size;
-        tempBufferL_ = new float[bufferSize_];
-        tempBufferR_ = new float[bufferSize_];
+        for (size_t offset = 0; offset < size; offset += bufferSize_) {
+            size_t chunk = std::min(bufferSize_, size - offset);
+            ProcessStereo(inL + offset, inR + offset, outL + offset, outR + offset, chunk);
+        }
+        return;
     }
     
     if (routingMode_ == RoutingMode::SERIES) {
@@ -165,9 +177,21 @@ void CompoundEffect::SetTempo(float tempoHz) {
     }
 }
 
+void CompoundEffect::SetLfoBank(LfoBank* lfoBank) {
+    lfoBank_ = lfoBank;
+
+    // Children share the bank, so their LFOs stay phase-coherent
+    for (Effect* effect : effects_) {
+        if (effect) {
+            effect->SetLfoBank(lfoBank);
+        }
+    }
+}
+
 void CompoundEffect::AddEffect(Effect* effect) {
     if (effect) {
         effects_.push_back(effect);
+        effect->SetLfoBank(lfoBank_);
         
         // If already initialized, initialize the new effect
         if (sampleRate_ > 0) {
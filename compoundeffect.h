@@ -22,6 +22,7 @@ public:
     void ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) override;
     void Update() override;
     void SetTempo(float tempoHz) override;
+    void SetLfoBank(LfoBank* lfoBank) override;
 
 protected:
     // Add an effect to the compound effect
@@ -0,0 +1,107 @@
+#include "controlmap.h"
+#include "effect.h"
+
+#include <string.h>
+
+using namespace perspective;
+
+ControlMap::ControlMap() {
+    Build(nullptr);
+}
+
+void ControlMap::Build(Effect* effect) {
+    count_ = 0;
+    values_ = nullptr;
+    memset(knobSlot_, -1, sizeof(knobSlot_));
+    memset(encoderSlot_, -1, sizeof(encoderSlot_));
+    memset(buttonSlot_, -1, sizeof(buttonSlot_));
+    memset(ccSlot_, -1, sizeof(ccSlot_));
+
+    if (!effect || !effect->GetParameterValues()) return;
+
+    const ParameterDescriptor* layout = effect->GetParameterLayout();
+    values_ = effect->GetParameterValues();
+    count_ = static_cast<int>(effect->GetParameterCount());
+    if (count_ > MAX_SLOTS) count_ = MAX_SLOTS;
+
+    for (int slot = 0; slot < count_; slot++) {
+        const ParameterDescriptor& desc = layout[slot];
+        min_[slot] = desc.minValue;
+        max_[slot] = desc.maxValue;
+        range_[slot] = desc.maxValue - desc.minValue;
+        step_[slot] = desc.stepSize;
+        curve_[slot] = desc.curve;
+        type_[slot] = desc.type;
+        name_[slot] = desc.name;
+
+        // The first parameter mapped to a control wins
+        int index = desc.index;
+        switch (desc.type) {
+            case ParameterType::POTENTIOMETER:
+                if (index >= 0 && index < NUM_KNOBS && knobSlot_[index] < 0) knobSlot_[index] = slot;
+                break;
+            case ParameterType::ENCODER:
+                if (index >= 0 && index < NUM_ENCODERS && encoderSlot_[index] < 0) encoderSlot_[index] = slot;
+                break;
+            case ParameterType::TOGGLE:
+                if (index >= 0 && index < NUM_TOTAL_BUTTONS && buttonSlot_[index] < 0) buttonSlot_[index] = slot;
+                break;
+        }
+
+        AssignCC(MIDI_CC_BASE + slot, slot);
+    }
+}
+
+int ControlMap::HandleKnob(int knobIndex, float normalized) {
+    int slot = GetKnobSlot(knobIndex);
+    if (slot < 0) return -1;
+
+    normalized = clamp(normalized, 0.0f, 1.0f);
+    values_[slot] = min_[slot] + ApplyPotCurve(curve_[slot], normalized) * range_[slot];
+    return slot;
+}
+
+int ControlMap::HandleEncoder(int encoderIndex, int increment) {
+    int slot = GetEncoderSlot(encoderIndex);
+    if (slot < 0) return -1;
+
+    values_[slot] = clamp(values_[slot] + increment * step_[slot], min_[slot], max_[slot]);
+    return slot;
+}
+
+int ControlMap::HandleButton(int buttonIndex) {
+    int slot = GetButtonSlot(buttonIndex);
+    if (slot < 0) return -1;
+
+    values_[slot] = values_[slot] >= 0.5f ? 0.0f : 1.0f;
+    return slot;
+}
+
+int ControlMap::HandleCC(uint8_t cc, uint8_t value) {
+    int slot = GetCCSlot(cc);
+    if (slot < 0) return -1;
+
+    float normalized = static_cast<float>(value > 127 ? 127 : value) / 127.0f;
+    switch (type_[slot]) {
+        case ParameterType::POTENTIOMETER:
+            values_[slot] = min_[slot] + ApplyPotCurve(curve_[slot], normalized) * range_[slot];
+            break;
+        case ParameterType::ENCODER:
+            values_[slot] = min_[slot] + normalized * range_[slot];
+            break;
+        case ParameterType::TOGGLE:
+            values_[slot] = value >= 64 ? 1.0f : 0.0f;
+            break;
+    }
+    return slot;
+}
+
+void ControlMap::AssignCC(uint8_t cc, int slot) {
+    if (cc >= 128) return;
+    ccSlot_[cc] = (slot >= 0 && slot < count_) ? static_cast<int8_t>(slot) : -1;
+}
+
+void ControlMap::AssignKnob(int knobIndex, int slot) {
+    if (knobIndex < 0 || knobIndex >= NUM_KNOBS) return;
+    knobSlot_[knobIndex] = (slot >= 0 && slot < count_) ? static_cast<int8_t>(slot) : -1;
+}
@@ -0,0 +1,79 @@
+#ifndef PERSPECTIVE_CONTROLMAP_H
+#define PERSPECTIVE_CONTROLMAP_H
+
+#include "effectparameter.h"
+#include "controls.h"
+
+#include <stdint.h>
+
+namespace perspective {
+
+class Effect;
+
+// Routes physical controls (and MIDI CCs) straight to parameter slots of the
+// active effect.
+// Built once when an effect is activated: each control index from controls.h
+// gets the slot of the parameter mapped to it (or -1), and the per-slot data
+// the handlers need is copied into parallel arrays. Handling an event is then
+// one table lookup plus a write into the effect's flat value array.
+class ControlMap {
+public:
+    ControlMap();
+
+    // Rebuilds the map for an effect (nullptr clears it)
+    void Build(Effect* effect);
+
+    // Event handlers - each returns the slot that changed, or -1 if the control is unmapped
+    int HandleKnob(int knobIndex, float normalized);    // Knob position 0.0 to 1.0, pot curve applied
+    int HandleEncoder(int encoderIndex, int increment); // Signed step count
+    int HandleButton(int buttonIndex);                  // Toggles (switches and encoder buttons)
+    int HandleCC(uint8_t cc, uint8_t value);            // MIDI CC 0-127, mapped linearly across the range
+
+    // Assigns a MIDI CC to a parameter slot (slot -1 unassigns). Build() assigns
+    // CC (MIDI_CC_BASE + slot) to every parameter by default.
+    void AssignCC(uint8_t cc, int slot);
+
+    // Assigns a knob to a parameter slot (slot -1 unassigns), replacing the
+    // effect's own mapping until the next Build(). Used to choose what the
+    // expression pedal (KNOB_EXP_IDX) sweeps.
+    void AssignKnob(int knobIndex, int slot);
+
+    // Direct slot lookups (-1 when nothing is mapped)
+    inline int GetKnobSlot(int knobIndex) const { return (knobIndex >= 0 && knobIndex < NUM_KNOBS) ? knobSlot_[knobIndex] : -1; }
+    inline int GetEncoderSlot(int encoderIndex) const { return (encoderIndex >= 0 && encoderIndex < NUM_ENCODERS) ? encoderSlot_[encoderIndex] : -1; }
+    inline int GetButtonSlot(int buttonIndex) const { return (buttonIndex >= 0 && buttonIndex < NUM_TOTAL_BUTTONS) ? buttonSlot_[buttonIndex] : -1; }
+    inline int GetCCSlot(uint8_t cc) const { return cc < 128 ? ccSlot_[cc] : -1; }
+
+    // Per-slot data
+    inline int GetSlotCount() const { return count_; }
+    inline float GetValue(int slot) const { return values_[slot]; }
+    inline float GetNormalizedValue(int slot) const { return (values_[slot] - min_[slot]) / range_[slot]; }
+    inline const char* GetName(int slot) const { return name_[slot]; }
+    inline ParameterType GetType(int slot) const { return type_[slot]; }
+
+    static constexpr int MAX_SLOTS = 16;
+    static constexpr uint8_t MIDI_CC_BASE = 20;  // CCs 20-31 are undefined in the MIDI spec
+
+private:
+    int count_;
+    float* values_;  // The effect's value array
+
+    // Structure of arrays, indexed by slot
+    float min_[MAX_SLOTS];
+    float max_[MAX_SLOTS];
+    float range_[MAX_SLOTS];
+    float step_[MAX_SLOTS];
+    PotCurve curve_[MAX_SLOTS];
+    ParameterType type_[MAX_SLOTS];
+    const char* name_[MAX_SLOTS];
+
+    // Control index -> slot
+    int8_t knobSlot_[NUM_KNOBS];
+    int8_t encoderSlot_[NUM_ENCODERS];
+    int8_t buttonSlot_[NUM_TOTAL_BUTTONS];
+    int8_t ccSlot_[128];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_CONTROLMAP_H
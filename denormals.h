@@ -0,0 +1,44 @@
+#ifndef PERSPECTIVE_DENORMALS_H
+#define PERSPECTIVE_DENORMALS_H
+
+#include <stdint.h>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+namespace perspective {
+
+// Flush-to-zero for the calling context. Feedback paths (delay, chorus,
+// flanger, phaser, filter states) decay into subnormal floats once the input
+// goes silent; flushed, they reach zero instead.
+//   Cortex-M7: FPSCR.FZ, which flushes both inputs and results. Interrupt
+//     handlers start from FPDSCR rather than the interrupted FPSCR, so the
+//     pedal also sets FPDSCR.FZ once (see Perspective::Init).
+//   x86 (host tools): MXCSR FTZ (results) and DAZ (inputs). Subnormals cost
+//     around a hundred cycles per operation there.
+//   AArch64 (host tools): FPCR.FZ.
+// Anywhere else this does nothing.
+inline void SetFlushToZero(bool enable) {
+#if defined(__arm__) && defined(__ARM_FP)
+    uint32_t fpscr;
+    __asm__ volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    fpscr = enable ? (fpscr | (1u << 24)) : (fpscr & ~(1u << 24));
+    __asm__ volatile("vmsr fpscr, %0" : : "r"(fpscr));
+#elif defined(__SSE__) || defined(_M_X64)
+    const unsigned int ftzDaz = 0x8040;
+    unsigned int csr = _mm_getcsr();
+    _mm_setcsr(enable ? (csr | ftzDaz) : (csr & ~ftzDaz));
+#elif defined(__aarch64__)
+    uint64_t fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    fpcr = enable ? (fpcr | (1ull << 24)) : (fpcr & ~(1ull << 24));
+    __asm__ volatile("msr fpcr, %0" : : "r"(fpcr));
+#else
+    (void)enable;
+#endif
+}
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_DENORMALS_H
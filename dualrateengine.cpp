@@ -0,0 +1,130 @@
+#include "dualrateengine.h"
+
+#include <cstring>
+
+using namespace perspective;
+
+DualRateEngine::DualRateEngine()
+    : active_(false),
+      underruns_(0),
+      sequence_(0),
+      fill_(0),
+      writing_(nullptr),
+      reading_(nullptr) {
+}
+
+void DualRateEngine::Start() {
+    active_.store(false, std::memory_order_release);
+    input_.Reset();
+    output_.Reset();
+    sequence_ = 0;
+    fill_ = 0;
+    writing_ = nullptr;
+    reading_ = nullptr;
+    active_.store(true, std::memory_order_release);
+}
+
+void DualRateEngine::Stop() {
+    active_.store(false, std::memory_order_release);
+}
+
+// Picks the worker's output for the block starting now: anything older is
+// dropped, and if the block itself is not back yet it plays as silence
+void DualRateEngine::NextOutput() {
+    reading_ = nullptr;
+    if (sequence_ < LATENCY_BLOCKS) return;  // The silence Start() begins with
+
+    uint32_t wanted = sequence_ - LATENCY_BLOCKS;
+    const Fifo::Block* block;
+    while ((block = output_.Front()) != nullptr && static_cast<int32_t>(block->sequence - wanted) < 0) {
+        output_.Pop();
+    }
+    if (block && block->sequence == wanted) {
+        reading_ = block;
+    } else {
+        underruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool DualRateEngine::Process(const float* inL, const float* inR, float* outL, float* outR, size_t size,
+                             bool process) {
+    bool queued = false;
+    size_t done = 0;
+    while (done < size) {
+        if (fill_ == 0) {
+            // A full input FIFO means the worker is far behind; the block is
+            // dropped, and comes out as an underrun LATENCY samples later
+            writing_ = input_.BeginWrite();
+            NextOutput();
+        }
+
+        size_t n = size - done;
+        if (n > BLOCK_SIZE - fill_) n = BLOCK_SIZE - fill_;
+
+        if (writing_) {
+            memcpy(writing_->left + fill_, inL + done, n * sizeof(float));
+            memcpy(writing_->right + fill_, inR + done, n * sizeof(float));
+        }
+        if (reading_) {
+            memcpy(outL + done, reading_->left + fill_, n * sizeof(float));
+            memcpy(outR + done, reading_->right + fill_, n * sizeof(float));
+        } else {
+            memset(outL + done, 0, n * sizeof(float));
+            memset(outR + done, 0, n * sizeof(float));
+        }
+
+        fill_ += n;
+        done += n;
+        if (fill_ == BLOCK_SIZE) {
+            if (writing_) {
+                writing_->sequence = sequence_;
+                writing_->process = process;
+                input_.EndWrite();
+                queued = true;
+            }
+            if (reading_) output_.Pop();
+            writing_ = nullptr;
+            reading_ = nullptr;
+            sequence_++;
+            fill_ = 0;
+        }
+    }
+    return queued;
+}
+
+bool DualRateEngine::BeginBlock(Job* job) {
+    while (true) {
+        Fifo::Block* in = input_.Front();
+        Fifo::Block* out = output_.BeginWrite();
+        if (!in || !out) return false;
+
+        if (in->process) {
+            job->inL = in->left;
+            job->inR = in->right;
+            job->outL = out->left;
+            job->outR = out->right;
+            return true;
+        }
+
+        // Bypassed block: no wet signal, and still in step so the effect
+        // comes back LATENCY late like the rest
+        memset(out->left, 0, sizeof(out->left));
+        memset(out->right, 0, sizeof(out->right));
+        EndBlock();
+    }
+}
+
+uint32_t DualRateEngine::SkipBlocks() {
+    uint32_t skipped = 0;
+    while (input_.Front()) {
+        input_.Pop();
+        skipped++;
+    }
+    return skipped;
+}
+
+void DualRateEngine::EndBlock() {
+    output_.BeginWrite()->sequence = input_.Front()->sequence;
+    output_.EndWrite();
+    input_.Pop();
+}
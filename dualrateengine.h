@@ -0,0 +1,85 @@
+#ifndef PERSPECTIVE_DUALRATEENGINE_H
+#define PERSPECTIVE_DUALRATEENGINE_H
+
+#include "blockfifo.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Runs a CPU-hungry effect at BLOCK_SIZE while the audio callback keeps its
+// own small block for the direct path. The callback hands its input over a
+// block FIFO to a worker at a lower priority (a software interrupt on the
+// pedal), and takes back what the worker made of the block two blocks
+// earlier: the effect's output is always exactly LATENCY samples late,
+// whatever the callback's block size. The worker has one whole BLOCK_SIZE
+// period for each block. A block that is not back by the time it is due is
+// played as silence and counted, and the output stays in step. The engine
+// carries the effect's wet signal only; the callback mixes in the dry signal
+// itself, without the latency.
+//
+// Contexts, lowest priority first: Start() and Stop() in the main loop,
+// BeginBlock()/EndBlock() in the worker, Process() in the audio callback. The
+// main loop only runs while the worker is idle, so Start() and Stop() never
+// overlap it; the callback leaves the engine alone while it is stopped.
+class DualRateEngine {
+public:
+    static constexpr size_t BLOCK_SIZE = 256;
+    static constexpr uint32_t LATENCY_BLOCKS = 2;  // One to fill, one for the worker
+    static constexpr size_t LATENCY = LATENCY_BLOCKS * BLOCK_SIZE;
+
+    DualRateEngine();
+
+    // Main loop: empty both FIFOs and start with LATENCY samples of silence
+    void Start();
+    void Stop();
+    inline bool IsActive() const { return active_.load(std::memory_order_acquire); }
+
+    // Audio side: queues size samples of input and writes the worker's output
+    // from LATENCY samples ago. With process false the block comes back silent
+    // instead of running the effect (bypass). Returns true when a block was
+    // queued, i.e. the worker should be triggered.
+    bool Process(const float* inL, const float* inR, float* outL, float* outR, size_t size, bool process);
+
+    // Worker side: the next block to run the effect on, or false when there
+    // is none. EndBlock() hands the output back.
+    struct Job {
+        const float* inL;
+        const float* inR;
+        float* outL;
+        float* outR;
+    };
+    bool BeginBlock(Job* job);
+    void EndBlock();
+    // Worker side: drops every queued block without running it, when the
+    // worker is out of time. They play as silence and count as underruns.
+    // Returns the number dropped.
+    uint32_t SkipBlocks();
+
+    // Blocks that were not back from the worker in time
+    inline uint32_t GetUnderruns() const { return underruns_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint32_t DEPTH = 4;
+    using Fifo = BlockFifo<BLOCK_SIZE, DEPTH>;
+
+    void NextOutput();
+
+    Fifo input_;
+    Fifo output_;
+    std::atomic<bool> active_;
+    std::atomic<uint32_t> underruns_;
+
+    // Audio side: position in the current block, which is input block
+    // sequence_ and output block sequence_ - LATENCY_BLOCKS
+    uint32_t sequence_;
+    size_t fill_;
+    Fifo::Block* writing_;        // nullptr while a block is dropped (worker far behind)
+    const Fifo::Block* reading_;  // nullptr while the output is silent
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_DUALRATEENGINE_H
@@ -1,5 +1,6 @@
 #include "effect.h"
-#include <cstring>
+
+#include <algorithm>
 
 using namespace perspective;
 
@@ -8,6 +9,15 @@ Effect::Effect(const std::string& name)
     , enabled_(true)
     , sampleRate_(48000.0f)
     , tempo_(0.0f)
+    , quality_(0)
+    , wetOnly_(false)
+    , lfoBank_(nullptr)
+    , layout_(nullptr)
+    , values_(nullptr)
+    , numParameters_(0)
+    , tempoSlot_(-1)
+    , modulationSlot_(-1)
+    , modulation_(nullptr)
 {}
 
 Effect::~Effect() {}
@@ -20,20 +30,69 @@ void Effect::ProcessStereo(float* inL, float* inR, float* outL, float* outR, siz
 
 void Effect::SetTempo(float tempoHz) {
     tempo_ = tempoHz;
-    
-    // Find and update rate parameters
-    for (size_t i = 0; i < parameters_.size(); i++) {
-        if (parameters_[i]->GetName() == "Rate") {
-            parameters_[i]->SetValue(tempoHz);
-            Update();
-            break;
-        }
+
+    if (tempoSlot_ >= 0) {
+        GetParameter(static_cast<size_t>(tempoSlot_)).SetValue(tempoHz);
+    }
+
+    // Tempo-synced effects (e.g. the delay) derive their timing from tempo_ in Update()
+    Update();
+}
+
+void Effect::SetSampleRate(float sampleRate) {
+    // Init loads the defaults, so the values are put back after it
+    std::vector<float> values(values_, values_ + numParameters_);
+    Init(sampleRate);
+    if (values_ && numParameters_ == values.size()) {
+        std::copy(values.begin(), values.end(), values_);
     }
+    Update();
+}
+
+void Effect::SetQuality(int level) {
+    int levels = GetQualityLevels();
+    level = level < 0 ? 0 : (level >= levels ? levels - 1 : level);
+    if (level == quality_) return;
+
+    quality_ = level;
+    Update();
+}
+
+void Effect::SetLfoBank(LfoBank* lfoBank) {
+    lfoBank_ = lfoBank;
 }
 
-void Effect::AddParameter(EffectParameter* param) {
-    if (param) {
-        parameters_.push_back(param);
+bool Effect::IsTempoLocked() const {
+    return tempoSlot_ >= 0 && tempo_ > 0.0f && values_[tempoSlot_] == tempo_;
+}
+
+int Effect::AllocateLfo(float phaseOffset) {
+    if (!lfoBank_) return -1;
+
+    int lfo = lfoBank_->Allocate();
+    lfoBank_->SetPhaseOffset(lfo, phaseOffset);
+    return lfo;
+}
+
+void Effect::SetLfo(int lfo, LfoWave wave, float hz, bool lockToBeat) {
+    if (!lfoBank_) return;
+
+    lfoBank_->SetWaveform(lfo, wave);
+    lfoBank_->SetFreq(lfo, hz);
+    if (lockToBeat) {
+        lfoBank_->LockToBeat(lfo);
+    } else {
+        lfoBank_->Unlock(lfo);
+    }
+}
+
+void Effect::BindParameters(const ParameterDescriptor* layout, float* values, size_t count) {
+    layout_ = layout;
+    values_ = values;
+    numParameters_ = count;
+
+    for (size_t i = 0; i < count; i++) {
+        values_[i] = layout_[i].defaultValue;
     }
 }
 
@@ -49,13 +108,13 @@ bool Effect::IsEnabled() const {
     return enabled_;
 }
 
-EffectParameter* Effect::GetParameter(size_t index) {
-    if (index < parameters_.size()) {
-        return parameters_[index];
+EffectParameter Effect::GetParameter(size_t index) {
+    if (index < numParameters_) {
+        return EffectParameter(&layout_[index], &values_[index]);
     }
-    return nullptr;
+    return EffectParameter();
 }
 
 size_t Effect::GetParameterCount() const {
-    return parameters_.size();
+    return numParameters_;
 }
@@ -2,6 +2,7 @@
 #define PERSPECTIVE_EFFECT_H
 
 #include "effectparameter.h"
+#include "lfobank.h"
 #include <vector>
 #include <memory>
 #include <string>
@@ -14,12 +15,18 @@ public:
     Effect(const std::string& name);
     virtual ~Effect();
 
-    // Initialize the effect (called once during setup)
+    // Initialize the effect (called during setup, and again by SetSampleRate)
     // The Init method should set up any parameters to control the effect.
     // Because different parameter types map to different physical controls,
     // the index of different parameters will not be sequential.
+    // Init must be safe to repeat: nothing allocated twice, and buffers sized
+    // for any rate up to 96kHz.
     virtual void Init(float sampleRate) = 0;
 
+    // Re-initializes at a new sample rate, keeping the parameter values.
+    // Main loop, with audio stopped.
+    void SetSampleRate(float sampleRate);
+
     // Process audio - must be implemented by derived classes
     virtual void Process(float* in, float* out, size_t size) = 0;
 
@@ -29,9 +36,37 @@ public:
     // Update effect parameters - called when parameters change
     virtual void Update() = 0;
 
-    // Set tempo (called from tap tempo)
+    // Set tempo (called from tap tempo and MIDI clock)
     virtual void SetTempo(float tempoHz);
 
+    // Cheaper processing modes for the audio watchdog: level 0 is full
+    // quality and each level up to GetQualityLevels() - 1 costs less.
+    // Effects with cheaper modes override GetQualityLevels() and read quality_
+    // in Update(), which SetQuality() calls. Called from the main loop.
+    virtual int GetQualityLevels() const { return 1; }
+    virtual void SetQuality(int level);
+    inline int GetQuality() const { return quality_; }
+
+    // Effects that cost much less per sample in large blocks (convolution,
+    // neural models, big reverbs). When the audio block is small and the
+    // watchdog finds the callback overloaded, they run off the audio interrupt
+    // at DualRateEngine::BLOCK_SIZE, with a fixed extra latency on the wet
+    // signal; ProcessStereo then gets no LFO bank blocks or modulation.
+    // Such effects also implement wet-only processing and GetDryGain().
+    virtual bool UsesLargeBlocks() const { return false; }
+
+    // Wet-only processing for the large-block path: ProcessStereo writes the
+    // wet signal alone, mix applied, and the callback adds the input times
+    // GetDryGain() without the extra latency. Set from the main loop while
+    // the large-block engine is stopped; GetDryGain() is read by the callback.
+    inline void SetWetOnly(bool wetOnly) { wetOnly_ = wetOnly; }
+    inline bool IsWetOnly() const { return wetOnly_; }
+    virtual float GetDryGain() const { return 0.0f; }
+
+    // Shared LFO bank (and the transport beat its voices lock to). Set before
+    // Init, which allocates the effect's voices.
+    virtual void SetLfoBank(LfoBank* lfoBank);
+
     // Get effect name
     const std::string& GetName() const;
 
@@ -39,18 +74,76 @@ public:
     void SetEnabled(bool enabled);
     bool IsEnabled() const;
 
-    // Get parameter by index
-    EffectParameter* GetParameter(size_t index);
+    // Get parameter by index (in parameter table order); invalid handle if out of range
+    EffectParameter GetParameter(size_t index);
     size_t GetParameterCount() const;
 
+    // Raw access for ControlMap: the parameter table and the flat value array
+    inline const ParameterDescriptor* GetParameterLayout() const { return layout_; }
+    inline float* GetParameterValues() { return values_; }
+
+    // Get parameter by an effect's parameter enum
+    template <typename Id>
+    inline EffectParameter GetParameter(Id id) { return GetParameter(static_cast<size_t>(id)); }
+
+    // Per-sample values for one parameter slot during the next ProcessStereo
+    // call (expression pedal). The buffer must hold one value per sample of the
+    // block; pass nullptr to clear. Set from the audio callback before processing.
+    inline void SetModulation(int slot, const float* values) {
+        modulationSlot_ = values ? slot : -1;
+        modulation_ = values;
+    }
+
 protected:
-    void AddParameter(EffectParameter* param);
+    // Per-sample values of a modulated parameter for the current block, or
+    // nullptr when it is not modulated (use the block value in params_ instead)
+    template <typename Id>
+    inline const float* GetModulation(Id id) const {
+        return modulationSlot_ == static_cast<int>(id) ? modulation_ : nullptr;
+    }
+
+    // Binds the effect's constexpr parameter table to its value storage and
+    // loads the defaults. Call once from Init().
+    template <typename Id, size_t N, size_t M>
+    void SetParameterLayout(const ParameterDescriptor (&layout)[N], ParameterValues<Id, M>& values) {
+        static_assert(N == M, "Parameter table must have one entry per parameter enum value");
+        BindParameters(layout, values.Data(), N);
+    }
+
+    // Parameter that follows the tempo (in Hz) on SetTempo. Call from Init()
+    // after SetParameterLayout; effects without one only get tempo_ updated.
+    template <typename Id>
+    inline void SetTempoParameter(Id id) { tempoSlot_ = static_cast<int>(id); }
+
+    // True while the tempo parameter still holds the last SetTempo value, i.e.
+    // its LFO should lock to the beat rather than free-run at the knob rate
+    bool IsTempoLocked() const;
+
+    // LFO voices from the shared bank; -1 (a silent voice) without a bank
+    int AllocateLfo(float phaseOffset = 0.0f);
+    // Free-running at hz, or one cycle per beat when lockToBeat. Call from Update().
+    void SetLfo(int lfo, LfoWave wave, float hz, bool lockToBeat);
+    // The voice's output for each sample of the current block
+    inline const float* GetLfoBlock(int lfo) { return lfoBank_ ? lfoBank_->GetBlock(lfo) : LfoBank::ZERO_BLOCK; }
 
     std::string name_;
-    std::vector<EffectParameter*> parameters_;
     bool enabled_;
     float sampleRate_;
     float tempo_;
+    int quality_;  // Watchdog quality level, 0 = full
+    bool wetOnly_; // Large-block path: leave the dry signal to the callback
+    LfoBank* lfoBank_;
+
+private:
+    void BindParameters(const ParameterDescriptor* layout, float* values, size_t count);
+
+    const ParameterDescriptor* layout_;
+    float* values_;
+    size_t numParameters_;
+    int tempoSlot_;
+
+    int modulationSlot_;
+    const float* modulation_;
 };
 
 } // namespace perspective
@@ -5,95 +5,8 @@
 using namespace daisy;
 using namespace perspective;
 
-// ========== EffectParameter Base Class ==========
-
-EffectParameter::EffectParameter(const std::string& name, float minValue, float maxValue, float defaultValue, int index)
-    : name_(name)
-    , minValue_(minValue)
-    , maxValue_(maxValue)
-    , currentValue_(defaultValue)
-    , index_(index)
-{}
-
-EffectParameter::~EffectParameter() {}
-
-float EffectParameter::GetValue() const {
-    return currentValue_;
-}
-
-float EffectParameter::GetNormalizedValue() const {
-    return (currentValue_ - minValue_) / (maxValue_ - minValue_);
-}
-
-const std::string& EffectParameter::GetName() const {
-    return name_;
-}
-
-float EffectParameter::GetMin() const {
-    return minValue_;
-}
-
-float EffectParameter::GetMax() const {
-    return maxValue_;
-}
-
-int EffectParameter::GetIndex() const {
-    return index_;
-}
-
-void EffectParameter::SetValue(float value) {
-    currentValue_ = clamp(value, minValue_, maxValue_);
-}
-
-void EffectParameter::SetNormalizedValue(float normalizedValue) {
-    float clampedNormalized = clamp(normalizedValue, 0.0f, 1.0f);
-    currentValue_ = minValue_ + (clampedNormalized * (maxValue_ - minValue_));
-}
-
-void EffectParameter::SetIndex(int index) {
-    index_ = index;
-}
-
-// ========== PotentiometerParameter ==========
-
-PotentiometerParameter::PotentiometerParameter(const std::string& name, float minValue, float maxValue, float defaultValue, PotCurve curve, int index)
-    : EffectParameter(name, minValue, maxValue, defaultValue, index)
-    , curve_(curve)
-{}
-
-PotentiometerParameter::~PotentiometerParameter() {}
-
-void PotentiometerParameter::SetCurve(PotCurve curve) {
-    curve_ = curve;
-}
-
-PotCurve PotentiometerParameter::GetCurve() const {
-    return curve_;
-}
-
-void PotentiometerParameter::SetNormalizedValueWithCurve(float normalizedValue) {
-    float curvedValue = ApplyCurve(normalizedValue);
-    currentValue_ = minValue_ + (curvedValue * (maxValue_ - minValue_));
-}
-
-ParameterType PotentiometerParameter::GetType() const {
-    return ParameterType::POTENTIOMETER;
-}
-
-int PotentiometerParameter::GetValueAsInt(int maxInt) const {
-    // Get normalized value (0.0 to 1.0)
-    float normalized = GetNormalizedValue();
-    
-    // Scale to integer range (0 to maxInt)
-    // Add 0.5 for proper rounding
-    int intValue = static_cast<int>(normalized * maxInt + 0.5f);
-    
-    // Clamp to ensure we stay within bounds
-    return clamp(intValue, 0, maxInt);
-}
-
-float PotentiometerParameter::ApplyCurve(float normalizedValue) {
-    switch (curve_) {
+float perspective::ApplyPotCurve(PotCurve curve, float normalizedValue) {
+    switch (curve) {
         case PotCurve::LIN:
             return normalizedValue;
         
@@ -129,60 +42,54 @@ float PotentiometerParameter::ApplyCurve(float normalizedValue) {
     }
 }
 
-// ========== EncoderParameter ==========
-
-EncoderParameter::EncoderParameter(const std::string& name, float minValue, float maxValue, float defaultValue, float stepSize, int index)
-    : EffectParameter(name, minValue, maxValue, defaultValue, index)
-    , stepSize_(stepSize)
-{}
+// ========== EffectParameter ==========
 
-EncoderParameter::~EncoderParameter() {}
-
-void EncoderParameter::SetStepSize(float stepSize) {
-    stepSize_ = stepSize;
+float EffectParameter::GetNormalizedValue() const {
+    return (*value_ - descriptor_->minValue) / (descriptor_->maxValue - descriptor_->minValue);
 }
 
-float EncoderParameter::GetStepSize() const {
-    return stepSize_;
+void EffectParameter::SetValue(float value) {
+    if (descriptor_->type == ParameterType::TOGGLE) {
+        SetState(value >= 0.5f);
+        return;
+    }
+    *value_ = clamp(value, descriptor_->minValue, descriptor_->maxValue);
 }
 
-void EncoderParameter::Increment(int steps) {
-    currentValue_ += steps * stepSize_;
-    currentValue_ = clamp(currentValue_, minValue_, maxValue_);
+void EffectParameter::SetNormalizedValue(float normalizedValue) {
+    float clampedNormalized = clamp(normalizedValue, 0.0f, 1.0f);
+    *value_ = descriptor_->minValue + (clampedNormalized * (descriptor_->maxValue - descriptor_->minValue));
 }
 
-void EncoderParameter::Decrement(int steps) {
-    currentValue_ -= steps * stepSize_;
-    currentValue_ = clamp(currentValue_, minValue_, maxValue_);
+void EffectParameter::SetNormalizedValueWithCurve(float normalizedValue) {
+    float curvedValue = ApplyPotCurve(descriptor_->curve, normalizedValue);
+    *value_ = descriptor_->minValue + (curvedValue * (descriptor_->maxValue - descriptor_->minValue));
 }
 
-ParameterType EncoderParameter::GetType() const {
-    return ParameterType::ENCODER;
+int EffectParameter::GetValueAsInt(int maxInt) const {
+    // Get normalized value (0.0 to 1.0)
+    float normalized = GetNormalizedValue();
+    
+    // Scale to integer range (0 to maxInt)
+    // Add 0.5 for proper rounding
+    int intValue = static_cast<int>(normalized * maxInt + 0.5f);
+    
+    // Clamp to ensure we stay within bounds
+    return clamp(intValue, 0, maxInt);
 }
 
-// ========== ToggleParameter ==========
-
-ToggleParameter::ToggleParameter(const std::string& name, bool defaultValue, int index)
-    : EffectParameter(name, 0.0f, 1.0f, defaultValue ? 1.0f : 0.0f, index)
-    , state_(defaultValue)
-{}
-
-ToggleParameter::~ToggleParameter() {}
-
-void ToggleParameter::Toggle() {
-    state_ = !state_;
-    currentValue_ = state_ ? 1.0f : 0.0f;
+void EffectParameter::Increment(int steps) {
+    *value_ = clamp(*value_ + steps * descriptor_->stepSize, descriptor_->minValue, descriptor_->maxValue);
 }
 
-bool ToggleParameter::GetState() const {
-    return state_;
+void EffectParameter::Decrement(int steps) {
+    *value_ = clamp(*value_ - steps * descriptor_->stepSize, descriptor_->minValue, descriptor_->maxValue);
 }
 
-void ToggleParameter::SetState(bool state) {
-    state_ = state;
-    currentValue_ = state_ ? 1.0f : 0.0f;
+void EffectParameter::Toggle() {
+    SetState(!GetState());
 }
 
-ParameterType ToggleParameter::GetType() const {
-    return ParameterType::TOGGLE;
+void EffectParameter::SetState(bool state) {
+    *value_ = state ? 1.0f : 0.0f;
 }
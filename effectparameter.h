@@ -53,97 +53,113 @@ static inline float taperFunction(float x, float ym) {
     return a * std::pow(b, x) - a;
 }
 
-// Base class for effect parameters
+// Maps a normalized control position (0.0 to 1.0) through a pot curve
+float ApplyPotCurve(PotCurve curve, float normalizedValue);
+
+// Static description of one effect parameter.
+// Each effect declares a constexpr table of these (one entry per value of its
+// parameter enum) using the PotentiometerParameter, EncoderParameter and
+// ToggleParameter helpers below. The table lives in flash; the current values
+// live in a flat float array owned by the effect (see ParameterValues).
 // NB: The index is used to map parameters to physical controls, and does not indicate the order of the parameter itself.
-// For PotentiometerParameter and EncoderParameter, index corresponds to a physical potentiometer or encoder number respectively.
+// For potentiometer and encoder parameters, index corresponds to a physical potentiometer or encoder number respectively.
+struct ParameterDescriptor {
+    constexpr ParameterDescriptor(const char* name, ParameterType type, float minValue, float maxValue, float defaultValue,
+                                  PotCurve curve, float stepSize, int index)
+        : name(name), type(type), minValue(minValue), maxValue(maxValue), defaultValue(defaultValue),
+          curve(curve), stepSize(stepSize), index(index) {}
+
+    const char* name;
+    ParameterType type;
+    float minValue;
+    float maxValue;
+    float defaultValue;
+    PotCurve curve;   // Potentiometers only
+    float stepSize;   // Encoders only
+    int index;        // Index for mapping to controls
+};
+
+// Parameter with potentiometer curves
+struct PotentiometerParameter : public ParameterDescriptor {
+    constexpr PotentiometerParameter(const char* name, float minValue, float maxValue, float defaultValue, PotCurve curve = PotCurve::LIN, int index = -1)
+        : ParameterDescriptor(name, ParameterType::POTENTIOMETER, minValue, maxValue, defaultValue, curve, 0.0f, index) {}
+};
+
+// Encoder-based parameter with step increments
+struct EncoderParameter : public ParameterDescriptor {
+    constexpr EncoderParameter(const char* name, float minValue, float maxValue, float defaultValue, float stepSize = 0.01f, int index = -1)
+        : ParameterDescriptor(name, ParameterType::ENCODER, minValue, maxValue, defaultValue, PotCurve::LIN, stepSize, index) {}
+};
+
+// Toggle parameter (on/off switch), stored as 0.0 or 1.0
+struct ToggleParameter : public ParameterDescriptor {
+    constexpr ToggleParameter(const char* name, bool defaultValue = false, int index = -1)
+        : ParameterDescriptor(name, ParameterType::TOGGLE, 0.0f, 1.0f, defaultValue ? 1.0f : 0.0f, PotCurve::LIN, 1.0f, index) {}
+};
+
+// Flat parameter storage for an effect, indexed by the effect's parameter enum.
+// The enum must end with COUNT. Reads are a plain array load - no virtual
+// calls or bounds checks - so they are safe to use in the audio loop.
+template <typename Id, size_t N = static_cast<size_t>(Id::COUNT)>
+class ParameterValues {
+public:
+    inline float operator[](Id id) const { return values_[static_cast<size_t>(id)]; }
+    inline float& operator[](Id id) { return values_[static_cast<size_t>(id)]; }
+
+    // Toggle parameters
+    inline bool IsOn(Id id) const { return values_[static_cast<size_t>(id)] >= 0.5f; }
+
+    inline float* Data() { return values_; }
+    static constexpr size_t Size() { return N; }
+
+private:
+    float values_[N];
+};
+
+// Handle onto one parameter of an effect (its descriptor plus its slot in the
+// value array). Used by the UI and preset code; the handle is cheap to copy and
+// is invalid (false) when the parameter does not exist.
 class EffectParameter {
 public:
-    EffectParameter(const std::string& name, float minValue, float maxValue, float defaultValue, int index = -1);
-    virtual ~EffectParameter();
+    EffectParameter() : descriptor_(nullptr), value_(nullptr) {}
+    EffectParameter(const ParameterDescriptor* descriptor, float* value) : descriptor_(descriptor), value_(value) {}
+
+    inline explicit operator bool() const { return descriptor_ != nullptr; }
 
     // Getters
-    float GetValue() const;
+    inline float GetValue() const { return *value_; }
     float GetNormalizedValue() const;
-    const std::string& GetName() const;
-    float GetMin() const;
-    float GetMax() const;
-    int GetIndex() const;
-    virtual ParameterType GetType() const = 0;  // Pure virtual - must be implemented
+    inline const char* GetName() const { return descriptor_->name; }
+    inline float GetMin() const { return descriptor_->minValue; }
+    inline float GetMax() const { return descriptor_->maxValue; }
+    inline float GetDefault() const { return descriptor_->defaultValue; }
+    inline int GetIndex() const { return descriptor_->index; }
+    inline ParameterType GetType() const { return descriptor_->type; }
+    inline PotCurve GetCurve() const { return descriptor_->curve; }
+    inline float GetStepSize() const { return descriptor_->stepSize; }
 
     // Setters
     void SetValue(float value);
     void SetNormalizedValue(float normalizedValue);  // Set value from 0.0 to 1.0
-    void SetIndex(int index);
-
-protected:
-    std::string name_;
-    float minValue_;
-    float maxValue_;
-    float currentValue_;
-    int index_;  // Index for mapping to controls
-};
 
-// Subclass for parameters with potentiometer curves
-class PotentiometerParameter : public EffectParameter {
-public:
-    PotentiometerParameter(const std::string& name, float minValue, float maxValue, float defaultValue, PotCurve curve = PotCurve::LIN, int index = -1);
-    virtual ~PotentiometerParameter();
-    
-    void SetCurve(PotCurve curve);
-    PotCurve GetCurve() const;
-    
-    // Set value with curve applied (input is 0.0 to 1.0)
+    // Potentiometers: set value with curve applied (input is 0.0 to 1.0)
     void SetNormalizedValueWithCurve(float normalizedValue);
-    
-    // Convert value to integer with configurable maximum
-    int GetValueAsInt(int maxInt) const;
-    
-    ParameterType GetType() const override;
-
-private:
-    float ApplyCurve(float normalizedValue);
-    
-    PotCurve curve_;
-};
 
-// Subclass for encoder-based parameters with step increments
-class EncoderParameter : public EffectParameter {
-public:
-    EncoderParameter(const std::string& name, float minValue, float maxValue, float defaultValue, float stepSize = 0.01f, int index = -1);
-    virtual ~EncoderParameter();
+    // Potentiometers: convert value to integer with configurable maximum
+    int GetValueAsInt(int maxInt) const;
 
-    void SetStepSize(float stepSize);
-    float GetStepSize() const;
-    
-    // Increment/decrement by step amount
+    // Encoders: increment/decrement by step amount
     void Increment(int steps = 1);
     void Decrement(int steps = 1);
-    
-    ParameterType GetType() const override;
-
-private:
-    float stepSize_;
-};
-
-// Subclass for toggle parameters (on/off switches)
-class ToggleParameter : public EffectParameter {
-public:
-    ToggleParameter(const std::string& name, bool defaultValue = false, int index = -1);
-    virtual ~ToggleParameter();
 
-    // Toggle the state
+    // Toggles
     void Toggle();
-    
-    // Get boolean state
-    bool GetState() const;
-    
-    // Set boolean state
+    inline bool GetState() const { return *value_ >= 0.5f; }
     void SetState(bool state);
-    
-    ParameterType GetType() const override;
 
 private:
-    bool state_;
+    const ParameterDescriptor* descriptor_;
+    float* value_;
 };
 
 } // namespace perspective
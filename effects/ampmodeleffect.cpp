@@ -0,0 +1,128 @@
+#include "ampmodeleffect.h"
+#include "../controls.h"
+#include "daisy_seed.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+// Input, Output, Mix, Model
+static constexpr ParameterDescriptor AMP_MODEL_PARAMETERS[] = {
+    PotentiometerParameter("Input", -12.0f, 24.0f, 0.0f, PotCurve::LIN, KNOB_1_IDX),   // dB
+    PotentiometerParameter("Output", -24.0f, 12.0f, 0.0f, PotCurve::LIN, KNOB_2_IDX),  // dB
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 1.0f, PotCurve::LIN, KNOB_3_IDX),
+    EncoderParameter("Model", 0.0f, static_cast<float>(AmpModelEffect::NUM_SLOTS - 1), 0.0f, 1.0f, ENCODER_1_IDX),
+};
+
+// Weights, WaveNet history and scratch for the loaded model (128KB). SDRAM,
+// since .bss is in the 128KB DTCM; reads go through the data cache.
+// Fits the LSTM and nano/feather WaveNet sizes; bigger models are refused at load.
+static constexpr size_t AMP_ARENA_FLOATS = 32768;
+static float DSY_SDRAM_BSS g_ampArena[AMP_ARENA_FLOATS];
+static NamModel g_ampModel;
+
+static inline float DbToGain(float db) {
+    return powf(10.0f, db * 0.05f);
+}
+
+AmpModelEffect::AmpModelEffect()
+    : Effect("Amp"),
+      flash_(nullptr),
+      slot_(-1),
+      loadResult_(NamModel::LoadResult::PARSE_ERROR),
+      ready_(false),
+      processing_(false),
+      inputGain_(1.0f),
+      outputGain_(1.0f) {
+}
+
+AmpModelEffect::~AmpModelEffect() {
+}
+
+void AmpModelEffect::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+    g_ampModel.SetArena(g_ampArena, AMP_ARENA_FLOATS);
+
+    SetParameterLayout(AMP_MODEL_PARAMETERS, params_);
+
+    // Set default parameters and load the first slot
+    slot_ = -1;
+    Update();
+}
+
+void AmpModelEffect::Process(float* in, float* out, size_t size) {
+    processing_.store(true);
+    if (!enabled_ || !ready_.load()) {
+        // Bypass (or no model) - pass through dry signal (left to the callback when wet only)
+        for (size_t i = 0; i < size; i++) {
+            out[i] = wetOnly_ ? 0.0f : in[i];
+        }
+        processing_.store(false);
+        return;
+    }
+
+    float mix = params_[Param::MIX];
+    float dry = wetOnly_ ? 0.0f : 1.0f - mix;
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        size_t chunk = size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE;
+        for (size_t i = 0; i < chunk; i++) {
+            input_[i] = in[offset + i] * inputGain_;
+        }
+        g_ampModel.Process(input_, wet_, chunk);
+        for (size_t i = 0; i < chunk; i++) {
+            out[offset + i] = in[offset + i] * dry + wet_[i] * outputGain_ * mix;
+        }
+    }
+    processing_.store(false);
+}
+
+void AmpModelEffect::ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) {
+    (void)inR;
+    Process(inL, outL, size);
+    for (size_t i = 0; i < size; i++) {
+        outR[i] = outL[i];
+    }
+}
+
+float AmpModelEffect::GetDryGain() const {
+    return enabled_ && ready_.load() ? 1.0f - params_[Param::MIX] : 1.0f;
+}
+
+void AmpModelEffect::Update() {
+    inputGain_ = DbToGain(params_[Param::INPUT]);
+    outputGain_ = DbToGain(params_[Param::OUTPUT]);
+
+    int slot = static_cast<int>(params_[Param::MODEL] + 0.5f);
+    if (slot != slot_) {
+        LoadSlot(slot);
+    }
+}
+
+void AmpModelEffect::LoadSlot(int slot) {
+    // Take the model away from the audio callback, and wait out a block in flight
+    ready_.store(false);
+    while (processing_.load()) {
+    }
+
+    slot_ = slot;
+    loadResult_ = NamModel::LoadResult::PARSE_ERROR;
+    g_ampModel.Unload();
+    if (!flash_ || slot < 0 || slot >= NUM_SLOTS) return;
+
+    uint32_t offset = static_cast<uint32_t>(slot) * MODEL_SLOT_SIZE;
+    const AmpModelSlotHeader* header = reinterpret_cast<const AmpModelSlotHeader*>(flash_->GetData(offset));
+    if (header->magic != AMP_MODEL_MAGIC || header->length > MODEL_SLOT_SIZE - sizeof(AmpModelSlotHeader)) return;
+
+    const char* text = reinterpret_cast<const char*>(flash_->GetData(offset + sizeof(AmpModelSlotHeader)));
+    loadResult_ = g_ampModel.Load(text, header->length, CHUNK_SIZE);
+
+    // Models are trained at one rate; running one at another shifts its tone
+    if (loadResult_ == NamModel::LoadResult::OK && g_ampModel.GetSampleRate() > 0.0f &&
+        fabsf(g_ampModel.GetSampleRate() - sampleRate_) > 1.0f) {
+        loadResult_ = NamModel::LoadResult::UNSUPPORTED;
+        g_ampModel.Unload();
+        return;
+    }
+
+    ready_.store(loadResult_ == NamModel::LoadResult::OK);
+}
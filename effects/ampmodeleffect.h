@@ -0,0 +1,72 @@
+#ifndef PERSPECTIVE_AMPMODELEFFECT_H
+#define PERSPECTIVE_AMPMODELEFFECT_H
+
+#include <atomic>
+#include "../effect.h"
+#include "../presetflash.h"
+#include "nammodel.h"
+
+// Amp model region below the presets: 7 slots of 128KB, each an
+// AmpModelSlotHeader followed by the .nam file text
+#define MODEL_FLASH_OFFSET 0x00700000
+#define MODEL_FLASH_SIZE   0x000E0000
+#define MODEL_SLOT_SIZE    0x00020000
+
+namespace perspective {
+
+struct AmpModelSlotHeader {
+    uint32_t magic;   // AMP_MODEL_MAGIC; erased slots read 0xFFFFFFFF
+    uint32_t length;  // Bytes of .nam text after the header
+};
+
+static constexpr uint32_t AMP_MODEL_MAGIC = 0x304D414E;  // "NAM0"
+
+// Neural amp model (see NamModel). The model is read from a QSPI slot when
+// the Model encoder changes; audio passes through dry while a slot is empty,
+// does not parse, or is too big for the arena. Mono - the left input is
+// modelled and sent to both outputs.
+class AmpModelEffect : public Effect {
+public:
+    AmpModelEffect();
+    ~AmpModelEffect() override;
+
+    // Flash region holding the model slots. Set before Init.
+    void SetModelFlash(const PresetFlash* flash) { flash_ = flash; }
+
+    void Init(float sampleRate) override;
+    void Process(float* in, float* out, size_t size) override;
+    void ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) override;
+    void Update() override;
+    bool UsesLargeBlocks() const override { return true; }
+    float GetDryGain() const override;
+
+    inline NamModel::LoadResult GetLoadResult() const { return loadResult_; }
+
+    static constexpr int NUM_SLOTS = MODEL_FLASH_SIZE / MODEL_SLOT_SIZE;
+
+private:
+    // Parameters, in table order
+    enum class Param { INPUT, OUTPUT, MIX, MODEL, COUNT };
+    ParameterValues<Param> params_;
+
+    static constexpr size_t CHUNK_SIZE = 64;  // Frames per model call; sizes the WaveNet history
+
+    void LoadSlot(int slot);
+
+    const PresetFlash* flash_;
+    int slot_;
+    NamModel::LoadResult loadResult_;
+
+    // The audio callback skips the model while the main loop reloads it
+    std::atomic<bool> ready_;
+    std::atomic<bool> processing_;
+
+    float inputGain_;
+    float outputGain_;
+    float input_[CHUNK_SIZE];
+    float wet_[CHUNK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_AMPMODELEFFECT_H
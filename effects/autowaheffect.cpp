@@ -4,6 +4,17 @@
 using namespace perspective;
 using namespace daisysp;
 
+// Mix, Resonance, Frequency, Attack, Release, Range, Direction
+static constexpr ParameterDescriptor AUTOWAH_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Resonance", 0.5f, 20.0f, 2.0f, PotCurve::LOG, KNOB_2_IDX),
+    PotentiometerParameter("Frequency", 400.0f, 2000.0f, 1000.0f, PotCurve::LOG, KNOB_3_IDX),
+    PotentiometerParameter("Attack", 0.001f, 0.5f, 0.1f, PotCurve::LOG, KNOB_4_IDX),
+    PotentiometerParameter("Release", 0.0001f, 0.1f, 0.001f, PotCurve::LOG, KNOB_5_IDX),
+    PotentiometerParameter("Range", 0.0f, 3000.0f, 1600.0f, PotCurve::LIN, KNOB_6_IDX),
+    ToggleParameter("Direction", true, SWITCH_1_IDX),  // true = up, false = down
+};
+
 AutowahEffect::AutowahEffect()
     : Effect("Autowah")
     , envelope_(0.0f) {
@@ -19,14 +30,7 @@ void AutowahEffect::Init(float sampleRate) {
     filterL_.Init(sampleRate);
     filterR_.Init(sampleRate);
     
-    // Add parameters: Mix, Resonance, Frequency, Attack, Release, Range, Direction
-    AddParameter(new PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX));
-    AddParameter(new PotentiometerParameter("Resonance", 0.5f, 20.0f, 2.0f, PotCurve::LOG, KNOB_2_IDX));
-    AddParameter(new PotentiometerParameter("Frequency", 400.0f, 2000.0f, 1000.0f, PotCurve::LOG, KNOB_3_IDX));
-    AddParameter(new PotentiometerParameter("Attack", 0.001f, 0.5f, 0.1f, PotCurve::LOG, KNOB_4_IDX));
-    AddParameter(new PotentiometerParameter("Release", 0.0001f, 0.1f, 0.001f, PotCurve::LOG, KNOB_5_IDX));
-    AddParameter(new PotentiometerParameter("Range", 0.0f, 3000.0f, 1600.0f, PotCurve::LIN, KNOB_6_IDX));
-    AddParameter(new ToggleParameter("Direction", true, SWITCH_1_IDX));  // true = up, false = down
+    SetParameterLayout(AUTOWAH_PARAMETERS, params_);
     
     // Set default filter parameters
     Update();
@@ -42,7 +46,7 @@ void AutowahEffect::Process(float* in, float* out, size_t size) {
     }
     
     // Get mix parameter
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    float mix = params_[Param::MIX];
     
     // Process with wet/dry blend
     for (size_t i = 0; i < size; i++) {
@@ -63,18 +67,14 @@ void AutowahEffect::ProcessStereo(float* inL, float* inR, float* outL, float* ou
     }
     
     // Get mix parameter
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    float mix = params_[Param::MIX];
     
     // Get parameters
-    float baseFreq = parameters_.size() >= 7 ? parameters_[2]->GetValue() : 1000.0f;
-    float freqRange = parameters_.size() >= 7 ? parameters_[6]->GetValue() : 1600.0f;
-    float attackCoeff = parameters_.size() >= 7 ? parameters_[4]->GetValue() : 0.1f;
-    float releaseCoeff = parameters_.size() >= 7 ? parameters_[5]->GetValue() : 0.001f;
-    bool directionUp = true;
-    if (parameters_.size() >= 7 && parameters_[3]->GetType() == ParameterType::TOGGLE) {
-        ToggleParameter* dirParam = static_cast<ToggleParameter*>(parameters_[3]);
-        directionUp = dirParam->GetState();
-    }
+    float baseFreq = params_[Param::FREQUENCY];
+    float freqRange = params_[Param::RANGE];
+    float attackCoeff = params_[Param::ATTACK];
+    float releaseCoeff = params_[Param::RELEASE];
+    bool directionUp = params_.IsOn(Param::DIRECTION);
     
     // Process stereo signal with independent filters
     for (size_t i = 0; i < size; i++) {
@@ -108,17 +108,10 @@ void AutowahEffect::ProcessStereo(float* inL, float* inR, float* outL, float* ou
 
 void AutowahEffect::Update() {
     // Update filter parameters from effect parameters
-    if (parameters_.size() >= 7) {
-        // Mix parameter (index 0) - handled in Process
-        // Frequency parameter (index 2) - handled in Process
-        // Direction parameter (index 3) - handled in Process
-        // Attack parameter (index 4) - handled in Process
-        // Release parameter (index 5) - handled in Process
-        // Range parameter (index 6) - handled in Process
-        
-        // Resonance parameter (index 1)
-        float q = parameters_[1]->GetNormalizedValue();
-        filterL_.SetRes(q);
-        filterR_.SetRes(q);
-    }
+    // Mix, Frequency, Attack, Release, Range and Direction - handled in Process
+    
+    // Resonance parameter
+    float q = GetParameter(Param::RESONANCE).GetNormalizedValue();
+    filterL_.SetRes(q);
+    filterR_.SetRes(q);
 }
@@ -19,6 +19,10 @@ public:
     void Update() override;
 
 private:
+    // Parameters, in table order
+    enum class Param { MIX, RESONANCE, FREQUENCY, ATTACK, RELEASE, RANGE, DIRECTION, COUNT };
+    ParameterValues<Param> params_;
+
     Svf filterL_;
     Svf filterR_;
     float envelope_;
@@ -4,6 +4,13 @@
 using namespace perspective;
 using namespace daisysp;
 
+// Mix, Resonance, Frequency
+static constexpr ParameterDescriptor BANDPASS_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Resonance", 0.5f, 20.0f, 2.0f, PotCurve::LOG, KNOB_2_IDX),
+    PotentiometerParameter("Frequency", 400.0f, 2000.0f, 1000.0f, PotCurve::LOG, KNOB_EXP_IDX),
+};
+
 BandpassEffect::BandpassEffect()
     : Effect("Wah2") {
 }
@@ -18,10 +25,7 @@ void BandpassEffect::Init(float sampleRate) {
     filterL_.Init(sampleRate);
     filterR_.Init(sampleRate);
     
-    // Add parameters: Mix, Resonance, Frequency
-    AddParameter(new PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX));
-    AddParameter(new PotentiometerParameter("Resonance", 0.5f, 20.0f, 2.0f, PotCurve::LOG, KNOB_2_IDX));
-    AddParameter(new PotentiometerParameter("Frequency", 400.0f, 2000.0f, 1000.0f, PotCurve::LOG, KNOB_EXP_IDX));
+    SetParameterLayout(BANDPASS_PARAMETERS, params_);
     
     // Set default filter parameters
     Update();
@@ -37,7 +41,7 @@ void BandpassEffect::Process(float* in, float* out, size_t size) {
     }
     
     // Get mix parameter
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    float mix = params_[Param::MIX];
     
     // Process with wet/dry blend
     for (size_t i = 0; i < size; i++) {
@@ -58,10 +62,18 @@ void BandpassEffect::ProcessStereo(float* inL, float* inR, float* outL, float* o
     }
     
     // Get mix parameter
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    float mix = params_[Param::MIX];
+
+    // Expression pedal sweep - SetFreq is costly, so retune every few samples
+    const float* frequency = GetModulation(Param::FREQUENCY);
     
     // Process stereo signal with independent filters
     for (size_t i = 0; i < size; i++) {
+        if (frequency && (i % FREQUENCY_UPDATE_INTERVAL) == 0) {
+            filterL_.SetFreq(frequency[i]);
+            filterR_.SetFreq(frequency[i]);
+        }
+
         filterL_.Process(inL[i]);
         filterR_.Process(inR[i]);
         
@@ -75,18 +87,16 @@ void BandpassEffect::ProcessStereo(float* inL, float* inR, float* outL, float* o
 
 void BandpassEffect::Update() {
     // Update filter parameters from effect parameters
-    if (parameters_.size() >= 3) {
-        // Mix parameter (index 0) - handled in Process
-        
-        // Frequency parameter (index 1)
-        float frequency = parameters_[1]->GetValue();
-        filterL_.SetFreq(frequency);
-        filterR_.SetFreq(frequency);
-        
-        // Resonance parameter (index 2)
-        // Convert Q factor (0.5-20) to resonance (0-1)
-        float q = parameters_[2]->GetNormalizedValue();
-        filterL_.SetRes(q);
-        filterR_.SetRes(q);
-    }
+    // Mix parameter - handled in Process
+    
+    // Frequency parameter
+    float frequency = params_[Param::FREQUENCY];
+    filterL_.SetFreq(frequency);
+    filterR_.SetFreq(frequency);
+    
+    // Resonance parameter
+    // Convert Q factor (0.5-20) to resonance (0-1)
+    float q = GetParameter(Param::RESONANCE).GetNormalizedValue();
+    filterL_.SetRes(q);
+    filterR_.SetRes(q);
 }
@@ -19,6 +19,12 @@ public:
     void Update() override;
 
 private:
+    // Parameters, in table order
+    enum class Param { MIX, RESONANCE, FREQUENCY, COUNT };
+    ParameterValues<Param> params_;
+
+    static constexpr size_t FREQUENCY_UPDATE_INTERVAL = 8;  // Samples between filter retunes when swept
+
     Svf filterL_;
     Svf filterR_;
 };
@@ -0,0 +1,143 @@
+#include "cabineteffect.h"
+#include "wavfile.h"
+#include "../controls.h"
+#include "daisy_seed.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+// Mix, Level, Length, IR
+static constexpr ParameterDescriptor CABINET_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 1.0f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Level", -24.0f, 12.0f, 0.0f, PotCurve::LIN, KNOB_2_IDX),   // dB
+    PotentiometerParameter("Length", 5.0f, 200.0f, 100.0f, PotCurve::LOG, KNOB_3_IDX), // ms
+    EncoderParameter("IR", 0.0f, static_cast<float>(CabinetEffect::NUM_SLOTS - 1), 0.0f, 1.0f, ENCODER_1_IDX),
+};
+
+// IR spectra, both channels' frequency delay lines and the decoded IR (~230KB)
+static ConvolutionIr::Memory DSY_SDRAM_BSS g_cabinetIrMemory;
+static PartitionedConvolver::History DSY_SDRAM_BSS g_cabinetHistory[2];
+static float DSY_SDRAM_BSS g_cabinetLoad[ConvolutionIr::MAX_LENGTH];
+static ConvolutionIr g_cabinetIr;
+
+CabinetEffect::CabinetEffect()
+    : Effect("Cabinet"),
+      flash_(nullptr),
+      slot_(-1),
+      ready_(false),
+      processing_(false),
+      level_(1.0f) {
+}
+
+CabinetEffect::~CabinetEffect() {
+}
+
+void CabinetEffect::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+
+    // SDRAM is not zeroed at startup; Init clears it
+    g_cabinetIr.Init(&g_cabinetIrMemory);
+    left_.Init(&g_cabinetIr, &g_cabinetHistory[0]);
+    right_.Init(&g_cabinetIr, &g_cabinetHistory[1]);
+
+    SetParameterLayout(CABINET_PARAMETERS, params_);
+
+    // Set default parameters and load the first slot
+    slot_ = -1;
+    Update();
+}
+
+void CabinetEffect::ProcessChannel(PartitionedConvolver& convolver, const float* in, float* out, size_t size) {
+    float mix = params_[Param::MIX];
+    float dry = wetOnly_ ? 0.0f : 1.0f - mix;
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        size_t chunk = size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE;
+        convolver.Process(in + offset, wet_, chunk);
+        for (size_t i = 0; i < chunk; i++) {
+            out[offset + i] = in[offset + i] * dry + wet_[i] * level_ * mix;
+        }
+    }
+}
+
+void CabinetEffect::Process(float* in, float* out, size_t size) {
+    processing_.store(true);
+    if (!enabled_ || !ready_.load()) {
+        // Bypass (or no IR) - pass through dry signal (left to the callback when wet only)
+        for (size_t i = 0; i < size; i++) {
+            out[i] = wetOnly_ ? 0.0f : in[i];
+        }
+    } else {
+        ProcessChannel(left_, in, out, size);
+    }
+    processing_.store(false);
+}
+
+void CabinetEffect::ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) {
+    processing_.store(true);
+    if (!enabled_ || !ready_.load()) {
+        // Bypass (or no IR) - pass through dry signal (left to the callback when wet only)
+        for (size_t i = 0; i < size; i++) {
+            outL[i] = wetOnly_ ? 0.0f : inL[i];
+            outR[i] = wetOnly_ ? 0.0f : inR[i];
+        }
+    } else {
+        ProcessChannel(left_, inL, outL, size);
+        ProcessChannel(right_, inR, outR, size);
+    }
+    processing_.store(false);
+}
+
+float CabinetEffect::GetDryGain() const {
+    return enabled_ && ready_.load() ? 1.0f - params_[Param::MIX] : 1.0f;
+}
+
+void CabinetEffect::Update() {
+    level_ = powf(10.0f, params_[Param::LEVEL] * 0.05f);
+
+    int slot = static_cast<int>(params_[Param::IR] + 0.5f);
+    if (slot != slot_) {
+        LoadSlot(slot);
+    }
+
+    // Length parameter - convolve only this much of the IR (less in the watchdog's cheaper modes)
+    float length = params_[Param::LENGTH] * 0.001f * sampleRate_;
+    g_cabinetIr.SetActiveLength(static_cast<size_t>(length) >> quality_);
+}
+
+void CabinetEffect::LoadSlot(int slot) {
+    // Take the IR away from the audio callback, and wait out a block in flight
+    ready_.store(false);
+    while (processing_.load()) {
+    }
+
+    slot_ = slot;
+    g_cabinetIr.Clear();
+    if (!flash_ || slot < 0 || slot >= NUM_SLOTS) return;
+
+    uint32_t offset = static_cast<uint32_t>(slot) * CABINET_SLOT_SIZE;
+    const CabinetSlotHeader* header = reinterpret_cast<const CabinetSlotHeader*>(flash_->GetData(offset));
+    if (header->magic != CABINET_MAGIC || header->length > CABINET_SLOT_SIZE - sizeof(CabinetSlotHeader)) return;
+
+    WavFile wav;
+    if (!wav.Parse(flash_->GetData(offset + sizeof(CabinetSlotHeader)), header->length) || wav.sampleRate == 0) return;
+
+    // Linear resampling to the pedal's rate; cabinets roll off well below
+    // Nyquist, so the interpolation's own high-frequency loss hardly matters
+    float step = static_cast<float>(wav.sampleRate) / sampleRate_;
+    size_t length = static_cast<size_t>(static_cast<float>(wav.frames) / step);
+    if (length > ConvolutionIr::MAX_LENGTH) length = ConvolutionIr::MAX_LENGTH;
+    for (size_t i = 0; i < length; i++) {
+        float position = static_cast<float>(i) * step;
+        uint32_t frame = static_cast<uint32_t>(position);
+        float fraction = position - static_cast<float>(frame);
+        float a = wav.GetSample(frame, 0);
+        float b = wav.GetSample(frame + 1, 0);
+        g_cabinetLoad[i] = a + (b - a) * fraction;
+    }
+
+    g_cabinetIr.Load(g_cabinetLoad, length, true);
+    left_.Reset();
+    right_.Reset();
+    ready_.store(g_cabinetIr.GetLength() > 0);
+}
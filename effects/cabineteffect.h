@@ -0,0 +1,76 @@
+#ifndef PERSPECTIVE_CABINETEFFECT_H
+#define PERSPECTIVE_CABINETEFFECT_H
+
+#include <atomic>
+#include "../effect.h"
+#include "../presetflash.h"
+#include "convolver.h"
+
+// Cabinet IR region below the amp models: 4 slots of 64KB, each a
+// CabinetSlotHeader followed by a .wav file (mono, or the first channel is used)
+#define CABINET_FLASH_OFFSET 0x006C0000
+#define CABINET_FLASH_SIZE   0x00040000
+#define CABINET_SLOT_SIZE    0x00010000
+
+namespace perspective {
+
+struct CabinetSlotHeader {
+    uint32_t magic;   // CABINET_MAGIC; erased slots read 0xFFFFFFFF
+    uint32_t length;  // Bytes of .wav file after the header
+};
+
+static constexpr uint32_t CABINET_MAGIC = 0x30424143;  // "CAB0"
+
+// Speaker cabinet simulation by convolution with an impulse response (see
+// PartitionedConvolver) - zero latency, up to 200ms of IR at 48kHz (100ms at
+// 96kHz). The IR is read from a QSPI slot when the IR encoder changes,
+// resampled to the pedal's rate if needed and normalised; Length trims the
+// convolved tail to save CPU.
+// Audio passes through dry while a slot is empty or not a usable WAV.
+class CabinetEffect : public Effect {
+public:
+    CabinetEffect();
+    ~CabinetEffect() override;
+
+    // Flash region holding the IR slots. Set before Init.
+    void SetIrFlash(const PresetFlash* flash) { flash_ = flash; }
+
+    void Init(float sampleRate) override;
+    void Process(float* in, float* out, size_t size) override;
+    void ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) override;
+    void Update() override;
+
+    // Watchdog levels convolve half, then a quarter, of the set Length
+    int GetQualityLevels() const override { return 3; }
+    bool UsesLargeBlocks() const override { return true; }
+    float GetDryGain() const override;
+
+    static constexpr int NUM_SLOTS = CABINET_FLASH_SIZE / CABINET_SLOT_SIZE;
+
+private:
+    // Parameters, in table order
+    enum class Param { MIX, LEVEL, LENGTH, IR, COUNT };
+    ParameterValues<Param> params_;
+
+    static constexpr size_t CHUNK_SIZE = 64;
+
+    void LoadSlot(int slot);
+    void ProcessChannel(PartitionedConvolver& convolver, const float* in, float* out, size_t size);
+
+    const PresetFlash* flash_;
+    int slot_;
+
+    PartitionedConvolver left_;
+    PartitionedConvolver right_;
+
+    // The audio callback skips the convolution while the main loop reloads the IR
+    std::atomic<bool> ready_;
+    std::atomic<bool> processing_;
+
+    float level_;
+    float wet_[CHUNK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_CABINETEFFECT_H
@@ -4,8 +4,23 @@
 using namespace perspective;
 using namespace daisysp;
 
+// Mix, Depth, Rate, Delay, Feedback, Wave
+static constexpr ParameterDescriptor CHORUS_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Depth", 0.0f, 1.0f, 0.9f, PotCurve::LIN, KNOB_2_IDX),
+    PotentiometerParameter("Rate", 0.1f, 5.0f, 0.3f, PotCurve::LOG, KNOB_3_IDX),
+    PotentiometerParameter("Delay", 0.1f, 5.0f, 0.75f, PotCurve::LIN, KNOB_4_IDX),
+    PotentiometerParameter("Feedback", -0.95f, 0.95f, 0.0f, PotCurve::LIN, KNOB_5_IDX),
+    EncoderParameter("Wave", 0.0f, 3.0f, 0.0f, 1.0f, ENCODER_1_IDX), // Sine, triangle, smooth random, S&H
+};
+
 ChorusEffect::ChorusEffect() 
-    : Effect("Chorus") {
+    : Effect("Chorus")
+    , lfoL_(-1)
+    , lfoR_(-1)
+    , delaySamples_(1.0f)
+    , lfoAmplitude_(0.0f)
+    , feedback_(0.0f) {
 }
 
 ChorusEffect::~ChorusEffect() {
@@ -14,15 +29,14 @@ ChorusEffect::~ChorusEffect() {
 void ChorusEffect::Init(float sampleRate) {
     sampleRate_ = sampleRate;
     
-    // Initialize chorus modules for stereo
-    chorusL_.Init(sampleRate);
-    chorusR_.Init(sampleRate);
+    // Initialize delay lines and LFOs for stereo
+    delayL_.Init();
+    delayR_.Init();
+    if (lfoL_ < 0) lfoL_ = AllocateLfo();
+    if (lfoR_ < 0) lfoR_ = AllocateLfo(0.25f);
 
-    AddParameter(new PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX));
-    AddParameter(new PotentiometerParameter("Depth", 0.0f, 1.0f, 0.9f, PotCurve::LIN, KNOB_2_IDX));
-    AddParameter(new PotentiometerParameter("Rate", 0.1f, 5.0f, 0.3f, PotCurve::LOG, KNOB_3_IDX));
-    AddParameter(new PotentiometerParameter("Delay", 0.1f, 5.0f, 0.75f, PotCurve::LIN, KNOB_4_IDX));
-    AddParameter(new PotentiometerParameter("Feedback", -0.95f, 0.95f, 0.0f, PotCurve::LIN, KNOB_5_IDX));
+    SetParameterLayout(CHORUS_PARAMETERS, params_);
+    SetTempoParameter(Param::RATE);
     
     // Set default chorus parameters
     Update();
@@ -37,12 +51,14 @@ void ChorusEffect::Process(float* in, float* out, size_t size) {
         return;
     }
     
-    // Get mix parameter (index 0)
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    // Get mix parameter
+    float mix = params_[Param::MIX];
+    
+    const float* lfo = GetLfoBlock(lfoL_);
     
     // Process with wet/dry blend
     for (size_t i = 0; i < size; i++) {
-        float wet = chorusL_.Process(in[i]);
+        float wet = ProcessVoice(delayL_, lfo[i], in[i]);
         out[i] = in[i] * (1.0f - mix) + wet * mix;
     }
 }
@@ -57,13 +73,16 @@ void ChorusEffect::ProcessStereo(float* inL, float* inR, float* outL, float* out
         return;
     }
     
-    // Get mix parameter (index 0)
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    // Get mix parameter
+    float mix = params_[Param::MIX];
+    
+    const float* lfoL = GetLfoBlock(lfoL_);
+    const float* lfoR = GetLfoBlock(lfoR_);
     
     // Process stereo signal with independent chorus for each channel
     for (size_t i = 0; i < size; i++) {
-        float wetL = chorusL_.Process(inL[i]);
-        float wetR = chorusR_.Process(inR[i]);
+        float wetL = ProcessVoice(delayL_, lfoL[i], inL[i]);
+        float wetR = ProcessVoice(delayR_, lfoR[i], inR[i]);
         
         outL[i] = inL[i] * (1.0f - mix) + wetL * mix;
         outR[i] = inR[i] * (1.0f - mix) + wetR * mix;
@@ -72,27 +91,29 @@ void ChorusEffect::ProcessStereo(float* inL, float* inR, float* outL, float* out
 
 void ChorusEffect::Update() {
     // Update chorus parameters from effect parameters
-    if (parameters_.size() >= 5) {
-        // Mix parameter (index 0) - handled in Process
-        
-        // Depth parameter (index 1)
-        float depth = parameters_[1]->GetValue();
-        chorusL_.SetLfoDepth(depth);
-        chorusR_.SetLfoDepth(depth);
-        
-        // Rate parameter (index 2)
-        float rate = parameters_[2]->GetValue();
-        chorusL_.SetLfoFreq(rate);
-        chorusR_.SetLfoFreq(rate * 1.1f);  // Slightly different for stereo width
-        
-        // Delay parameter (index 3)
-        float delay = parameters_[3]->GetValue();
-        chorusL_.SetDelay(delay);
-        chorusR_.SetDelay(delay);
-        
-        // Feedback parameter (index 4)
-        float feedback = parameters_[4]->GetValue();
-        chorusL_.SetFeedback(feedback);
-        chorusR_.SetFeedback(feedback);
-    }
+    // Mix parameter - handled in Process
+    
+    // Delay parameter - 0.1ms plus up to 7.9ms per unit
+    delaySamples_ = (0.1f + params_[Param::DELAY] * 7.9f) * 0.001f * sampleRate_;
+    delaySamples_ = fclamp(delaySamples_, 1.0f, static_cast<float>(MAX_DELAY - 2));
+    
+    // Depth parameter - LFO swing as a fraction of the delay
+    lfoAmplitude_ = fclamp(params_[Param::DEPTH], 0.0f, 0.93f) * delaySamples_;
+    
+    // Rate and Wave parameters - locked to the beat while the rate follows tap tempo
+    float rate = params_[Param::RATE];
+    LfoWave wave = LfoWaveFromValue(params_[Param::WAVE]);
+    bool locked = IsTempoLocked();
+    SetLfo(lfoL_, wave, rate, locked);
+    SetLfo(lfoR_, wave, rate, locked);
+    
+    // Feedback parameter
+    feedback_ = params_[Param::FEEDBACK];
+}
+
+float ChorusEffect::ProcessVoice(DelayLine<float, MAX_DELAY>& delay, float lfo, float in) {
+    delay.SetDelay(delaySamples_ + lfo * lfoAmplitude_);
+    float delayed = delay.Read();
+    delay.Write(in + delayed * feedback_);
+    return (in + delayed) * 0.5f;
 }
@@ -19,8 +19,23 @@ public:
     void Update() override;
 
 private:
-    Chorus chorusL_;
-    Chorus chorusR_;
+    // Parameters, in table order
+    enum class Param { MIX, DEPTH, RATE, DELAY, FEEDBACK, WAVE, COUNT };
+    ParameterValues<Param> params_;
+
+    // Modulated delay per channel; the LFOs lock to the transport beat when the
+    // rate follows tap tempo (right channel a quarter cycle ahead for width)
+    static constexpr size_t MAX_DELAY = 2400;  // 50ms at 48kHz
+    DelayLine<float, MAX_DELAY> delayL_;
+    DelayLine<float, MAX_DELAY> delayR_;
+    int lfoL_;  // LfoBank voices
+    int lfoR_;
+
+    float delaySamples_;
+    float lfoAmplitude_;  // In samples
+    float feedback_;
+
+    float ProcessVoice(DelayLine<float, MAX_DELAY>& delay, float lfo, float in);
 };
 
 } // namespace perspective
@@ -0,0 +1,163 @@
+#include "convolver.h"
+
+#include <math.h>
+#include <string.h>
+
+using namespace perspective;
+
+ConvolutionIr::ConvolutionIr()
+    : memory_(nullptr),
+      length_(0),
+      partitions_(0),
+      active_(0) {
+    memset(head_, 0, sizeof(head_));
+}
+
+void ConvolutionIr::Init(Memory* memory) {
+    memory_ = memory;
+    fft_.Init(FFT_SIZE);
+    Clear();
+}
+
+void ConvolutionIr::Clear() {
+    memset(head_, 0, sizeof(head_));
+    length_ = 0;
+    partitions_ = 0;
+    active_ = 0;
+}
+
+void ConvolutionIr::Load(const float* ir, size_t length, bool normalize) {
+    Clear();
+    if (!memory_ || !ir || length == 0) return;
+    if (length > MAX_LENGTH) length = MAX_LENGTH;
+
+    float scale = 1.0f;
+    if (normalize) {
+        float energy = 0.0f;
+        for (size_t i = 0; i < length; i++) {
+            energy += ir[i] * ir[i];
+        }
+        if (energy > 0.0f) scale = 1.0f / sqrtf(energy);
+    }
+
+    size_t headLength = length < PARTITION_SIZE ? length : PARTITION_SIZE;
+    for (size_t i = 0; i < headLength; i++) {
+        head_[PARTITION_SIZE - 1 - i] = ir[i] * scale;
+    }
+
+    // Each tail partition zero-padded to the FFT size
+    partitions_ = (length - headLength + PARTITION_SIZE - 1) / PARTITION_SIZE;
+    for (size_t p = 0; p < partitions_; p++) {
+        size_t start = (p + 1) * PARTITION_SIZE;
+        for (size_t i = 0; i < FFT_SIZE; i++) {
+            scratch_[i] = i < PARTITION_SIZE && start + i < length ? ir[start + i] * scale : 0.0f;
+        }
+        fft_.Forward(scratch_, memory_->spectra[p]);
+    }
+
+    length_ = length;
+    active_ = partitions_;
+}
+
+void ConvolutionIr::SetActiveLength(size_t samples) {
+    size_t tail = samples > PARTITION_SIZE ? samples - PARTITION_SIZE : 0;
+    size_t partitions = (tail + PARTITION_SIZE - 1) / PARTITION_SIZE;
+    active_ = partitions < partitions_ ? partitions : partitions_;
+}
+
+PartitionedConvolver::PartitionedConvolver()
+    : ir_(nullptr),
+      history_(nullptr),
+      fill_(0),
+      newest_(0),
+      headPos_(0) {
+}
+
+void PartitionedConvolver::Init(const ConvolutionIr* ir, History* history) {
+    ir_ = ir;
+    history_ = history;
+    fft_.Init(N);
+    Reset();
+}
+
+void PartitionedConvolver::Reset() {
+    if (history_) {
+        memset(history_, 0, sizeof(History));
+    }
+    memset(headHistory_, 0, sizeof(headHistory_));
+    memset(input_, 0, sizeof(input_));
+    memset(tail_, 0, sizeof(tail_));
+    fill_ = 0;
+    newest_ = 0;
+    headPos_ = 0;
+}
+
+void PartitionedConvolver::Process(const float* in, float* out, size_t size) {
+    if (!ir_ || !history_) {
+        memset(out, 0, size * sizeof(float));
+        return;
+    }
+
+    const float* head = ir_->GetHead();
+    for (size_t i = 0; i < size; i++) {
+        float x = in[i];
+
+        // Direct-form head over the last B inputs, oldest first
+        headHistory_[headPos_] = x;
+        headHistory_[headPos_ + B] = x;
+        const float* window = headHistory_ + headPos_ + 1;
+        if (++headPos_ >= B) headPos_ = 0;
+
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        for (size_t k = 0; k < B; k += 4) {
+            s0 += head[k] * window[k];
+            s1 += head[k + 1] * window[k + 1];
+            s2 += head[k + 2] * window[k + 2];
+            s3 += head[k + 3] * window[k + 3];
+        }
+
+        out[i] = (s0 + s1) + (s2 + s3) + tail_[fill_];
+
+        input_[B + fill_] = x;
+        if (++fill_ == B) {
+            ProcessPartition();
+            fill_ = 0;
+        }
+    }
+}
+
+void PartitionedConvolver::ProcessPartition() {
+    // The newest partition's spectrum goes into the frequency delay line
+    newest_ = newest_ + 1 < ConvolutionIr::MAX_PARTITIONS ? newest_ + 1 : 0;
+    memcpy(scratch_, input_, sizeof(input_));
+    fft_.Forward(scratch_, history_->spectra[newest_]);
+    memcpy(input_, input_ + B, B * sizeof(float));
+
+    // Tail for the next partition: sum of X[j - m] * H[m + 1]
+    memset(sum_, 0, sizeof(sum_));
+    size_t partitions = ir_->GetActivePartitions();
+    size_t slot = newest_;
+    for (size_t m = 0; m < partitions; m++) {
+        const float* x = history_->spectra[slot];
+        const float* h = ir_->GetSpectrum(m);
+
+        // DC and Nyquist are real, then complex bins
+        sum_[0] += x[0] * h[0];
+        sum_[1] += x[1] * h[1];
+        for (size_t k = 2; k < N; k += 2) {
+            sum_[k] += x[k] * h[k] - x[k + 1] * h[k + 1];
+            sum_[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+        }
+
+        slot = slot > 0 ? slot - 1 : ConvolutionIr::MAX_PARTITIONS - 1;
+    }
+
+    if (partitions == 0) {
+        memset(tail_, 0, sizeof(tail_));
+        return;
+    }
+
+    // Overlap-save: the second half of the inverse is valid
+    fft_.Inverse(sum_, scratch_);
+    memcpy(tail_, scratch_ + B, B * sizeof(float));
+}
@@ -0,0 +1,94 @@
+#ifndef PERSPECTIVE_CONVOLVER_H
+#define PERSPECTIVE_CONVOLVER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "realfft.h"
+
+namespace perspective {
+
+// An impulse response prepared for PartitionedConvolver: the first partition
+// as time-domain taps for the direct-form head, and the rest as the spectra
+// of zero-padded partitions. Spectrum memory is supplied by the caller
+// (SDRAM on the pedal).
+class ConvolutionIr {
+public:
+    static constexpr size_t PARTITION_SIZE = 64;
+    static constexpr size_t FFT_SIZE = 2 * PARTITION_SIZE;
+    static constexpr size_t MAX_LENGTH = 9600 + PARTITION_SIZE;  // 200ms at 48kHz after the head
+    static constexpr size_t MAX_PARTITIONS = (MAX_LENGTH - PARTITION_SIZE) / PARTITION_SIZE;
+
+    struct Memory {
+        float spectra[MAX_PARTITIONS][FFT_SIZE];
+    };
+
+    ConvolutionIr();
+
+    void Init(Memory* memory);
+
+    // Transforms the IR (truncated to MAX_LENGTH). With normalize, the IR is
+    // scaled to unit energy so IRs of different loudness sit at similar levels.
+    void Load(const float* ir, size_t length, bool normalize);
+    void Clear();
+
+    // Caps the IR length actually convolved, trading the tail for CPU;
+    // rounded up to whole partitions
+    void SetActiveLength(size_t samples);
+
+    inline size_t GetLength() const { return length_; }
+    inline size_t GetActivePartitions() const { return active_; }
+    inline const float* GetHead() const { return head_; }
+    inline const float* GetSpectrum(size_t partition) const { return memory_->spectra[partition]; }
+
+private:
+    Memory* memory_;
+    RealFft fft_;
+    size_t length_;
+    size_t partitions_;   // Tail partitions holding the IR
+    size_t active_;       // Tail partitions convolved
+    float head_[PARTITION_SIZE];  // First taps, reversed for the dot product
+    float scratch_[FFT_SIZE];
+};
+
+// Zero-latency uniformly partitioned convolution (UPOLS with a direct-form
+// head). The first partition runs as a per-sample FIR; every PARTITION_SIZE
+// samples the last two input partitions are transformed into the frequency
+// delay line and multiplied against the IR spectra, giving the tail's output
+// for the next partition. Works for any audio block size; the FFT work lands
+// on the sample that completes a partition.
+class PartitionedConvolver {
+public:
+    struct History {
+        float spectra[ConvolutionIr::MAX_PARTITIONS][ConvolutionIr::FFT_SIZE];
+    };
+
+    PartitionedConvolver();
+
+    void Init(const ConvolutionIr* ir, History* history);
+    void Reset();
+
+    void Process(const float* in, float* out, size_t size);
+
+private:
+    static constexpr size_t B = ConvolutionIr::PARTITION_SIZE;
+    static constexpr size_t N = ConvolutionIr::FFT_SIZE;
+
+    void ProcessPartition();
+
+    const ConvolutionIr* ir_;
+    History* history_;
+    RealFft fft_;
+
+    size_t fill_;         // Samples of the current partition so far
+    size_t newest_;       // Frequency delay line slot holding the latest partition
+    float headHistory_[2 * B];  // Duplicated, as in HalfbandFilter
+    size_t headPos_;
+    float input_[N];      // Previous partition then the current one
+    float tail_[B];       // Tail output for the current partition
+    float scratch_[N];
+    float sum_[N];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_CONVOLVER_H
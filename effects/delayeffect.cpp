@@ -1,13 +1,51 @@
 #include "delayeffect.h"
 #include "../controls.h"
+#include "daisy_seed.h"
+
+#include <math.h>
 
 using namespace perspective;
 using namespace daisysp;
 
+// Mix, Feedback, ModRate, ModDepth, Subdivision, Time/Tempo, TempoToggle, ModWave, Taps, TapPattern, Interpolation,
+// Cross, PingPong, Width, LowCut, HighCut, Saturation
+static constexpr ParameterDescriptor DELAY_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Feedback", 0.0f, 0.95f, 0.5f, PotCurve::LIN, KNOB_2_IDX),
+    PotentiometerParameter("ModRate", 0.0f, 10.0f, 0.5f, PotCurve::LOG, KNOB_3_IDX),
+    PotentiometerParameter("ModDepth", 0.0f, 50.0f, 0.0f, PotCurve::LIN, KNOB_4_IDX),
+    PotentiometerParameter("Subdivision", 0.0f, 6.0f, 3.0f, PotCurve::LIN, KNOB_5_IDX), // 7 subdivisions: 1-6 and 8 sixteenths, default to quarter note (4 sixteenths)
+    EncoderParameter("Time", 0.001f, 2.0f, 0.5f, 0.005f, ENCODER_1_IDX),
+    ToggleParameter("TempoMode", false, ENCODER_2_BUTTON_IDX), // Encoder 2 switch
+    EncoderParameter("ModWave", 0.0f, 3.0f, 0.0f, 1.0f, ENCODER_2_IDX), // Sine, triangle, smooth random, S&H
+    PotentiometerParameter("Taps", 1.0f, 8.0f, 1.0f, PotCurve::LIN, KNOB_6_IDX), // 1 = modulated stereo delay, 2-8 = multi-tap
+    EncoderParameter("TapPattern", 0.0f, 3.0f, 0.0f, 1.0f), // Even, alternate, sweep, swell; no panel control (MIDI CC or preset)
+    EncoderParameter("Interpolation", 0.0f, 3.0f, 3.0f, 1.0f), // Linear, Lagrange, allpass, Hermite; no panel control
+    PotentiometerParameter("Cross", 0.0f, 1.0f, 0.0f), // Feedback matrix: 0 = independent lines, 1 = swap each repeat
+    ToggleParameter("PingPong", false, ENCODER_1_BUTTON_IDX), // Encoder 1 switch
+    PotentiometerParameter("Width", 0.0f, 1.0f, 1.0f),
+    PotentiometerParameter("LowCut", 20.0f, 1000.0f, 20.0f, PotCurve::LOG),       // Hz, in the feedback path
+    PotentiometerParameter("HighCut", 1000.0f, 20000.0f, 20000.0f, PotCurve::LOG), // Hz, in the feedback path
+    ToggleParameter("Saturation", false), // Tape-style soft clip in the feedback path
+};
+
+// Modulated stereo delay lines: 2^18 samples each, room for 2s plus 50ms of ModDepth at 96kHz
+static constexpr size_t DELAY_BUFFER_SIZE = 1 << 18;
+static float DSY_SDRAM_BSS g_delayBuffer[2][DELAY_BUFFER_SIZE];
+
+// Shared multi-tap buffer: 2^18 samples, 2.7s at 96kHz
+static constexpr size_t MULTITAP_BUFFER_SIZE = 1 << 18;
+static float DSY_SDRAM_BSS g_multiTapBuffer[MULTITAP_BUFFER_SIZE];
+static_assert(MultiTapDelay::MAX_BLOCK_SIZE <= FractionalDelay::MAX_BLOCK_SIZE, "multi-tap chunks share the wet buffers");
+
 DelayEffect::DelayEffect() 
     : Effect("Delay")
+    , width_(1.0f)
+    , lfoL_(-1)
+    , lfoR_(-1)
     , baseDelayTime_(0.5f)
     , effectiveDelayTime_(0.5f)
+    , taps_(1)
     , tempoMode_(false) {
 }
 
@@ -18,33 +56,70 @@ void DelayEffect::Init(float sampleRate) {
     sampleRate_ = sampleRate;
     
     // Initialize delay lines for stereo
-    delayL_.Init();
-    delayR_.Init();
-    
-    // Initialize modulation LFOs
-    lfoL_.Init(sampleRate);
-    lfoL_.SetWaveform(Oscillator::WAVE_SIN);
-    lfoL_.SetAmp(1.0f);
-    lfoL_.SetFreq(0.5f);
-    
-    lfoR_.Init(sampleRate);
-    lfoR_.SetWaveform(Oscillator::WAVE_SIN);
-    lfoR_.SetAmp(1.0f);
-    lfoR_.SetFreq(0.5f);
-    
-    // Add parameters: Mix, Feedback, ModRate, ModDepth, Subdivision, Time/Tempo, TempoToggle
-    AddParameter(new PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX));
-    AddParameter(new PotentiometerParameter("Feedback", 0.0f, 0.95f, 0.5f, PotCurve::LIN, KNOB_2_IDX));
-    AddParameter(new PotentiometerParameter("ModRate", 0.0f, 10.0f, 0.5f, PotCurve::LOG, KNOB_3_IDX));
-    AddParameter(new PotentiometerParameter("ModDepth", 0.0f, 50.0f, 0.0f, PotCurve::LIN, KNOB_4_IDX));
-    AddParameter(new PotentiometerParameter("Subdivision", 0.0f, 6.0f, 3.0f, PotCurve::LIN, KNOB_5_IDX)); // 7 subdivisions: 1-6 and 8 sixteenths, default to quarter note (4 sixteenths)
-    AddParameter(new EncoderParameter("Time", 0.001f, 2.0f, 0.5f, 0.005f, ENCODER_1_IDX));
-    AddParameter(new ToggleParameter("TempoMode", false, ENCODER_2_BUTTON_IDX)); // Encoder 2 switch
+    delayL_.Init(g_delayBuffer[0], DELAY_BUFFER_SIZE);
+    delayR_.Init(g_delayBuffer[1], DELAY_BUFFER_SIZE);
+    feedbackMatrix_.Init(sampleRate);
+
+    // SDRAM is not zeroed at startup; Init clears it
+    multiTap_.Init(g_multiTapBuffer, MULTITAP_BUFFER_SIZE);
+    
+    // Modulation LFOs - right channel 90 degrees ahead for stereo width
+    if (lfoL_ < 0) lfoL_ = AllocateLfo();
+    if (lfoR_ < 0) lfoR_ = AllocateLfo(0.25f);
+    
+    SetParameterLayout(DELAY_PARAMETERS, params_);
     
     // Set default delay parameters
     Update();
 }
 
+void DelayEffect::PrepareChunk(size_t offset, size_t size) {
+    float feedback = params_[Param::FEEDBACK];
+    float modDepth = params_[Param::MOD_DEPTH];
+
+    // Feedback can be swept per sample by the expression pedal
+    const float* feedbackMod = GetModulation(Param::FEEDBACK);
+    
+    const float* lfoL = GetLfoBlock(lfoL_);
+    const float* lfoR = GetLfoBlock(lfoR_);
+
+    // Apply modulation to delay times (stereo LFOs for wider effect)
+    for (size_t i = 0; i < size; i++) {
+        float modulatedTimeL = effectiveDelayTime_ + (lfoL[offset + i] * modDepth * 0.001f); // modDepth in ms
+        float modulatedTimeR = effectiveDelayTime_ + (lfoR[offset + i] * modDepth * 0.001f);
+        delaySamplesL_[i] = sampleRate_ * fclamp(modulatedTimeL, 0.001f, 2.0f);
+        delaySamplesR_[i] = sampleRate_ * fclamp(modulatedTimeR, 0.001f, 2.0f);
+        feedback_[i] = feedbackMod ? feedbackMod[offset + i] : feedback;
+    }
+}
+
+void DelayEffect::ProcessLines(const float* inL, const float* inR, size_t size) {
+    // Both lines advance by the same run, so each write can take both repeats
+    size_t start = 0;
+    while (start < size) {
+        size_t run = FractionalDelay::GetRun(delaySamplesL_ + start, size - start);
+        run = FractionalDelay::GetRun(delaySamplesR_ + start, run);
+
+        delayL_.Read(delaySamplesL_ + start, wetL_ + start, run);
+        delayR_.Read(delaySamplesR_ + start, wetR_ + start, run);
+        feedbackMatrix_.Process(inL + start, inR + start, wetL_ + start, wetR_ + start, feedback_ + start, writeL_,
+                                writeR_, run);
+        delayL_.Write(writeL_, run);
+        delayR_.Write(writeR_, run);
+        start += run;
+    }
+
+    // Width - side level of the wet signal
+    if (width_ < 1.0f) {
+        for (size_t i = 0; i < size; i++) {
+            float mid = 0.5f * (wetL_[i] + wetR_[i]);
+            float side = 0.5f * (wetL_[i] - wetR_[i]) * width_;
+            wetL_[i] = mid + side;
+            wetR_[i] = mid - side;
+        }
+    }
+}
+
 void DelayEffect::Process(float* in, float* out, size_t size) {
     if (!enabled_) {
         // Bypass - pass through dry signal
@@ -53,28 +128,26 @@ void DelayEffect::Process(float* in, float* out, size_t size) {
         }
         return;
     }
+
+    if (taps_ > 1) {
+        // Multi-tap - both pan halves summed back to mono
+        ProcessMultiTap(in, in, out, out, size);
+        return;
+    }
     
-    // Get parameters
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
-    float feedback = parameters_.size() > 1 ? parameters_[1]->GetValue() : 0.5f;
-    float modDepth = parameters_.size() > 3 ? parameters_[3]->GetValue() : 0.0f;
-    
-    // Calculate effective delay time based on mode
-    float effectiveDelayTime = tempoMode_ ? CalculateDelayTimeFromTempo() : baseDelayTime_;
-    
-    // Process with wet/dry blend and modulation
-    for (size_t i = 0; i < size; i++) {
-        // Apply modulation to delay time
-        float lfoValue = lfoL_.Process();
-        float modulatedTime = effectiveDelayTime + (lfoValue * modDepth * 0.001f); // modDepth in ms
-        modulatedTime = fclamp(modulatedTime, 0.001f, 2.0f);
-        float delaySamples = sampleRate_ * modulatedTime;
-        delayL_.SetDelay(delaySamples);
-        
-        float delayed = delayL_.Read();
-        delayL_.Write(in[i] + delayed * feedback);
-        
-        out[i] = in[i] * (1.0f - mix) + delayed * mix;
+    float mix = params_[Param::MIX];
+    const float* mixMod = GetModulation(Param::MIX);
+
+    // Both lines fed the mono input and summed back down
+    for (size_t offset = 0; offset < size; offset += FractionalDelay::MAX_BLOCK_SIZE) {
+        size_t chunk = size - offset < FractionalDelay::MAX_BLOCK_SIZE ? size - offset : FractionalDelay::MAX_BLOCK_SIZE;
+        PrepareChunk(offset, chunk);
+        ProcessLines(in + offset, in + offset, chunk);
+
+        for (size_t i = 0; i < chunk; i++) {
+            if (mixMod) mix = mixMod[offset + i];
+            out[offset + i] = in[offset + i] * (1.0f - mix) + 0.5f * (wetL_[i] + wetR_[i]) * mix;
+        }
     }
 }
 
@@ -87,67 +160,127 @@ void DelayEffect::ProcessStereo(float* inL, float* inR, float* outL, float* outR
         }
         return;
     }
+
+    if (taps_ > 1) {
+        ProcessMultiTap(inL, inR, outL, outR, size);
+        return;
+    }
     
-    // Get parameters
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
-    float feedback = parameters_.size() > 1 ? parameters_[1]->GetValue() : 0.5f;
-    float modDepth = parameters_.size() > 3 ? parameters_[3]->GetValue() : 0.0f;
-    
-    // Use cached effective delay time (updated in Update())
-    float effectiveDelayTime = effectiveDelayTime_;
+    // Mix can be swept per sample by the expression pedal
+    float mix = params_[Param::MIX];
+    const float* mixMod = GetModulation(Param::MIX);
     
-    // Process stereo signal with independent delays and modulation
-    for (size_t i = 0; i < size; i++) {
-        // Apply modulation to delay times (stereo LFOs for wider effect)
-        float lfoValueL = lfoL_.Process();
-        float lfoValueR = lfoR_.Process();
-        
-        float modulatedTimeL = effectiveDelayTime + (lfoValueL * modDepth * 0.001f); // modDepth in ms
-        float modulatedTimeR = effectiveDelayTime + (lfoValueR * modDepth * 0.001f);
-        modulatedTimeL = fclamp(modulatedTimeL, 0.001f, 2.0f);
-        modulatedTimeR = fclamp(modulatedTimeR, 0.001f, 2.0f);
-        
-        delayL_.SetDelay(sampleRate_ * modulatedTimeL);
-        delayR_.SetDelay(sampleRate_ * modulatedTimeR);
-        
-        float delayedL = delayL_.Read();
-        float delayedR = delayR_.Read();
-        
-        delayL_.Write(inL[i] + delayedL * feedback);
-        delayR_.Write(inR[i] + delayedR * feedback);
-        
-        outL[i] = inL[i] * (1.0f - mix) + delayedL * mix;
-        outR[i] = inR[i] * (1.0f - mix) + delayedR * mix;
+    for (size_t offset = 0; offset < size; offset += FractionalDelay::MAX_BLOCK_SIZE) {
+        size_t chunk = size - offset < FractionalDelay::MAX_BLOCK_SIZE ? size - offset : FractionalDelay::MAX_BLOCK_SIZE;
+        PrepareChunk(offset, chunk);
+        ProcessLines(inL + offset, inR + offset, chunk);
+
+        for (size_t i = 0; i < chunk; i++) {
+            if (mixMod) mix = mixMod[offset + i];
+            outL[offset + i] = inL[offset + i] * (1.0f - mix) + wetL_[i] * mix;
+            outR[offset + i] = inR[offset + i] * (1.0f - mix) + wetR_[i] * mix;
+        }
     }
 }
 
 void DelayEffect::Update() {
     // Update delay parameters from effect parameters
-    if (parameters_.size() >= 7) {
-        // Mix parameter (index 0) - handled in Process
-        // Feedback parameter (index 1) - handled in Process
-        
-        // ModRate parameter (index 2)
-        float modRate = parameters_[2]->GetValue();
-        lfoL_.SetFreq(modRate);
-        // Offset right channel LFO by 90 degrees for stereo width
-        lfoR_.SetFreq(modRate);
-        lfoR_.PhaseAdd(0.25f); // 90 degree offset
-        
-        // ModDepth parameter (index 3) - handled in Process
-        // Subdivision parameter (index 4) - handled in CalculateDelayTimeFromTempo
-        
-        // Time parameter (index 5) - in seconds or BPM depending on mode
-        baseDelayTime_ = parameters_[5]->GetValue();
-        
-        // TempoMode toggle (index 6)
-        if (parameters_[6]->GetType() == ParameterType::TOGGLE) {
-            ToggleParameter* toggleParam = static_cast<ToggleParameter*>(parameters_[6]);
-            tempoMode_ = toggleParam->GetState();
+    // Mix and Feedback - handled in Process
+    
+    // ModRate and ModWave parameters
+    float modRate = params_[Param::MOD_RATE];
+    LfoWave modWave = LfoWaveFromValue(params_[Param::MOD_WAVE]);
+    SetLfo(lfoL_, modWave, modRate, false);
+    SetLfo(lfoR_, modWave, modRate, false);
+    
+    // ModDepth parameter - handled in Process
+    // Subdivision parameter - handled in CalculateDelayTimeFromTempo
+    
+    // Time parameter - in seconds or BPM depending on mode
+    baseDelayTime_ = params_[Param::TIME];
+    
+    // TempoMode toggle
+    tempoMode_ = params_.IsOn(Param::TEMPO_MODE);
+    
+    // Calculate effective delay time based on mode
+    effectiveDelayTime_ = tempoMode_ ? CalculateDelayTimeFromTempo() : baseDelayTime_;
+
+    // Interpolation parameter - kernel for the modulated delay reads
+    DelayInterpolation interpolation = static_cast<DelayInterpolation>(static_cast<int>(params_[Param::INTERPOLATION] + 0.5f));
+    if (quality_ > 0) interpolation = DelayInterpolation::LINEAR;
+    delayL_.SetInterpolation(interpolation);
+    delayR_.SetInterpolation(interpolation);
+
+    // Feedback matrix and tone parameters
+    feedbackMatrix_.SetCross(params_[Param::CROSS]);
+    feedbackMatrix_.SetPingPong(params_.IsOn(Param::PING_PONG));
+    feedbackMatrix_.SetFilters(params_[Param::LOW_CUT], params_[Param::HIGH_CUT]);
+    feedbackMatrix_.SetSaturation(params_.IsOn(Param::SATURATION));
+    width_ = params_[Param::WIDTH];
+
+    // Taps and TapPattern parameters
+    UpdateTaps();
+}
+
+void DelayEffect::UpdateTaps() {
+    int taps = static_cast<int>(params_[Param::TAPS] + 0.5f);
+    if (quality_ > 0 && taps > 4) taps = 4;
+    int pattern = static_cast<int>(params_[Param::TAP_PATTERN] + 0.5f);
+
+    // Tap k sits at k + 1 delay times (a subdivision each in tempo mode); taps
+    // past the end of the buffer are dropped
+    float spacing = effectiveDelayTime_ * sampleRate_;
+    int fit = static_cast<int>(static_cast<float>(multiTap_.GetMaxDelay()) / spacing);
+    if (taps > fit) taps = fit > 1 ? fit : 1;
+
+    for (int k = 0; k < taps; k++) {
+        float position = taps > 1 ? static_cast<float>(k) / static_cast<float>(taps - 1) : 0.0f;
+        float decay = 1.0f - 0.75f * position;
+        float alternate = (k & 1) ? 0.8f : -0.8f;
+
+        float gain, pan;
+        switch (pattern) {
+            case 1: gain = decay; pan = alternate; break;                     // Alternate
+            case 2: gain = decay; pan = 2.0f * position - 1.0f; break;        // Sweep left to right
+            case 3: gain = 0.25f + 0.75f * position; pan = alternate; break;  // Swell
+            default: gain = decay; pan = 0.0f; break;                         // Even
+        }
+        multiTap_.SetTap(k, spacing * static_cast<float>(k + 1), gain, pan);
+    }
+    multiTap_.SetTapCount(taps);
+
+    // Moving into multi-tap mode starts from silence rather than stale audio
+    if (taps > 1 && taps_ <= 1) {
+        multiTap_.Clear();
+    }
+    taps_ = taps;
+}
+
+void DelayEffect::ProcessMultiTap(const float* inL, const float* inR, float* outL, float* outR, size_t size) {
+    float mix = params_[Param::MIX];
+    float feedback = params_[Param::FEEDBACK];
+    const float* mixMod = GetModulation(Param::MIX);
+    const float* feedbackMod = GetModulation(Param::FEEDBACK);
+    bool mono = outL == outR;
+
+    for (size_t offset = 0; offset < size; offset += MultiTapDelay::MAX_BLOCK_SIZE) {
+        size_t chunk = size - offset < MultiTapDelay::MAX_BLOCK_SIZE ? size - offset : MultiTapDelay::MAX_BLOCK_SIZE;
+
+        // Feedback is applied per chunk; the pedal follows at block rate here
+        multiTap_.SetFeedback(feedbackMod ? feedbackMod[offset + chunk - 1] : feedback);
+        multiTap_.Process(inL + offset, inR + offset, wetL_, wetR_, chunk);
+
+        for (size_t i = 0; i < chunk; i++) {
+            if (mixMod) mix = mixMod[offset + i];
+            float dryL = inL[offset + i];
+            float dryR = inR[offset + i];
+            if (mono) {
+                outL[offset + i] = dryL * (1.0f - mix) + 0.70710678f * (wetL_[i] + wetR_[i]) * mix;
+            } else {
+                outL[offset + i] = dryL * (1.0f - mix) + wetL_[i] * mix;
+                outR[offset + i] = dryR * (1.0f - mix) + wetR_[i] * mix;
+            }
         }
-        
-        // Calculate effective delay time based on mode
-        effectiveDelayTime_ = tempoMode_ ? CalculateDelayTimeFromTempo() : baseDelayTime_;
     }
 }
 
@@ -173,12 +306,8 @@ float DelayEffect::CalculateDelayTimeFromTempo() {
 }
 
 float DelayEffect::GetSubdivisionMultiplier() const {
-    if (parameters_.size() <= 4 || parameters_[4]->GetType() != ParameterType::POTENTIOMETER) {
-        return SUBDIVISION_4_16TH; // Default to quarter note (4 sixteenths)
-    }
-    
-    PotentiometerParameter* subdivParam = static_cast<PotentiometerParameter*>(parameters_[4]);
-    int subdivIndex = subdivParam->GetValueAsInt(6); // 0-6 for 7 subdivisions
+    // The Subdivision range is 0-6, so rounding gives the index for 7 subdivisions
+    int subdivIndex = static_cast<int>(params_[Param::SUBDIVISION] + 0.5f);
     
     // Map index to subdivision multiplier (in sixteenths)
     switch (subdivIndex) {
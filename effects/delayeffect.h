@@ -2,6 +2,9 @@
 #define PERSPECTIVE_DELAYEFFECT_H
 
 #include "../effect.h"
+#include "feedbackmatrix.h"
+#include "fractionaldelay.h"
+#include "multitapdelay.h"
 #include "daisysp.h"
 
 using namespace daisysp;
@@ -18,18 +21,50 @@ public:
     void ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) override;
     void Update() override;
 
+    // Watchdog level 1 reads the lines with linear interpolation and caps the taps at 4
+    int GetQualityLevels() const override { return 2; }
+
 private:
-    static constexpr size_t MAX_DELAY = 48000 * 2; // 2 seconds max delay at 48kHz
-    
-    DelayLine<float, MAX_DELAY> delayL_;
-    DelayLine<float, MAX_DELAY> delayR_;
+    // Parameters, in table order
+    enum class Param { MIX, FEEDBACK, MOD_RATE, MOD_DEPTH, SUBDIVISION, TIME, TEMPO_MODE, MOD_WAVE, TAPS, TAP_PATTERN, INTERPOLATION,
+                       CROSS, PING_PONG, WIDTH, LOW_CUT, HIGH_CUT, SATURATION, COUNT };
+    ParameterValues<Param> params_;
+
+    // Fractional delay lines on SDRAM buffers, read a block at a time
+    FractionalDelay delayL_;
+    FractionalDelay delayR_;
+    float delaySamplesL_[FractionalDelay::MAX_BLOCK_SIZE];
+    float delaySamplesR_[FractionalDelay::MAX_BLOCK_SIZE];
+    float feedback_[FractionalDelay::MAX_BLOCK_SIZE];
+
+    // Repeats are tone shaped and cross-mixed between the lines before they
+    // are written back (ping-pong, cross-feed); Width narrows the wet output
+    FeedbackMatrix feedbackMatrix_;
+    float width_;
+    float writeL_[FractionalDelay::MAX_BLOCK_SIZE];
+    float writeR_[FractionalDelay::MAX_BLOCK_SIZE];
+
+    // Delays and feedback for a chunk of the block, then the lines over it into wetL_/wetR_
+    void PrepareChunk(size_t offset, size_t size);
+    void ProcessLines(const float* inL, const float* inR, size_t size);
     
-    // Modulation
-    Oscillator lfoL_;
-    Oscillator lfoR_;
+    // Modulation - LfoBank voices, right channel a quarter cycle ahead
+    int lfoL_;
+    int lfoR_;
     float baseDelayTime_;
     float effectiveDelayTime_;  // Cached effective delay time (updated in Update())
     
+    // Multi-tap mode (Taps above 1) - taps at multiples of the delay time from
+    // one shared SDRAM buffer, instead of the modulated stereo delay lines
+    MultiTapDelay multiTap_;
+    int taps_;
+    void UpdateTaps();
+    void ProcessMultiTap(const float* inL, const float* inR, float* outL, float* outR, size_t size);
+
+    // Wet chunk, from either the delay lines or the multi-tap engine
+    float wetL_[FractionalDelay::MAX_BLOCK_SIZE];
+    float wetR_[FractionalDelay::MAX_BLOCK_SIZE];
+
     // Tempo mode
     bool tempoMode_;  // false = Time mode (seconds), true = Tempo mode (BPM-based)
     float CalculateDelayTimeFromTempo();
@@ -3,14 +3,20 @@
 
 #include <vector>
 #include "../effect.h"
+#include "../presetflash.h"
+#include "../streamreader.h"
 
 // Include all effect types
+#include "ampmodeleffect.h"
 #include "autowaheffect.h"
 #include "bandpasseffect.h"
+#include "cabineteffect.h"
 #include "choruseffect.h"
 #include "delayeffect.h"
 #include "flangereffect.h"
+#include "loopereffect.h"
 #include "phasereffect.h"
+#include "reverbeffect.h"
 #include "tunereffect.h"
 #include "waheffect.h"
 
@@ -20,47 +26,87 @@ namespace perspective {
  * @brief Populates a vector with all available effects
  * @param effects Pointer to vector to populate with effect instances
  * @param sampleRate Sample rate to initialize effects with
+ * @param lfoBank Shared LFO bank the effects allocate their modulation voices from
+ * @param modelFlash QSPI region holding the amp model slots
+ * @param cabinetFlash QSPI region holding the cabinet IR slots
+ * @param backingTrack SD card stream the looper plays its backing track from
  */
-inline void PopulateEffects(std::vector<Effect*>* effects, float sampleRate) {
+inline void PopulateEffects(std::vector<Effect*>* effects, float sampleRate, LfoBank* lfoBank, const PresetFlash* modelFlash,
+                            const PresetFlash* cabinetFlash, StreamReader* backingTrack) {
     if (!effects) return;
     
     // Add delay effect
     DelayEffect* delayEffect = new DelayEffect();
+    delayEffect->SetLfoBank(lfoBank);
     delayEffect->Init(sampleRate);
     effects->push_back(delayEffect);
     
+    // Add reverb effect
+    ReverbEffect* reverbEffect = new ReverbEffect();
+    reverbEffect->SetLfoBank(lfoBank);
+    reverbEffect->Init(sampleRate);
+    effects->push_back(reverbEffect);
+    
+    // Add amp model effect
+    AmpModelEffect* ampModelEffect = new AmpModelEffect();
+    ampModelEffect->SetLfoBank(lfoBank);
+    ampModelEffect->SetModelFlash(modelFlash);
+    ampModelEffect->Init(sampleRate);
+    effects->push_back(ampModelEffect);
+    
+    // Add cabinet effect
+    CabinetEffect* cabinetEffect = new CabinetEffect();
+    cabinetEffect->SetLfoBank(lfoBank);
+    cabinetEffect->SetIrFlash(cabinetFlash);
+    cabinetEffect->Init(sampleRate);
+    effects->push_back(cabinetEffect);
+    
+    // Add looper effect
+    LooperEffect* looperEffect = new LooperEffect();
+    looperEffect->SetLfoBank(lfoBank);
+    looperEffect->SetBackingTrack(backingTrack);
+    looperEffect->Init(sampleRate);
+    effects->push_back(looperEffect);
+    
     // Add chorus effect
     /*ChorusEffect* chorusEffect = new ChorusEffect();
+    chorusEffect->SetLfoBank(lfoBank);
     chorusEffect->Init(sampleRate);
     effects->push_back(chorusEffect);
     
     // Add flanger effect
     FlangerEffect* flangerEffect = new FlangerEffect();
+    flangerEffect->SetLfoBank(lfoBank);
     flangerEffect->Init(sampleRate);
     effects->push_back(flangerEffect);
     
     // Add phaser effect
     PhaserEffect* phaserEffect = new PhaserEffect();
+    phaserEffect->SetLfoBank(lfoBank);
     phaserEffect->Init(sampleRate);
     effects->push_back(phaserEffect);
     
     // Add wah effect
     WahEffect* wahEffect = new WahEffect();
+    wahEffect->SetLfoBank(lfoBank);
     wahEffect->Init(sampleRate);
     effects->push_back(wahEffect);
     
     // Add autowah effect
     AutowahEffect* autowahEffect = new AutowahEffect();
+    autowahEffect->SetLfoBank(lfoBank);
     autowahEffect->Init(sampleRate);
     effects->push_back(autowahEffect);
     
     // Add bandpass effect
     BandpassEffect* bandpassEffect = new BandpassEffect();
+    bandpassEffect->SetLfoBank(lfoBank);
     bandpassEffect->Init(sampleRate);
     effects->push_back(bandpassEffect);
     
     // Add tuner effect
     TunerEffect* tunerEffect = new TunerEffect();
+    tunerEffect->SetLfoBank(lfoBank);
     tunerEffect->Init(sampleRate);
     effects->push_back(tunerEffect);*/
 }
@@ -0,0 +1,105 @@
+#include "feedbackmatrix.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+FeedbackMatrix::FeedbackMatrix()
+    : sampleRate_(48000.0f),
+      cross_(0.0f),
+      pingPong_(false),
+      saturation_(false) {
+    highCut_ = Design(20000.0f, sampleRate_);
+    lowCut_ = Design(20.0f, sampleRate_);
+    Reset();
+}
+
+void FeedbackMatrix::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+    SetFilters(20.0f, 20000.0f);
+    Reset();
+}
+
+void FeedbackMatrix::Reset() {
+    for (int c = 0; c < 2; c++) {
+        highIc1_[c] = 0.0f;
+        highIc2_[c] = 0.0f;
+        lowIc1_[c] = 0.0f;
+        lowIc2_[c] = 0.0f;
+    }
+}
+
+FeedbackMatrix::Coefficients FeedbackMatrix::Design(float frequency, float sampleRate) {
+    // Trapezoidal (TPT) state-variable filter, Butterworth Q
+    float limit = 0.45f * sampleRate;
+    if (frequency > limit) frequency = limit;
+    float g = tanf(3.14159265f * frequency / sampleRate);
+    Coefficients c;
+    c.k = 1.41421356f;
+    c.a1 = 1.0f / (1.0f + g * (g + c.k));
+    c.a2 = g * c.a1;
+    c.a3 = g * c.a2;
+    return c;
+}
+
+void FeedbackMatrix::SetFilters(float lowCut, float highCut) {
+    lowCut_ = Design(lowCut, sampleRate_);
+    highCut_ = Design(highCut, sampleRate_);
+}
+
+void FeedbackMatrix::Process(const float* inL, const float* inR, const float* yL, const float* yR,
+                             const float* feedback, float* wL, float* wR, size_t size) {
+    const Coefficients hc = highCut_;
+    const Coefficients lc = lowCut_;
+    const float cross = pingPong_ ? 1.0f : cross_;
+    const float straight = 1.0f - cross;
+    const bool saturation = saturation_;
+
+    float hIc1[2] = {highIc1_[0], highIc1_[1]};
+    float hIc2[2] = {highIc2_[0], highIc2_[1]};
+    float lIc1[2] = {lowIc1_[0], lowIc1_[1]};
+    float lIc2[2] = {lowIc2_[0], lowIc2_[1]};
+
+    for (size_t i = 0; i < size; i++) {
+        float x[2] = {yL[i], yR[i]};
+        float f[2];
+
+        for (int c = 0; c < 2; c++) {
+            // High-cut: lowpass output
+            float v3 = x[c] - hIc2[c];
+            float v1 = hc.a1 * hIc1[c] + hc.a2 * v3;
+            float v2 = hIc2[c] + hc.a2 * hIc1[c] + hc.a3 * v3;
+            hIc1[c] = 2.0f * v1 - hIc1[c];
+            hIc2[c] = 2.0f * v2 - hIc2[c];
+            float low = v2;
+
+            // Low-cut: highpass output
+            v3 = low - lIc2[c];
+            v1 = lc.a1 * lIc1[c] + lc.a2 * v3;
+            v2 = lIc2[c] + lc.a2 * lIc1[c] + lc.a3 * v3;
+            lIc1[c] = 2.0f * v1 - lIc1[c];
+            lIc2[c] = 2.0f * v2 - lIc2[c];
+            float y = low - lc.k * v1 - v2;
+
+            if (saturation) {
+                // Tape-style soft clip (Pade tanh, saturating at +/-3)
+                y = y < -3.0f ? -3.0f : (y > 3.0f ? 3.0f : y);
+                y = y * (27.0f + y * y) / (27.0f + 9.0f * y * y);
+            }
+            f[c] = y;
+        }
+
+        float fb = feedback[i];
+        float dryL = pingPong_ ? 0.5f * (inL[i] + inR[i]) : inL[i];
+        float dryR = pingPong_ ? 0.0f : inR[i];
+        wL[i] = dryL + fb * (straight * f[0] + cross * f[1]);
+        wR[i] = dryR + fb * (straight * f[1] + cross * f[0]);
+    }
+
+    for (int c = 0; c < 2; c++) {
+        highIc1_[c] = hIc1[c];
+        highIc2_[c] = hIc2[c];
+        lowIc1_[c] = lIc1[c];
+        lowIc2_[c] = lIc2[c];
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef PERSPECTIVE_FEEDBACKMATRIX_H
+#define PERSPECTIVE_FEEDBACKMATRIX_H
+
+#include <stddef.h>
+
+namespace perspective {
+
+// Feedback path of a stereo delay: the two lines' outputs are tone shaped
+// (low-cut and high-cut state-variable filters, optional tape-style
+// saturation), mixed through a 2x2 matrix and added to the input to give
+// what each line writes. Cross 0 keeps two independent loops, 1 swaps the
+// lines on every repeat; ping-pong feeds the summed input into the left line
+// only with full cross, so repeats alternate sides.
+//
+// Both channels run as two lanes of one loop - filter states and matrix
+// terms kept side by side with shared coefficients - so the matrix costs
+// about what two separate mono loops did.
+class FeedbackMatrix {
+public:
+    FeedbackMatrix();
+
+    void Init(float sampleRate);
+    void Reset();
+
+    // Corner frequencies in Hz
+    void SetFilters(float lowCut, float highCut);
+    // 0.0 (independent) to 1.0 (lines swap each repeat)
+    void SetCross(float cross) { cross_ = cross; }
+    void SetPingPong(bool pingPong) { pingPong_ = pingPong; }
+    void SetSaturation(bool saturation) { saturation_ = saturation; }
+
+    // Delayed outputs yL/yR and per-sample feedback in, line writes wL/wR out
+    void Process(const float* inL, const float* inR, const float* yL, const float* yR, const float* feedback, float* wL,
+                 float* wR, size_t size);
+
+private:
+    struct Coefficients {
+        float k;   // 1 / Q
+        float a1;
+        float a2;
+        float a3;
+    };
+    static Coefficients Design(float frequency, float sampleRate);
+
+    float sampleRate_;
+    float cross_;
+    bool pingPong_;
+    bool saturation_;
+
+    Coefficients highCut_;
+    Coefficients lowCut_;
+
+    // Integrator states, [lane]
+    float highIc1_[2];
+    float highIc2_[2];
+    float lowIc1_[2];
+    float lowIc2_[2];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_FEEDBACKMATRIX_H
@@ -4,8 +4,22 @@
 using namespace perspective;
 using namespace daisysp;
 
+// Mix, Depth, Rate, Feedback, Wave
+static constexpr ParameterDescriptor FLANGER_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Depth", 0.0f, 1.0f, 0.7f, PotCurve::LIN, KNOB_2_IDX),
+    PotentiometerParameter("Rate", 0.05f, 10.0f, 0.3f, PotCurve::LOG, KNOB_3_IDX),
+    PotentiometerParameter("Feedback", 0.0f, 0.95f, 0.5f, PotCurve::LIN, KNOB_4_IDX),
+    EncoderParameter("Wave", 0.0f, 3.0f, 0.0f, 1.0f, ENCODER_1_IDX), // Sine, triangle, smooth random, S&H
+};
+
 FlangerEffect::FlangerEffect()
-    : Effect("Flanger") {
+    : Effect("Flanger")
+    , lfoL_(-1)
+    , lfoR_(-1)
+    , delaySamples_(1.0f)
+    , lfoAmplitude_(0.0f)
+    , feedback_(0.0f) {
 }
 
 FlangerEffect::~FlangerEffect() {
@@ -14,15 +28,15 @@ FlangerEffect::~FlangerEffect() {
 void FlangerEffect::Init(float sampleRate) {
     sampleRate_ = sampleRate;
     
-    // Initialize flanger for stereo
-    flangerL_.Init(sampleRate);
-    flangerR_.Init(sampleRate);
+    // Initialize delay lines and LFOs for stereo
+    delayL_.Init();
+    delayR_.Init();
+    if (lfoL_ < 0) lfoL_ = AllocateLfo();
+    if (lfoR_ < 0) lfoR_ = AllocateLfo();
+    delaySamples_ = BASE_DELAY_MS * 0.001f * sampleRate;
     
-    // Add parameters: Mix, Depth, Rate, Feedback
-    AddParameter(new PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX));
-    AddParameter(new PotentiometerParameter("Depth", 0.0f, 1.0f, 0.7f, PotCurve::LIN, KNOB_2_IDX));
-    AddParameter(new PotentiometerParameter("Rate", 0.05f, 10.0f, 0.3f, PotCurve::LOG, KNOB_3_IDX));
-    AddParameter(new PotentiometerParameter("Feedback", 0.0f, 0.95f, 0.5f, PotCurve::LIN, KNOB_4_IDX));
+    SetParameterLayout(FLANGER_PARAMETERS, params_);
+    SetTempoParameter(Param::RATE);
     
     // Set default flanger parameters
     Update();
@@ -38,11 +52,13 @@ void FlangerEffect::Process(float* in, float* out, size_t size) {
     }
     
     // Get mix parameter
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    float mix = params_[Param::MIX];
+    
+    const float* lfo = GetLfoBlock(lfoL_);
     
     // Process with wet/dry blend
     for (size_t i = 0; i < size; i++) {
-        float wet = flangerL_.Process(in[i]);
+        float wet = ProcessVoice(delayL_, lfo[i], in[i]);
         out[i] = in[i] * (1.0f - mix) + wet * mix;
     }
 }
@@ -58,12 +74,15 @@ void FlangerEffect::ProcessStereo(float* inL, float* inR, float* outL, float* ou
     }
     
     // Get mix parameter
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    float mix = params_[Param::MIX];
+    
+    const float* lfoL = GetLfoBlock(lfoL_);
+    const float* lfoR = GetLfoBlock(lfoR_);
     
     // Process stereo signal with independent flangers
     for (size_t i = 0; i < size; i++) {
-        float wetL = flangerL_.Process(inL[i]);
-        float wetR = flangerR_.Process(inR[i]);
+        float wetL = ProcessVoice(delayL_, lfoL[i], inL[i]);
+        float wetR = ProcessVoice(delayR_, lfoR[i], inR[i]);
         
         outL[i] = inL[i] * (1.0f - mix) + wetL * mix;
         outR[i] = inR[i] * (1.0f - mix) + wetR * mix;
@@ -72,22 +91,25 @@ void FlangerEffect::ProcessStereo(float* inL, float* inR, float* outL, float* ou
 
 void FlangerEffect::Update() {
     // Update flanger parameters from effect parameters
-    if (parameters_.size() >= 4) {
-        // Mix parameter (index 0) - handled in Process
-        
-        // Depth parameter (index 1)
-        float depth = parameters_[1]->GetValue();
-        flangerL_.SetLfoDepth(depth);
-        flangerR_.SetLfoDepth(depth);
-        
-        // Rate parameter (index 2)
-        float rate = parameters_[2]->GetValue();
-        flangerL_.SetLfoFreq(rate);
-        flangerR_.SetLfoFreq(rate);
-        
-        // Feedback parameter (index 3)
-        float feedback = parameters_[3]->GetValue();
-        flangerL_.SetFeedback(feedback);
-        flangerR_.SetFeedback(feedback);
-    }
+    // Mix parameter - handled in Process
+    
+    // Depth parameter - LFO swing as a fraction of the base delay
+    lfoAmplitude_ = fclamp(params_[Param::DEPTH], 0.0f, 0.93f) * delaySamples_;
+    
+    // Rate and Wave parameters - locked to the beat while the rate follows tap tempo
+    float rate = params_[Param::RATE];
+    LfoWave wave = LfoWaveFromValue(params_[Param::WAVE]);
+    bool locked = IsTempoLocked();
+    SetLfo(lfoL_, wave, rate, locked);
+    SetLfo(lfoR_, wave, rate, locked);
+    
+    // Feedback parameter
+    feedback_ = fclamp(params_[Param::FEEDBACK], 0.0f, 1.0f) * 0.97f;
+}
+
+float FlangerEffect::ProcessVoice(DelayLine<float, MAX_DELAY>& delay, float lfo, float in) {
+    delay.SetDelay(1.0f + delaySamples_ + lfo * lfoAmplitude_);
+    float delayed = delay.Read();
+    delay.Write(in + delayed * feedback_);
+    return (in + delayed) * 0.5f;
 }
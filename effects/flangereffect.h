@@ -19,8 +19,24 @@ public:
     void Update() override;
 
 private:
-    Flanger flangerL_;
-    Flanger flangerR_;
+    // Parameters, in table order
+    enum class Param { MIX, DEPTH, RATE, FEEDBACK, WAVE, COUNT };
+    ParameterValues<Param> params_;
+
+    // Modulated delay per channel; the LFOs lock to the transport beat when the
+    // rate follows tap tempo
+    static constexpr size_t MAX_DELAY = 960;  // 20ms at 48kHz
+    static constexpr float BASE_DELAY_MS = 5.275f;
+    DelayLine<float, MAX_DELAY> delayL_;
+    DelayLine<float, MAX_DELAY> delayR_;
+    int lfoL_;  // LfoBank voices
+    int lfoR_;
+
+    float delaySamples_;
+    float lfoAmplitude_;  // In samples
+    float feedback_;
+
+    float ProcessVoice(DelayLine<float, MAX_DELAY>& delay, float lfo, float in);
 };
 
 } // namespace perspective
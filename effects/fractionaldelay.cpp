@@ -0,0 +1,146 @@
+#include "fractionaldelay.h"
+
+#include <string.h>
+
+using namespace perspective;
+
+FractionalDelay::FractionalDelay()
+    : buffer_(nullptr),
+      mask_(0),
+      write_(0),
+      interpolation_(DelayInterpolation::HERMITE4),
+      allpassState_(0.0f) {
+}
+
+void FractionalDelay::Init(float* buffer, size_t size) {
+    buffer_ = buffer;
+    mask_ = static_cast<uint32_t>(size - 1);
+    Clear();
+}
+
+void FractionalDelay::Clear() {
+    if (buffer_) {
+        memset(buffer_, 0, (mask_ + 1) * sizeof(float));
+    }
+    write_ = 0;
+    allpassState_ = 0.0f;
+}
+
+void FractionalDelay::ReadLinear(const uint32_t* base, const float* t, float* out, size_t size) const {
+    for (size_t i = 0; i < size; i++) {
+        float x0 = buffer_[base[i] & mask_];
+        float x1 = buffer_[(base[i] + 1) & mask_];
+        out[i] = x0 + (x1 - x0) * t[i];
+    }
+}
+
+void FractionalDelay::ReadLagrange3(const uint32_t* base, const float* t, float* out, size_t size) const {
+    for (size_t i = 0; i < size; i++) {
+        float xm1 = buffer_[(base[i] - 1) & mask_];
+        float x0 = buffer_[base[i] & mask_];
+        float x1 = buffer_[(base[i] + 1) & mask_];
+        float x2 = buffer_[(base[i] + 2) & mask_];
+
+        // Lagrange basis through points -1, 0, 1, 2 at t
+        float d = t[i];
+        float dp1 = d + 1.0f;
+        float dm1 = d - 1.0f;
+        float dm2 = d - 2.0f;
+        float cm1 = -d * dm1 * dm2 * (1.0f / 6.0f);
+        float c0 = dp1 * dm1 * dm2 * 0.5f;
+        float c1 = -dp1 * d * dm2 * 0.5f;
+        float c2 = dp1 * d * dm1 * (1.0f / 6.0f);
+        out[i] = cm1 * xm1 + c0 * x0 + c1 * x1 + c2 * x2;
+    }
+}
+
+void FractionalDelay::ReadAllpass(const uint32_t* base, const float* t, float* out, size_t size) {
+    // First-order allpass on the line one sample short of the integer delay,
+    // so its own delay stays in [1, 2) and the coefficient in (-1/3, 0] -
+    // well clear of the pole near Nyquist that a delay close to 0 gives
+    float y = allpassState_;
+    for (size_t i = 0; i < size; i++) {
+        float x1 = buffer_[(base[i] + 1) & mask_];
+        float x2 = buffer_[(base[i] + 2) & mask_];
+        float eta = 2.0f - t[i];
+        float a = (1.0f - eta) / (1.0f + eta);
+        y = a * x2 + x1 - a * y;
+        out[i] = y;
+    }
+    allpassState_ = y;
+}
+
+void FractionalDelay::ReadHermite4(const uint32_t* base, const float* t, float* out, size_t size) const {
+    for (size_t i = 0; i < size; i++) {
+        float xm1 = buffer_[(base[i] - 1) & mask_];
+        float x0 = buffer_[base[i] & mask_];
+        float x1 = buffer_[(base[i] + 1) & mask_];
+        float x2 = buffer_[(base[i] + 2) & mask_];
+
+        float c1 = 0.5f * (x1 - xm1);
+        float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+        float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+        float d = t[i];
+        out[i] = ((c3 * d + c2) * d + c1) * d + x0;
+    }
+}
+
+size_t FractionalDelay::GetRun(const float* delay, size_t size) {
+    // Sample k's newest point (write + k - whole + 1) has to be older than
+    // the write position; delays are clamped to at least MIN_DELAY
+    size_t run = 1;
+    while (run < size && delay[run] >= static_cast<float>(run + 2)) {
+        run++;
+    }
+    return run;
+}
+
+void FractionalDelay::Read(const float* delay, float* out, size_t size) {
+    if (!buffer_) {
+        memset(out, 0, size * sizeof(float));
+        return;
+    }
+    if (size > MAX_BLOCK_SIZE) size = MAX_BLOCK_SIZE;
+
+    // Read positions for the whole run: the point just older than each read,
+    // and the fraction from it towards the newer point
+    float maxDelay = GetMaxDelay();
+    for (size_t k = 0; k < size; k++) {
+        float d = delay[k];
+        d = d < MIN_DELAY ? MIN_DELAY : (d > maxDelay ? maxDelay : d);
+        uint32_t whole = static_cast<uint32_t>(d);
+        base_[k] = write_ + static_cast<uint32_t>(k) - whole - 1;
+        fraction_[k] = 1.0f - (d - static_cast<float>(whole));
+    }
+
+    switch (interpolation_) {
+        case DelayInterpolation::LINEAR:    ReadLinear(base_, fraction_, out, size); break;
+        case DelayInterpolation::LAGRANGE3: ReadLagrange3(base_, fraction_, out, size); break;
+        case DelayInterpolation::ALLPASS:   ReadAllpass(base_, fraction_, out, size); break;
+        case DelayInterpolation::HERMITE4:  ReadHermite4(base_, fraction_, out, size); break;
+    }
+}
+
+void FractionalDelay::Write(const float* in, size_t size) {
+    if (!buffer_) return;
+    for (size_t k = 0; k < size; k++) {
+        buffer_[(write_ + k) & mask_] = in[k];
+    }
+    write_ = (write_ + static_cast<uint32_t>(size)) & mask_;
+}
+
+void FractionalDelay::Process(const float* in, const float* delay, const float* feedback, float* out, size_t size) {
+    if (size > MAX_BLOCK_SIZE) size = MAX_BLOCK_SIZE;
+
+    float write[MAX_BLOCK_SIZE];
+    size_t start = 0;
+    while (start < size) {
+        size_t run = GetRun(delay + start, size - start);
+        Read(delay + start, out + start, run);
+        for (size_t k = 0; k < run; k++) {
+            write[k] = in[start + k] + feedback[start + k] * out[start + k];
+        }
+        Write(write, run);
+        start += run;
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef PERSPECTIVE_FRACTIONALDELAY_H
+#define PERSPECTIVE_FRACTIONALDELAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Fractional-delay interpolation kernels, in parameter order
+enum class DelayInterpolation {
+    LINEAR,     // 2 points - cheapest, dulls the top end at half-sample delays
+    LAGRANGE3,  // 4 points, third-order Lagrange
+    ALLPASS,    // First-order allpass (Thiran) - flat magnitude, recursive
+    HERMITE4,   // 4 points, Catmull-Rom Hermite
+};
+
+// Feedback delay line with a per-sample fractional delay, read a block at a
+// time (buffer in SDRAM on the pedal, supplied by the caller). Process cuts
+// the block into runs of samples whose reads all land on audio already
+// written; for each run it splits every delay into whole samples and fraction
+// at once, runs the selected kernel over the run, and then writes input plus
+// feedback. Delays shorter than the block just make the runs shorter. Read/Write expose the
+// same steps for a caller that mixes several lines' outputs into the writes.
+class FractionalDelay {
+public:
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+    // Kernels read up to two samples newer than the integer delay
+    static constexpr float MIN_DELAY = 4.0f;
+
+    FractionalDelay();
+
+    // size must be a power of two
+    void Init(float* buffer, size_t size);
+    void Clear();
+
+    void SetInterpolation(DelayInterpolation interpolation) { interpolation_ = interpolation; }
+    inline DelayInterpolation GetInterpolation() const { return interpolation_; }
+    // Delays are clamped to MIN_DELAY - GetMaxDelay()
+    inline float GetMaxDelay() const { return static_cast<float>(mask_ - 2); }
+
+    // out[i] is the line delayed by delay[i] samples; then in[i] + feedback[i] * out[i]
+    // is written. size <= MAX_BLOCK_SIZE.
+    void Process(const float* in, const float* delay, const float* feedback, float* out, size_t size);
+
+    // Length of the run from the start of delay (at most size) whose reads can
+    // all be made before any of it is written
+    static size_t GetRun(const float* delay, size_t size);
+    // Reads a run (size <= GetRun) into out; Write must then add exactly size samples
+    void Read(const float* delay, float* out, size_t size);
+    void Write(const float* in, size_t size);
+
+private:
+    // Each kernel reads run samples from base[i] (the point just older than the
+    // read position) with fraction t[i] towards the next newer point
+    void ReadLinear(const uint32_t* base, const float* t, float* out, size_t size) const;
+    void ReadLagrange3(const uint32_t* base, const float* t, float* out, size_t size) const;
+    void ReadAllpass(const uint32_t* base, const float* t, float* out, size_t size);
+    void ReadHermite4(const uint32_t* base, const float* t, float* out, size_t size) const;
+
+    float* buffer_;
+    uint32_t mask_;
+    uint32_t write_;
+    DelayInterpolation interpolation_;
+    float allpassState_;
+
+    uint32_t base_[MAX_BLOCK_SIZE];
+    float fraction_[MAX_BLOCK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_FRACTIONALDELAY_H
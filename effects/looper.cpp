@@ -0,0 +1,407 @@
+#include "looper.h"
+
+#include <string.h>
+
+#if defined(ARM_MATH_CM7)
+#include "arm_math.h"
+#endif
+
+using namespace perspective;
+
+static inline int32_t Saturate16(int32_t x) {
+    return x < -32768 ? -32768 : (x > 32767 ? 32767 : x);
+}
+
+static inline uint32_t Pack(float left, float right) {
+    int32_t l = Saturate16(static_cast<int32_t>(left * 32767.0f + (left < 0.0f ? -0.5f : 0.5f)));
+    int32_t r = Saturate16(static_cast<int32_t>(right * 32767.0f + (right < 0.0f ? -0.5f : 0.5f)));
+    return (static_cast<uint32_t>(l) & 0xFFFFu) | (static_cast<uint32_t>(r) << 16);
+}
+
+static inline float Left(uint32_t frame) {
+    return static_cast<float>(static_cast<int16_t>(frame & 0xFFFFu)) * (1.0f / 32767.0f);
+}
+
+static inline float Right(uint32_t frame) {
+    return static_cast<float>(static_cast<int16_t>(frame >> 16)) * (1.0f / 32767.0f);
+}
+
+// Saturating add of both channels at once
+static inline uint32_t AddFrames(uint32_t a, uint32_t b) {
+#if defined(ARM_MATH_CM7)
+    return __QADD16(a, b);
+#else
+    int32_t l = Saturate16(static_cast<int16_t>(a & 0xFFFFu) + static_cast<int16_t>(b & 0xFFFFu));
+    int32_t r = Saturate16(static_cast<int16_t>(a >> 16) + static_cast<int16_t>(b >> 16));
+    return (static_cast<uint32_t>(l) & 0xFFFFu) | (static_cast<uint32_t>(r) << 16);
+#endif
+}
+
+static inline float Ramp(float value, float target, float step) {
+    if (value < target) return value + step < target ? value + step : target;
+    if (value > target) return value - step > target ? value - step : target;
+    return value;
+}
+
+Looper::Looper()
+    : pool_(nullptr),
+      poolFrames_(0),
+      queueWrite_(0),
+      queueRead_(0),
+      reverse_(false),
+      crossfade_(0),
+      rampStep_(1.0f),
+      overdubLevel_(1.0f) {
+    Reset();
+}
+
+void Looper::Init(uint32_t* pool, size_t frames) {
+    pool_ = pool;
+    poolFrames_ = frames;
+    queueRead_.store(queueWrite_.load());
+    Reset();
+}
+
+void Looper::Reset() {
+    state_ = State::EMPTY;
+    current_ = pool_;
+    spare_ = nullptr;
+    undoAvailable_ = false;
+    length_ = 0;
+    position_ = 0;
+    forward_ = true;
+    sessionActive_ = false;
+    target_ = nullptr;
+    lo_ = hi_ = head_ = 0;
+    dubGain_ = dubTarget_ = 0.0f;
+    outGain_ = outTarget_ = 1.0f;
+    fade_ = Fade::NONE;
+    tail_ = 0;
+    loopFade_ = 0;
+    swapFrom_ = nullptr;
+    swapLeft_ = 0;
+    swapFrames_ = 0;
+}
+
+void Looper::SetCrossfade(size_t frames) {
+    crossfade_ = frames < MAX_CROSSFADE ? frames : MAX_CROSSFADE;
+    rampStep_ = crossfade_ > 0 ? 1.0f / static_cast<float>(crossfade_) : 1.0f;
+}
+
+void Looper::Push(Command command) {
+    uint32_t write = queueWrite_.load(std::memory_order_relaxed);
+    if (write - queueRead_.load(std::memory_order_acquire) >= QUEUE_SIZE) return;
+    queue_[write % QUEUE_SIZE] = command;
+    queueWrite_.store(write + 1, std::memory_order_release);
+}
+
+void Looper::CloseLoop() {
+    if (length_ == 0) {
+        Reset();
+        return;
+    }
+
+    state_ = State::PLAYING;
+    position_ = 0;
+    forward_ = true;
+    spare_ = 2 * length_ <= poolFrames_ ? pool_ + length_ : nullptr;
+    undoAvailable_ = false;
+    sessionActive_ = false;
+    outGain_ = outTarget_ = 1.0f;
+    fade_ = Fade::NONE;
+
+    loopFade_ = crossfade_ < length_ ? crossfade_ : length_;
+    tail_ = loopFade_;
+}
+
+void Looper::StartOverdub() {
+    state_ = State::OVERDUBBING;
+    dubTarget_ = 1.0f;
+    if (spare_ && !sessionActive_) {
+        // Carried on from the head; the first frame is outside the arc either way
+        sessionActive_ = true;
+        target_ = spare_;
+        undoAvailable_ = false;
+        head_ = 0;
+        lo_ = hi_ = forward_ ? 0 : 1;
+    }
+}
+
+void Looper::SwapLayers() {
+    swapFrom_ = current_;
+    swapLeft_ = swapFrames_ = crossfade_;
+    uint32_t* previous = current_;
+    current_ = spare_;
+    spare_ = previous;
+}
+
+void Looper::Apply(Command command) {
+    switch (command) {
+        case Command::RECORD:
+            if (state_ == State::EMPTY) {
+                current_ = pool_;
+                length_ = 0;
+                state_ = State::RECORDING;
+            } else if (state_ == State::RECORDING) {
+                CloseLoop();
+            } else if (state_ == State::OVERDUBBING) {
+                state_ = State::PLAYING;
+                dubTarget_ = 0.0f;
+            } else if (state_ == State::STOPPED || fade_ != Fade::NONE) {
+                // Play again (or call off a fade out in progress)
+                state_ = State::PLAYING;
+                outTarget_ = 1.0f;
+                fade_ = Fade::NONE;
+            } else {
+                StartOverdub();
+            }
+            break;
+
+        case Command::STOP:
+            if (state_ == State::RECORDING) {
+                CloseLoop();
+            } else if (state_ == State::STOPPED) {
+                state_ = State::PLAYING;
+                outTarget_ = 1.0f;
+            } else if (state_ != State::EMPTY) {
+                state_ = State::PLAYING;
+                dubTarget_ = 0.0f;
+                outTarget_ = 0.0f;
+                fade_ = Fade::STOP;
+            }
+            break;
+
+        case Command::UNDO:
+            if (sessionActive_) {
+                // Call off an overdub not yet carried round the loop: the old
+                // loop is untouched, so switch back, fading over what has been
+                // written ahead of the head
+                int64_t ahead = 0;
+                if (hi_ - lo_ >= static_cast<int64_t>(length_)) {
+                    ahead = static_cast<int64_t>(length_);
+                } else if (forward_ ? head_ < hi_ : head_ >= lo_) {
+                    ahead = forward_ ? hi_ - head_ : head_ - lo_ + 1;
+                }
+                swapFrom_ = target_;
+                swapFrames_ = crossfade_ < static_cast<size_t>(ahead) ? crossfade_ : static_cast<size_t>(ahead);
+                swapLeft_ = swapFrames_;
+                sessionActive_ = false;
+                dubGain_ = dubTarget_ = 0.0f;
+                if (state_ == State::OVERDUBBING) state_ = State::PLAYING;
+            } else if (undoAvailable_) {
+                SwapLayers();
+            }
+            break;
+
+        case Command::CLEAR:
+            if (state_ == State::PLAYING || state_ == State::OVERDUBBING) {
+                state_ = State::PLAYING;
+                dubTarget_ = 0.0f;
+                outTarget_ = 0.0f;
+                fade_ = Fade::CLEAR;
+            } else {
+                Reset();
+            }
+            break;
+    }
+}
+
+size_t Looper::RecordSegment(size_t offset, size_t size) {
+    size_t room = poolFrames_ - length_;
+    if (size > room) size = room;
+    if (size == 0) {
+        CloseLoop();
+        return 0;
+    }
+
+    memcpy(current_ + length_, inFrames_ + offset, size * sizeof(uint32_t));
+    length_ += size;
+
+    // Out of memory - close the loop here
+    if (length_ == poolFrames_) CloseLoop();
+    return size;
+}
+
+size_t Looper::LoopSegment(const float* inL, const float* inR, float* outL, float* outR, size_t offset, size_t size) {
+    const bool forward = forward_;
+
+    // The segment ends at the wrap, the end of the closing crossfade, and the
+    // edge of the overdub session's arc
+    size_t m = forward ? length_ - position_ : position_ + 1;
+    if (m > size) m = size;
+    if (tail_ > 0 && m > tail_) m = tail_;
+
+    bool covered = true;
+    if (sessionActive_) {
+        int64_t span = hi_ - lo_;
+        int64_t length = static_cast<int64_t>(length_);
+        if (span < length) {
+            int64_t limit;
+            if (forward) {
+                covered = head_ < hi_;
+                limit = covered ? hi_ - head_ : length - span;
+            } else {
+                covered = head_ >= lo_;
+                limit = covered ? head_ - lo_ + 1 : length - span;
+            }
+            if (static_cast<int64_t>(m) > limit) m = static_cast<size_t>(limit);
+        }
+    }
+
+    // Reads come from the new layer where the session has written it
+    const uint32_t* src = sessionActive_ && covered ? target_ : current_;
+    uint32_t* dst = sessionActive_ ? target_ : current_;
+    const size_t base = position_;
+    const ptrdiff_t stride = forward ? 1 : -1;
+    float* yL = outL + offset;
+    float* yR = outR + offset;
+    const float* xL = inL + offset;
+    const float* xR = inR + offset;
+
+    // Output: the loop as it was before this segment's writes
+    if (tail_ == 0 && swapLeft_ == 0 && outGain_ == 1.0f && outTarget_ == 1.0f) {
+        for (size_t k = 0; k < m; k++) {
+            uint32_t frame = src[base + stride * static_cast<ptrdiff_t>(k)];
+            yL[k] = Left(frame);
+            yR[k] = Right(frame);
+        }
+    } else {
+        for (size_t k = 0; k < m; k++) {
+            size_t idx = base + stride * static_cast<ptrdiff_t>(k);
+            uint32_t frame = src[idx];
+            float l = Left(frame);
+            float r = Right(frame);
+
+            if (tail_ > 0) {
+                // Closing crossfade: the loop start fades in under the input
+                // that followed the close, and the blend is what is kept
+                float g = static_cast<float>(idx) / static_cast<float>(loopFade_);
+                l *= g;
+                r *= g;
+                current_[idx] = Pack(l + xL[k] * (1.0f - g), r + xR[k] * (1.0f - g));
+            }
+            if (swapLeft_ > 0) {
+                float w = static_cast<float>(swapLeft_) / static_cast<float>(swapFrames_);
+                uint32_t from = swapFrom_[idx];
+                l += (Left(from) - l) * w;
+                r += (Right(from) - r) * w;
+                swapLeft_--;
+            }
+            outGain_ = Ramp(outGain_, outTarget_, rampStep_);
+            yL[k] = l * outGain_;
+            yR[k] = r * outGain_;
+        }
+    }
+
+    // Writes: overdub (punching in and out on a ramp), or carry the old loop
+    // into the new layer where the session has not been yet
+    if (dubGain_ > 0.0f || dubTarget_ > 0.0f) {
+        if (dubGain_ == 1.0f && dubTarget_ == 1.0f && overdubLevel_ >= 1.0f) {
+            const uint32_t* in = inFrames_ + offset;
+            for (size_t k = 0; k < m; k++) {
+                size_t idx = base + stride * static_cast<ptrdiff_t>(k);
+                dst[idx] = AddFrames(src[idx], in[k]);
+            }
+        } else {
+            for (size_t k = 0; k < m; k++) {
+                size_t idx = base + stride * static_cast<ptrdiff_t>(k);
+                dubGain_ = Ramp(dubGain_, dubTarget_, rampStep_);
+                float level = 1.0f - (1.0f - overdubLevel_) * dubGain_;
+                uint32_t frame = src[idx];
+                dst[idx] = Pack(Left(frame) * level + xL[k] * dubGain_, Right(frame) * level + xR[k] * dubGain_);
+            }
+        }
+    } else if (sessionActive_ && !covered) {
+        size_t first = forward ? base : base + 1 - m;
+        memcpy(dst + first, src + first, m * sizeof(uint32_t));
+    }
+
+    if (sessionActive_) {
+        if (!covered) {
+            if (forward) {
+                hi_ += static_cast<int64_t>(m);
+            } else {
+                lo_ -= static_cast<int64_t>(m);
+            }
+        }
+        head_ += forward ? static_cast<int64_t>(m) : -static_cast<int64_t>(m);
+    }
+    if (tail_ > 0) tail_ -= m;
+    Step(m);
+
+    // The overdub has been carried round the whole loop: it becomes the loop,
+    // and the old loop is kept for undo
+    if (sessionActive_ && hi_ - lo_ >= static_cast<int64_t>(length_) && dubGain_ == 0.0f && dubTarget_ == 0.0f) {
+        spare_ = current_;
+        current_ = target_;
+        sessionActive_ = false;
+        undoAvailable_ = true;
+    }
+
+    if (fade_ != Fade::NONE && outGain_ == 0.0f) {
+        if (fade_ == Fade::STOP) {
+            state_ = State::STOPPED;
+            fade_ = Fade::NONE;
+        } else {
+            Reset();
+        }
+    }
+    return m;
+}
+
+void Looper::Step(size_t frames) {
+    if (forward_) {
+        position_ += frames;
+        if (position_ >= length_) position_ -= length_;
+    } else {
+        position_ = frames > position_ ? position_ + length_ - frames : position_ - frames;
+    }
+}
+
+void Looper::Process(const float* inL, const float* inR, float* outL, float* outR, size_t size) {
+    if (size > MAX_BLOCK_SIZE) size = MAX_BLOCK_SIZE;
+
+    // Commands and direction changes wait out the closing crossfade
+    if (tail_ == 0) {
+        uint32_t read = queueRead_.load(std::memory_order_relaxed);
+        uint32_t write = queueWrite_.load(std::memory_order_acquire);
+        while (read != write) {
+            Apply(queue_[read % QUEUE_SIZE]);
+            read++;
+        }
+        queueRead_.store(read, std::memory_order_release);
+
+        bool forward = !reverse_;
+        bool looping = state_ == State::PLAYING || state_ == State::OVERDUBBING || state_ == State::STOPPED;
+        if (looping && forward != forward_ && tail_ == 0) {
+            // Turn round on the last frame played rather than the one after it
+            forward_ = forward;
+            size_t turn = 2 % length_;
+            if (forward) {
+                position_ = (position_ + turn) % length_;
+            } else {
+                position_ = (position_ + length_ - turn) % length_;
+            }
+            head_ += forward ? 2 : -2;
+        }
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        inFrames_[i] = Pack(inL[i], inR[i]);
+    }
+
+    size_t done = 0;
+    while (done < size) {
+        if (state_ == State::RECORDING) {
+            memset(outL + done, 0, (size - done) * sizeof(float));
+            memset(outR + done, 0, (size - done) * sizeof(float));
+            done += RecordSegment(done, size - done);
+        } else if (state_ == State::PLAYING || state_ == State::OVERDUBBING) {
+            done += LoopSegment(inL, inR, outL, outR, done, size - done);
+        } else {
+            memset(outL + done, 0, (size - done) * sizeof(float));
+            memset(outR + done, 0, (size - done) * sizeof(float));
+            done = size;
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#ifndef PERSPECTIVE_LOOPER_H
+#define PERSPECTIVE_LOOPER_H
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Loop recorder over a pool of packed stereo frames (16-bit left in the low
+// half, right in the high half; SDRAM on the pedal, supplied by the caller).
+// A loop of length L records to the start of the pool. When 2L frames fit,
+// the next L frames hold a second layer, so an overdub writes the old loop
+// plus the input into the spare layer and the undo is a pointer swap. An
+// overdub is undoable once it has been carried through one whole pass (the
+// rest of the loop is copied as the head goes round). Longer loops overdub
+// in place without undo.
+//
+// Loop boundaries are crossfaded as they stream: after the loop is closed
+// the input keeps being recorded over its first crossfade frames, fading in
+// the loop's start under the note that was ringing at the close. Overdubs
+// punch in and out on a ramp, and stop, clear and undo fade the output.
+//
+// Commands are queued by the main loop and applied at the start of the next
+// block, so a loop's length is exactly the frames between the two Record
+// commands whatever the block size. Commands queued during the closing
+// crossfade wait until it is done.
+class Looper {
+public:
+    enum class State { EMPTY, RECORDING, PLAYING, OVERDUBBING, STOPPED };
+
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+    static constexpr size_t MAX_CROSSFADE = 4800;
+
+    Looper();
+
+    void Init(uint32_t* pool, size_t frames);
+
+    // Frames, 0 to MAX_CROSSFADE
+    void SetCrossfade(size_t frames);
+    // Level the existing loop keeps on each overdubbed pass, 0.0 to 1.0
+    void SetOverdubLevel(float level) { overdubLevel_ = level; }
+    void SetReverse(bool reverse) { reverse_ = reverse; }
+
+    // Empty: record. Recording: close the loop and play. Playing: overdub.
+    // Overdubbing: back to playing. Stopped: play.
+    void Record() { Push(Command::RECORD); }
+    // Playing or overdubbing: fade out and pause. Stopped: play.
+    void Stop() { Push(Command::STOP); }
+    // Take the last overdub off, or put it back
+    void Undo() { Push(Command::UNDO); }
+    void Clear() { Push(Command::CLEAR); }
+
+    // Loop output only (the input is not passed through)
+    void Process(const float* inL, const float* inR, float* outL, float* outR, size_t size);
+
+    inline State GetState() const { return state_; }
+    inline size_t GetLength() const { return length_; }
+    inline size_t GetPosition() const { return position_; }
+    inline size_t GetMaxLength() const { return poolFrames_; }
+    // An overdub is ready to be taken off (or put back)
+    inline bool CanUndo() const { return undoAvailable_ || sessionActive_; }
+
+private:
+    enum class Command : uint8_t { RECORD, STOP, UNDO, CLEAR };
+    enum class Fade : uint8_t { NONE, STOP, CLEAR };
+
+    static constexpr uint32_t QUEUE_SIZE = 8;
+
+    void Reset();
+    void Push(Command command);
+    void Apply(Command command);
+    void CloseLoop();
+    void StartOverdub();
+    void SwapLayers();
+
+    // Record or play from frame offset of the block; returns frames used
+    size_t RecordSegment(size_t offset, size_t size);
+    size_t LoopSegment(const float* inL, const float* inR, float* outL, float* outR, size_t offset, size_t size);
+    void Step(size_t frames);
+
+    uint32_t* pool_;
+    size_t poolFrames_;
+
+    // Main loop -> audio command queue
+    Command queue_[QUEUE_SIZE];
+    std::atomic<uint32_t> queueWrite_;
+    std::atomic<uint32_t> queueRead_;
+
+    State state_;
+    uint32_t* current_;   // The loop as it plays
+    uint32_t* spare_;     // Second layer, or nullptr when 2L frames do not fit
+    bool undoAvailable_;  // spare_ holds the other side of the last overdub
+    size_t length_;
+    size_t position_;     // Next frame to play
+    bool forward_;
+    bool reverse_;
+
+    // Overdub session into spare_: the arc [lo_, hi_) of frames written so
+    // far, in unwrapped positions from where it started, and the head
+    bool sessionActive_;
+    uint32_t* target_;
+    int64_t lo_;
+    int64_t hi_;
+    int64_t head_;
+
+    // Ramps, per frame
+    size_t crossfade_;
+    float rampStep_;
+    float overdubLevel_;
+    float dubGain_;
+    float dubTarget_;
+    float outGain_;
+    float outTarget_;
+    Fade fade_;
+
+    // Closing crossfade: frames of the loop start still to be blended
+    size_t tail_;
+    size_t loopFade_;
+
+    // Output crossfade from another layer after an undo
+    const uint32_t* swapFrom_;
+    size_t swapLeft_;
+    size_t swapFrames_;
+
+    uint32_t inFrames_[MAX_BLOCK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_LOOPER_H
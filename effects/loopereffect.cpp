@@ -0,0 +1,154 @@
+#include "loopereffect.h"
+#include "../controls.h"
+#include "daisy_seed.h"
+
+using namespace perspective;
+
+// Level, Overdub, Crossfade, Record, Undo, Reverse, Stop, Clear, Track, Track Level
+static constexpr ParameterDescriptor LOOPER_PARAMETERS[] = {
+    PotentiometerParameter("Level", 0.0f, 1.0f, 1.0f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Overdub", 0.0f, 1.0f, 1.0f, PotCurve::LIN, KNOB_2_IDX),     // Loop level kept per overdubbed pass
+    PotentiometerParameter("Crossfade", 0.0f, 50.0f, 10.0f, PotCurve::LIN, KNOB_3_IDX), // ms
+    ToggleParameter("Record", false, SWITCH_1_IDX),
+    ToggleParameter("Undo", false, ENCODER_1_BUTTON_IDX),
+    ToggleParameter("Reverse", false, ENCODER_2_BUTTON_IDX),
+    ToggleParameter("Stop", false),  // No panel control (MIDI CC)
+    ToggleParameter("Clear", false), // No panel control (MIDI CC)
+    ToggleParameter("Track", false), // Backing track on/off (MIDI CC)
+    PotentiometerParameter("Track Level", 0.0f, 1.0f, 0.7f), // No panel control (MIDI CC)
+};
+
+static constexpr const char* BACKING_TRACK_PATH = "backing.wav";
+
+// Loop memory: packed 16-bit stereo frames, 262s at 48kHz
+static constexpr size_t LOOPER_POOL_FRAMES = 3 << 22;
+static uint32_t DSY_SDRAM_BSS g_looperPool[LOOPER_POOL_FRAMES];
+
+LooperEffect::LooperEffect()
+    : Effect("Looper"),
+      backing_(nullptr),
+      record_(false),
+      undo_(false),
+      stop_(false),
+      clear_(false),
+      track_(false) {
+}
+
+LooperEffect::~LooperEffect() {
+}
+
+void LooperEffect::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+
+    // Only the recorded part of the pool is ever read, so it is not cleared
+    looper_.Init(g_looperPool, LOOPER_POOL_FRAMES);
+
+    SetParameterLayout(LOOPER_PARAMETERS, params_);
+    record_ = params_.IsOn(Param::RECORD);
+    undo_ = params_.IsOn(Param::UNDO);
+    stop_ = params_.IsOn(Param::STOP);
+    clear_ = params_.IsOn(Param::CLEAR);
+    track_ = false;
+
+    // Set default looper parameters
+    Update();
+}
+
+void LooperEffect::Process(float* in, float* out, size_t size) {
+    if (!enabled_) {
+        // Bypass - pass through dry signal
+        for (size_t i = 0; i < size; i++) {
+            out[i] = in[i];
+        }
+        return;
+    }
+
+    // The loop (and backing track) is summed to mono over the dry signal
+    float level = params_[Param::LEVEL];
+    float trackLevel = params_[Param::TRACK_LEVEL];
+    bool playing = backing_ && backing_->IsOpen();
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        size_t chunk = size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE;
+        looper_.Process(in + offset, in + offset, wetL_, wetR_, chunk);
+        if (playing) {
+            backing_->ReadFrames(trackL_, trackR_, chunk);
+            for (size_t i = 0; i < chunk; i++) {
+                wetL_[i] += trackL_[i] * trackLevel;
+                wetR_[i] += trackR_[i] * trackLevel;
+            }
+        }
+        for (size_t i = 0; i < chunk; i++) {
+            out[offset + i] = in[offset + i] + 0.5f * (wetL_[i] + wetR_[i]) * level;
+        }
+    }
+}
+
+void LooperEffect::ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) {
+    if (!enabled_) {
+        // Bypass - pass through dry signal
+        for (size_t i = 0; i < size; i++) {
+            outL[i] = inL[i];
+            outR[i] = inR[i];
+        }
+        return;
+    }
+
+    // Level is on knob 1, but MIDI CC 16 (value 1) can point the expression
+    // pedal at it instead, and then it is swept per sample
+    float level = params_[Param::LEVEL];
+    const float* levelMod = GetModulation(Param::LEVEL);
+    float trackLevel = params_[Param::TRACK_LEVEL];
+    bool playing = backing_ && backing_->IsOpen();
+
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        size_t chunk = size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE;
+        looper_.Process(inL + offset, inR + offset, wetL_, wetR_, chunk);
+        if (playing) {
+            // Read ahead by the main loop, so this is a copy from SDRAM
+            backing_->ReadFrames(trackL_, trackR_, chunk);
+            for (size_t i = 0; i < chunk; i++) {
+                wetL_[i] += trackL_[i] * trackLevel;
+                wetR_[i] += trackR_[i] * trackLevel;
+            }
+        }
+        for (size_t i = 0; i < chunk; i++) {
+            if (levelMod) level = levelMod[offset + i];
+            outL[offset + i] = inL[offset + i] + wetL_[i] * level;
+            outR[offset + i] = inR[offset + i] + wetR_[i] * level;
+        }
+    }
+}
+
+void LooperEffect::Update() {
+    looper_.SetOverdubLevel(params_[Param::OVERDUB]);
+    looper_.SetCrossfade(static_cast<size_t>(params_[Param::CROSSFADE] * 0.001f * sampleRate_));
+    looper_.SetReverse(params_.IsOn(Param::REVERSE));
+
+    // Each change of a command toggle is a press
+    bool record = params_.IsOn(Param::RECORD);
+    if (record != record_) looper_.Record();
+    record_ = record;
+
+    bool undo = params_.IsOn(Param::UNDO);
+    if (undo != undo_) looper_.Undo();
+    undo_ = undo;
+
+    bool stop = params_.IsOn(Param::STOP);
+    if (stop != stop_) looper_.Stop();
+    stop_ = stop;
+
+    bool clear = params_.IsOn(Param::CLEAR);
+    if (clear != clear_) looper_.Clear();
+    clear_ = clear;
+
+    // Opening reads ahead from the card, which is main loop work like this
+    bool track = params_.IsOn(Param::TRACK);
+    if (backing_ && track != track_) {
+        if (track) {
+            backing_->OpenWav(BACKING_TRACK_PATH, true);
+        } else {
+            backing_->Close();
+        }
+    }
+    track_ = track;
+}
@@ -0,0 +1,62 @@
+#ifndef PERSPECTIVE_LOOPEREFFECT_H
+#define PERSPECTIVE_LOOPEREFFECT_H
+
+#include "../effect.h"
+#include "../streamreader.h"
+#include "looper.h"
+
+namespace perspective {
+
+// Stereo looper (see Looper) over 48MB of SDRAM: loops up to 4.3 minutes at
+// 48kHz, with undo for loops up to half that. The memory is shared, so only
+// one instance can exist.
+//
+// Switch 1 steps record -> play -> overdub -> play; the encoder 1 button
+// undoes (and redoes) the last overdub and the encoder 2 button reverses.
+// Stop and Clear are on MIDI. The buttons' toggle parameters act on every
+// change of value, so each press is one command.
+//
+// A backing track (backing.wav on the SD card, 1 or 2 channels, played at
+// the pedal's rate) can loop under the output. It is started and stopped
+// from MIDI and is not recorded into the loop.
+class LooperEffect : public Effect {
+public:
+    LooperEffect();
+    ~LooperEffect() override;
+
+    void Init(float sampleRate) override;
+    void Process(float* in, float* out, size_t size) override;
+    void ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) override;
+    void Update() override;
+
+    // Stream for the backing track (SD card). Set before Init.
+    void SetBackingTrack(StreamReader* track) { backing_ = track; }
+
+    inline const Looper& GetLooper() const { return looper_; }
+
+private:
+    // Parameters, in table order
+    enum class Param { LEVEL, OVERDUB, CROSSFADE, RECORD, UNDO, REVERSE, STOP, CLEAR, TRACK, TRACK_LEVEL, COUNT };
+    ParameterValues<Param> params_;
+
+    static constexpr size_t CHUNK_SIZE = Looper::MAX_BLOCK_SIZE;
+
+    Looper looper_;
+    StreamReader* backing_;
+
+    // Last seen toggle values, to turn presses into commands
+    bool record_;
+    bool undo_;
+    bool stop_;
+    bool clear_;
+    bool track_;
+
+    float wetL_[CHUNK_SIZE];
+    float wetR_[CHUNK_SIZE];
+    float trackL_[CHUNK_SIZE];
+    float trackR_[CHUNK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_LOOPEREFFECT_H
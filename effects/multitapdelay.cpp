@@ -0,0 +1,102 @@
+#include "multitapdelay.h"
+
+#include <math.h>
+#include <string.h>
+
+using namespace perspective;
+
+MultiTapDelay::MultiTapDelay()
+    : buffer_(nullptr),
+      mask_(0),
+      write_(0),
+      count_(0),
+      feedback_(0.0f) {
+    for (int i = 0; i < MAX_TAPS; i++) {
+        taps_[i].delay = MAX_BLOCK_SIZE;
+        taps_[i].gainL = 0.0f;
+        taps_[i].gainR = 0.0f;
+    }
+}
+
+void MultiTapDelay::Init(float* buffer, size_t size) {
+    buffer_ = buffer;
+    mask_ = static_cast<uint32_t>(size - 1);
+    Clear();
+}
+
+void MultiTapDelay::Clear() {
+    if (buffer_) {
+        memset(buffer_, 0, (mask_ + 1) * sizeof(float));
+    }
+    write_ = 0;
+}
+
+void MultiTapDelay::SetTap(int tap, float delaySamples, float gain, float pan) {
+    if (tap < 0 || tap >= MAX_TAPS) return;
+
+    float maxDelay = static_cast<float>(GetMaxDelay());
+    if (delaySamples < static_cast<float>(MAX_BLOCK_SIZE)) delaySamples = static_cast<float>(MAX_BLOCK_SIZE);
+    if (delaySamples > maxDelay) delaySamples = maxDelay;
+    pan = pan < -1.0f ? -1.0f : (pan > 1.0f ? 1.0f : pan);
+
+    // Equal-power pan
+    float angle = (pan + 1.0f) * 0.785398163f;
+    taps_[tap].delay = static_cast<uint32_t>(delaySamples + 0.5f);
+    taps_[tap].gainL = gain * cosf(angle);
+    taps_[tap].gainR = gain * sinf(angle);
+}
+
+void MultiTapDelay::SetTapCount(int count) {
+    count_ = count < 0 ? 0 : (count > MAX_TAPS ? MAX_TAPS : count);
+}
+
+void MultiTapDelay::Gather(uint32_t start, float gainL, float gainR, float* outL, float* outR, size_t size) const {
+    start &= mask_;
+    size_t first = mask_ + 1 - start;
+    if (first > size) first = size;
+
+    const float* src = buffer_ + start;
+    for (size_t i = 0; i < first; i++) {
+        outL[i] += gainL * src[i];
+        outR[i] += gainR * src[i];
+    }
+
+    // Wrapped remainder from the start of the buffer
+    for (size_t i = first; i < size; i++) {
+        outL[i] += gainL * buffer_[i - first];
+        outR[i] += gainR * buffer_[i - first];
+    }
+}
+
+void MultiTapDelay::Copy(uint32_t start, float* out, size_t size) const {
+    start &= mask_;
+    size_t first = mask_ + 1 - start;
+    if (first > size) first = size;
+    memcpy(out, buffer_ + start, first * sizeof(float));
+    memcpy(out + first, buffer_, (size - first) * sizeof(float));
+}
+
+void MultiTapDelay::Process(const float* inL, const float* inR, float* outL, float* outR, size_t size) {
+    memset(outL, 0, size * sizeof(float));
+    memset(outR, 0, size * sizeof(float));
+    if (!buffer_ || count_ == 0) return;
+    if (size > MAX_BLOCK_SIZE) size = MAX_BLOCK_SIZE;
+
+    // Feedback from the longest tap, read before this block is written
+    uint32_t longest = 0;
+    for (int t = 0; t < count_; t++) {
+        if (taps_[t].delay > longest) longest = taps_[t].delay;
+    }
+    Copy(write_ - longest, feedbackBuffer_, size);
+
+    // The one write: mono input plus feedback
+    for (size_t i = 0; i < size; i++) {
+        buffer_[(write_ + i) & mask_] = 0.5f * (inL[i] + inR[i]) + feedback_ * feedbackBuffer_[i];
+    }
+
+    for (int t = 0; t < count_; t++) {
+        Gather(write_ - taps_[t].delay, taps_[t].gainL, taps_[t].gainR, outL, outR, size);
+    }
+
+    write_ = (write_ + static_cast<uint32_t>(size)) & mask_;
+}
@@ -0,0 +1,61 @@
+#ifndef PERSPECTIVE_MULTITAPDELAY_H
+#define PERSPECTIVE_MULTITAPDELAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Up to eight taps read from one shared delay buffer (SDRAM on the pedal,
+// supplied by the caller). Each block is one write of the mono input plus
+// feedback, then one gather per tap: the tap's read span is at most two
+// contiguous runs of the buffer (split where it wraps), each accumulated into
+// both output channels with the tap's panned gains. Tap delays are whole
+// samples and at least MAX_BLOCK_SIZE, so no read touches the block being
+// written and the feedback can be taken before the write.
+class MultiTapDelay {
+public:
+    static constexpr int MAX_TAPS = 8;
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+
+    MultiTapDelay();
+
+    // size must be a power of two
+    void Init(float* buffer, size_t size);
+    void Clear();
+
+    // Delay in samples (clamped to MAX_BLOCK_SIZE - buffer size), gain, pan -1.0 (left) to 1.0 (right)
+    void SetTap(int tap, float delaySamples, float gain, float pan);
+    void SetTapCount(int count);
+    // Fed back from the longest active tap
+    void SetFeedback(float feedback) { feedback_ = feedback; }
+
+    inline int GetTapCount() const { return count_; }
+    inline size_t GetMaxDelay() const { return mask_ + 1 - MAX_BLOCK_SIZE; }
+
+    // Wet signal only; size <= MAX_BLOCK_SIZE
+    void Process(const float* inL, const float* inR, float* outL, float* outR, size_t size);
+
+private:
+    struct Tap {
+        uint32_t delay;
+        float gainL;
+        float gainR;
+    };
+
+    // Adds gainL/gainR times the span [start, start + size) of the buffer
+    void Gather(uint32_t start, float gainL, float gainR, float* outL, float* outR, size_t size) const;
+    void Copy(uint32_t start, float* out, size_t size) const;
+
+    float* buffer_;
+    uint32_t mask_;
+    uint32_t write_;
+    Tap taps_[MAX_TAPS];
+    int count_;
+    float feedback_;
+    float feedbackBuffer_[MAX_BLOCK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_MULTITAPDELAY_H
@@ -0,0 +1,693 @@
+#include "nammodel.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ARM_MATH_CM7)
+#include "arm_math.h"
+#endif
+
+using namespace perspective;
+
+// Minimal JSON reader for .nam files. Works on a bounded, possibly
+// unterminated buffer; only what the .nam format needs is supported
+// (no escape decoding in keys or values we compare).
+
+static const char* SkipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    return p;
+}
+
+static const char* SkipString(const char* p, const char* end) {
+    // p is on the opening quote; returns just past the closing quote
+    for (p++; p < end; p++) {
+        if (*p == '\\') {
+            p++;
+        } else if (*p == '"') {
+            return p + 1;
+        }
+    }
+    return nullptr;
+}
+
+static const char* SkipValue(const char* p, const char* end) {
+    p = SkipSpace(p, end);
+    if (p >= end) return nullptr;
+
+    if (*p == '"') return SkipString(p, end);
+
+    if (*p == '{' || *p == '[') {
+        int depth = 0;
+        while (p < end) {
+            if (*p == '"') {
+                p = SkipString(p, end);
+                if (!p) return nullptr;
+                continue;
+            }
+            if (*p == '{' || *p == '[') depth++;
+            if (*p == '}' || *p == ']') {
+                if (--depth == 0) return p + 1;
+            }
+            p++;
+        }
+        return nullptr;
+    }
+
+    // Number or literal
+    while (p < end && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') p++;
+    return p;
+}
+
+// Finds key in the object at p; returns the start of its value or nullptr
+static const char* FindKey(const char* p, const char* end, const char* key) {
+    p = SkipSpace(p, end);
+    if (p >= end || *p != '{') return nullptr;
+    size_t keyLength = strlen(key);
+
+    p++;
+    while (true) {
+        p = SkipSpace(p, end);
+        if (p >= end || *p == '}') return nullptr;
+        if (*p != '"') return nullptr;
+
+        const char* name = p + 1;
+        p = SkipString(p, end);
+        if (!p) return nullptr;
+        bool match = static_cast<size_t>(p - 1 - name) == keyLength && !memcmp(name, key, keyLength);
+
+        p = SkipSpace(p, end);
+        if (p >= end || *p != ':') return nullptr;
+        p = SkipSpace(p + 1, end);
+        if (match) return p;
+
+        p = SkipValue(p, end);
+        if (!p) return nullptr;
+        p = SkipSpace(p, end);
+        if (p < end && *p == ',') p++;
+    }
+}
+
+static bool ParseFloat(const char* p, const char* end, float& value) {
+    p = SkipSpace(p, end);
+    if (p >= end) return false;
+    // Copy out so strtof never runs off the end of an unterminated buffer
+    char text[40];
+    size_t n = 0;
+    while (p < end && n < sizeof(text) - 1 && (strchr("+-.eE", *p) || (*p >= '0' && *p <= '9'))) {
+        text[n++] = *p++;
+    }
+    if (n == 0) return false;
+    text[n] = '\0';
+    char* stop;
+    value = strtof(text, &stop);
+    return stop != text;
+}
+
+static bool ParseInt(const char* p, const char* end, int& value) {
+    float f;
+    if (!p || !ParseFloat(p, end, f)) return false;
+    value = static_cast<int>(f);
+    return true;
+}
+
+static bool ParseBool(const char* p, const char* end, bool& value) {
+    if (!p) return false;
+    p = SkipSpace(p, end);
+    if (end - p >= 4 && !memcmp(p, "true", 4)) {
+        value = true;
+        return true;
+    }
+    if (end - p >= 5 && !memcmp(p, "false", 5)) {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+static bool StringEquals(const char* p, const char* end, const char* text) {
+    if (!p) return false;
+    p = SkipSpace(p, end);
+    if (p >= end || *p != '"') return false;
+    size_t length = strlen(text);
+    return static_cast<size_t>(end - p) > length + 1 && !memcmp(p + 1, text, length) && p[length + 1] == '"';
+}
+
+// Walks the flat "weights" array one value at a time
+class WeightReader {
+public:
+    WeightReader(const char* p, const char* end) : p_(SkipSpace(p, end)), end_(end), count_(0), ok_(true) {
+        if (p_ >= end_ || *p_ != '[') {
+            ok_ = false;
+        } else {
+            p_++;
+        }
+    }
+
+    void Read(float* out, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = Next();
+        }
+    }
+
+    float Next() {
+        if (!ok_) return 0.0f;
+        p_ = SkipSpace(p_, end_);
+        if (p_ < end_ && *p_ == ',') p_ = SkipSpace(p_ + 1, end_);
+        float value;
+        if (p_ >= end_ || *p_ == ']' || !ParseFloat(p_, end_, value)) {
+            ok_ = false;
+            return 0.0f;
+        }
+        p_ = SkipValue(p_, end_);
+        if (!p_) {
+            p_ = end_;
+            ok_ = false;
+        }
+        count_++;
+        return value;
+    }
+
+    // True when every value was read and nothing is left over
+    bool Finished() {
+        if (!ok_) return false;
+        p_ = SkipSpace(p_, end_);
+        return p_ < end_ && *p_ == ']';
+    }
+
+    inline size_t GetCount() const { return count_; }
+
+private:
+    const char* p_;
+    const char* end_;
+    size_t count_;
+    bool ok_;
+};
+
+// NeuralAmpModelerCore's fast_tanh
+static inline float FastTanh(float x) {
+    const float ax = fabsf(x);
+    const float x2 = x * x;
+    return (x * (2.45550750702956f + 2.45550750702956f * ax + (0.893229853513558f + 0.821226666969744f * ax) * x2)) /
+           (2.44506634652299f + (2.44506634652299f + x2) * fabsf(x + 0.814642734961073f * x * ax));
+}
+
+static inline float FastSigmoid(float x) {
+    return 0.5f * (1.0f + FastTanh(0.5f * x));
+}
+
+// y = W x (or y += W x), W row-major rows x cols
+static inline void Gemv(const float* w, const float* x, float* y, int rows, int cols, bool accumulate) {
+    for (int r = 0; r < rows; r++) {
+        const float* row = w + r * cols;
+        float sum;
+#if defined(ARM_MATH_CM7)
+        arm_dot_prod_f32(const_cast<float*>(row), const_cast<float*>(x), static_cast<uint32_t>(cols), &sum);
+#else
+        float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        int c = 0;
+        for (; c + 4 <= cols; c += 4) {
+            s0 += row[c] * x[c];
+            s1 += row[c + 1] * x[c + 1];
+            s2 += row[c + 2] * x[c + 2];
+            s3 += row[c + 3] * x[c + 3];
+        }
+        for (; c < cols; c++) {
+            s0 += row[c] * x[c];
+        }
+        sum = (s0 + s1) + (s2 + s3);
+#endif
+        y[r] = accumulate ? y[r] + sum : sum;
+    }
+}
+
+NamModel::NamModel()
+    : arena_(nullptr),
+      arenaSize_(0),
+      used_(0),
+      maxBlockSize_(0),
+      weightCount_(0),
+      architecture_(Architecture::NONE),
+      sampleRate_(0.0f),
+      lstmLayers_(0),
+      hiddenSize_(0),
+      headWeight_(nullptr),
+      headBias_(0.0f),
+      numArrays_(0),
+      headScale_(1.0f),
+      current_(nullptr),
+      next_(nullptr),
+      z_(nullptr),
+      headSum_(nullptr),
+      headOut_(nullptr) {
+}
+
+void NamModel::SetArena(float* arena, size_t floats) {
+    Unload();
+    arena_ = arena;
+    arenaSize_ = floats;
+}
+
+void NamModel::Unload() {
+    architecture_ = Architecture::NONE;
+    used_ = 0;
+    weightCount_ = 0;
+    sampleRate_ = 0.0f;
+    lstmLayers_ = 0;
+    numArrays_ = 0;
+}
+
+float* NamModel::Allocate(size_t floats) {
+    // Keep every tensor 8-byte aligned for the dot products
+    floats = (floats + 1) & ~static_cast<size_t>(1);
+    if (!arena_ || used_ + floats > arenaSize_) return nullptr;
+    float* p = arena_ + used_;
+    used_ += floats;
+    return p;
+}
+
+const char* NamModel::GetResultName(LoadResult result) {
+    switch (result) {
+        case LoadResult::OK: return "ok";
+        case LoadResult::PARSE_ERROR: return "parse error";
+        case LoadResult::UNSUPPORTED: return "unsupported model";
+        case LoadResult::TOO_LARGE: return "model too large";
+        case LoadResult::WEIGHT_MISMATCH: return "weight count mismatch";
+    }
+    return "";
+}
+
+NamModel::LoadResult NamModel::Load(const char* json, size_t length, size_t maxBlockSize) {
+    Unload();
+    if (!json || maxBlockSize < 1) return LoadResult::PARSE_ERROR;
+
+    const char* end = json + length;
+    const char* architecture = FindKey(json, end, "architecture");
+    const char* config = FindKey(json, end, "config");
+    const char* weights = FindKey(json, end, "weights");
+    if (!architecture || !config || !weights) return LoadResult::PARSE_ERROR;
+
+    maxBlockSize_ = maxBlockSize;
+    LoadResult result;
+    if (StringEquals(architecture, end, "LSTM")) {
+        result = LoadLstm(config, weights, end);
+    } else if (StringEquals(architecture, end, "WaveNet")) {
+        result = LoadWaveNet(config, weights, end);
+    } else {
+        result = LoadResult::UNSUPPORTED;
+    }
+
+    if (result != LoadResult::OK) {
+        Unload();
+        return result;
+    }
+
+    float rate;
+    const char* sampleRate = FindKey(json, end, "sample_rate");
+    sampleRate_ = sampleRate && ParseFloat(sampleRate, end, rate) ? rate : 0.0f;
+
+    Reset();
+    return LoadResult::OK;
+}
+
+NamModel::LoadResult NamModel::LoadLstm(const char* config, const char* weights, const char* end) {
+    int layers, inputSize, hiddenSize;
+    if (!ParseInt(FindKey(config, end, "num_layers"), end, layers) ||
+        !ParseInt(FindKey(config, end, "input_size"), end, inputSize) ||
+        !ParseInt(FindKey(config, end, "hidden_size"), end, hiddenSize)) {
+        return LoadResult::PARSE_ERROR;
+    }
+    if (layers < 1 || layers > MAX_LSTM_LAYERS || inputSize != 1 || hiddenSize < 1) {
+        return LoadResult::UNSUPPORTED;
+    }
+
+    WeightReader reader(weights, end);
+    int h = hiddenSize;
+    for (int l = 0; l < layers; l++) {
+        LstmLayer& layer = lstm_[l];
+        layer.inputSize = l == 0 ? inputSize : h;
+        int cols = layer.inputSize + h;
+        layer.w = Allocate(4 * h * cols);
+        layer.b = Allocate(4 * h);
+        layer.xh = Allocate(cols);
+        layer.c = Allocate(h);
+        layer.h0 = Allocate(h);
+        layer.c0 = Allocate(h);
+        layer.ifgo = Allocate(4 * h);
+        if (!layer.ifgo) return LoadResult::TOO_LARGE;
+
+        reader.Read(layer.w, 4 * h * cols);
+        reader.Read(layer.b, 4 * h);
+        reader.Read(layer.h0, h);
+        reader.Read(layer.c0, h);
+    }
+    headWeight_ = Allocate(h);
+    if (!headWeight_) return LoadResult::TOO_LARGE;
+    reader.Read(headWeight_, h);
+    headBias_ = reader.Next();
+
+    if (!reader.Finished()) return LoadResult::WEIGHT_MISMATCH;
+
+    weightCount_ = reader.GetCount();
+    lstmLayers_ = layers;
+    hiddenSize_ = h;
+    architecture_ = Architecture::LSTM;
+    return LoadResult::OK;
+}
+
+NamModel::LoadResult NamModel::LoadWaveNet(const char* config, const char* weights, const char* end) {
+    const char* arrays = FindKey(config, end, "layers");
+    float headScale;
+    if (!arrays || !ParseFloat(FindKey(config, end, "head_scale"), end, headScale)) {
+        return LoadResult::PARSE_ERROR;
+    }
+    const char* head = FindKey(config, end, "head");
+    if (head && !(end - head >= 4 && !memcmp(head, "null", 4))) {
+        return LoadResult::UNSUPPORTED;  // Post-stack heads are not supported
+    }
+
+    // First pass: shapes, so every allocation size is known
+    const char* p = SkipSpace(arrays, end);
+    if (p >= end || *p != '[') return LoadResult::PARSE_ERROR;
+    p++;
+
+    int numArrays = 0;
+    int numLayers = 0;
+    int width = 1;
+    while (true) {
+        p = SkipSpace(p, end);
+        if (p < end && *p == ',') p = SkipSpace(p + 1, end);
+        if (p >= end) return LoadResult::PARSE_ERROR;
+        if (*p == ']') break;
+        if (numArrays >= MAX_LAYER_ARRAYS) return LoadResult::UNSUPPORTED;
+
+        LayerArray& array = arrays_[numArrays];
+        if (!ParseInt(FindKey(p, end, "input_size"), end, array.inputSize) ||
+            !ParseInt(FindKey(p, end, "condition_size"), end, array.conditionSize) ||
+            !ParseInt(FindKey(p, end, "head_size"), end, array.headSize) ||
+            !ParseInt(FindKey(p, end, "channels"), end, array.channels) ||
+            !ParseInt(FindKey(p, end, "kernel_size"), end, array.kernelSize) ||
+            !ParseBool(FindKey(p, end, "gated"), end, array.gated) ||
+            !ParseBool(FindKey(p, end, "head_bias"), end, array.hasHeadBias)) {
+            return LoadResult::PARSE_ERROR;
+        }
+
+        const char* activation = FindKey(p, end, "activation");
+        if (StringEquals(activation, end, "Tanh") || StringEquals(activation, end, "Fasttanh")) {
+            array.activation = Activation::TANH;
+        } else if (StringEquals(activation, end, "Hardtanh")) {
+            array.activation = Activation::HARDTANH;
+        } else if (StringEquals(activation, end, "ReLU")) {
+            array.activation = Activation::RELU;
+        } else if (StringEquals(activation, end, "Sigmoid")) {
+            array.activation = Activation::SIGMOID;
+        } else {
+            return LoadResult::UNSUPPORTED;
+        }
+
+        // The condition is the dry input; each array's head feeds the next one's head sum
+        if (array.conditionSize != 1 || array.channels < 1 || array.kernelSize < 1 || array.headSize < 1 ||
+            array.inputSize != (numArrays == 0 ? 1 : arrays_[numArrays - 1].channels) ||
+            (numArrays > 0 && arrays_[numArrays - 1].headSize != array.channels)) {
+            return LoadResult::UNSUPPORTED;
+        }
+
+        const char* dilations = FindKey(p, end, "dilations");
+        if (!dilations || *dilations != '[') return LoadResult::PARSE_ERROR;
+        array.firstLayer = numLayers;
+        array.numLayers = 0;
+        dilations++;
+        while (true) {
+            dilations = SkipSpace(dilations, end);
+            if (dilations < end && *dilations == ',') dilations++;
+            dilations = SkipSpace(dilations, end);
+            if (dilations >= end) return LoadResult::PARSE_ERROR;
+            if (*dilations == ']') break;
+            if (numLayers >= MAX_WAVENET_LAYERS) return LoadResult::UNSUPPORTED;
+            int dilation;
+            if (!ParseInt(dilations, end, dilation) || dilation < 1) return LoadResult::PARSE_ERROR;
+            layers_[numLayers++].dilation = dilation;
+            array.numLayers++;
+            dilations = SkipValue(dilations, end);
+            if (!dilations) return LoadResult::PARSE_ERROR;
+        }
+
+        int z = array.gated ? 2 * array.channels : array.channels;
+        if (z > width) width = z;
+        if (array.headSize > width) width = array.headSize;
+        if (array.inputSize > width) width = array.inputSize;
+
+        numArrays++;
+        p = SkipValue(p, end);
+        if (!p) return LoadResult::PARSE_ERROR;
+    }
+    if (numArrays == 0) return LoadResult::PARSE_ERROR;
+
+    // Second pass: allocate and read the weights in NAM order
+    size_t block = maxBlockSize_;
+    current_ = Allocate(block * width);
+    next_ = Allocate(block * width);
+    z_ = Allocate(block * width);
+    headSum_ = Allocate(block * width);
+    headOut_ = Allocate(block * width);
+    if (!headOut_) return LoadResult::TOO_LARGE;
+
+    WeightReader reader(weights, end);
+    for (int a = 0; a < numArrays; a++) {
+        LayerArray& array = arrays_[a];
+        int c = array.channels;
+        int z = array.gated ? 2 * c : c;
+        int k = array.kernelSize;
+
+        array.rechannel = Allocate(c * array.inputSize);
+        if (!array.rechannel) return LoadResult::TOO_LARGE;
+        reader.Read(array.rechannel, c * array.inputSize);
+
+        for (int l = array.firstLayer; l < array.firstLayer + array.numLayers; l++) {
+            WaveNetLayer& layer = layers_[l];
+            layer.conv = Allocate(k * z * c);
+            layer.convBias = Allocate(z);
+            layer.mixin = Allocate(z * array.conditionSize);
+            layer.out = Allocate(c * c);
+            layer.outBias = Allocate(c);
+            layer.ringFrames = (k - 1) * layer.dilation + static_cast<int>(block);
+            layer.ringPos = 0;
+            layer.ring = Allocate(static_cast<size_t>(layer.ringFrames) * c);
+            if (!layer.ring) return LoadResult::TOO_LARGE;
+
+            // Conv1D: for each output, input, tap - stored here tap-major
+            for (int o = 0; o < z; o++) {
+                for (int i = 0; i < c; i++) {
+                    for (int t = 0; t < k; t++) {
+                        layer.conv[(t * z + o) * c + i] = reader.Next();
+                    }
+                }
+            }
+            reader.Read(layer.convBias, z);
+            reader.Read(layer.mixin, z * array.conditionSize);
+            reader.Read(layer.out, c * c);
+            reader.Read(layer.outBias, c);
+        }
+
+        array.head = Allocate(array.headSize * c);
+        array.headBias = array.hasHeadBias ? Allocate(array.headSize) : nullptr;
+        if (!array.head || (array.hasHeadBias && !array.headBias)) return LoadResult::TOO_LARGE;
+        reader.Read(array.head, array.headSize * c);
+        if (array.hasHeadBias) reader.Read(array.headBias, array.headSize);
+    }
+    headScale_ = reader.Next();
+
+    if (!reader.Finished()) return LoadResult::WEIGHT_MISMATCH;
+
+    weightCount_ = reader.GetCount();
+    numArrays_ = numArrays;
+    architecture_ = Architecture::WAVENET;
+    return LoadResult::OK;
+}
+
+void NamModel::Reset() {
+    for (int l = 0; l < lstmLayers_; l++) {
+        LstmLayer& layer = lstm_[l];
+        for (int i = 0; i < layer.inputSize; i++) {
+            layer.xh[i] = 0.0f;
+        }
+        memcpy(layer.xh + layer.inputSize, layer.h0, hiddenSize_ * sizeof(float));
+        memcpy(layer.c, layer.c0, hiddenSize_ * sizeof(float));
+    }
+    for (int a = 0; a < numArrays_; a++) {
+        const LayerArray& array = arrays_[a];
+        for (int l = array.firstLayer; l < array.firstLayer + array.numLayers; l++) {
+            memset(layers_[l].ring, 0, static_cast<size_t>(layers_[l].ringFrames) * array.channels * sizeof(float));
+            layers_[l].ringPos = 0;
+        }
+    }
+}
+
+void NamModel::Process(const float* in, float* out, size_t size) {
+    if (size > maxBlockSize_) size = maxBlockSize_;
+
+    switch (architecture_) {
+        case Architecture::LSTM:
+            for (size_t i = 0; i < size; i++) {
+                out[i] = ProcessLstmSample(in[i]);
+            }
+            break;
+
+        case Architecture::WAVENET:
+            ProcessWaveNet(in, out, size);
+            break;
+
+        default:
+            memset(out, 0, size * sizeof(float));
+            break;
+    }
+}
+
+float NamModel::ProcessLstmSample(float x) {
+    int h = hiddenSize_;
+    const float* input = &x;
+    for (int l = 0; l < lstmLayers_; l++) {
+        LstmLayer& layer = lstm_[l];
+        for (int i = 0; i < layer.inputSize; i++) {
+            layer.xh[i] = input[i];
+        }
+
+        int cols = layer.inputSize + h;
+        Gemv(layer.w, layer.xh, layer.ifgo, 4 * h, cols, false);
+
+        const float* gi = layer.ifgo;
+        const float* gf = layer.ifgo + h;
+        const float* gg = layer.ifgo + 2 * h;
+        const float* go = layer.ifgo + 3 * h;
+        float* hidden = layer.xh + layer.inputSize;
+        for (int i = 0; i < h; i++) {
+            float c = FastSigmoid(gf[i] + layer.b[h + i]) * layer.c[i] +
+                      FastSigmoid(gi[i] + layer.b[i]) * FastTanh(gg[i] + layer.b[2 * h + i]);
+            layer.c[i] = c;
+            hidden[i] = FastSigmoid(go[i] + layer.b[3 * h + i]) * FastTanh(c);
+        }
+        input = hidden;
+    }
+
+    float y = headBias_;
+    for (int i = 0; i < h; i++) {
+        y += headWeight_[i] * input[i];
+    }
+    return y;
+}
+
+void NamModel::ProcessWaveNet(const float* in, float* out, size_t size) {
+    const float* layerIn = in;
+    int inWidth = 1;
+
+    for (int a = 0; a < numArrays_; a++) {
+        const LayerArray& array = arrays_[a];
+        int c = array.channels;
+
+        // Rechannel the array input into next_, then make it current
+        for (size_t t = 0; t < size; t++) {
+            Gemv(array.rechannel, layerIn + t * inWidth, next_ + t * c, c, inWidth, false);
+        }
+        float* swap = current_;
+        current_ = next_;
+        next_ = swap;
+
+        // The first array's head sum starts at zero, later ones at the previous head output
+        if (a == 0) {
+            memset(headSum_, 0, size * c * sizeof(float));
+        } else {
+            memcpy(headSum_, headOut_, size * c * sizeof(float));
+        }
+
+        for (int l = array.firstLayer; l < array.firstLayer + array.numLayers; l++) {
+            ProcessWaveNetLayer(array, layers_[l], in, size);
+        }
+
+        for (size_t t = 0; t < size; t++) {
+            float* y = headOut_ + t * array.headSize;
+            Gemv(array.head, headSum_ + t * c, y, array.headSize, c, false);
+            if (array.headBias) {
+                for (int i = 0; i < array.headSize; i++) {
+                    y[i] += array.headBias[i];
+                }
+            }
+        }
+
+        layerIn = current_;
+        inWidth = c;
+    }
+
+    int headSize = arrays_[numArrays_ - 1].headSize;
+    for (size_t t = 0; t < size; t++) {
+        out[t] = headScale_ * headOut_[t * headSize];
+    }
+}
+
+void NamModel::ProcessWaveNetLayer(const LayerArray& array, WaveNetLayer& layer, const float* condition, size_t size) {
+    int c = array.channels;
+    int z = array.gated ? 2 * c : c;
+    int k = array.kernelSize;
+    int frames = layer.ringFrames;
+
+    // Append the block to the input history
+    for (size_t t = 0; t < size; t++) {
+        int w = layer.ringPos + static_cast<int>(t);
+        if (w >= frames) w -= frames;
+        memcpy(layer.ring + w * c, current_ + t * c, c * sizeof(float));
+    }
+
+    // Bias and condition mix-in, then one tap of the dilated conv at a time
+    for (size_t t = 0; t < size; t++) {
+        float* zt = z_ + t * z;
+        for (int o = 0; o < z; o++) {
+            zt[o] = layer.convBias[o] + layer.mixin[o] * condition[t];
+        }
+    }
+    for (int tap = 0; tap < k; tap++) {
+        const float* weights = layer.conv + tap * z * c;
+        int offset = (k - 1 - tap) * layer.dilation;
+        for (size_t t = 0; t < size; t++) {
+            int r = layer.ringPos + static_cast<int>(t) - offset;
+            if (r < 0) r += frames;
+            if (r >= frames) r -= frames;
+            Gemv(weights, layer.ring + r * c, z_ + t * z, z, c, true);
+        }
+    }
+    layer.ringPos += static_cast<int>(size);
+    if (layer.ringPos >= frames) layer.ringPos -= frames;
+
+    // Activation (gated: activation of the top half times sigmoid of the bottom half)
+    for (size_t t = 0; t < size; t++) {
+        float* zt = z_ + t * z;
+        for (int i = 0; i < c; i++) {
+            float v = zt[i];
+            switch (array.activation) {
+                case Activation::TANH: v = FastTanh(v); break;
+                case Activation::HARDTANH: v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v); break;
+                case Activation::RELU: v = v < 0.0f ? 0.0f : v; break;
+                case Activation::SIGMOID: v = FastSigmoid(v); break;
+            }
+            if (array.gated) v *= FastSigmoid(zt[c + i]);
+            zt[i] = v;
+        }
+    }
+
+    // Head sum, and the residual 1x1 into the next layer's input
+    for (size_t t = 0; t < size; t++) {
+        const float* zt = z_ + t * z;
+        float* sum = headSum_ + t * c;
+        const float* x = current_ + t * c;
+        float* y = next_ + t * c;
+        for (int i = 0; i < c; i++) {
+            sum[i] += zt[i];
+        }
+        Gemv(layer.out, zt, y, c, c, false);
+        for (int i = 0; i < c; i++) {
+            y[i] += x[i] + layer.outBias[i];
+        }
+    }
+
+    float* swap = current_;
+    current_ = next_;
+    next_ = swap;
+}
@@ -0,0 +1,142 @@
+#ifndef PERSPECTIVE_NAMMODEL_H
+#define PERSPECTIVE_NAMMODEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Inference for Neural Amp Modeler (.nam) models, sized for the Cortex-M7.
+// Load() reads the .nam JSON straight from memory (memory-mapped QSPI on the
+// pedal) and lays the weights and all run-time state out in a fixed arena
+// supplied by the caller - there is no heap or Eigen allocation, and a model
+// that does not fit is rejected at load time.
+// Supports the LSTM and WaveNet architectures with the NeuralAmpModelerCore
+// weight order. WaveNet runs a layer at a time over the whole block, so each
+// layer's weights stay in cache while every frame of the block goes through
+// them; the inner loops are float32 dot products (CMSIS-DSP on the M7).
+// Tanh and sigmoid use NAM's fast tanh approximation.
+class NamModel {
+public:
+    enum class Architecture {
+        NONE,
+        LSTM,
+        WAVENET
+    };
+
+    enum class LoadResult {
+        OK,
+        PARSE_ERROR,       // Not a .nam file, or a field is missing
+        UNSUPPORTED,       // Architecture, activation or shape not handled
+        TOO_LARGE,         // Does not fit the arena
+        WEIGHT_MISMATCH    // Weight count does not match the config
+    };
+
+    NamModel();
+
+    // The arena holds weights, delay history and scratch for one model
+    void SetArena(float* arena, size_t floats);
+
+    // Frames per Process() call must not exceed maxBlockSize
+    LoadResult Load(const char* json, size_t length, size_t maxBlockSize);
+    void Unload();
+
+    // Clears the model state (LSTM cells and WaveNet history)
+    void Reset();
+
+    void Process(const float* in, float* out, size_t size);
+
+    inline bool IsLoaded() const { return architecture_ != Architecture::NONE; }
+    inline Architecture GetArchitecture() const { return architecture_; }
+    inline float GetSampleRate() const { return sampleRate_; }  // 0.0 when the file does not say
+    inline size_t GetArenaUsed() const { return used_; }
+    inline size_t GetWeightCount() const { return weightCount_; }
+    inline size_t GetMaxBlockSize() const { return maxBlockSize_; }
+
+    static const char* GetResultName(LoadResult result);
+
+    static constexpr int MAX_LSTM_LAYERS = 4;
+    static constexpr int MAX_LAYER_ARRAYS = 4;
+    static constexpr int MAX_WAVENET_LAYERS = 48;
+
+private:
+    enum class Activation { TANH, HARDTANH, RELU, SIGMOID };
+
+    struct LstmLayer {
+        int inputSize;
+        float* w;       // 4H x (inputSize + H), row-major; gates i, f, g, o
+        float* b;       // 4H
+        float* xh;      // Input then hidden state
+        float* c;       // Cell state
+        float* h0;      // Initial hidden and cell state from the file
+        float* c0;
+        float* ifgo;    // 4H scratch
+    };
+
+    struct WaveNetLayer {
+        int dilation;
+        float* conv;        // kernelSize taps of Z x C, tap-major
+        float* convBias;    // Z
+        float* mixin;       // Z x conditionSize
+        float* out;         // 1x1, C x C
+        float* outBias;     // C
+        float* ring;        // Input history, ringFrames x C
+        int ringFrames;
+        int ringPos;
+    };
+
+    struct LayerArray {
+        int inputSize;
+        int conditionSize;
+        int headSize;
+        int channels;
+        int kernelSize;
+        int firstLayer;
+        int numLayers;
+        Activation activation;
+        bool gated;
+        bool hasHeadBias;
+        float* rechannel;   // C x inputSize
+        float* head;        // headSize x C
+        float* headBias;    // headSize, or nullptr
+    };
+
+    float* Allocate(size_t floats);
+
+    LoadResult LoadLstm(const char* config, const char* weights, const char* end);
+    LoadResult LoadWaveNet(const char* config, const char* weights, const char* end);
+
+    float ProcessLstmSample(float x);
+    void ProcessWaveNet(const float* in, float* out, size_t size);
+    void ProcessWaveNetLayer(const LayerArray& array, WaveNetLayer& layer, const float* condition, size_t size);
+
+    float* arena_;
+    size_t arenaSize_;
+    size_t used_;
+    size_t maxBlockSize_;
+    size_t weightCount_;
+    Architecture architecture_;
+    float sampleRate_;
+
+    // LSTM
+    int lstmLayers_;
+    int hiddenSize_;
+    LstmLayer lstm_[MAX_LSTM_LAYERS];
+    float* headWeight_;
+    float headBias_;
+
+    // WaveNet
+    int numArrays_;
+    LayerArray arrays_[MAX_LAYER_ARRAYS];
+    WaveNetLayer layers_[MAX_WAVENET_LAYERS];
+    float headScale_;
+    float* current_;    // maxBlock x width, frame-major
+    float* next_;
+    float* z_;          // maxBlock x 2C
+    float* headSum_;    // maxBlock x width
+    float* headOut_;    // maxBlock x width
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_NAMMODEL_H
@@ -0,0 +1,166 @@
+#include "oversampler.h"
+
+#include <math.h>
+#include <string.h>
+
+using namespace perspective;
+
+// Kaiser window shape; about 60dB of image rejection with the stage lengths used
+static constexpr float KAISER_BETA = 6.0f;
+
+static float BesselI0(float x) {
+    // Power series; converges quickly for the betas used here
+    float sum = 1.0f;
+    float term = 1.0f;
+    float q = x * x * 0.25f;
+    for (int k = 1; k < 32; k++) {
+        term *= q / static_cast<float>(k * k);
+        sum += term;
+        if (term < sum * 1e-9f) break;
+    }
+    return sum;
+}
+
+HalfbandFilter::HalfbandFilter()
+    : halfTaps_(0),
+      upPos_(0),
+      downPos_(0) {
+}
+
+void HalfbandFilter::Init(int halfTaps) {
+    halfTaps = halfTaps < 4 ? 4 : (halfTaps > MAX_HALF_TAPS ? MAX_HALF_TAPS : halfTaps);
+    halfTaps_ = halfTaps & ~3;
+
+    // Windowed sinc at the odd offsets 2i + 1 (the even ones are zero), then
+    // scaled so the side taps sum to 0.25 and the DC gain is exactly 1
+    int span = 2 * halfTaps_ - 1;  // Outermost offset
+    float i0Beta = BesselI0(KAISER_BETA);
+    float side[MAX_HALF_TAPS];
+    float sum = 0.0f;
+    for (int i = 0; i < halfTaps_; i++) {
+        float n = static_cast<float>(2 * i + 1);
+        float sinc = sinf(1.57079632679f * n) / (3.14159265359f * n);
+        float r = n / static_cast<float>(span + 1);
+        float window = BesselI0(KAISER_BETA * sqrtf(1.0f - r * r)) / i0Beta;
+        side[i] = sinc * window;
+        sum += side[i];
+    }
+
+    // Folded order: coeffs_[i] pairs window[i] with window[2K - 1 - i], outermost first
+    for (int i = 0; i < halfTaps_; i++) {
+        coeffs_[i] = side[halfTaps_ - 1 - i] * (0.25f / sum);
+    }
+
+    Reset();
+}
+
+void HalfbandFilter::Reset() {
+    memset(upHistory_, 0, sizeof(upHistory_));
+    memset(downEven_, 0, sizeof(downEven_));
+    memset(downOdd_, 0, sizeof(downOdd_));
+    upPos_ = 0;
+    downPos_ = 0;
+}
+
+float HalfbandFilter::Convolve(const float* window) const {
+    int n = 2 * halfTaps_;
+    const float* tail = window + n - 1;
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    for (int i = 0; i < halfTaps_; i += 4) {
+        s0 += coeffs_[i] * (window[i] + tail[-i]);
+        s1 += coeffs_[i + 1] * (window[i + 1] + tail[-i - 1]);
+        s2 += coeffs_[i + 2] * (window[i + 2] + tail[-i - 2]);
+        s3 += coeffs_[i + 3] * (window[i + 3] + tail[-i - 3]);
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+void HalfbandFilter::Upsample(const float* in, float* out, size_t size) {
+    int n = 2 * halfTaps_;
+    for (size_t i = 0; i < size; i++) {
+        upHistory_[upPos_] = in[i];
+        upHistory_[upPos_ + n] = in[i];
+        const float* window = upHistory_ + upPos_ + 1;  // Oldest first, newest last
+
+        // FIR phase (gain 2 for the inserted zeros), then the centre tap's delay phase
+        out[2 * i] = 2.0f * Convolve(window);
+        out[2 * i + 1] = window[halfTaps_];
+
+        if (++upPos_ >= n) upPos_ = 0;
+    }
+}
+
+void HalfbandFilter::Downsample(const float* in, float* out, size_t size) {
+    int n = 2 * halfTaps_;
+    for (size_t i = 0; i < size; i++) {
+        downEven_[downPos_] = in[2 * i];
+        downEven_[downPos_ + n] = in[2 * i];
+        downOdd_[downPos_] = in[2 * i + 1];
+        downOdd_[downPos_ + n] = in[2 * i + 1];
+
+        // Centre tap: the odd sample halfTaps pairs back
+        const float* even = downEven_ + downPos_ + 1;
+        const float* odd = downOdd_ + downPos_ + 1;
+        out[i] = Convolve(even) + 0.5f * odd[halfTaps_ - 1];
+
+        if (++downPos_ >= n) downPos_ = 0;
+    }
+}
+
+Oversampler::Oversampler()
+    : factor_(1) {
+}
+
+void Oversampler::Init(int factor) {
+    factor_ = factor >= 4 ? 4 : (factor >= 2 ? 2 : 1);
+    stage1_.Init(STAGE_1_HALF_TAPS);
+    stage2_.Init(STAGE_2_HALF_TAPS);
+}
+
+void Oversampler::Reset() {
+    stage1_.Reset();
+    stage2_.Reset();
+}
+
+float Oversampler::GetLatency() const {
+    // Each stage delays by GetLatency() samples at its higher rate, once each way
+    float latency = 0.0f;
+    if (factor_ >= 2) latency += static_cast<float>(2 * stage1_.GetLatency()) / 2.0f;
+    if (factor_ >= 4) latency += static_cast<float>(2 * stage2_.GetLatency()) / 4.0f;
+    return latency;
+}
+
+float* Oversampler::Upsample(const float* in, size_t size) {
+    if (size > MAX_BLOCK_SIZE) size = MAX_BLOCK_SIZE;
+
+    switch (factor_) {
+        case 2:
+            stage1_.Upsample(in, buffer_, size);
+            break;
+        case 4:
+            stage1_.Upsample(in, scratch_, size);
+            stage2_.Upsample(scratch_, buffer_, size * 2);
+            break;
+        default:
+            memcpy(buffer_, in, size * sizeof(float));
+            break;
+    }
+    return buffer_;
+}
+
+void Oversampler::Downsample(float* out, size_t size) {
+    if (size > MAX_BLOCK_SIZE) size = MAX_BLOCK_SIZE;
+
+    switch (factor_) {
+        case 2:
+            stage1_.Downsample(buffer_, out, size);
+            break;
+        case 4:
+            stage2_.Downsample(buffer_, scratch_, size * 2);
+            stage1_.Downsample(scratch_, out, size);
+            break;
+        default:
+            memcpy(out, buffer_, size * sizeof(float));
+            break;
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef PERSPECTIVE_OVERSAMPLER_H
+#define PERSPECTIVE_OVERSAMPLER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// One 2x stage: a linear-phase halfband FIR run in polyphase form. Every other
+// tap of a halfband filter is zero and the centre tap is 0.5, so upsampling
+// needs one symmetric FIR phase plus a pure delay, and downsampling needs the
+// same FIR over the even samples plus a delayed odd sample.
+// The non-zero taps are stored folded (one coefficient per symmetric pair) in
+// a contiguous array that is a multiple of 4 long, and the histories are
+// duplicated so each output reads one unbroken window - the inner loops are
+// straight multiply-adds with no wrap or zero-tap branches.
+class HalfbandFilter {
+public:
+    static constexpr int MAX_HALF_TAPS = 16;  // Non-zero side taps per side
+
+    HalfbandFilter();
+
+    // halfTaps must be a multiple of 4: 4 (15 taps) to 16 (63 taps)
+    void Init(int halfTaps);
+    void Reset();
+
+    // out gets 2 * size samples
+    void Upsample(const float* in, float* out, size_t size);
+    // in holds 2 * size samples
+    void Downsample(const float* in, float* out, size_t size);
+
+    inline int GetHalfTaps() const { return halfTaps_; }
+    // Delay of one direction, in samples at the higher rate
+    inline int GetLatency() const { return 2 * halfTaps_ - 1; }
+
+private:
+    static constexpr int MAX_WINDOW = 2 * MAX_HALF_TAPS;
+
+    // Folded FIR over a window of 2 * halfTaps samples, oldest first
+    float Convolve(const float* window) const;
+
+    int halfTaps_;
+    float coeffs_[MAX_HALF_TAPS];
+
+    // Duplicated histories: each sample is written at pos and pos + window
+    float upHistory_[2 * MAX_WINDOW];
+    float downEven_[2 * MAX_WINDOW];
+    float downOdd_[2 * MAX_WINDOW];
+    int upPos_;
+    int downPos_;
+};
+
+// 1x, 2x or 4x oversampling around a nonlinear block, built from cascaded
+// halfband stages (a long stage next to the base rate, where the transition
+// band is narrow, and a short one between 2x and 4x).
+// Usage, per block:
+//     oversampler_.Process(in, out, size, [&](float* x, size_t n) {
+//         for (size_t i = 0; i < n; i++) x[i] = Drive(x[i]);
+//     });
+// or Upsample(), work on the returned buffer, then Downsample(). The core
+// runs at GetFactor() times the effect's sample rate, so filters inside it
+// must be designed for that rate. Use one Oversampler per channel.
+class Oversampler {
+public:
+    static constexpr int MAX_FACTOR = 4;
+    static constexpr size_t MAX_BLOCK_SIZE = 256;  // Base-rate samples per Upsample()
+
+    Oversampler();
+
+    void Init(int factor);  // 1, 2 or 4; anything else is rounded down
+    void Reset();
+
+    inline int GetFactor() const { return factor_; }
+    // Up plus down, in base-rate samples
+    float GetLatency() const;
+
+    // Returns GetFactor() * size samples (size <= MAX_BLOCK_SIZE)
+    float* Upsample(const float* in, size_t size);
+    // Filters the upsampled buffer back down into out
+    void Downsample(float* out, size_t size);
+
+    // Upsample, run core(samples, count) in place, downsample; any block size
+    template <typename Core>
+    void Process(const float* in, float* out, size_t size, Core&& core) {
+        for (size_t offset = 0; offset < size; offset += MAX_BLOCK_SIZE) {
+            size_t chunk = size - offset < MAX_BLOCK_SIZE ? size - offset : MAX_BLOCK_SIZE;
+            float* x = Upsample(in + offset, chunk);
+            core(x, chunk * static_cast<size_t>(factor_));
+            Downsample(out + offset, chunk);
+        }
+    }
+
+    static constexpr int STAGE_1_HALF_TAPS = 12;  // Base <-> 2x, 47 taps
+    static constexpr int STAGE_2_HALF_TAPS = 4;   // 2x <-> 4x, 15 taps
+
+private:
+    int factor_;
+    HalfbandFilter stage1_;
+    HalfbandFilter stage2_;
+    float buffer_[MAX_BLOCK_SIZE * MAX_FACTOR];
+    float scratch_[MAX_BLOCK_SIZE * 2];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_OVERSAMPLER_H
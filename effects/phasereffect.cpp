@@ -1,11 +1,27 @@
 #include "phasereffect.h"
 #include "../controls.h"
+#include <math.h>
 
 using namespace perspective;
 using namespace daisysp;
 
+// Mix, Rate, Depth, Feedback, Poles, Wave
+static constexpr ParameterDescriptor PHASER_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Rate", 0.01f, 10.0f, 0.3f, PotCurve::LOG, KNOB_2_IDX),
+    PotentiometerParameter("Depth", 0.0f, 1.0f, 0.7f, PotCurve::LIN, KNOB_3_IDX),
+    PotentiometerParameter("Feedback", 0.0f, 0.95f, 0.7f, PotCurve::LIN, KNOB_4_IDX),
+    EncoderParameter("Poles", 1.0f, 8.0f, 4.0f, 1.0f, ENCODER_1_IDX),
+    EncoderParameter("Wave", 0.0f, 3.0f, 0.0f, 1.0f, ENCODER_2_IDX), // Sine, triangle, smooth random, S&H
+};
+
 PhaserEffect::PhaserEffect() 
-    : Effect("Phaser") {
+    : Effect("Phaser")
+    , lfoL_(-1)
+    , lfoR_(-1)
+    , poles_(4)
+    , depth_(0.0f)
+    , feedback_(0.0f) {
 }
 
 PhaserEffect::~PhaserEffect() {
@@ -14,16 +30,14 @@ PhaserEffect::~PhaserEffect() {
 void PhaserEffect::Init(float sampleRate) {
     sampleRate_ = sampleRate;
     
-    // Initialize phaser modules for stereo
-    phaserL_.Init(sampleRate);
-    phaserR_.Init(sampleRate);
+    // Initialize allpass chains and LFOs for stereo
+    ResetVoice(voiceL_);
+    ResetVoice(voiceR_);
+    if (lfoL_ < 0) lfoL_ = AllocateLfo();
+    if (lfoR_ < 0) lfoR_ = AllocateLfo();
 
-    // Add parameters: Mix, Rate, Depth, Feedback, Poles
-    AddParameter(new PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX));
-    AddParameter(new PotentiometerParameter("Rate", 0.01f, 10.0f, 0.3f, PotCurve::LOG, KNOB_2_IDX));
-    AddParameter(new PotentiometerParameter("Depth", 0.0f, 1.0f, 0.7f, PotCurve::LIN, KNOB_3_IDX));
-    AddParameter(new PotentiometerParameter("Feedback", 0.0f, 0.95f, 0.7f, PotCurve::LIN, KNOB_4_IDX));
-    AddParameter(new EncoderParameter("Poles", 1.0f, 8.0f, 4.0f, 1.0f, ENCODER_1_IDX));
+    SetParameterLayout(PHASER_PARAMETERS, params_);
+    SetTempoParameter(Param::RATE);
     
     // Set default phaser parameters
     Update();
@@ -38,12 +52,14 @@ void PhaserEffect::Process(float* in, float* out, size_t size) {
         return;
     }
     
-    // Get mix parameter (index 0)
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    // Get mix parameter
+    float mix = params_[Param::MIX];
+    
+    const float* lfo = GetLfoBlock(lfoL_);
     
     // Process with wet/dry blend
     for (size_t i = 0; i < size; i++) {
-        float wet = phaserL_.Process(in[i]);
+        float wet = ProcessVoice(voiceL_, lfo[i], in[i], (i % COEFF_UPDATE_INTERVAL) == 0);
         out[i] = in[i] * (1.0f - mix) + wet * mix;
     }
 }
@@ -58,13 +74,17 @@ void PhaserEffect::ProcessStereo(float* inL, float* inR, float* outL, float* out
         return;
     }
     
-    // Get mix parameter (index 0)
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    // Get mix parameter
+    float mix = params_[Param::MIX];
+    
+    const float* lfoL = GetLfoBlock(lfoL_);
+    const float* lfoR = GetLfoBlock(lfoR_);
     
     // Process stereo signal with independent phaser for each channel
     for (size_t i = 0; i < size; i++) {
-        float wetL = phaserL_.Process(inL[i]);
-        float wetR = phaserR_.Process(inR[i]);
+        bool retune = (i % COEFF_UPDATE_INTERVAL) == 0;
+        float wetL = ProcessVoice(voiceL_, lfoL[i], inL[i], retune);
+        float wetR = ProcessVoice(voiceR_, lfoR[i], inR[i], retune);
         
         outL[i] = inL[i] * (1.0f - mix) + wetL * mix;
         outR[i] = inR[i] * (1.0f - mix) + wetR * mix;
@@ -73,27 +93,48 @@ void PhaserEffect::ProcessStereo(float* inL, float* inR, float* outL, float* out
 
 void PhaserEffect::Update() {
     // Update phaser parameters from effect parameters
-    if (parameters_.size() >= 5) {
-        // Mix parameter (index 0) - handled in Process
-        
-        // Rate parameter (index 1)
-        float rate = parameters_[1]->GetValue();
-        phaserL_.SetLfoFreq(rate);
-        phaserR_.SetLfoFreq(rate);
-        
-        // Depth parameter (index 2)
-        float depth = parameters_[2]->GetValue();
-        phaserL_.SetLfoDepth(depth);
-        phaserR_.SetLfoDepth(depth);
-        
-        // Feedback parameter (index 3)
-        float feedback = parameters_[3]->GetValue();
-        phaserL_.SetFeedback(feedback);
-        phaserR_.SetFeedback(feedback);
-        
-        // Poles parameter (index 4)
-        int poles = static_cast<int>(parameters_[4]->GetValue());
-        phaserL_.SetPoles(poles);
-        phaserR_.SetPoles(poles);
+    // Mix parameter - handled in Process
+    
+    // Rate and Wave parameters - locked to the beat while the rate follows tap tempo
+    float rate = params_[Param::RATE];
+    LfoWave wave = LfoWaveFromValue(params_[Param::WAVE]);
+    bool locked = IsTempoLocked();
+    SetLfo(lfoL_, wave, rate, locked);
+    SetLfo(lfoR_, wave, rate, locked);
+    
+    // Depth parameter - sweep width in octaves
+    depth_ = params_[Param::DEPTH] * SWEEP_OCTAVES;
+    
+    // Feedback parameter
+    feedback_ = params_[Param::FEEDBACK];
+    
+    // Poles parameter
+    poles_ = static_cast<int>(fclamp(params_[Param::POLES], 1.0f, static_cast<float>(MAX_POLES)));
+}
+
+void PhaserEffect::ResetVoice(Voice& voice) {
+    for (int i = 0; i < MAX_POLES; i++) {
+        voice.state[i] = 0.0f;
+    }
+    voice.last = 0.0f;
+    voice.coeff = 0.0f;
+}
+
+float PhaserEffect::ProcessVoice(Voice& voice, float lfo, float in, bool retune) {
+    if (retune) {
+        // Notch frequency sweeps up from MIN_FREQ; bilinear allpass coefficient
+        // with tan(w) ~ w, which holds over the sweep range
+        float freq = MIN_FREQ * exp2f(depth_ * (lfo * 0.5f + 0.5f));
+        float w = PI_F * freq / sampleRate_;
+        voice.coeff = (w - 1.0f) / (w + 1.0f);
+    }
+
+    float x = in + voice.last * feedback_;
+    for (int i = 0; i < poles_; i++) {
+        float y = voice.coeff * x + voice.state[i];
+        voice.state[i] = x - voice.coeff * y;
+        x = y;
     }
+    voice.last = x;
+    return (in + x) * 0.5f;
 }
@@ -19,8 +19,34 @@ public:
     void Update() override;
 
 private:
-    Phaser phaserL_;
-    Phaser phaserR_;
+    // Parameters, in table order
+    enum class Param { MIX, RATE, DEPTH, FEEDBACK, POLES, WAVE, COUNT };
+    ParameterValues<Param> params_;
+
+    // Cascade of first-order allpass stages per channel, swept exponentially
+    // by an LFO that locks to the transport beat when the rate follows tap tempo
+    static constexpr int MAX_POLES = 8;
+    static constexpr float MIN_FREQ = 200.0f;
+    static constexpr float SWEEP_OCTAVES = 4.0f;  // At full depth
+    static constexpr size_t COEFF_UPDATE_INTERVAL = 8;  // Samples between allpass retunes
+
+    struct Voice {
+        float state[MAX_POLES];
+        float last;
+        float coeff;
+    };
+
+    Voice voiceL_;
+    Voice voiceR_;
+    int lfoL_;  // LfoBank voices
+    int lfoR_;
+
+    int poles_;
+    float depth_;
+    float feedback_;
+
+    static void ResetVoice(Voice& voice);
+    float ProcessVoice(Voice& voice, float lfo, float in, bool retune);
 };
 
 } // namespace perspective
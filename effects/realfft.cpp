@@ -0,0 +1,112 @@
+#include "realfft.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+RealFft::RealFft()
+    : size_(0) {
+}
+
+#if defined(ARM_MATH_CM7)
+
+bool RealFft::Init(size_t size) {
+    if (size < 32 || size > MAX_SIZE || (size & (size - 1))) return false;
+    if (arm_rfft_fast_init_f32(&instance_, static_cast<uint16_t>(size)) != ARM_MATH_SUCCESS) return false;
+    size_ = size;
+    return true;
+}
+
+void RealFft::Forward(float* in, float* out) {
+    arm_rfft_fast_f32(&instance_, in, out, 0);
+}
+
+void RealFft::Inverse(float* in, float* out) {
+    arm_rfft_fast_f32(&instance_, in, out, 1);
+}
+
+#else
+
+bool RealFft::Init(size_t size) {
+    if (size < 32 || size > MAX_SIZE || (size & (size - 1))) return false;
+    size_ = size;
+    for (size_t i = 0; i < size / 2; i++) {
+        double angle = -6.283185307179586 * static_cast<double>(i) / static_cast<double>(size);
+        cos_[i] = static_cast<float>(cos(angle));
+        sin_[i] = static_cast<float>(sin(angle));
+    }
+    return true;
+}
+
+void RealFft::Transform(float* re, float* im, bool inverse) {
+    // Iterative radix-2, bit reversal first
+    size_t n = size_;
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+
+    float sign = inverse ? -1.0f : 1.0f;
+    for (size_t length = 2; length <= n; length <<= 1) {
+        size_t half = length >> 1;
+        size_t step = n / length;
+        for (size_t start = 0; start < n; start += length) {
+            for (size_t k = 0; k < half; k++) {
+                float wr = cos_[k * step];
+                float wi = sign * sin_[k * step];
+                size_t a = start + k;
+                size_t b = a + half;
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+void RealFft::Forward(float* in, float* out) {
+    size_t n = size_;
+    for (size_t i = 0; i < n; i++) {
+        re_[i] = in[i];
+        im_[i] = 0.0f;
+    }
+    Transform(re_, im_, false);
+
+    out[0] = re_[0];
+    out[1] = re_[n / 2];
+    for (size_t k = 1; k < n / 2; k++) {
+        out[2 * k] = re_[k];
+        out[2 * k + 1] = im_[k];
+    }
+}
+
+void RealFft::Inverse(float* in, float* out) {
+    // Rebuild the Hermitian spectrum, then a complex inverse
+    size_t n = size_;
+    re_[0] = in[0];
+    im_[0] = 0.0f;
+    re_[n / 2] = in[1];
+    im_[n / 2] = 0.0f;
+    for (size_t k = 1; k < n / 2; k++) {
+        re_[k] = in[2 * k];
+        im_[k] = in[2 * k + 1];
+        re_[n - k] = in[2 * k];
+        im_[n - k] = -in[2 * k + 1];
+    }
+    Transform(re_, im_, true);
+
+    float scale = 1.0f / static_cast<float>(n);
+    for (size_t i = 0; i < n; i++) {
+        out[i] = re_[i] * scale;
+    }
+}
+
+#endif
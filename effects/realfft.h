@@ -0,0 +1,48 @@
+#ifndef PERSPECTIVE_REALFFT_H
+#define PERSPECTIVE_REALFFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(ARM_MATH_CM7)
+#include "arm_math.h"
+#endif
+
+namespace perspective {
+
+// Real FFT with CMSIS-DSP's arm_rfft_fast_f32 packing: out[0] is the DC bin,
+// out[1] the Nyquist bin (both real), then re/im pairs for bins 1 to N/2 - 1.
+// On the M7 it is arm_rfft_fast_f32; elsewhere a portable radix-2 transform
+// with the same layout and scaling, so code built on it runs unchanged on a host.
+class RealFft {
+public:
+    static constexpr size_t MAX_SIZE = 1024;
+
+    RealFft();
+
+    // size is a power of two, 32 to MAX_SIZE
+    bool Init(size_t size);
+    inline size_t GetSize() const { return size_; }
+
+    // in is used as scratch and overwritten
+    void Forward(float* in, float* out);
+    // Scaled by 1/N, so Inverse(Forward(x)) == x; in is overwritten
+    void Inverse(float* in, float* out);
+
+private:
+    size_t size_;
+#if defined(ARM_MATH_CM7)
+    arm_rfft_fast_instance_f32 instance_;
+#else
+    void Transform(float* re, float* im, bool inverse);
+
+    float cos_[MAX_SIZE / 2];
+    float sin_[MAX_SIZE / 2];
+    float re_[MAX_SIZE];
+    float im_[MAX_SIZE];
+#endif
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_REALFFT_H
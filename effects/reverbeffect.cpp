@@ -0,0 +1,107 @@
+#include "reverbeffect.h"
+#include "../controls.h"
+#include "daisy_seed.h"
+
+using namespace perspective;
+
+// Mix, Decay, Size, Damping, PreDelay, Quality, Diffusion
+static constexpr ParameterDescriptor REVERB_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 0.3f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Decay", 0.3f, 10.0f, 2.0f, PotCurve::LOG, KNOB_2_IDX),
+    PotentiometerParameter("Size", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_3_IDX),
+    PotentiometerParameter("Damping", 1000.0f, 16000.0f, 6000.0f, PotCurve::LOG, KNOB_4_IDX),
+    PotentiometerParameter("PreDelay", 0.0f, 0.25f, 0.01f, PotCurve::LIN, KNOB_5_IDX),
+    PotentiometerParameter("Quality", 0.0f, 1.0f, 0.67f, PotCurve::LIN, KNOB_6_IDX), // Delay lines: 2, 4, 6 or 8
+    EncoderParameter("Diffusion", 0.0f, 1.0f, 0.7f, 0.05f, ENCODER_1_IDX),
+};
+
+// Delay lines, diffusers and pre-delay for both channels
+static ReverbChannel::Memory DSY_SDRAM_BSS g_reverbMemory[2];
+
+ReverbEffect::ReverbEffect()
+    : Effect("Reverb") {
+}
+
+ReverbEffect::~ReverbEffect() {
+}
+
+void ReverbEffect::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+
+    // SDRAM is not zeroed at startup; Init clears it
+    engine_.Init(sampleRate, &g_reverbMemory[0], &g_reverbMemory[1]);
+    engine_.SetModulation(MOD_DEPTH_MS, MOD_RATE_HZ);
+
+    SetParameterLayout(REVERB_PARAMETERS, params_);
+
+    // Set default reverb parameters
+    Update();
+}
+
+void ReverbEffect::Process(float* in, float* out, size_t size) {
+    if (!enabled_) {
+        // Bypass - pass through dry signal (left to the callback when wet only)
+        for (size_t i = 0; i < size; i++) {
+            out[i] = wetOnly_ ? 0.0f : in[i];
+        }
+        return;
+    }
+
+    // Get mix parameter
+    float mix = params_[Param::MIX];
+    float dry = wetOnly_ ? 0.0f : 1.0f - mix;
+
+    // Process with wet/dry blend, a chunk at a time for large blocks
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        size_t chunk = size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE;
+        engine_.GetLeft().Process(in + offset, wetL_, chunk);
+        for (size_t i = 0; i < chunk; i++) {
+            out[offset + i] = in[offset + i] * dry + wetL_[i] * mix;
+        }
+    }
+}
+
+void ReverbEffect::ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) {
+    if (!enabled_) {
+        // Bypass - pass through dry signal (left to the callback when wet only)
+        for (size_t i = 0; i < size; i++) {
+            outL[i] = wetOnly_ ? 0.0f : inL[i];
+            outR[i] = wetOnly_ ? 0.0f : inR[i];
+        }
+        return;
+    }
+
+    // Get mix parameter
+    float mix = params_[Param::MIX];
+    float dry = wetOnly_ ? 0.0f : 1.0f - mix;
+
+    // Process stereo signal, a chunk at a time for large blocks
+    for (size_t offset = 0; offset < size; offset += CHUNK_SIZE) {
+        size_t chunk = size - offset < CHUNK_SIZE ? size - offset : CHUNK_SIZE;
+        engine_.Process(inL + offset, inR + offset, wetL_, wetR_, chunk);
+        for (size_t i = 0; i < chunk; i++) {
+            outL[offset + i] = inL[offset + i] * dry + wetL_[i] * mix;
+            outR[offset + i] = inR[offset + i] * dry + wetR_[i] * mix;
+        }
+    }
+}
+
+float ReverbEffect::GetDryGain() const {
+    return enabled_ ? 1.0f - params_[Param::MIX] : 1.0f;
+}
+
+void ReverbEffect::Update() {
+    // Update reverb parameters from effect parameters
+    // Mix parameter - handled in Process
+    engine_.SetDecay(params_[Param::DECAY]);
+    engine_.SetSize(params_[Param::SIZE]);
+    engine_.SetDamping(params_[Param::DAMPING]);
+    engine_.SetPreDelay(params_[Param::PREDELAY]);
+    engine_.SetDiffusion(params_[Param::DIFFUSION]);
+
+    // Quality parameter - fewer lines and diffuser stages for less CPU, and
+    // fewer still while the watchdog has the effect in a cheaper mode
+    static constexpr float QUALITY_CAP[] = {1.0f, 0.34f, 0.0f};
+    float quality = params_[Param::QUALITY];
+    engine_.SetQuality(quality < QUALITY_CAP[quality_] ? quality : QUALITY_CAP[quality_]);
+}
@@ -0,0 +1,42 @@
+#ifndef PERSPECTIVE_REVERBEFFECT_H
+#define PERSPECTIVE_REVERBEFFECT_H
+
+#include "../effect.h"
+#include "reverbengine.h"
+
+namespace perspective {
+
+// CloudSeed-style stereo reverb (see ReverbEngine). The delay memory (~2.3MB)
+// lives in SDRAM and is shared, so only one instance can exist.
+class ReverbEffect : public Effect {
+public:
+    ReverbEffect();
+    ~ReverbEffect() override;
+
+    void Init(float sampleRate) override;
+    void Process(float* in, float* out, size_t size) override;
+    void ProcessStereo(float* inL, float* inR, float* outL, float* outR, size_t size) override;
+    void Update() override;
+
+    // Watchdog levels cap Quality at 4 lines, then 2
+    int GetQualityLevels() const override { return 3; }
+    bool UsesLargeBlocks() const override { return true; }
+    float GetDryGain() const override;
+
+private:
+    // Parameters, in table order
+    enum class Param { MIX, DECAY, SIZE, DAMPING, PREDELAY, QUALITY, DIFFUSION, COUNT };
+    ParameterValues<Param> params_;
+
+    static constexpr size_t CHUNK_SIZE = ReverbChannel::MAX_BLOCK_SIZE;
+    static constexpr float MOD_DEPTH_MS = 0.5f;
+    static constexpr float MOD_RATE_HZ = 0.3f;
+
+    ReverbEngine engine_;
+    float wetL_[CHUNK_SIZE];
+    float wetR_[CHUNK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_REVERBEFFECT_H
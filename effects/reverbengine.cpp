@@ -0,0 +1,293 @@
+#include "reverbengine.h"
+
+#include <math.h>
+#include <string.h>
+
+using namespace perspective;
+
+static constexpr float TWO_PI = 6.28318530718f;
+static constexpr uint32_t LINE_MASK = ReverbChannel::LINE_SIZE - 1;
+static constexpr uint32_t DIFFUSER_MASK = ReverbChannel::DIFFUSER_SIZE - 1;
+static constexpr uint32_t PREDELAY_MASK = ReverbChannel::PREDELAY_SIZE - 1;
+
+// Delay ranges at Size 0 and Size 1 (seconds); each line/stage gets a random
+// point between 60% and 100% of the scaled length
+static constexpr float LINE_MIN_S = 0.05f;
+static constexpr float LINE_MAX_S = 0.30f;
+static constexpr float DIFFUSER_MIN_S = 0.005f;
+static constexpr float DIFFUSER_MAX_S = 0.030f;
+static constexpr float MAX_DIFFUSION_GAIN = 0.75f;
+
+#ifdef PERSPECTIVE_REVERB_FLOAT_DIFFUSION
+static inline ReverbDiffuserSample ToDiffuser(float x) { return x; }
+static inline float FromDiffuser(ReverbDiffuserSample x) { return x; }
+#else
+static inline ReverbDiffuserSample ToDiffuser(float x) {
+    // Saturate rather than wrap - the diffuser state can briefly exceed full scale.
+    // Truncate towards zero: rounding lets the allpass loop sustain a limit cycle
+    if (x > 0.99997f) x = 0.99997f;
+    if (x < -1.0f) x = -1.0f;
+    return static_cast<int16_t>(x * 32768.0f);
+}
+static inline float FromDiffuser(ReverbDiffuserSample x) { return static_cast<float>(x) * (1.0f / 32768.0f); }
+#endif
+
+static float NextRandom(uint32_t& state) {
+    // xorshift32, 0.0 to 1.0
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(state >> 8) * (1.0f / 16777216.0f);
+}
+
+ReverbChannel::ReverbChannel()
+    : memory_(nullptr),
+      sampleRate_(48000.0f),
+      predelaySamples_(0),
+      lineWrite_(0),
+      diffuserWrite_(0),
+      predelayWrite_(0),
+      size_(0.5f),
+      decay_(2.0f),
+      dampCoeff_(1.0f),
+      diffusion_(0.5f),
+      modDepth_(0.0f),
+      modRate_(0.3f),
+      lines_(MAX_LINES),
+      stages_(MAX_DIFFUSER_STAGES),
+      outputGain_(1.0f) {
+}
+
+void ReverbChannel::Init(float sampleRate, Memory* memory, uint32_t seed) {
+    sampleRate_ = sampleRate;
+    memory_ = memory;
+
+    uint32_t state = seed ? seed : 1;
+    for (int i = 0; i < MAX_LINES; i++) {
+        lineRandom_[i] = NextRandom(state);
+        lfoPhase_[i] = NextRandom(state);
+    }
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        diffuserRandom_[i] = NextRandom(state);
+    }
+
+    Clear();
+    UpdateDelays();
+    SetDamping(8000.0f);
+    SetLineCount(lines_);
+}
+
+void ReverbChannel::Clear() {
+    if (memory_) {
+        memset(memory_, 0, sizeof(Memory));
+    }
+    for (int i = 0; i < MAX_LINES; i++) {
+        lineDamp_[i] = 0.0f;
+        lineMod_[i] = 0.0f;
+    }
+    lineWrite_ = 0;
+    diffuserWrite_ = 0;
+    predelayWrite_ = 0;
+}
+
+void ReverbChannel::SetPreDelay(float seconds) {
+    float samples = seconds * sampleRate_;
+    if (samples < 0.0f) samples = 0.0f;
+    if (samples > static_cast<float>(PREDELAY_SIZE - 1)) samples = static_cast<float>(PREDELAY_SIZE - 1);
+    predelaySamples_ = static_cast<uint32_t>(samples);
+}
+
+void ReverbChannel::SetSize(float size) {
+    size_ = size < 0.0f ? 0.0f : (size > 1.0f ? 1.0f : size);
+    UpdateDelays();
+}
+
+void ReverbChannel::SetDecay(float seconds) {
+    decay_ = seconds < 0.05f ? 0.05f : seconds;
+    UpdateGains();
+}
+
+void ReverbChannel::SetDamping(float hz) {
+    float coeff = 1.0f - expf(-TWO_PI * hz / sampleRate_);
+    dampCoeff_ = coeff > 1.0f ? 1.0f : coeff;
+}
+
+void ReverbChannel::SetDiffusion(float amount) {
+    amount = amount < 0.0f ? 0.0f : (amount > 1.0f ? 1.0f : amount);
+    diffusion_ = amount * MAX_DIFFUSION_GAIN;
+}
+
+void ReverbChannel::SetModulation(float depthMs, float rateHz) {
+    modDepth_ = depthMs * 0.001f * sampleRate_;
+    modRate_ = rateHz;
+    UpdateDelays();  // Keeps the modulated read inside the line
+}
+
+void ReverbChannel::SetLineCount(int lines) {
+    lines_ = lines < 1 ? 1 : (lines > MAX_LINES ? MAX_LINES : lines);
+    outputGain_ = 1.0f / sqrtf(static_cast<float>(lines_));
+}
+
+void ReverbChannel::SetDiffuserStages(int stages) {
+    stages_ = stages < 0 ? 0 : (stages > MAX_DIFFUSER_STAGES ? MAX_DIFFUSER_STAGES : stages);
+}
+
+void ReverbChannel::UpdateDelays() {
+    float lineSeconds = LINE_MIN_S + (LINE_MAX_S - LINE_MIN_S) * size_;
+    float maxLine = static_cast<float>(LINE_SIZE - MAX_BLOCK_SIZE - 2) - modDepth_;
+    for (int i = 0; i < MAX_LINES; i++) {
+        float samples = lineSeconds * (0.6f + 0.4f * lineRandom_[i]) * sampleRate_;
+        lineDelay_[i] = samples > maxLine ? maxLine : samples;
+    }
+
+    float diffuserSeconds = DIFFUSER_MIN_S + (DIFFUSER_MAX_S - DIFFUSER_MIN_S) * size_;
+    for (int i = 0; i < MAX_DIFFUSER_STAGES; i++) {
+        float samples = diffuserSeconds * (0.6f + 0.4f * diffuserRandom_[i]) * sampleRate_;
+        if (samples > static_cast<float>(DIFFUSER_SIZE - 1)) samples = static_cast<float>(DIFFUSER_SIZE - 1);
+        diffuserDelay_[i] = static_cast<uint32_t>(samples) + 1;
+    }
+
+    UpdateGains();
+}
+
+void ReverbChannel::UpdateGains() {
+    // Gain per pass so the loop falls 60dB in decay_ seconds
+    for (int i = 0; i < MAX_LINES; i++) {
+        float seconds = lineDelay_[i] / sampleRate_;
+        lineGain_[i] = powf(10.0f, -3.0f * seconds / decay_);
+    }
+}
+
+void ReverbChannel::Process(const float* in, float* out, size_t size) {
+    if (!memory_) {
+        memset(out, 0, size * sizeof(float));
+        return;
+    }
+    if (size > MAX_BLOCK_SIZE) size = MAX_BLOCK_SIZE;
+
+    // Pre-delay
+    float* predelay = memory_->predelay;
+    for (size_t i = 0; i < size; i++) {
+        uint32_t w = (predelayWrite_ + i) & PREDELAY_MASK;
+        predelay[w] = in[i];
+        buffer_[i] = predelay[(w - predelaySamples_) & PREDELAY_MASK];
+    }
+    predelayWrite_ = (predelayWrite_ + size) & PREDELAY_MASK;
+
+    // Allpass diffusers, one stage at a time over the whole block
+    float g = diffusion_;
+    for (int s = 0; s < stages_; s++) {
+        ReverbDiffuserSample* line = memory_->diffusers[s];
+        uint32_t delay = diffuserDelay_[s];
+        for (size_t i = 0; i < size; i++) {
+            uint32_t w = (diffuserWrite_ + i) & DIFFUSER_MASK;
+            float delayed = FromDiffuser(line[(w - delay) & DIFFUSER_MASK]);
+            float v = buffer_[i] + g * delayed;
+            line[w] = ToDiffuser(v);
+            buffer_[i] = delayed - g * v;
+        }
+    }
+    diffuserWrite_ = (diffuserWrite_ + size) & DIFFUSER_MASK;
+
+    // Parallel feedback lines
+    memset(out, 0, size * sizeof(float));
+    float lfoStep = modRate_ * static_cast<float>(size) / sampleRate_;
+    float inverseSize = 1.0f / static_cast<float>(size);
+    for (int l = 0; l < lines_; l++) {
+        float* line = memory_->lines[l];
+
+        // Block-rate LFO, ramped across the block
+        lfoPhase_[l] += lfoStep;
+        lfoPhase_[l] -= floorf(lfoPhase_[l]);
+        float modStart = lineMod_[l];
+        float modEnd = modDepth_ * (1.0f + sinf(TWO_PI * lfoPhase_[l])) * 0.5f;
+        float modStep = (modEnd - modStart) * inverseSize;
+        lineMod_[l] = modEnd;
+
+        float delay = lineDelay_[l] + modStart;
+        float gain = lineGain_[l];
+        float damp = lineDamp_[l];
+        float coeff = dampCoeff_;
+
+        for (size_t i = 0; i < size; i++) {
+            uint32_t w = (lineWrite_ + i) & LINE_MASK;
+
+            // Linear interpolated read; delay is always at least a block long
+            float read = static_cast<float>(w + LINE_SIZE) - delay;
+            uint32_t whole = static_cast<uint32_t>(read);
+            float fraction = read - static_cast<float>(whole);
+            float a = line[whole & LINE_MASK];
+            float b = line[(whole + 1) & LINE_MASK];
+            float delayed = a + (b - a) * fraction;
+
+            damp += coeff * (delayed - damp);
+            line[w] = buffer_[i] + damp * gain;
+            out[i] += delayed;
+
+            delay += modStep;
+        }
+        lineDamp_[l] = damp;
+    }
+    lineWrite_ = (lineWrite_ + size) & LINE_MASK;
+
+    for (size_t i = 0; i < size; i++) {
+        out[i] *= outputGain_;
+    }
+}
+
+void ReverbEngine::Init(float sampleRate, ReverbChannel::Memory* left, ReverbChannel::Memory* right) {
+    left_.Init(sampleRate, left, 0x2545F491u);
+    right_.Init(sampleRate, right, 0x9E3779B9u);
+}
+
+void ReverbEngine::Clear() {
+    left_.Clear();
+    right_.Clear();
+}
+
+void ReverbEngine::SetPreDelay(float seconds) {
+    left_.SetPreDelay(seconds);
+    right_.SetPreDelay(seconds);
+}
+
+void ReverbEngine::SetSize(float size) {
+    left_.SetSize(size);
+    right_.SetSize(size);
+}
+
+void ReverbEngine::SetDecay(float seconds) {
+    left_.SetDecay(seconds);
+    right_.SetDecay(seconds);
+}
+
+void ReverbEngine::SetDamping(float hz) {
+    left_.SetDamping(hz);
+    right_.SetDamping(hz);
+}
+
+void ReverbEngine::SetDiffusion(float amount) {
+    left_.SetDiffusion(amount);
+    right_.SetDiffusion(amount);
+}
+
+void ReverbEngine::SetModulation(float depthMs, float rateHz) {
+    left_.SetModulation(depthMs, rateHz);
+    right_.SetModulation(depthMs, rateHz * 1.13f);  // Keep the channels from moving together
+}
+
+void ReverbEngine::SetQuality(float quality) {
+    quality = quality < 0.0f ? 0.0f : (quality > 1.0f ? 1.0f : quality);
+    int steps = static_cast<int>(quality * 3.0f + 0.5f);  // 0-3
+    int lines = 2 + steps * 2;
+    int stages = 2 + steps * 2;
+
+    left_.SetLineCount(lines);
+    right_.SetLineCount(lines);
+    left_.SetDiffuserStages(stages);
+    right_.SetDiffuserStages(stages);
+}
+
+void ReverbEngine::Process(const float* inL, const float* inR, float* outL, float* outR, size_t size) {
+    left_.Process(inL, outL, size);
+    right_.Process(inR, outR, size);
+}
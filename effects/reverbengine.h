@@ -0,0 +1,130 @@
+#ifndef PERSPECTIVE_REVERBENGINE_H
+#define PERSPECTIVE_REVERBENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Diffuser delay samples. Q15 by default, which halves the memory and SDRAM
+// bandwidth of the diffusion stages; define PERSPECTIVE_REVERB_FLOAT_DIFFUSION
+// to keep them in float.
+#ifdef PERSPECTIVE_REVERB_FLOAT_DIFFUSION
+using ReverbDiffuserSample = float;
+#else
+using ReverbDiffuserSample = int16_t;
+#endif
+
+// One channel of a CloudSeed-style reverb, cut down for the Cortex-M7.
+// Signal flow follows CloudSeed's ReverbChannel: pre-delay, a chain of allpass
+// diffusers, then a bank of parallel feedback delay lines, each with a slow
+// modulated read, a damping low-pass and a decay gain. Delay lengths are drawn
+// from a seeded random sequence and scaled by Size, so two channels with
+// different seeds decorrelate into stereo.
+// Everything runs a block at a time; the delay line modulation is ramped
+// across each block, so the per-sample work is a read, an interpolation, a
+// one-pole and a write per line. All delay memory is supplied by the caller
+// (SDRAM on the pedal).
+class ReverbChannel {
+public:
+    static constexpr int MAX_LINES = 8;
+    static constexpr int MAX_DIFFUSER_STAGES = 8;
+    static constexpr size_t LINE_SIZE = 32768;      // Power of two; 680ms at 48kHz
+    static constexpr size_t DIFFUSER_SIZE = 4096;   // Power of two; 85ms at 48kHz
+    static constexpr size_t PREDELAY_SIZE = 16384;  // Power of two; 340ms at 48kHz
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+
+    struct Memory {
+        float lines[MAX_LINES][LINE_SIZE];
+        ReverbDiffuserSample diffusers[MAX_DIFFUSER_STAGES][DIFFUSER_SIZE];
+        float predelay[PREDELAY_SIZE];
+    };
+
+    ReverbChannel();
+
+    void Init(float sampleRate, Memory* memory, uint32_t seed);
+    void Clear();
+
+    void SetPreDelay(float seconds);
+    void SetSize(float size);           // 0.0 to 1.0
+    void SetDecay(float seconds);       // RT60
+    void SetDamping(float hz);          // Feedback low-pass cutoff
+    void SetDiffusion(float amount);    // 0.0 to 1.0
+    void SetModulation(float depthMs, float rateHz);
+    void SetLineCount(int lines);
+    void SetDiffuserStages(int stages);
+
+    inline int GetLineCount() const { return lines_; }
+    inline int GetDiffuserStages() const { return stages_; }
+
+    // Wet signal only
+    void Process(const float* in, float* out, size_t size);
+
+private:
+    void UpdateDelays();
+    void UpdateGains();
+
+    Memory* memory_;
+    float sampleRate_;
+
+    // Random factors (0.0 to 1.0) drawn from the seed
+    float lineRandom_[MAX_LINES];
+    float diffuserRandom_[MAX_DIFFUSER_STAGES];
+    float lfoPhase_[MAX_LINES];
+
+    // Derived state
+    float lineDelay_[MAX_LINES];   // Samples
+    float lineGain_[MAX_LINES];
+    float lineDamp_[MAX_LINES];    // Damping filter state
+    float lineMod_[MAX_LINES];     // Modulation offset at the end of the last block
+    uint32_t diffuserDelay_[MAX_DIFFUSER_STAGES];
+    uint32_t predelaySamples_;
+
+    // Shared write positions - every line (and every diffuser stage) advances together
+    uint32_t lineWrite_;
+    uint32_t diffuserWrite_;
+    uint32_t predelayWrite_;
+
+    float size_;
+    float decay_;
+    float dampCoeff_;
+    float diffusion_;
+    float modDepth_;   // Samples
+    float modRate_;    // Hz
+    int lines_;
+    int stages_;
+    float outputGain_;
+
+    float buffer_[MAX_BLOCK_SIZE];
+};
+
+// Stereo reverb: two channels with different seeds, and a quality setting
+// that trades line and diffuser count for CPU load.
+class ReverbEngine {
+public:
+    void Init(float sampleRate, ReverbChannel::Memory* left, ReverbChannel::Memory* right);
+    void Clear();
+
+    void SetPreDelay(float seconds);
+    void SetSize(float size);
+    void SetDecay(float seconds);
+    void SetDamping(float hz);
+    void SetDiffusion(float amount);
+    void SetModulation(float depthMs, float rateHz);
+
+    // 0.0 (2 lines, 2 diffuser stages) to 1.0 (8 and 8)
+    void SetQuality(float quality);
+
+    void Process(const float* inL, const float* inR, float* outL, float* outR, size_t size);
+
+    inline ReverbChannel& GetLeft() { return left_; }
+    inline ReverbChannel& GetRight() { return right_; }
+
+private:
+    ReverbChannel left_;
+    ReverbChannel right_;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_REVERBENGINE_H
@@ -5,6 +5,11 @@
 using namespace perspective;
 using namespace daisysp;
 
+// Tuning Reference (default A4 = 440Hz, range 430-450Hz)
+static constexpr ParameterDescriptor TUNER_PARAMETERS[] = {
+    PotentiometerParameter("Reference", 430.0f, 450.0f, 440.0f, PotCurve::LIN, KNOB_1_IDX),
+};
+
 TunerEffect::TunerEffect()
     : Effect("Tuner")
     , tuningReference_(440.0f)
@@ -26,11 +31,12 @@ TunerEffect::~TunerEffect() {
 void TunerEffect::Init(float sampleRate) {
     sampleRate_ = sampleRate;
     
-    // Add parameter: Tuning Reference (default A4 = 440Hz, range 430-450Hz)
-    AddParameter(new PotentiometerParameter("Reference", 430.0f, 450.0f, 440.0f, PotCurve::LIN, KNOB_1_IDX));
+    SetParameterLayout(TUNER_PARAMETERS, params_);
     
-    // Initialize cycfi/q pitch detector
+    // Initialize cycfi/q pitch detector (again when the sample rate changes)
     // Constructor: pitch_detector(lowest_freq, highest_freq, sps, hysteresis)
+    delete pitchDetector_;
+    delete signalConditioner_;
     cycfi::q::frequency lowest = MIN_FREQUENCY * 1_Hz;
     cycfi::q::frequency highest = MAX_FREQUENCY * 1_Hz;
     pitchDetector_ = new cycfi::q::pitch_detector(lowest, highest, sampleRate, -45_dB);
@@ -74,9 +80,7 @@ void TunerEffect::ProcessStereo(float* inL, float* inR, float* outL, float* outR
 
 void TunerEffect::Update() {
     // Update tuning reference from parameter
-    if (parameters_.size() > 0) {
-        tuningReference_ = parameters_[0]->GetValue();
-    }
+    tuningReference_ = params_[Param::REFERENCE];
 }
 
 void TunerEffect::DetectPitch(float sample) {
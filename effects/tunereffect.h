@@ -37,6 +37,10 @@ public:
     float GetSignalLevel() const { return signalLevel_; }
 
 private:
+    // Parameters, in table order
+    enum class Param { REFERENCE, COUNT };
+    ParameterValues<Param> params_;
+
     // Pitch detection using cycfi/q
     void DetectPitch(float sample);
     void UpdateNoteInfo();
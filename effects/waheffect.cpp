@@ -4,6 +4,12 @@
 using namespace perspective;
 using namespace daisysp;
 
+// Mix, Wah (expression pedal)
+static constexpr ParameterDescriptor WAH_PARAMETERS[] = {
+    PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX),
+    PotentiometerParameter("Wah", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_EXP_IDX),
+};
+
 WahEffect::WahEffect()
     : Effect("Wah") {
 }
@@ -18,9 +24,7 @@ void WahEffect::Init(float sampleRate) {
     wahL_.Init(sampleRate);
     wahR_.Init(sampleRate);
     
-    // Add parameters: Mix, Wah (expression pedal)
-    AddParameter(new PotentiometerParameter("Mix", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_1_IDX));
-    AddParameter(new PotentiometerParameter("Wah", 0.0f, 1.0f, 0.5f, PotCurve::LIN, KNOB_EXP_IDX));
+    SetParameterLayout(WAH_PARAMETERS, params_);
     
     // Set default wah parameters
     Update();
@@ -36,7 +40,7 @@ void WahEffect::Process(float* in, float* out, size_t size) {
     }
     
     // Get mix parameter
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    float mix = params_[Param::MIX];
     
     // Process with wet/dry blend
     for (size_t i = 0; i < size; i++) {
@@ -56,10 +60,18 @@ void WahEffect::ProcessStereo(float* inL, float* inR, float* outL, float* outR,
     }
     
     // Get mix parameter
-    float mix = parameters_.size() > 0 ? parameters_[0]->GetValue() : 0.5f;
+    float mix = params_[Param::MIX];
+
+    // Expression pedal sweeps arrive one value per sample
+    const float* wah = GetModulation(Param::WAH);
     
     // Process stereo signal with independent wah
     for (size_t i = 0; i < size; i++) {
+        if (wah) {
+            wahL_.SetWah(wah[i]);
+            wahR_.SetWah(wah[i]);
+        }
+
         float wetL = wahL_.Process(inL[i]);
         float wetR = wahR_.Process(inR[i]);
         
@@ -70,12 +82,10 @@ void WahEffect::ProcessStereo(float* inL, float* inR, float* outL, float* outR,
 
 void WahEffect::Update() {
     // Update wah parameter from effect parameters
-    if (parameters_.size() >= 2) {
-        // Mix parameter (index 0) - handled in Process
-        
-        // Wah parameter (index 1 / pot 7)
-        float wah = parameters_[1]->GetValue();
-        wahL_.SetWah(wah);
-        wahR_.SetWah(wah);
-    }
+    // Mix parameter - handled in Process
+    
+    // Wah parameter (pot 7)
+    float wah = params_[Param::WAH];
+    wahL_.SetWah(wah);
+    wahR_.SetWah(wah);
 }
@@ -19,6 +19,10 @@ public:
     void Update() override;
 
 private:
+    // Parameters, in table order
+    enum class Param { MIX, WAH, COUNT };
+    ParameterValues<Param> params_;
+
     Autowah wahL_;
     Autowah wahR_;
 };
@@ -0,0 +1,88 @@
+#include "wavfile.h"
+
+#include <string.h>
+
+using namespace perspective;
+
+static constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+static constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+static constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+// Little-endian reads that do not assume alignment (flash data may be unaligned)
+static inline uint16_t Read16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t Read32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+bool WavFile::Parse(const uint8_t* file, size_t size) {
+    data = nullptr;
+    frames = 0;
+    if (!file || size < 12 || memcmp(file, "RIFF", 4) || memcmp(file + 8, "WAVE", 4)) return false;
+
+    bool haveFormat = false;
+    uint16_t tag = 0;
+    size_t offset = 12;
+    while (offset + 8 <= size) {
+        const uint8_t* chunk = file + offset;
+        uint32_t length = Read32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        if (length > size - offset - 8) length = static_cast<uint32_t>(size - offset - 8);
+
+        if (!memcmp(chunk, "fmt ", 4) && length >= 16) {
+            tag = Read16(body);
+            channels = Read16(body + 2);
+            sampleRate = Read32(body + 4);
+            bitsPerSample = Read16(body + 14);
+            if (tag == WAVE_FORMAT_EXTENSIBLE && length >= 26) {
+                tag = Read16(body + 24);  // First two bytes of the sub-format GUID
+            }
+            haveFormat = true;
+        } else if (!memcmp(chunk, "data", 4) && haveFormat) {
+            if (channels == 0) return false;
+            if (tag == WAVE_FORMAT_PCM && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32)) {
+                format = Format::PCM;
+            } else if (tag == WAVE_FORMAT_IEEE_FLOAT && bitsPerSample == 32) {
+                format = Format::FLOAT;
+            } else {
+                return false;
+            }
+            data = body;
+            frames = length / (channels * (bitsPerSample / 8));
+            return frames > 0;
+        }
+
+        offset += 8 + length + (length & 1);  // Chunks are padded to even sizes
+    }
+    return false;
+}
+
+float WavFile::GetSample(uint32_t frame, uint16_t channel) const {
+    if (!data || frame >= frames || channel >= channels) return 0.0f;
+
+    size_t bytes = bitsPerSample / 8;
+    const uint8_t* p = data + (static_cast<size_t>(frame) * channels + channel) * bytes;
+    if (format == Format::FLOAT) {
+        uint32_t bits = Read32(p);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    switch (bitsPerSample) {
+        case 16:
+            return static_cast<float>(static_cast<int16_t>(Read16(p))) * (1.0f / 32768.0f);
+        case 24: {
+            // Into the top three bytes, so the sign comes along
+            uint32_t bits = (static_cast<uint32_t>(p[0]) << 8) | (static_cast<uint32_t>(p[1]) << 16) |
+                            (static_cast<uint32_t>(p[2]) << 24);
+            int32_t value = static_cast<int32_t>(bits);
+            return static_cast<float>(value) * (1.0f / 2147483648.0f);
+        }
+        default:
+            return static_cast<float>(static_cast<int32_t>(Read32(p))) * (1.0f / 2147483648.0f);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef PERSPECTIVE_WAVFILE_H
+#define PERSPECTIVE_WAVFILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// A RIFF/WAVE file in memory (memory-mapped flash or a RAM buffer). Handles
+// 16, 24 and 32-bit integer PCM and 32-bit float, plain or
+// WAVE_FORMAT_EXTENSIBLE; the data is read in place, nothing is copied.
+struct WavFile {
+    enum class Format { PCM, FLOAT };
+
+    Format format;
+    uint16_t channels;
+    uint16_t bitsPerSample;
+    uint32_t sampleRate;
+    uint32_t frames;
+    const uint8_t* data;
+
+    // False if the file is not a WAV the reader handles
+    bool Parse(const uint8_t* file, size_t size);
+
+    // One sample, -1.0 to 1.0
+    float GetSample(uint32_t frame, uint16_t channel) const;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_WAVFILE_H
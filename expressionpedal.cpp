@@ -0,0 +1,85 @@
+#include "expressionpedal.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+ExpressionPedal::ExpressionPedal()
+    : adc_(nullptr),
+      blockRate_(1000.0f),
+      coeff_(1.0f),
+      position_(0.0f),
+      last_(0.0f),
+      primed_(false),
+      target_(Target::NONE),
+      slot_(-1),
+      min_(0.0f),
+      range_(1.0f),
+      curve_(PotCurve::LIN) {
+}
+
+void ExpressionPedal::Init(const uint16_t* adc, float sampleRate, size_t blockSize) {
+    adc_ = adc;
+    blockRate_ = sampleRate / static_cast<float>(blockSize);
+    primed_ = false;
+    SetSmoothing(0.01f);
+}
+
+void ExpressionPedal::SetSmoothing(float seconds) {
+    // One-pole coefficient for a filter clocked once per block
+    coeff_ = seconds > 0.0f ? 1.0f - expf(-1.0f / (seconds * blockRate_)) : 1.0f;
+}
+
+void ExpressionPedal::AssignParameter(int slot, float minValue, float maxValue, PotCurve curve) {
+    Assign(Target::PARAMETER, slot, minValue, maxValue, curve);
+}
+
+void ExpressionPedal::AssignVolume(float minGain, float maxGain, PotCurve curve) {
+    Assign(Target::VOLUME, -1, minGain, maxGain, curve);
+}
+
+void ExpressionPedal::Unassign() {
+    // Read-modify-writes, so nothing after them (such as switching the
+    // current effect) is moved ahead of them
+    target_.exchange(Target::NONE, std::memory_order_acq_rel);
+    slot_.exchange(-1, std::memory_order_acq_rel);
+}
+
+void ExpressionPedal::Assign(Target target, int slot, float minValue, float maxValue, PotCurve curve) {
+    // Disable first so the audio callback never sees a half-written assignment;
+    // the exchange keeps the writes below after it, and the release store keeps
+    // them before the target is published again
+    target_.exchange(Target::NONE, std::memory_order_acq_rel);
+    slot_.store(slot, std::memory_order_relaxed);
+    min_ = minValue;
+    range_ = maxValue - minValue;
+    curve_ = curve;
+    primed_ = false;
+    target_.store(target, std::memory_order_release);
+}
+
+const float* ExpressionPedal::Process(size_t size) {
+    if (target_.load(std::memory_order_acquire) == Target::NONE || !adc_ || size == 0 || size > MAX_BLOCK_SIZE) return nullptr;
+
+    float raw = static_cast<float>(*adc_) / 65535.0f;
+    position_ += coeff_ * (raw - position_);
+
+    float value = min_ + ApplyPotCurve(curve_, position_) * range_;
+    if (!primed_) {
+        position_ = raw;
+        value = min_ + ApplyPotCurve(curve_, position_) * range_;
+        last_ = value;
+        primed_ = true;
+    }
+
+    // Ramp from the end of the previous block to this block's value
+    float step = (value - last_) / static_cast<float>(size);
+    float ramp = last_;
+    for (size_t i = 0; i < size; i++) {
+        ramp += step;
+        buffer_[i] = ramp;
+    }
+    last_ = value;
+
+    return buffer_;
+}
@@ -0,0 +1,76 @@
+#ifndef PERSPECTIVE_EXPRESSIONPEDAL_H
+#define PERSPECTIVE_EXPRESSIONPEDAL_H
+
+#include "effectparameter.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace perspective {
+
+// Expression pedal as an audio-rate modulation source.
+// The pedal's ADC channel is read once per audio block, smoothed at block rate
+// and then ramped linearly across the block, so the assigned target moves every
+// sample instead of in 10 Hz knob-event steps. The range and curve are applied
+// at the block end points only, which keeps the per-sample cost to one add.
+// Assignments are made from the main loop and read by the audio callback:
+// the target is disabled before the rest changes and published after it.
+class ExpressionPedal {
+public:
+    enum class Target {
+        NONE,
+        PARAMETER,  // A parameter slot of the current effect
+        VOLUME      // Output gain
+    };
+
+    ExpressionPedal();
+
+    // adc points at the pedal's raw 16-bit ADC value
+    void Init(const uint16_t* adc, float sampleRate, size_t blockSize);
+
+    // Time constant of the block-rate smoothing
+    void SetSmoothing(float seconds);
+
+    // Sweep a parameter from minValue (heel) to maxValue (toe) through a pot curve
+    void AssignParameter(int slot, float minValue, float maxValue, PotCurve curve = PotCurve::LIN);
+
+    // Sweep the output volume (gain 0.0 to 1.0)
+    void AssignVolume(float minGain = 0.0f, float maxGain = 1.0f, PotCurve curve = PotCurve::LOG_A);
+
+    void Unassign();
+
+    inline Target GetTarget() const { return target_.load(std::memory_order_acquire); }
+    inline int GetSlot() const { return slot_.load(std::memory_order_acquire); }
+
+    // Smoothed pedal position (0.0 to 1.0)
+    inline float GetPosition() const { return position_; }
+
+    // Call once per audio block. Returns the target's value for each sample
+    // of the block, or nullptr when the pedal is unassigned.
+    const float* Process(size_t size);
+
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+
+private:
+    void Assign(Target target, int slot, float minValue, float maxValue, PotCurve curve);
+
+    const uint16_t* adc_;
+    float blockRate_;
+    float coeff_;
+    float position_;
+    float last_;
+    bool primed_;
+
+    std::atomic<Target> target_;
+    std::atomic<int> slot_;
+    float min_;
+    float range_;
+    PotCurve curve_;
+
+    float buffer_[MAX_BLOCK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_EXPRESSIONPEDAL_H
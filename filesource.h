@@ -0,0 +1,32 @@
+#ifndef PERSPECTIVE_FILESOURCE_H
+#define PERSPECTIVE_FILESOURCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Read-only access to files on a storage medium, used by the StreamReader.
+// Paths are relative to the root of the medium. A handful of files can be
+// open at once; each is named by a small handle. Reads block, so they belong
+// in the main loop, never in the audio callback.
+class FileSource {
+public:
+    static constexpr int MAX_FILES = 4;
+
+    virtual ~FileSource() {}
+
+    // Handle (0 to MAX_FILES - 1), or -1 if the file cannot be opened
+    virtual int Open(const char* path) = 0;
+    virtual void Close(int file) = 0;
+
+    virtual uint32_t GetSize(int file) const = 0;
+    virtual bool Seek(int file, uint32_t offset) = 0;
+
+    // Bytes read, fewer than size only at the end of the file; -1 on error
+    virtual int32_t Read(int file, uint8_t* data, uint32_t size) = 0;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_FILESOURCE_H
@@ -9,6 +9,7 @@ using namespace perspective;
 
 DECLARE_DISPLAY(__Display);
 DECLARE_LAYER(BackgroundLayer, 320, 240)
+DECLARE_LAYER(ForegroundLayer, 320, 240)
 
 void timerCallback(void* data)
 {
@@ -77,6 +78,20 @@ void perspective::Hardware::SetControlUpdateRate(float rate)
 }
 
 void Hardware::ProcessControls() {
+    // Tap tempo runs even while the main loop is processing events, so no tap is missed
+    if (tapTempo_) {
+        bool pressed = !tapPin_.Read();  // Switches are active low
+        if (pressed) {
+            if (!tapPressed_ && tapReleasedTicks_ >= TAP_RELEASE_TICKS) {
+                tapTempo_->Tap(System::GetUs());
+            }
+            tapReleasedTicks_ = 0;
+        } else if (tapReleasedTicks_ < TAP_RELEASE_TICKS) {
+            tapReleasedTicks_++;
+        }
+        tapPressed_ = pressed;
+    }
+
     if (processing) {
         return; // Skip processing if already in the middle of processing to prevent reentrancy issues
     }
@@ -110,27 +125,47 @@ void Hardware::ProcessControls() {
         }
     }
 
+    bool scanSwitches = ++switch_divider >= SWITCH_DIVISOR;
+    bool scanEncoders = ++encoder_divider >= ENCODER_DIVISOR;
+
+    // Sample all switch/encoder pins with one read per GPIO port
+    if (scanSwitches || scanEncoders) {
+        ports_.Capture();
+    }
+
     // Process switches and fire button events
-    if (++switch_divider >= SWITCH_DIVISOR) {
+    if (scanSwitches) {
         switch_divider = 0;
-        for (int i = 0; i < numSwitches; i++) {
-            switches[i].Process();
-            
-            if (switches[i].RisingEdge()) {
+        switchBank_.Process(ports_);
+
+        uint32_t rising = switchBank_.RisingMask();
+        uint32_t falling = switchBank_.FallingMask();
+        uint32_t held = switchBank_.PressedMask();
+
+        // Only lanes that are changing or held need any further work
+        uint32_t pending = switchBank_.ActiveMask() | held;
+        while (pending) {
+            int i = __builtin_ctz(pending);
+            uint32_t bit = 1u << i;
+            pending &= pending - 1;
+
+            switches[i].SetDebouncedState(switchBank_.State(i));
+
+            if (rising & bit) {
                // Button pressed - reset hold flag
                 switchHoldFired_[i] = false;
                 eventHandler_->QueueButtonPressed(
                     &switches[i],
                     i
                 );
-            } else if (switches[i].FallingEdge()) {
+            } else if (falling & bit) {
                 // Button released
                 switchHoldFired_[i] = false;
                 eventHandler_->QueueButtonReleased(
                     &switches[i],
                     i
                 );
-            } else if (switches[i].Pressed()) {
+            } else if (held & bit) {
                 // Button is being held - check if threshold reached
                 int holdTime = switches[i].TimeHeld();
                 if (!switchHoldFired_[i] && holdTime >= BUTTON_HOLD_THRESHOLD_MS) {
@@ -146,10 +181,10 @@ void Hardware::ProcessControls() {
     }
 
     // Process encoders and fire encoder events
-    if (++encoder_divider >= ENCODER_DIVISOR) {
+    if (scanEncoders) {
         encoder_divider = 0;
         for (int i = 0; i < numEncoders; i++) {
-            encoders[i].Process();
+            encoders[i].Process(ports_);
             int increment = encoders[i].Increment();
             
             if (increment != 0) {
@@ -167,13 +202,17 @@ void Hardware::InitControls()
 {
     numKnobs = sizeof(knobPins) / sizeof(Pin);
  
-    AdcChannelConfig cfg[numKnobs];
+    // The expression pedal gets its own channel after the knobs; it is read
+    // once per audio block rather than through the knob events
+    AdcChannelConfig cfg[numKnobs + 1];
 
     for (int i = 0; i < numKnobs; i++) {
         cfg[i].InitSingle(knobPins[i]);
     }
+    cfg[numKnobs].InitSingle(KNOB_EXP_PIN);
+    expressionChannel_ = numKnobs;
 
-    DaisySeed::adc.Init(cfg, numKnobs);
+    DaisySeed::adc.Init(cfg, numKnobs + 1);
 
     for (int i = 0; i < numKnobs; i++) {
         Knob newKnob;
@@ -200,6 +239,20 @@ void Hardware::InitControls()
 
     numSwitches += numEncoders; // Account for encoder buttons added to switches
 
+    // Register every switch/encoder pin with the port snapshot and the parallel debouncer.
+    // Lane order must match the switches vector: footswitches first, then encoder buttons.
+    switchBank_.Init();
+    for (Pin pin : switchPins) {
+        ports_.AddPin(pin);
+        switchBank_.AddLane(pin);
+    }
+    for (int i = 0; i < numEncoders; i++) {
+        ports_.AddPin(encoderPins[i][0]);
+        ports_.AddPin(encoderPins[i][1]);
+        ports_.AddPin(encoderPins[i][2]);
+        switchBank_.AddLane(encoderPins[i][2]);
+    }
+
     numLeds = sizeof(ledPins) / sizeof(Pin);
 
     for (int i = 0; i < numLeds; i++) {
@@ -208,9 +261,11 @@ void Hardware::InitControls()
         leds.push_back(newLed);
     }
 
-    // Jack insertion detection
+    // Jack insertion detection (with MIDI built in, the right input's detect pin is its RX - see InitMidi)
     leftIn.Init(AUDIO_IN_L_PIN, GPIO::Mode::INPUT);
+#ifndef PERSPECTIVE_MIDI
     rightIn.Init(AUDIO_IN_R_PIN, GPIO::Mode::INPUT);
+#endif
     leftOut.Init(AUDIO_OUT_L_PIN, GPIO::Mode::INPUT);
     rightOut.Init(AUDIO_OUT_R_PIN, GPIO::Mode::INPUT);
     expression.Init(EXPRESSION_PEDAL_PIN, GPIO::Mode::INPUT);
@@ -221,11 +276,9 @@ void Hardware::InitControls()
     PrintLine("Starting ADC");
     adc.Start();
 
-    // No Midi controls for now
-    /*MidiUartHandler::Config midiConfig;
-    midiConfig.transport_config.rx = midiRx;
-    midiConfig.transport_config.tx = midiTx;
-    midi.Init(midiConfig);*/
+#ifdef PERSPECTIVE_MIDI
+    InitMidi();
+#endif
 
     /*MyOledDisplay::Config dispCfg;
     dispCfg.driver_config.transport_config.pin_config.dc = displayDC;
@@ -233,6 +286,53 @@ void Hardware::InitControls()
     display.Init(dispCfg);*/
 }
 
+void Hardware::SetTapTempo(TapTempo* tapTempo, int switchIndex)
+{
+    if (switchIndex < 0 || switchIndex >= static_cast<int>(sizeof(switchPins) / sizeof(Pin))) return;
+
+    tapPin_.Init(switchPins[switchIndex], GPIO::Mode::INPUT, GPIO::Pull::NOPULL);
+    tapPressed_ = false;
+    tapReleasedTicks_ = TAP_RELEASE_TICKS;
+    tapTempo_ = tapTempo;
+}
+
+#ifdef PERSPECTIVE_MIDI
+// DMA target for MIDI receive - must live in non-cached memory
+static uint8_t DMA_BUFFER_MEM_SECTION midiRxBuffer[64];
+
+void Hardware::InitMidi()
+{
+    UartHandler::Config cfg;
+    cfg.periph = UartHandler::Config::Peripheral::USART_1;
+    cfg.baudrate = 31250;
+    cfg.stopbits = UartHandler::Config::StopBits::BITS_1;
+    cfg.parity = UartHandler::Config::Parity::NONE;
+    cfg.mode = UartHandler::Config::Mode::RX;
+    cfg.wordlength = UartHandler::Config::WordLength::BITS_8;
+    cfg.pin_config.rx = MIDI_RX_PIN;
+    cfg.pin_config.tx = Pin();  // Nothing is sent, and D13 stays the left input's jack detect
+
+    midi_.Init();
+    if (midiUart_.Init(cfg) != UartHandler::Result::OK) {
+        PrintLine("MIDI UART init failed");
+        return;
+    }
+
+    // Circular DMA: the callback fires on half/full transfer and on line idle,
+    // so isolated clock bytes are delivered (and timestamped) as they arrive,
+    // and a clock byte inside a burst is dated back from the end of its chunk
+    midiUart_.DmaListenStart(midiRxBuffer, sizeof(midiRxBuffer), MidiRxCallback, this);
+}
+
+void Hardware::MidiRxCallback(uint8_t* data, size_t size, void* context, UartHandler::Result result)
+{
+    if (result != UartHandler::Result::OK) return;
+
+    Hardware* hardware = static_cast<Hardware*>(context);
+    hardware->midi_.Receive(data, size, System::GetUs());
+}
+#endif
+
 void Hardware::InitGFX2Display()
 {
     INIT_DISPLAY(__Display);
@@ -241,6 +341,15 @@ void Hardware::InitGFX2Display()
     pBackground->drawFillRect(0,0,320, 240, DadGFX::sColor(9, 111, 148, 255));
     pBackground->drawFillRect(80, 0, 80, 240, DadGFX::sColor(23, 148, 194, 255));
     pBackground->drawFillRect(240, 0, 240, 240, DadGFX::sColor(23, 148, 194, 255));
+
+    // Widgets draw into a transparent layer so only the blocks they touch are re-sent
+    foregroundLayer_ = ADD_LAYER(ForegroundLayer, 0, 0, 2);
+    foregroundLayer_->drawFillRect(0, 0, 320, 240, DadGFX::sColor(0, 0, 0, 0));
   
     __Display.flush();
 }
+
+DadGFX::cDisplay* Hardware::GetDisplay()
+{
+    return &__Display;
+}
@@ -9,6 +9,10 @@
 #include "ui/knob.h"
 #include "ui/switch.h"
 #include "ui/encoder.h"
+#include "ui/portsnapshot.h"
+#include "ui/switchbank.h"
+#include "midiinput.h"
+#include "taptempo.h"
 
 using namespace daisy;
 
@@ -17,6 +21,11 @@ using namespace daisy;
 #define SWITCH_DIVISOR 16 // Process switch changes every 16th call to control timer for better responsiveness
 #define KNOB_DIVISOR 200 // Process knob changes every 100th call to control timer for better responsiveness
 
+namespace DadGFX {
+    class cDisplay;
+    class cLayer;
+}
+
 namespace perspective {
     // Forward declaration
     class UIEventHandler;
@@ -65,9 +74,31 @@ namespace perspective {
             return nullptr;
         }
 
+        // Raw 16-bit ADC value of the expression pedal input
+        inline const uint16_t* GetExpressionAdc() { return adc.GetPtr(expressionChannel_); }
+
+        // Jack detect: the switched expression jack pulls the detect pin high when a plug is inserted
+        inline bool IsExpressionConnected() { return expression.Read(); }
+
+        // Samples a switch on every control tick and timestamps its presses into tapTempo
+        void SetTapTempo(TapTempo* tapTempo, int switchIndex);
+
+        // Bytes arrive by UART DMA (make USE_MIDI=1, otherwise nothing arrives);
+        // call GetMidi().Process() from the main loop
+        inline MidiInput& GetMidi() { return midi_; }
+
+        DadGFX::cDisplay* GetDisplay();
+
+        // Transparent layer above the background, used by the UI widgets
+        inline DadGFX::cLayer* GetForegroundLayer() { return foregroundLayer_; }
+
     protected:
         void InitControls();
         void InitGFX2Display();
+#ifdef PERSPECTIVE_MIDI
+        void InitMidi();
+        static void MidiRxCallback(uint8_t* data, size_t size, void* context, UartHandler::Result result);
+#endif
 
         bool boost = true;
         float controlUpdateRate = 0.0f; // in Hz
@@ -79,16 +110,22 @@ namespace perspective {
         std::vector<perspective::Encoder> encoders;
         std::vector<Led> leds;
 
+        // Single IDR read per scan, shared by all switches and encoders
+        PortSnapshot ports_;
+        SwitchBank switchBank_;  // Lanes match the indices in switches
+
         int numKnobs = 0;
         int numSwitches = 0;
         int numEncoders = 0;
         int numLeds = 0;
+        int expressionChannel_ = 0;
 
         int encoder_divider = 0;
         int switch_divider = 0;
         int knob_divider = 0;
 
         UIEventHandler* eventHandler_;
+        DadGFX::cLayer* foregroundLayer_ = nullptr;
 
         // Track if hold event has been fired for each switch
         bool switchHoldFired_[6] = {false, false, false, false, false, false};
@@ -101,7 +138,9 @@ namespace perspective {
         Pin ledPins[2] = {LED_1_PIN, LED_2_PIN};
 
         GPIO leftIn;
+#ifndef PERSPECTIVE_MIDI
         GPIO rightIn;
+#endif
         GPIO leftOut;
         GPIO rightOut;
         GPIO expression;
@@ -109,6 +148,18 @@ namespace perspective {
 
         TimerHandle controlTimer;
 
+#ifdef PERSPECTIVE_MIDI
+        UartHandler midiUart_;
+#endif
+        MidiInput midi_;
+
+        // Tap tempo switch, read raw on every tick (the debouncer only runs every SWITCH_DIVISOR ticks)
+        TapTempo* tapTempo_ = nullptr;
+        GPIO tapPin_;
+        bool tapPressed_ = false;
+        int tapReleasedTicks_ = 0;
+        static constexpr int TAP_RELEASE_TICKS = 20;  // 10ms released before the next press counts
+
         int knobValues_[7] = {0};
     };
 }
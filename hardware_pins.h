@@ -31,6 +31,10 @@
 #define EXPRESSION_PEDAL_PIN seed::D22
 #define TRUE_BYPASS_PIN seed::D0
 
+// MIDI in on USART1 RX (31.25 kbaud), only with make USE_MIDI=1. This is the
+// right input's jack detect pin, which is then given up to the UART
+#define MIDI_RX_PIN seed::D14
+
 // Not strictly used as they are defined in the GFX2 UserConfig.h file
 #define DISPLAY_DC_PIN seed::D12
 #define DISPLAY_RESET_PIN seed::D11
@@ -0,0 +1,343 @@
+#include "cDisplay.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace DadGFX;
+
+// ========== cLayer ==========
+
+void cLayer::init(cDisplay* pDisplay, sColor* pFrame, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t z) {
+    m_pDisplay = pDisplay;
+    m_pFrame = pFrame;
+    m_X = x;
+    m_Y = y;
+    m_Width = width;
+    m_Height = height;
+    m_Z = z;
+}
+
+void cLayer::drawPixel(uint16_t x, uint16_t y, sColor Color) {
+    if (x >= m_Width || y >= m_Height) {
+        return;
+    }
+    m_pFrame[y * m_Width + x] = Color;
+    m_pDisplay->markPixel(m_X + x, m_Y + y);
+}
+
+void cLayer::drawFillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, sColor Color) {
+    for (uint16_t j = y; j < y + height && j < m_Height; j++) {
+        for (uint16_t i = x; i < x + width && i < m_Width; i++) {
+            drawPixel(i, j, Color);
+        }
+    }
+}
+
+void cLayer::drawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t thickness, sColor Color) {
+    drawFillRect(x, y, width, thickness, Color);
+    drawFillRect(x, y + height - thickness, width, thickness, Color);
+    drawFillRect(x, y, thickness, height, Color);
+    drawFillRect(x + width - thickness, y, thickness, height, Color);
+}
+
+void cLayer::eraseLayer(sColor Color) {
+    drawFillRect(0, 0, m_Width, m_Height, Color);
+}
+
+void cLayer::drawText(const char* text) {
+    if (!m_pFont) {
+        return;
+    }
+
+    for (const char* c = text; *c; c++) {
+        uint8_t ch = static_cast<uint8_t>(*c);
+        if (ch < m_pFont->first || ch > m_pFont->last) {
+            continue;
+        }
+
+        // Bitmaps are packed MSB first, continuously across rows
+        const GFXglyph& glyph = m_pFont->glyph[ch - m_pFont->first];
+        uint32_t bit = glyph.bitmapOffset * 8;
+        for (int row = 0; row < glyph.height; row++) {
+            for (int col = 0; col < glyph.width; col++, bit++) {
+                if ((m_pFont->bitmap[bit >> 3] >> (7 - (bit & 7))) & 1) {
+                    drawPixel(m_CursorX + glyph.xOffset + col, m_CursorY + glyph.yOffset + row, m_TextColor);
+                }
+            }
+        }
+        m_CursorX += glyph.xAdvance;
+    }
+}
+
+// ========== cDisplay ==========
+
+cDisplay::cDisplay()
+    : m_Width(TFT_WIDTH)
+    , m_Height(TFT_HEIGHT)
+    , m_BlockWidth(TFT_WIDTH / NB_BLOC_WIDTH)
+    , m_BlockHeight(TFT_HEIGHT / NB_BLOC_HEIGHT)
+    , m_BlocksX(NB_BLOC_WIDTH)
+    , m_BlocksY(NB_BLOC_HEIGHT)
+    , m_pFramebuffer(nullptr)
+    , m_NumLayers(0)
+    , m_PixelsThisFrame(0)
+    , m_LastStats()
+    , m_TotalPixels(0)
+    , m_TotalBlocks(0)
+{
+    memset(m_Dirty, 0, sizeof(m_Dirty));
+}
+
+cDisplay::~cDisplay() {
+    delete[] m_pFramebuffer;
+}
+
+void cDisplay::init() {
+    delete[] m_pFramebuffer;
+    m_pFramebuffer = new uint16_t[TFT_WIDTH * TFT_HEIGHT]();
+    m_NumLayers = 0;
+    m_PixelsThisFrame = 0;
+    m_LastStats = sFrameStats();
+    m_TotalPixels = 0;
+    m_TotalBlocks = 0;
+    memset(m_Dirty, 0, sizeof(m_Dirty));
+}
+
+void cDisplay::setOrientation(Rotation rotation) {
+    // The block grid is defined on the panel, so it rotates with the screen
+    bool landscape = (rotation == Rotation::Degre_90 || rotation == Rotation::Degre_270);
+    m_Width = landscape ? TFT_HEIGHT : TFT_WIDTH;
+    m_Height = landscape ? TFT_WIDTH : TFT_HEIGHT;
+    m_BlocksX = landscape ? NB_BLOC_HEIGHT : NB_BLOC_WIDTH;
+    m_BlocksY = landscape ? NB_BLOC_WIDTH : NB_BLOC_HEIGHT;
+    m_BlockWidth = m_Width / m_BlocksX;
+    m_BlockHeight = m_Height / m_BlocksY;
+}
+
+cLayer* cDisplay::addLayer(sColor* pFrame, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t z) {
+    if (m_NumLayers >= MAX_LAYERS) {
+        return nullptr;
+    }
+
+    int index = m_NumLayers++;
+    m_Layers[index].init(this, pFrame, x, y, width, height, z);
+    for (uint32_t i = 0; i < static_cast<uint32_t>(width) * height; i++) {
+        pFrame[i] = sColor(0, 0, 0, 0);
+    }
+
+    // Keep the draw order sorted by z so compositing is a single bottom-to-top pass
+    int pos = index;
+    while (pos > 0 && m_Layers[m_Order[pos - 1]].getZ() > z) {
+        m_Order[pos] = m_Order[pos - 1];
+        pos--;
+    }
+    m_Order[pos] = index;
+
+    return &m_Layers[index];
+}
+
+void cDisplay::markPixel(int x, int y) {
+    if (x < 0 || y < 0 || x >= m_Width || y >= m_Height) {
+        return;
+    }
+    m_Dirty[(y / m_BlockHeight) * m_BlocksX + (x / m_BlockWidth)] = true;
+    m_PixelsThisFrame++;
+}
+
+void cDisplay::flush() {
+    if (!m_pFramebuffer) {
+        return;
+    }
+
+    uint16_t blocks = 0;
+    for (int by = 0; by < m_BlocksY; by++) {
+        for (int bx = 0; bx < m_BlocksX; bx++) {
+            bool& dirty = m_Dirty[by * m_BlocksX + bx];
+            if (dirty) {
+                compositeBlock(bx, by);
+                dirty = false;
+                blocks++;
+            }
+        }
+    }
+
+    m_LastStats.frame++;
+    m_LastStats.pixelsTouched = m_PixelsThisFrame;
+    m_LastStats.blocksTouched = blocks;
+    m_TotalPixels += m_PixelsThisFrame;
+    m_TotalBlocks += blocks;
+    m_PixelsThisFrame = 0;
+}
+
+void cDisplay::compositeBlock(int bx, int by) {
+    int x0 = bx * m_BlockWidth;
+    int y0 = by * m_BlockHeight;
+
+    for (int y = y0; y < y0 + m_BlockHeight; y++) {
+        for (int x = x0; x < x0 + m_BlockWidth; x++) {
+            // Blend layers bottom to top over black
+            float r = 0.0f, g = 0.0f, b = 0.0f;
+            for (int l = 0; l < m_NumLayers; l++) {
+                const cLayer& layer = m_Layers[m_Order[l]];
+                int lx = x - layer.getX();
+                int ly = y - layer.getY();
+                if (lx < 0 || ly < 0 || lx >= layer.getWidth() || ly >= layer.getHeight()) {
+                    continue;
+                }
+                const sColor& c = layer.getFrame()[ly * layer.getWidth() + lx];
+                float a = c.m_A / 255.0f;
+                r += (c.m_R - r) * a;
+                g += (c.m_G - g) * a;
+                b += (c.m_B - b) * a;
+            }
+
+            // Quantise to RGB565 like the panel (TFT_COLOR 16)
+            uint16_t pixel = ((static_cast<uint16_t>(r + 0.5f) >> 3) << 11)
+                           | ((static_cast<uint16_t>(g + 0.5f) >> 2) << 5)
+                           | (static_cast<uint16_t>(b + 0.5f) >> 3);
+            m_pFramebuffer[y * m_Width + x] = pixel;
+        }
+    }
+}
+
+// ========== Image output ==========
+
+static inline void Rgb565ToRgb888(uint16_t pixel, uint8_t* out) {
+    uint8_t r = (pixel >> 11) & 0x1f;
+    uint8_t g = (pixel >> 5) & 0x3f;
+    uint8_t b = pixel & 0x1f;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+}
+
+bool cDisplay::writePPM(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (!file || !m_pFramebuffer) {
+        if (file) fclose(file);
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", m_Width, m_Height);
+    for (int i = 0; i < m_Width * m_Height; i++) {
+        uint8_t rgb[3];
+        Rgb565ToRgb888(m_pFramebuffer[i], rgb);
+        fwrite(rgb, 1, 3, file);
+    }
+
+    fclose(file);
+    return true;
+}
+
+static uint32_t Crc32(uint32_t crc, const uint8_t* data, size_t length) {
+    static uint32_t table[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableReady = true;
+    }
+
+    crc ^= 0xffffffffu;
+    for (size_t i = 0; i < length; i++) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+static void WriteBigEndian(FILE* file, uint32_t value) {
+    uint8_t bytes[4] = {
+        static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+        static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)
+    };
+    fwrite(bytes, 1, 4, file);
+}
+
+static void WriteChunk(FILE* file, const char* type, const uint8_t* data, uint32_t length) {
+    WriteBigEndian(file, length);
+    fwrite(type, 1, 4, file);
+    if (length > 0) {
+        fwrite(data, 1, length, file);
+    }
+    uint32_t crc = Crc32(0, reinterpret_cast<const uint8_t*>(type), 4);
+    crc = Crc32(crc, data, length);
+    WriteBigEndian(file, crc);
+}
+
+bool cDisplay::writePNG(const char* path) const {
+    if (!m_pFramebuffer) {
+        return false;
+    }
+
+    // Raw scanlines: filter byte 0 followed by RGB888 pixels
+    size_t rowBytes = 1 + m_Width * 3;
+    size_t rawSize = rowBytes * m_Height;
+    uint8_t* raw = new uint8_t[rawSize];
+    for (int y = 0; y < m_Height; y++) {
+        uint8_t* row = raw + y * rowBytes;
+        row[0] = 0;
+        for (int x = 0; x < m_Width; x++) {
+            Rgb565ToRgb888(m_pFramebuffer[y * m_Width + x], row + 1 + x * 3);
+        }
+    }
+
+    // zlib stream made of uncompressed (stored) deflate blocks
+    size_t numBlocks = (rawSize + 65534) / 65535;
+    size_t zlibSize = 2 + rawSize + numBlocks * 5 + 4;
+    uint8_t* zlib = new uint8_t[zlibSize];
+    size_t pos = 0;
+    zlib[pos++] = 0x78;
+    zlib[pos++] = 0x01;
+
+    uint32_t s1 = 1, s2 = 0;
+    for (size_t offset = 0; offset < rawSize; offset += 65535) {
+        size_t length = rawSize - offset < 65535 ? rawSize - offset : 65535;
+        zlib[pos++] = (offset + length == rawSize) ? 1 : 0;
+        zlib[pos++] = length & 0xff;
+        zlib[pos++] = (length >> 8) & 0xff;
+        zlib[pos++] = ~length & 0xff;
+        zlib[pos++] = (~length >> 8) & 0xff;
+        memcpy(zlib + pos, raw + offset, length);
+        pos += length;
+
+        for (size_t i = 0; i < length; i++) {
+            s1 = (s1 + raw[offset + i]) % 65521;
+            s2 = (s2 + s1) % 65521;
+        }
+    }
+    uint32_t adler = (s2 << 16) | s1;
+    zlib[pos++] = adler >> 24;
+    zlib[pos++] = adler >> 16;
+    zlib[pos++] = adler >> 8;
+    zlib[pos++] = adler;
+
+    FILE* file = fopen(path, "wb");
+    bool ok = file != nullptr;
+    if (ok) {
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+        fwrite(signature, 1, 8, file);
+
+        uint8_t header[13] = {
+            static_cast<uint8_t>(m_Width >> 24), static_cast<uint8_t>(m_Width >> 16),
+            static_cast<uint8_t>(m_Width >> 8), static_cast<uint8_t>(m_Width),
+            static_cast<uint8_t>(m_Height >> 24), static_cast<uint8_t>(m_Height >> 16),
+            static_cast<uint8_t>(m_Height >> 8), static_cast<uint8_t>(m_Height),
+            8,  // Bit depth
+            2,  // Colour type: RGB
+            0, 0, 0
+        };
+        WriteChunk(file, "IHDR", header, sizeof(header));
+        WriteChunk(file, "IDAT", zlib, static_cast<uint32_t>(pos));
+        WriteChunk(file, "IEND", nullptr, 0);
+        fclose(file);
+    }
+
+    delete[] raw;
+    delete[] zlib;
+    return ok;
+}
@@ -0,0 +1,162 @@
+//*************************************************************************
+// Headless stand-in for the DaisySeedGFX2 cDisplay/cLayer interface
+//
+// Put the host/ directory ahead of dependencies/DaisySeedGFX2 on the include
+// path to build the UI code (ui/widgets.cpp, ui/textrenderer.cpp,
+// ui/renderer.cpp) on Linux. Layers are composited into an in-memory RGB565
+// framebuffer on flush(), only for the blocks that were touched, exactly like
+// the ST7789 driver. Frames can be dumped as PPM or PNG, and every flush
+// records how many pixels and blocks were touched so UI render cost can be
+// measured and screens regression-tested without the panel.
+//*************************************************************************
+#pragma once
+#ifndef PERSPECTIVE_HOST_CDISPLAY_H
+#define PERSPECTIVE_HOST_CDISPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "UserConfig.h"
+
+enum class Rotation {
+    Degre_0,
+    Degre_90,
+    Degre_180,
+    Degre_270
+};
+
+namespace DadGFX {
+
+struct sColor {
+    uint8_t m_R;
+    uint8_t m_G;
+    uint8_t m_B;
+    uint8_t m_A;
+
+    sColor() : m_R(0), m_G(0), m_B(0), m_A(0) {}
+    sColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) : m_R(r), m_G(g), m_B(b), m_A(a) {}
+};
+
+// Same layout as the GFX2 (Adafruit GFX style) font tables
+struct GFXglyph {
+    uint16_t bitmapOffset;
+    uint8_t  width;
+    uint8_t  height;
+    uint8_t  xAdvance;
+    int8_t   xOffset;
+    int8_t   yOffset;   // From the top of the line
+};
+
+struct GFXCFont {
+    uint8_t*  bitmap;
+    GFXglyph* glyph;
+    uint16_t  first;
+    uint16_t  last;
+    uint8_t   yAdvance;
+};
+
+// Per-flush render cost
+struct sFrameStats {
+    uint32_t frame;          // Frame number (flush count)
+    uint32_t pixelsTouched;  // Pixel writes into any layer since the previous flush
+    uint16_t blocksTouched;  // Display blocks recomposited and "sent"
+};
+
+class cDisplay;
+
+class cLayer {
+public:
+    cLayer() : m_pDisplay(nullptr), m_pFrame(nullptr), m_X(0), m_Y(0), m_Width(0), m_Height(0), m_Z(0),
+               m_CursorX(0), m_CursorY(0), m_pFont(nullptr) {}
+
+    void init(cDisplay* pDisplay, sColor* pFrame, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t z);
+
+    void drawPixel(uint16_t x, uint16_t y, sColor Color);
+    void drawFillRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, sColor Color);
+    void drawRect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t thickness, sColor Color);
+    void eraseLayer(sColor Color = sColor(0, 0, 0, 0));
+
+    // Text (cursor is the top-left corner of the line)
+    void setCursor(uint16_t x, uint16_t y) { m_CursorX = x; m_CursorY = y; }
+    void setFont(GFXCFont* pFont) { m_pFont = pFont; }
+    void setTextFrontColor(sColor Color) { m_TextColor = Color; }
+    void drawText(const char* text);
+
+    // Host-only accessors used by the compositor
+    inline const sColor* getFrame() const { return m_pFrame; }
+    inline uint16_t getX() const { return m_X; }
+    inline uint16_t getY() const { return m_Y; }
+    inline uint16_t getWidth() const { return m_Width; }
+    inline uint16_t getHeight() const { return m_Height; }
+    inline uint8_t getZ() const { return m_Z; }
+
+private:
+    cDisplay* m_pDisplay;
+    sColor*   m_pFrame;
+    uint16_t  m_X, m_Y;
+    uint16_t  m_Width, m_Height;
+    uint8_t   m_Z;
+    uint16_t  m_CursorX, m_CursorY;
+    GFXCFont* m_pFont;
+    sColor    m_TextColor;
+};
+
+class cDisplay {
+public:
+    static constexpr int MAX_LAYERS = 8;
+
+    cDisplay();
+    ~cDisplay();
+
+    void init();
+    void setOrientation(Rotation rotation);
+    cLayer* addLayer(sColor* pFrame, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t z);
+
+    // Composites every touched block into the framebuffer
+    void flush();
+
+    // Called by the layers for every pixel written (screen coordinates)
+    void markPixel(int x, int y);
+
+    // ---- Host-only API ----
+    inline uint16_t getWidth() const { return m_Width; }
+    inline uint16_t getHeight() const { return m_Height; }
+
+    // RGB565 framebuffer, row-major, getWidth() x getHeight()
+    inline const uint16_t* getFramebuffer() const { return m_pFramebuffer; }
+
+    inline const sFrameStats& getLastFrameStats() const { return m_LastStats; }
+    inline uint32_t getTotalPixelsTouched() const { return m_TotalPixels; }
+    inline uint32_t getTotalBlocksTouched() const { return m_TotalBlocks; }
+
+    bool writePPM(const char* path) const;
+    bool writePNG(const char* path) const;
+
+private:
+    void compositeBlock(int bx, int by);
+
+    uint16_t  m_Width, m_Height;
+    uint16_t  m_BlockWidth, m_BlockHeight;
+    uint16_t  m_BlocksX, m_BlocksY;
+    uint16_t* m_pFramebuffer;
+    bool      m_Dirty[NB_BLOC_WIDTH * NB_BLOC_HEIGHT];
+    cLayer    m_Layers[MAX_LAYERS];  // In creation order (pointers handed out stay valid)
+    int       m_Order[MAX_LAYERS];   // Layer indices sorted by z
+    int       m_NumLayers;
+
+    uint32_t    m_PixelsThisFrame;
+    sFrameStats m_LastStats;
+    uint32_t    m_TotalPixels;
+    uint32_t    m_TotalBlocks;
+};
+
+} // namespace DadGFX
+
+#define DECLARE_DISPLAY(Display) DadGFX::cDisplay Display;
+#define INIT_DISPLAY(Display) Display.init();
+#define DECLARE_LAYER(Name, Width, Height) \
+    DadGFX::sColor Name##_Frame[(Width) * (Height)]; \
+    constexpr uint16_t Name##_Width = (Width); \
+    constexpr uint16_t Name##_Height = (Height);
+#define ADD_LAYER(Name, x, y, z) __Display.addLayer(Name##_Frame, x, y, Name##_Width, Name##_Height, z)
+
+#endif // PERSPECTIVE_HOST_CDISPLAY_H
@@ -0,0 +1,115 @@
+// Host benchmark for the partitioned convolver.
+//
+// Convolves noise with a synthetic cabinet-like IR (a decaying, filtered
+// noise burst) at several lengths up to 200ms, checks the output against
+// direct convolution and reports the time per block against the block period.
+// Host timings are only a relative guide to the cost on the pedal.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/convbench.cpp effects/convolver.cpp effects/realfft.cpp -o convbench
+//
+// Options:
+//   --block N        samples per block (default 48)
+//   --rate HZ        sample rate (default 48000)
+//   --seconds S      audio processed per length (default 10)
+
+#include "effects/convolver.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace perspective;
+
+int main(int argc, char** argv) {
+    size_t blockSize = 48;
+    float sampleRate = 48000.0f;
+    float seconds = 10.0f;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            blockSize = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            sampleRate = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = static_cast<float>(atof(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--block N] [--rate HZ] [--seconds S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (blockSize < 1) {
+        fprintf(stderr, "block size must be at least 1\n");
+        return 1;
+    }
+
+    // Decaying low-passed noise, the rough shape of a cabinet IR
+    std::vector<float> ir(ConvolutionIr::MAX_LENGTH);
+    uint32_t seed = 12345;
+    float lowpass = 0.0f;
+    for (size_t i = 0; i < ir.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise = static_cast<float>(static_cast<int32_t>(seed)) / 2147483648.0f;
+        lowpass += 0.3f * (noise - lowpass);
+        ir[i] = lowpass * expf(-static_cast<float>(i) / (0.01f * sampleRate));
+    }
+
+    std::vector<ConvolutionIr::Memory> irMemory(1);
+    std::vector<PartitionedConvolver::History> history(1);
+    ConvolutionIr convolutionIr;
+    convolutionIr.Init(&irMemory[0]);
+    PartitionedConvolver convolver;
+
+    double periodUs = 1e6 * static_cast<double>(blockSize) / sampleRate;
+    size_t blocks = static_cast<size_t>(seconds * sampleRate / static_cast<float>(blockSize));
+    std::vector<float> in(blocks * blockSize), out(blockSize);
+    for (size_t i = 0; i < in.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        in[i] = static_cast<float>(static_cast<int32_t>(seed)) * (0.5f / 2147483648.0f);
+    }
+
+    printf("Block %zu samples at %.0f Hz, period %.1f us\n", blockSize, sampleRate, periodUs);
+    printf("%-8s %10s %10s %10s %8s %12s\n", "IR ms", "partitions", "mean us", "max us", "load", "max error");
+
+    static const float LENGTHS_MS[] = {5.0f, 25.0f, 50.0f, 100.0f, 200.0f};
+    for (float ms : LENGTHS_MS) {
+        size_t length = static_cast<size_t>(ms * 0.001f * sampleRate);
+        if (length > ir.size()) length = ir.size();
+        convolutionIr.Load(ir.data(), length, false);
+        convolver.Init(&convolutionIr, &history[0]);
+
+        double total = 0.0;
+        double worst = 0.0;
+        double maxError = 0.0;
+        size_t checked = 0;
+        for (size_t b = 0; b < blocks; b++) {
+            auto start = std::chrono::steady_clock::now();
+            convolver.Process(&in[b * blockSize], out.data(), blockSize);
+            auto end = std::chrono::steady_clock::now();
+
+            double us = std::chrono::duration<double, std::micro>(end - start).count();
+            total += us;
+            if (us > worst) worst = us;
+
+            // Spot-check against direct convolution, sample for sample (zero latency)
+            for (size_t i = 0; i < blockSize && checked < 4096; i += 7, checked++) {
+                size_t n = b * blockSize + i;
+                double expected = 0.0;
+                for (size_t k = 0; k < length && k <= n; k++) {
+                    expected += static_cast<double>(ir[k]) * in[n - k];
+                }
+                double error = fabs(expected - out[i]);
+                if (error > maxError) maxError = error;
+            }
+        }
+
+        double mean = total / static_cast<double>(blocks);
+        printf("%-8.0f %10zu %10.2f %10.2f %7.1f%% %12.2e\n", ms, convolutionIr.GetActivePartitions(), mean, worst,
+               100.0 * mean / periodUs, maxError);
+    }
+
+    return 0;
+}
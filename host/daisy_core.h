@@ -0,0 +1,48 @@
+//*************************************************************************
+// Host stand-in for the parts of libDaisy's daisy_core.h the control code uses
+//
+// Put the host/ directory on the include path (ahead of libDaisy, if that is
+// on it too) to build ui/switchbank.cpp and ui/portsnapshot.h on Linux.
+// GPIOPort and Pin match libDaisy's declarations, so a port trace loaded
+// with PortSnapshot::Load() is read by the same pin numbers as on the pedal.
+// PortSnapshot::Capture() (ui/portsnapshot.cpp) reads the STM32 registers
+// and is not built on the host.
+//*************************************************************************
+#pragma once
+#ifndef PERSPECTIVE_HOST_DAISY_CORE_H
+#define PERSPECTIVE_HOST_DAISY_CORE_H
+
+#include <stdint.h>
+
+namespace daisy {
+
+enum GPIOPort {
+    PORTA,
+    PORTB,
+    PORTC,
+    PORTD,
+    PORTE,
+    PORTF,
+    PORTG,
+    PORTH,
+    PORTI,
+    PORTJ,
+    PORTK,
+    PORTX  // Unused or unsupported pin
+};
+
+struct Pin {
+    GPIOPort port;
+    uint8_t pin;
+
+    constexpr Pin(const GPIOPort pt, const uint8_t pn) : port(pt), pin(pn) {}
+    constexpr Pin() : port(PORTX), pin(255) {}
+
+    constexpr bool IsValid() const { return port != PORTX && pin <= 15; }
+    constexpr bool operator==(const Pin& rhs) const { return rhs.port == port && rhs.pin == pin; }
+    constexpr bool operator!=(const Pin& rhs) const { return !operator==(rhs); }
+};
+
+} // namespace daisy
+
+#endif // PERSPECTIVE_HOST_DAISY_CORE_H
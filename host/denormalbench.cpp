@@ -0,0 +1,302 @@
+// Host benchmark for subnormal floats in the effects' feedback paths.
+//
+// Feeds each feedback path a burst of loud noise and then silence, and times
+// every block, first with the default floating point mode and then with
+// flush-to-zero (denormals.h, as the audio callback sets it). Once the input
+// is silent the recirculating signal decays towards zero; without
+// flush-to-zero it spends a long time as subnormals, which cost around a
+// hundred cycles per operation on x86. Reports the mean time per block over
+// the burst and over the silence, the worst one-second window of the silence,
+// and the share of the final output that is subnormal.
+//
+// The paths, at settings that decay into the subnormal range quickly:
+//   delay    FractionalDelay lines through the FeedbackMatrix filters, as in
+//            DelayEffect (20ms, feedback 0.8)
+//   chorus   linearly interpolated modulated line, as in ChorusEffect
+//            (8ms, feedback -0.95)
+//   flanger  the same at 1ms, feedback 0.92, as in FlangerEffect
+//   phaser   8 allpass stages with feedback 0.7, a copy of
+//            PhaserEffect::ProcessVoice
+// Host timings are only a relative guide to the cost on the pedal.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/denormalbench.cpp effects/fractionaldelay.cpp effects/feedbackmatrix.cpp -o denormalbench
+//
+// Options:
+//   --block N        samples per block (default 48)
+//   --rate HZ        sample rate (default 48000)
+//   --seconds S      silence after the burst (default 20)
+
+#include "denormals.h"
+#include "effects/fractionaldelay.h"
+#include "effects/feedbackmatrix.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace perspective;
+
+static constexpr double TWO_PI = 6.283185307179586;
+static constexpr size_t LINE_SIZE = 1 << 14;
+static constexpr float BURST_S = 0.5f;
+
+// A stereo feedback path, in blocks of up to FractionalDelay::MAX_BLOCK_SIZE
+class Path {
+public:
+    virtual ~Path() {}
+    virtual void Process(const float* inL, const float* inR, float* outL, float* outR, size_t size) = 0;
+};
+
+// Sine LFO sweeping a delay in samples
+struct Sweep {
+    void Fill(float* delay, size_t size, float rate) {
+        for (size_t i = 0; i < size; i++) {
+            delay[i] = static_cast<float>(center + depth * sin(phase));
+            phase += TWO_PI * hz / rate;
+        }
+    }
+    double center;
+    double depth;
+    double hz;
+    double phase = 0.0;
+};
+
+class DelayPath : public Path {
+public:
+    explicit DelayPath(float rate) : rate_(rate), bufferL_(LINE_SIZE), bufferR_(LINE_SIZE) {
+        lineL_.Init(bufferL_.data(), LINE_SIZE);
+        lineR_.Init(bufferR_.data(), LINE_SIZE);
+        matrix_.Init(rate);
+        matrix_.SetFilters(100.0f, 4000.0f);
+        matrix_.SetCross(0.3f);
+        sweepL_ = {0.020 * rate, 0.001 * rate, 0.5};
+        sweepR_ = {0.020 * rate, 0.001 * rate, 0.5, 1.0};
+        std::fill(feedback_, feedback_ + FractionalDelay::MAX_BLOCK_SIZE, 0.8f);
+    }
+
+    void Process(const float* inL, const float* inR, float* outL, float* outR, size_t size) override {
+        float delayL[FractionalDelay::MAX_BLOCK_SIZE] = {}, delayR[FractionalDelay::MAX_BLOCK_SIZE] = {};
+        float writeL[FractionalDelay::MAX_BLOCK_SIZE] = {}, writeR[FractionalDelay::MAX_BLOCK_SIZE] = {};
+        sweepL_.Fill(delayL, size, rate_);
+        sweepR_.Fill(delayR, size, rate_);
+
+        // DelayEffect::ProcessLines
+        size_t start = 0;
+        while (start < size) {
+            size_t run = FractionalDelay::GetRun(delayL + start, size - start);
+            run = FractionalDelay::GetRun(delayR + start, run);
+            lineL_.Read(delayL + start, outL + start, run);
+            lineR_.Read(delayR + start, outR + start, run);
+            matrix_.Process(inL + start, inR + start, outL + start, outR + start, feedback_, writeL, writeR, run);
+            lineL_.Write(writeL, run);
+            lineR_.Write(writeR, run);
+            start += run;
+        }
+    }
+
+private:
+    float rate_;
+    std::vector<float> bufferL_, bufferR_;
+    FractionalDelay lineL_, lineR_;
+    FeedbackMatrix matrix_;
+    Sweep sweepL_, sweepR_;
+    float feedback_[FractionalDelay::MAX_BLOCK_SIZE];
+};
+
+// Chorus and flanger: a modulated line per side, linear interpolation (as
+// DaisySP's DelayLine), its output fed back into its input
+class ModulatedPath : public Path {
+public:
+    ModulatedPath(float rate, double ms, double depthMs, double hz, float feedback)
+        : rate_(rate), bufferL_(LINE_SIZE), bufferR_(LINE_SIZE) {
+        lineL_.Init(bufferL_.data(), LINE_SIZE);
+        lineR_.Init(bufferR_.data(), LINE_SIZE);
+        lineL_.SetInterpolation(DelayInterpolation::LINEAR);
+        lineR_.SetInterpolation(DelayInterpolation::LINEAR);
+        sweepL_ = {0.001 * ms * rate, 0.001 * depthMs * rate, hz};
+        sweepR_ = {0.001 * ms * rate, 0.001 * depthMs * rate, hz, 1.5};
+        std::fill(feedback_, feedback_ + FractionalDelay::MAX_BLOCK_SIZE, feedback);
+    }
+
+    void Process(const float* inL, const float* inR, float* outL, float* outR, size_t size) override {
+        float delay[FractionalDelay::MAX_BLOCK_SIZE] = {};
+        sweepL_.Fill(delay, size, rate_);
+        lineL_.Process(inL, delay, feedback_, outL, size);
+        sweepR_.Fill(delay, size, rate_);
+        lineR_.Process(inR, delay, feedback_, outR, size);
+    }
+
+private:
+    float rate_;
+    std::vector<float> bufferL_, bufferR_;
+    FractionalDelay lineL_, lineR_;
+    Sweep sweepL_, sweepR_;
+    float feedback_[FractionalDelay::MAX_BLOCK_SIZE];
+};
+
+class PhaserPath : public Path {
+public:
+    explicit PhaserPath(float rate) : rate_(rate) {}
+
+    void Process(const float* inL, const float* inR, float* outL, float* outR, size_t size) override {
+        for (size_t i = 0; i < size; i++) {
+            float lfo = static_cast<float>(sin(phase_));
+            phase_ += TWO_PI * 0.5 / rate_;
+            bool retune = (count_++ & 31) == 0;
+            outL[i] = ProcessVoice(left_, lfo, inL[i], retune);
+            outR[i] = ProcessVoice(right_, -lfo, inR[i], retune);
+        }
+    }
+
+private:
+    static constexpr int POLES = 8;
+    static constexpr float MIN_FREQ = 200.0f;
+    static constexpr float DEPTH = 4.0f;
+    static constexpr float FEEDBACK = 0.7f;
+
+    struct Voice {
+        float state[POLES] = {};
+        float last = 0.0f;
+        float coeff = 0.0f;
+    };
+
+    // PhaserEffect::ProcessVoice at full depth
+    float ProcessVoice(Voice& voice, float lfo, float in, bool retune) {
+        if (retune) {
+            float freq = MIN_FREQ * exp2f(DEPTH * (lfo * 0.5f + 0.5f));
+            float w = 3.14159265f * freq / rate_;
+            voice.coeff = (w - 1.0f) / (w + 1.0f);
+        }
+        float x = in + voice.last * FEEDBACK;
+        for (int i = 0; i < POLES; i++) {
+            float y = voice.coeff * x + voice.state[i];
+            voice.state[i] = x - voice.coeff * y;
+            x = y;
+        }
+        voice.last = x;
+        return (in + x) * 0.5f;
+    }
+
+    float rate_;
+    Voice left_, right_;
+    double phase_ = 0.0;
+    uint32_t count_ = 0;
+};
+
+static std::unique_ptr<Path> MakePath(int index, float rate) {
+    switch (index) {
+        case 0: return std::unique_ptr<Path>(new DelayPath(rate));
+        case 1: return std::unique_ptr<Path>(new ModulatedPath(rate, 8.0, 3.0, 0.8, -0.95f));
+        case 2: return std::unique_ptr<Path>(new ModulatedPath(rate, 1.0, 0.8, 0.3, 0.92f));
+        default: return std::unique_ptr<Path>(new PhaserPath(rate));
+    }
+}
+
+static const char* PATH_NAMES[] = {"delay", "chorus", "flanger", "phaser"};
+
+struct Result {
+    double burstUs;
+    double silenceUs;
+    double worstUs;     // Worst one-second window of the silence, per block
+    double subnormal;   // Share of the last second's output samples
+};
+
+static Result Run(int index, float rate, size_t blockSize, float seconds) {
+    std::unique_ptr<Path> path = MakePath(index, rate);
+    std::vector<float> inL(blockSize), inR(blockSize), outL(blockSize), outR(blockSize);
+
+    size_t burstBlocks = static_cast<size_t>(BURST_S * rate / static_cast<float>(blockSize));
+    size_t silenceBlocks = static_cast<size_t>(seconds * rate / static_cast<float>(blockSize));
+    size_t windowBlocks = std::max<size_t>(1, static_cast<size_t>(rate / static_cast<float>(blockSize)));
+
+    uint32_t seed = 12345;
+    double burst = 0.0, silence = 0.0, window = 0.0, worst = 0.0;
+    size_t inWindow = 0, subnormals = 0, lastSamples = 0;
+    for (size_t b = 0; b < burstBlocks + silenceBlocks; b++) {
+        bool loud = b < burstBlocks;
+        for (size_t i = 0; i < blockSize; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            inL[i] = loud ? static_cast<float>(static_cast<int32_t>(seed)) * (0.8f / 2147483648.0f) : 0.0f;
+            inR[i] = loud ? -inL[i] : 0.0f;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        path->Process(inL.data(), inR.data(), outL.data(), outR.data(), blockSize);
+        auto end = std::chrono::steady_clock::now();
+        double us = std::chrono::duration<double, std::micro>(end - begin).count();
+
+        if (loud) {
+            burst += us;
+            continue;
+        }
+        silence += us;
+        window += us;
+        if (++inWindow == windowBlocks) {
+            worst = std::max(worst, window / static_cast<double>(windowBlocks));
+            window = 0.0;
+            inWindow = 0;
+        }
+        if (b + windowBlocks >= burstBlocks + silenceBlocks) {
+            for (size_t i = 0; i < blockSize; i++) {
+                subnormals += std::fpclassify(outL[i]) == FP_SUBNORMAL;
+                subnormals += std::fpclassify(outR[i]) == FP_SUBNORMAL;
+            }
+            lastSamples += 2 * blockSize;
+        }
+    }
+
+    Result result;
+    result.burstUs = burst / static_cast<double>(burstBlocks);
+    result.silenceUs = silence / static_cast<double>(silenceBlocks);
+    result.worstUs = worst;
+    result.subnormal = lastSamples ? static_cast<double>(subnormals) / static_cast<double>(lastSamples) : 0.0;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    size_t blockSize = 48;
+    float rate = 48000.0f;
+    float seconds = 20.0f;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            blockSize = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            rate = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = static_cast<float>(atof(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--block N] [--rate HZ] [--seconds S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (blockSize < 1 || blockSize > FractionalDelay::MAX_BLOCK_SIZE) {
+        fprintf(stderr, "block size must be 1-%zu\n", FractionalDelay::MAX_BLOCK_SIZE);
+        return 1;
+    }
+    if (seconds < 1.0f) {
+        fprintf(stderr, "silence must be at least 1s\n");
+        return 1;
+    }
+
+    printf("Block %zu samples at %.0f Hz, period %.1f us, %.1fs burst then %.0fs silence\n", blockSize, rate,
+           1e6 * static_cast<double>(blockSize) / rate, BURST_S, seconds);
+    printf("%-9s %-4s %9s %10s %9s %9s\n", "path", "ftz", "burst us", "silence us", "worst us", "subnormal");
+
+    for (int p = 0; p < 4; p++) {
+        for (int ftz = 0; ftz < 2; ftz++) {
+            SetFlushToZero(ftz != 0);
+            Result r = Run(p, rate, blockSize, seconds);
+            printf("%-9s %-4s %9.2f %10.2f %9.2f %8.1f%%\n", PATH_NAMES[p], ftz ? "on" : "off", r.burstUs,
+                   r.silenceUs, r.worstUs, 100.0 * r.subnormal);
+        }
+    }
+    SetFlushToZero(false);
+    return 0;
+}
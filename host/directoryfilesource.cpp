@@ -0,0 +1,70 @@
+#include "directoryfilesource.h"
+
+using namespace perspective;
+
+DirectoryFileSource::DirectoryFileSource(const char* root)
+    : root_(root ? root : "."),
+      reads_(0),
+      bytes_(0) {
+    for (int i = 0; i < MAX_FILES; i++) {
+        files_[i] = nullptr;
+        sizes_[i] = 0;
+    }
+}
+
+DirectoryFileSource::~DirectoryFileSource() {
+    for (int i = 0; i < MAX_FILES; i++) {
+        Close(i);
+    }
+}
+
+int DirectoryFileSource::Open(const char* path) {
+    if (!path) return -1;
+
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (files_[i]) continue;
+
+        // Paths are relative to the root, as on the card
+        std::string full = root_;
+        if (path[0] != '/') full += '/';
+        full += path;
+        FILE* file = fopen(full.c_str(), "rb");
+        if (!file) return -1;
+
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        files_[i] = file;
+        sizes_[i] = size > 0 ? static_cast<uint32_t>(size) : 0;
+        return i;
+    }
+    return -1;
+}
+
+void DirectoryFileSource::Close(int file) {
+    if (file < 0 || file >= MAX_FILES || !files_[file]) return;
+
+    fclose(files_[file]);
+    files_[file] = nullptr;
+    sizes_[file] = 0;
+}
+
+uint32_t DirectoryFileSource::GetSize(int file) const {
+    if (file < 0 || file >= MAX_FILES || !files_[file]) return 0;
+    return sizes_[file];
+}
+
+bool DirectoryFileSource::Seek(int file, uint32_t offset) {
+    if (file < 0 || file >= MAX_FILES || !files_[file]) return false;
+    return fseek(files_[file], static_cast<long>(offset), SEEK_SET) == 0;
+}
+
+int32_t DirectoryFileSource::Read(int file, uint8_t* data, uint32_t size) {
+    if (file < 0 || file >= MAX_FILES || !files_[file]) return -1;
+
+    size_t read = fread(data, 1, size, files_[file]);
+    if (read < size && ferror(files_[file])) return -1;
+    reads_++;
+    bytes_ += read;
+    return static_cast<int32_t>(read);
+}
@@ -0,0 +1,39 @@
+// Host stand-in for the SD card: files under a local directory, through
+// stdio, for running the StreamReader (streamreader.h/cpp) off the pedal.
+#ifndef PERSPECTIVE_HOST_DIRECTORYFILESOURCE_H
+#define PERSPECTIVE_HOST_DIRECTORYFILESOURCE_H
+
+#include "filesource.h"
+
+#include <stdio.h>
+#include <string>
+
+namespace perspective {
+
+class DirectoryFileSource : public FileSource {
+public:
+    explicit DirectoryFileSource(const char* root);
+    ~DirectoryFileSource() override;
+
+    int Open(const char* path) override;
+    void Close(int file) override;
+
+    uint32_t GetSize(int file) const override;
+    bool Seek(int file, uint32_t offset) override;
+    int32_t Read(int file, uint8_t* data, uint32_t size) override;
+
+    // Every Read() call and byte, for checking how the stream reads
+    inline uint32_t GetReadCount() const { return reads_; }
+    inline uint64_t GetBytesRead() const { return bytes_; }
+
+private:
+    std::string root_;
+    FILE* files_[MAX_FILES];
+    uint32_t sizes_[MAX_FILES];
+    uint32_t reads_;
+    uint64_t bytes_;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_HOST_DIRECTORYFILESOURCE_H
@@ -0,0 +1,278 @@
+// Host test for the dual-rate engine.
+//
+// Runs the engine (dualrateengine.h/cpp) with callback blocks drawn at
+// random from 4 to 252 samples (or fixed with --block), and a worker that
+// negates each block, run between callbacks the way the software interrupt
+// would be. Checks:
+//   - latency: the output is the worker's result exactly LATENCY samples
+//     late, with silence before it and no underruns
+//   - late: a block the worker has not finished when it is due is silent and
+//     counted, and the blocks after it are still in step
+//   - preempt: a callback between BeginBlock() and EndBlock() neither sees
+//     nor disturbs the half-done block
+//   - bypass: blocks queued with process false come back silent, and the
+//     processed blocks after them just as late
+//   - skip: a block the worker drops with SkipBlocks() (over its budget) is
+//     silent and counted, and the blocks after it are still in step
+//   - restart: after Stop() and Start() the latency is the same again
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/dualratetest.cpp dualrateengine.cpp -o dualratetest
+//
+// Options:
+//   --block N        fixed samples per callback block, 1-255 (default random)
+//   --seed N         random seed (default 1)
+
+#include "dualrateengine.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace perspective;
+
+static constexpr size_t MAX_CALLBACK_SIZE = DualRateEngine::BLOCK_SIZE - 1;
+
+static uint32_t g_seed = 1;
+static size_t g_block = 0;
+
+static uint32_t Random() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+static size_t NextBlock() {
+    return g_block ? g_block : 4 * (1 + Random() % (MAX_CALLBACK_SIZE / 4));
+}
+
+// Input sample t is t + 1 on the left and -(t + 1) on the right, so every
+// output sample names the input it came from (exact in a float up to 2^24)
+static float Left(size_t t) { return static_cast<float>(t + 1); }
+static float Right(size_t t) { return -static_cast<float>(t + 1); }
+
+struct Harness {
+    Harness() { engine.Start(); }
+
+    // The effect: negate
+    static void Negate(const DualRateEngine::Job& job) {
+        for (size_t i = 0; i < DualRateEngine::BLOCK_SIZE; i++) {
+            job.outL[i] = -job.inL[i];
+            job.outR[i] = -job.inR[i];
+        }
+    }
+
+    // Everything queued so far
+    void Work() {
+        DualRateEngine::Job job;
+        while (engine.BeginBlock(&job)) {
+            Negate(job);
+            engine.EndBlock();
+        }
+    }
+
+    // One callback block; the worker runs after it unless held
+    void Callback(size_t n, bool process = true, bool work = true) {
+        float inL[MAX_CALLBACK_SIZE] = {}, inR[MAX_CALLBACK_SIZE] = {};
+        float yL[MAX_CALLBACK_SIZE], yR[MAX_CALLBACK_SIZE];
+        for (size_t i = 0; i < n; i++) {
+            inL[i] = Left(time + i);
+            inR[i] = Right(time + i);
+        }
+        bool queued = engine.Process(inL, inR, yL, yR, n, process);
+        for (size_t i = 0; i < n; i++) {
+            outL.push_back(yL[i]);
+            outR.push_back(yR[i]);
+        }
+        time += n;
+        if (queued && work) Work();
+    }
+
+    void Run(size_t frames, bool process = true) {
+        size_t end = time + frames;
+        while (time < end) {
+            size_t n = NextBlock();
+            if (n > end - time) n = end - time;
+            Callback(n, process);
+        }
+    }
+
+    // Output sample t is silence, or input t - LATENCY negated
+    bool Expect(size_t t, bool silent) const {
+        if (silent) return outL[t] == 0.0f && outR[t] == 0.0f;
+        size_t source = t - DualRateEngine::LATENCY;
+        return outL[t] == -Left(source) && outR[t] == -Right(source);
+    }
+
+    DualRateEngine engine;
+    std::vector<float> outL, outR;
+    size_t time = 0;
+};
+
+static bool Check(const char* name, bool ok) {
+    printf("%-10s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool TestLatency() {
+    Harness h;
+    h.Run(100 * DualRateEngine::BLOCK_SIZE + Random() % 1000);
+    bool ok = h.engine.GetUnderruns() == 0;
+    for (size_t t = 0; t < h.outL.size() && ok; t++) {
+        ok = h.Expect(t, t < DualRateEngine::LATENCY);
+    }
+    return Check("latency", ok);
+}
+
+static bool TestLate() {
+    Harness h;
+    h.Run(10 * DualRateEngine::BLOCK_SIZE);
+
+    // Hold the worker until just past the next block's deadline: that block
+    // is missed
+    size_t end = (h.time / DualRateEngine::BLOCK_SIZE + 2) * DualRateEngine::BLOCK_SIZE + 1;
+    while (h.time < end) {
+        size_t n = NextBlock();
+        if (n > end - h.time) n = end - h.time;
+        h.Callback(n, true, false);
+    }
+    h.Work();
+    h.Run(10 * DualRateEngine::BLOCK_SIZE);
+
+    // One block is silent; all the rest are on time
+    uint32_t missed = 0;
+    bool ok = true;
+    for (size_t block = 0; block * DualRateEngine::BLOCK_SIZE < h.outL.size() && ok; block++) {
+        size_t start = block * DualRateEngine::BLOCK_SIZE;
+        bool silent = h.outL[start] == 0.0f;
+        if (silent && start >= DualRateEngine::LATENCY) missed++;
+        for (size_t t = start; t < start + DualRateEngine::BLOCK_SIZE && t < h.outL.size() && ok; t++) {
+            ok = h.Expect(t, silent);
+        }
+    }
+    ok = ok && missed == 1 && h.engine.GetUnderruns() == 1;
+    return Check("late", ok);
+}
+
+static bool TestPreempt() {
+    Harness h;
+    h.Run(5 * DualRateEngine::BLOCK_SIZE);
+
+    // Fill a block with the worker held, start on it, and let callbacks run
+    // until it is due
+    size_t end = (h.time / DualRateEngine::BLOCK_SIZE + 1) * DualRateEngine::BLOCK_SIZE;
+    while (h.time < end) {
+        size_t n = NextBlock();
+        if (n > end - h.time) n = end - h.time;
+        h.Callback(n, true, false);
+    }
+    DualRateEngine::Job job;
+    bool ok = h.engine.BeginBlock(&job);
+    for (size_t i = 0; i < DualRateEngine::BLOCK_SIZE / 2; i++) {
+        job.outL[i] = -job.inL[i];
+        job.outR[i] = -job.inR[i];
+    }
+    size_t due = end + DualRateEngine::BLOCK_SIZE;
+    while (h.time < due + DualRateEngine::BLOCK_SIZE / 2) {
+        size_t n = NextBlock();
+        if (n > due + DualRateEngine::BLOCK_SIZE / 2 - h.time) n = due + DualRateEngine::BLOCK_SIZE / 2 - h.time;
+        h.Callback(n, true, false);
+    }
+    Harness::Negate(job);
+    h.engine.EndBlock();
+    h.Work();
+    h.Run(5 * DualRateEngine::BLOCK_SIZE);
+
+    // Only the half-done block is lost
+    for (size_t t = 0; t < h.outL.size() && ok; t++) {
+        bool silent = t < DualRateEngine::LATENCY || (t >= due && t < due + DualRateEngine::BLOCK_SIZE);
+        ok = h.Expect(t, silent);
+    }
+    ok = ok && h.engine.GetUnderruns() == 1;
+    return Check("preempt", ok);
+}
+
+static bool TestBypass() {
+    Harness h;
+    size_t blocks = 6;
+    h.Run(blocks * DualRateEngine::BLOCK_SIZE);
+    h.Run(blocks * DualRateEngine::BLOCK_SIZE, false);
+    h.Run(blocks * DualRateEngine::BLOCK_SIZE);
+
+    // A block is processed or silent as it was flagged when it was completed
+    bool ok = h.engine.GetUnderruns() == 0;
+    for (size_t t = DualRateEngine::LATENCY; t < h.outL.size() && ok; t++) {
+        size_t block = (t - DualRateEngine::LATENCY) / DualRateEngine::BLOCK_SIZE;
+        ok = h.Expect(t, block >= blocks && block < 2 * blocks);
+    }
+    return Check("bypass", ok);
+}
+
+static bool TestSkip() {
+    Harness h;
+    h.Run(5 * DualRateEngine::BLOCK_SIZE);
+
+    // Let two blocks queue with the worker held, then run the first and drop
+    // the second, as the worker does once it is over its budget
+    size_t end = (h.time / DualRateEngine::BLOCK_SIZE + 2) * DualRateEngine::BLOCK_SIZE;
+    while (h.time < end) {
+        size_t n = NextBlock();
+        if (n > end - h.time) n = end - h.time;
+        h.Callback(n, true, false);
+    }
+    DualRateEngine::Job job;
+    bool ok = h.engine.BeginBlock(&job);
+    Harness::Negate(job);
+    h.engine.EndBlock();
+    ok = ok && h.engine.SkipBlocks() == 1 && !h.engine.BeginBlock(&job);
+    h.Run(5 * DualRateEngine::BLOCK_SIZE);
+
+    // Only the dropped block is lost
+    size_t dropped = end - DualRateEngine::BLOCK_SIZE + DualRateEngine::LATENCY;
+    for (size_t t = 0; t < h.outL.size() && ok; t++) {
+        bool silent = t < DualRateEngine::LATENCY || (t >= dropped && t < dropped + DualRateEngine::BLOCK_SIZE);
+        ok = h.Expect(t, silent);
+    }
+    ok = ok && h.engine.GetUnderruns() == 1;
+    return Check("skip", ok);
+}
+
+static bool TestRestart() {
+    Harness h;
+    h.Run(8 * DualRateEngine::BLOCK_SIZE + Random() % DualRateEngine::BLOCK_SIZE);
+    h.engine.Stop();
+    h.engine.Start();
+
+    size_t restart = h.time;
+    h.Run(8 * DualRateEngine::BLOCK_SIZE);
+    bool ok = h.engine.GetUnderruns() == 0;
+    for (size_t t = restart; t < h.outL.size() && ok; t++) {
+        ok = h.Expect(t, t < restart + DualRateEngine::LATENCY);
+    }
+    return Check("restart", ok);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            g_block = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            g_seed = static_cast<uint32_t>(atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--block N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (g_block > MAX_CALLBACK_SIZE) {
+        fprintf(stderr, "block size must be 1-%zu\n", MAX_CALLBACK_SIZE);
+        return 1;
+    }
+
+    bool ok = TestLatency();
+    ok = TestLate() && ok;
+    ok = TestPreempt() && ok;
+    ok = TestBypass() && ok;
+    ok = TestSkip() && ok;
+    ok = TestRestart() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,270 @@
+// Host test for the looper engine.
+//
+// Drives the looper (effects/looper.h/cpp) with block sizes drawn at random
+// from 1 to 256 (or fixed with --block) and checks:
+//   - length: a loop is exactly the frames fed between the two Record
+//     commands, and plays back sample for sample, pass after pass
+//   - crossfade: with a closing crossfade the loop still repeats exactly
+//   - overdub and undo: the overdubbed loop is the sum of both takes, undo
+//     gives back the first take and a second undo the sum again; an overdub
+//     undone part way round leaves the loop as it was
+//   - reverse: playback steps backwards one frame at a time, wrapping
+//   - memory: recording past the pool closes the loop at the pool size
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/looptest.cpp effects/looper.cpp -o looptest
+//
+// Options:
+//   --block N        fixed samples per block (default random)
+//   --seed N         random seed (default 1)
+
+#include "effects/looper.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace perspective;
+
+static uint32_t g_seed = 1;
+static size_t g_block = 0;
+
+static uint32_t Random() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+static size_t NextBlock() {
+    return g_block ? g_block : 1 + Random() % Looper::MAX_BLOCK_SIZE;
+}
+
+// The looper's 16-bit sample for x
+static int32_t Quantize(float x) {
+    int32_t q = static_cast<int32_t>(x * 32767.0f + (x < 0.0f ? -0.5f : 0.5f));
+    return q < -32768 ? -32768 : (q > 32767 ? 32767 : q);
+}
+
+static int32_t Sample(float y) {
+    return static_cast<int32_t>(lrintf(y * 32767.0f));
+}
+
+// Stereo source: left and right different, so a swap would show
+struct Source {
+    float Left(size_t t) const { return 0.4f * sinf(0.0123f * static_cast<float>(t) * scale) + offset; }
+    float Right(size_t t) const { return 0.3f * cosf(0.0071f * static_cast<float>(t) * scale) - offset; }
+    float scale;
+    float offset;
+};
+
+struct Harness {
+    explicit Harness(size_t poolFrames) : pool(poolFrames) { looper.Init(pool.data(), pool.size()); }
+
+    // Runs frames through the looper in random blocks, appending the output
+    void Run(const Source* source, size_t frames, std::vector<int32_t>* outL = nullptr,
+             std::vector<int32_t>* outR = nullptr) {
+        float inL[Looper::MAX_BLOCK_SIZE], inR[Looper::MAX_BLOCK_SIZE];
+        float yL[Looper::MAX_BLOCK_SIZE], yR[Looper::MAX_BLOCK_SIZE];
+        size_t done = 0;
+        while (done < frames) {
+            size_t n = NextBlock();
+            if (n > frames - done) n = frames - done;
+            for (size_t i = 0; i < n; i++) {
+                inL[i] = source ? source->Left(time + i) : 0.0f;
+                inR[i] = source ? source->Right(time + i) : 0.0f;
+            }
+            looper.Process(inL, inR, yL, yR, n);
+            for (size_t i = 0; i < n; i++) {
+                if (outL) outL->push_back(Sample(yL[i]));
+                if (outR) outR->push_back(Sample(yR[i]));
+            }
+            time += n;
+            done += n;
+        }
+    }
+
+    std::vector<uint32_t> pool;
+    Looper looper;
+    size_t time = 0;
+};
+
+static bool Check(const char* name, bool ok) {
+    printf("%-10s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool TestLength() {
+    bool ok = true;
+    for (int trial = 0; trial < 8 && ok; trial++) {
+        Harness h(1 << 20);
+        Source a = {1.0f + 0.1f * static_cast<float>(trial), 0.0f};
+        h.Run(&a, Random() % 1000);
+
+        h.looper.Record();
+        size_t start = h.time;
+        h.Run(&a, 2000 + Random() % 40000);
+        h.looper.Record();
+        size_t length = h.time - start;
+        ok = ok && h.looper.GetLength() == length;
+
+        std::vector<int32_t> outL, outR;
+        h.Run(nullptr, 5 * length, &outL, &outR);
+        for (size_t t = 0; t < outL.size() && ok; t++) {
+            size_t source = start + t % length;
+            ok = outL[t] == Quantize(a.Left(source)) && outR[t] == Quantize(a.Right(source));
+        }
+    }
+    return Check("length", ok);
+}
+
+static bool TestCrossfade() {
+    Harness h(1 << 20);
+    h.looper.SetCrossfade(480);
+    Source a = {1.0f, 0.0f};
+    h.looper.Record();
+    h.Run(&a, 10000 + Random() % 10000);
+    h.looper.Record();
+    size_t length = h.looper.GetLength();
+
+    // The first pass still has the closing crossfade streaming into it
+    std::vector<int32_t> outL, outR;
+    h.Run(&a, 4 * length, &outL, &outR);
+    bool ok = true;
+    for (size_t t = length; t + length < outL.size() && ok; t++) {
+        ok = outL[t] == outL[t + length] && outR[t] == outR[t + length];
+    }
+    return Check("crossfade", ok);
+}
+
+static bool TestOverdub() {
+    Harness h(1 << 20);
+    Source a = {1.0f, 0.1f};
+    Source b = {2.3f, -0.05f};
+    h.looper.Record();
+    size_t start = h.time;
+    h.Run(&a, 5000 + Random() % 5000);
+    h.looper.Record();
+    size_t length = h.looper.GetLength();
+
+    std::vector<int32_t> firstL(length), firstR(length);
+    for (size_t p = 0; p < length; p++) {
+        firstL[p] = Quantize(a.Left(start + p));
+        firstR[p] = Quantize(a.Right(start + p));
+    }
+
+    // Overdub b for a pass and a bit, from wherever the head is
+    h.Run(nullptr, Random() % length);
+    size_t position = h.looper.GetPosition();
+    h.looper.Record();
+    size_t dubStart = h.time;
+    h.Run(&b, length + Random() % length);
+    h.looper.Record();
+    size_t dubEnd = h.time;
+
+    std::vector<int32_t> sumL = firstL, sumR = firstR;
+    for (size_t t = dubStart; t < dubEnd; t++) {
+        size_t p = (position + (t - dubStart)) % length;
+        int32_t l = sumL[p] + Quantize(b.Left(t));
+        int32_t r = sumR[p] + Quantize(b.Right(t));
+        sumL[p] = l < -32768 ? -32768 : (l > 32767 ? 32767 : l);
+        sumR[p] = r < -32768 ? -32768 : (r > 32767 ? 32767 : r);
+    }
+
+    // Compare a whole pass, from position 0, against the expected loop
+    auto matches = [&](const std::vector<int32_t>& expectL, const std::vector<int32_t>& expectR) {
+        size_t skip = (length - h.looper.GetPosition()) % length;
+        h.Run(nullptr, skip);
+        std::vector<int32_t> outL, outR;
+        h.Run(nullptr, length, &outL, &outR);
+        for (size_t p = 0; p < length; p++) {
+            if (abs(outL[p] - expectL[p]) > 1 || abs(outR[p] - expectR[p]) > 1) return false;
+        }
+        return true;
+    };
+
+    bool ok = matches(sumL, sumR);
+    h.Run(nullptr, length);
+    ok = ok && h.looper.CanUndo();
+    h.looper.Undo();
+    ok = ok && matches(firstL, firstR);
+    h.looper.Undo();
+    ok = ok && matches(sumL, sumR);
+
+    // An overdub called off before it has gone round leaves the loop as it was
+    h.looper.Record();
+    h.Run(&a, length / 3);
+    h.looper.Undo();
+    ok = ok && matches(sumL, sumR);
+    return Check("overdub", ok);
+}
+
+static bool TestReverse() {
+    Harness h(1 << 20);
+    size_t length = 3000 + Random() % 10000;
+
+    // A ramp, so each output names the frame it came from
+    h.looper.Record();
+    {
+        float inL[Looper::MAX_BLOCK_SIZE], inR[Looper::MAX_BLOCK_SIZE], y[Looper::MAX_BLOCK_SIZE];
+        size_t done = 0;
+        while (done < length) {
+            size_t n = NextBlock();
+            if (n > length - done) n = length - done;
+            for (size_t i = 0; i < n; i++) {
+                inL[i] = static_cast<float>(done + i) / 32767.0f;
+                inR[i] = -inL[i];
+            }
+            h.looper.Process(inL, inR, y, y, n);
+            done += n;
+        }
+    }
+    h.looper.Record();
+
+    h.Run(nullptr, Random() % length);
+    h.looper.SetReverse(true);
+    std::vector<int32_t> outL, outR;
+    h.Run(nullptr, 3 * length, &outL, &outR);
+
+    // The first block turns round; from then on each frame is the one before
+    bool ok = true;
+    for (size_t t = Looper::MAX_BLOCK_SIZE; t + 1 < outL.size() && ok; t++) {
+        int32_t expect = outL[t] == 0 ? static_cast<int32_t>(length) - 1 : outL[t] - 1;
+        ok = outL[t + 1] == expect && outR[t + 1] == -expect;
+    }
+    return Check("reverse", ok);
+}
+
+static bool TestMemory() {
+    Harness h(50000);
+    Source a = {1.0f, 0.0f};
+    h.looper.Record();
+    h.Run(&a, 60000);
+    bool ok = h.looper.GetLength() == 50000 && h.looper.GetState() == Looper::State::PLAYING &&
+              !h.looper.CanUndo();
+    return Check("memory", ok);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            g_block = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            g_seed = static_cast<uint32_t>(atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--block N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (g_block > Looper::MAX_BLOCK_SIZE) {
+        fprintf(stderr, "block size must be 1-%zu\n", Looper::MAX_BLOCK_SIZE);
+        return 1;
+    }
+
+    bool ok = TestLength();
+    ok = TestCrossfade() && ok;
+    ok = TestOverdub() && ok;
+    ok = TestReverse() && ok;
+    ok = TestMemory() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+// Host replay tool for the MIDI input engine.
+//
+// Feeds a recorded MIDI stream through MidiInput with the same split as the
+// firmware: bytes go out at 31.25 kbaud wire timing and are delivered in the
+// chunks the UART DMA callback would see (up to line idle, or the half and full
+// marks of the 64-byte circular buffer), and Process() runs on a simulated main
+// loop. Prints the CC / program change / tempo callbacks and queue statistics.
+// With --clock, a clock mixed into a dense stream shares chunks with other
+// bytes, and the tempo must come out within TEMPO_TOLERANCE of the clock's.
+// Before the replay, a few fixed bursts check that CCs and program changes
+// fire in arrival order, so a CC after a program change reaches the new preset.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/midireplay.cpp midiinput.cpp -o midireplay
+//
+// Input formats:
+//   *.txt  - one message per line: "<time in ms> <hex bytes...>", '#' starts a comment
+//   other  - raw MIDI bytes, sent back to back at wire speed
+//
+// Options:
+//   --loop-us N      main loop period (default 1000)
+//   --budget N       bytes parsed per main loop pass (default 256)
+//   --channel N      receive channel 1-16 (default omni)
+//   --clock BPM      mix a MIDI clock at BPM into the stream
+//   --jitter US      random timing jitter on the generated clock (default 0)
+//   --quiet          statistics only
+
+#include "midiinput.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace perspective;
+
+static constexpr uint32_t BYTE_TIME_US = MidiInput::BYTE_TIME_US;
+static constexpr size_t RX_BUFFER_SIZE = 64;  // As in hardware.cpp
+static constexpr float TEMPO_TOLERANCE = 0.5f;  // BPM
+
+struct TimedBytes {
+    uint32_t timeUs;
+    std::vector<uint8_t> bytes;
+};
+
+static bool EndsWith(const std::string& s, const char* suffix) {
+    size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static bool LoadText(const char* path, std::vector<TimedBytes>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    char line[1024];
+    while (fgets(line, sizeof(line), f)) {
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+
+        char* p = line;
+        char* end;
+        double ms = strtod(p, &end);
+        if (end == p) continue;
+        p = end;
+
+        TimedBytes entry;
+        entry.timeUs = static_cast<uint32_t>(ms * 1000.0);
+        for (;;) {
+            long value = strtol(p, &end, 16);
+            if (end == p) break;
+            entry.bytes.push_back(static_cast<uint8_t>(value));
+            p = end;
+        }
+        if (!entry.bytes.empty()) out.push_back(entry);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool LoadRaw(const char* path, std::vector<TimedBytes>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+
+    TimedBytes entry;
+    entry.timeUs = 0;
+    int c;
+    while ((c = fgetc(f)) != EOF) {
+        entry.bytes.push_back(static_cast<uint8_t>(c));
+    }
+    fclose(f);
+    if (!entry.bytes.empty()) out.push_back(entry);
+    return true;
+}
+
+static void AddClock(std::vector<TimedBytes>& out, float bpm, uint32_t jitterUs, uint32_t durationUs) {
+    double tickUs = 60000000.0 / (bpm * MidiClock::PPQN);
+    srand(1);
+    for (double t = 0.0; t < durationUs; t += tickUs) {
+        int32_t jitter = jitterUs ? static_cast<int32_t>(rand() % (2 * jitterUs + 1)) - static_cast<int32_t>(jitterUs) : 0;
+        int64_t time = static_cast<int64_t>(t) + jitter;
+        out.push_back({static_cast<uint32_t>(time < 0 ? 0 : time), {MIDI_CLOCK}});
+    }
+}
+
+// Bytes delivered in one chunk and parsed in one pass, and the callbacks they must give
+struct OrderCase {
+    std::vector<uint8_t> bytes;
+    const char* expected;
+};
+
+static bool CheckOrder() {
+    static const OrderCase CASES[] = {
+        {{0xC0, 0x05, 0xB0, 0x15, 0x40}, "PC 5, CC 21=64, "},
+        {{0xB0, 0x15, 0x10, 0x15, 0x11, 0xC0, 0x05, 0xB0, 0x15, 0x40, 0x15, 0x41}, "CC 21=17, PC 5, CC 21=65, "},
+        {{0xB0, 0x15, 0x10, 0x16, 0x20, 0xC0, 0x03, 0x05, 0xB0, 0x16, 0x21}, "CC 21=16, CC 22=32, PC 5, CC 22=33, "},
+    };
+
+    bool ok = true;
+    for (const OrderCase& test : CASES) {
+        MidiInput midi;
+        midi.Init();
+        std::string log;
+        char text[32];
+        midi.SetControlChangeCallback([&](uint8_t cc, uint8_t value) {
+            snprintf(text, sizeof(text), "CC %u=%u, ", cc, value);
+            log += text;
+        });
+        midi.SetProgramChangeCallback([&](uint8_t program) {
+            snprintf(text, sizeof(text), "PC %u, ", program);
+            log += text;
+        });
+        midi.Receive(test.bytes.data(), test.bytes.size(), 0);
+        midi.Process();
+        if (log != test.expected) {
+            printf("Ordering: got \"%s\", expected \"%s\"\n", log.c_str(), test.expected);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    uint32_t loopUs = 1000;
+    size_t budget = 256;
+    int channel = MidiInput::OMNI;
+    float clockBpm = 0.0f;
+    uint32_t jitterUs = 0;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--loop-us") && i + 1 < argc) loopUs = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--budget") && i + 1 < argc) budget = static_cast<size_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--channel") && i + 1 < argc) channel = atoi(argv[++i]) - 1;
+        else if (!strcmp(argv[i], "--clock") && i + 1 < argc) clockBpm = static_cast<float>(atof(argv[++i]));
+        else if (!strcmp(argv[i], "--jitter") && i + 1 < argc) jitterUs = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--quiet")) quiet = true;
+        else path = argv[i];
+    }
+
+    if (!CheckOrder()) return 4;
+
+    std::vector<TimedBytes> stream;
+    if (path) {
+        bool ok = EndsWith(path, ".txt") ? LoadText(path, stream) : LoadRaw(path, stream);
+        if (!ok) {
+            fprintf(stderr, "Can't read %s\n", path);
+            return 1;
+        }
+    }
+    if (clockBpm > 0.0f) {
+        uint32_t lastUs = 0;
+        for (const TimedBytes& entry : stream) {
+            lastUs = std::max(lastUs, entry.timeUs + static_cast<uint32_t>(entry.bytes.size()) * BYTE_TIME_US);
+        }
+        AddClock(stream, clockBpm, jitterUs, std::max(lastUs, 8000000u));
+    }
+    if (stream.empty()) {
+        fprintf(stderr, "Usage: %s [options] <stream.txt|stream.bin>\n", argv[0]);
+        return 1;
+    }
+    std::stable_sort(stream.begin(), stream.end(),
+                     [](const TimedBytes& a, const TimedBytes& b) { return a.timeUs < b.timeUs; });
+
+    MidiInput midi;
+    midi.Init(channel);
+
+    uint32_t now = 0;
+    uint32_t ccCalls = 0, pcCalls = 0, tempoCalls = 0;
+    midi.SetControlChangeCallback([&](uint8_t cc, uint8_t value) {
+        ccCalls++;
+        if (!quiet) printf("%10.3f ms  CC %3u = %3u\n", now / 1000.0, cc, value);
+    });
+    midi.SetProgramChangeCallback([&](uint8_t program) {
+        pcCalls++;
+        if (!quiet) printf("%10.3f ms  PC %3u\n", now / 1000.0, program);
+    });
+    midi.SetTempoCallback([&](float bpm) {
+        tempoCalls++;
+        if (!quiet) printf("%10.3f ms  Tempo %.2f BPM\n", now / 1000.0, bpm);
+    });
+
+    // Serialise onto the wire: a byte can't start before the previous one has been sent.
+    // Real-time bytes (the generated clock) go between the bytes of other messages,
+    // as a sender would put them, so they wait at most one byte time. Each byte
+    // has arrived when its stop bit has.
+    std::vector<TimedBytes> realtime, messages;
+    for (const TimedBytes& entry : stream) {
+        bool single = entry.bytes.size() == 1 && entry.bytes[0] >= MIDI_CLOCK;
+        (single ? realtime : messages).push_back(entry);
+    }
+    struct WireByte { uint32_t timeUs; uint8_t byte; };
+    std::vector<WireByte> wire;
+    size_t r = 0, m = 0, b = 0;
+    uint32_t t = 0;
+    while (r < realtime.size() || m < messages.size()) {
+        uint32_t messageReady = m < messages.size() ? std::max(t, b ? t : messages[m].timeUs) : UINT32_MAX;
+        uint32_t realtimeReady = r < realtime.size() ? std::max(t, realtime[r].timeUs) : UINT32_MAX;
+        uint8_t byte;
+        if (realtimeReady <= messageReady) {
+            t = realtimeReady;
+            byte = realtime[r++].bytes[0];
+        } else {
+            t = messageReady;
+            byte = messages[m].bytes[b++];
+            if (b == messages[m].bytes.size()) {
+                m++;
+                b = 0;
+            }
+        }
+        t += BYTE_TIME_US;
+        wire.push_back({t, byte});
+    }
+
+    // Split into DMA callbacks: one at the half and full marks of the circular
+    // buffer, as the last byte arrives, and one a byte time after the line
+    // goes idle
+    struct Chunk { uint32_t timeUs; std::vector<uint8_t> bytes; };
+    std::vector<Chunk> chunks;
+    size_t position = 0;
+    for (size_t i = 0; i < wire.size(); i++) {
+        if (chunks.empty() || chunks.back().timeUs) chunks.push_back({0, {}});
+        chunks.back().bytes.push_back(wire[i].byte);
+        position = (position + 1) % RX_BUFFER_SIZE;
+        if (position % (RX_BUFFER_SIZE / 2) == 0) {
+            chunks.back().timeUs = wire[i].timeUs;
+        } else if (i + 1 == wire.size() || wire[i + 1].timeUs > wire[i].timeUs + BYTE_TIME_US) {
+            chunks.back().timeUs = wire[i].timeUs + BYTE_TIME_US;
+        }
+    }
+
+    size_t next = 0;
+    uint32_t nextLoop = loopUs;
+    size_t parsed = 0;
+    while (next < chunks.size() || midi.GetQueued() > 0) {
+        // Deliver everything that arrives before the next main loop pass
+        while (next < chunks.size() && chunks[next].timeUs <= nextLoop) {
+            now = chunks[next].timeUs;
+            midi.Receive(chunks[next].bytes.data(), chunks[next].bytes.size(), now);
+            next++;
+        }
+        now = nextLoop;
+        parsed += midi.Process(budget);
+        nextLoop += loopUs;
+    }
+
+    const MidiClock& clock = midi.GetClock();
+    printf("\n");
+    printf("Duration:        %.3f s\n", now / 1000000.0);
+    printf("Bytes on wire:   %zu (%zu parsed, %zu DMA callbacks)\n", wire.size(), parsed, chunks.size());
+    printf("Messages:        %u\n", midi.GetMessageCount());
+    printf("CC callbacks:    %u\n", ccCalls);
+    printf("PC callbacks:    %u\n", pcCalls);
+    printf("Tempo updates:   %u (last %.2f BPM, %u ticks rejected)\n", tempoCalls, clock.GetBpm(), clock.GetRejectedCount());
+    printf("Max queued:      %zu of %zu bytes\n", midi.GetMaxQueued(), MidiInput::QUEUE_SIZE);
+    printf("Overflows:       %u\n", midi.GetOverflowCount());
+
+    if (midi.GetOverflowCount()) return 2;
+    if (clockBpm > 0.0f && !(fabsf(clock.GetBpm() - clockBpm) <= TEMPO_TOLERANCE)) {
+        printf("Tempo off by more than %.1f BPM\n", TEMPO_TOLERANCE);
+        return 3;
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+// Host benchmark for the neural amp model engine.
+//
+// Loads .nam files (or, with none given, synthetic models with random weights
+// in the standard NAM trainer shapes) through NamModel, runs a sine sweep
+// through each and reports the arena each one needs and its real-time factor
+// (processing time / audio time). Models whose arena is larger than the
+// pedal's are flagged; the real-time factor on the pedal has to be measured
+// there, host timings only rank the architectures against each other.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/nambench.cpp effects/nammodel.cpp -o nambench
+//
+// Options:
+//   --block N        samples per Process call (default 64, as AmpModelEffect)
+//   --rate HZ        sample rate (default 48000)
+//   --seconds S      audio processed per model (default 5)
+//   --arena FLOATS   pedal arena size to check against (default 32768)
+//   file.nam ...     models to benchmark instead of the synthetic set
+
+#include "effects/nammodel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace perspective;
+
+static constexpr size_t HOST_ARENA_FLOATS = 8 * 1024 * 1024;
+
+struct Model {
+    std::string name;
+    std::string json;
+};
+
+static uint32_t g_random = 12345;
+
+static float Random() {
+    g_random = g_random * 1664525u + 1013904223u;
+    return static_cast<float>(static_cast<int32_t>(g_random)) * (0.2f / 2147483648.0f);
+}
+
+static void AppendWeights(std::string& json, size_t count) {
+    json += "\"weights\": [";
+    char value[32];
+    for (size_t i = 0; i < count; i++) {
+        snprintf(value, sizeof(value), "%s%.6f", i ? ", " : "", Random());
+        json += value;
+    }
+    json += "]";
+}
+
+static Model MakeLstm(int layers, int hidden) {
+    size_t weights = 0;
+    for (int l = 0; l < layers; l++) {
+        int in = l == 0 ? 1 : hidden;
+        weights += 4 * hidden * (in + hidden) + 4 * hidden + 2 * hidden;
+    }
+    weights += hidden + 1;
+
+    char config[160];
+    snprintf(config, sizeof(config),
+             "{\"version\": \"0.5.0\", \"architecture\": \"LSTM\", \"config\": {\"num_layers\": %d, \"input_size\": 1, \"hidden_size\": %d}, ",
+             layers, hidden);
+    Model model;
+    model.name = "LSTM " + std::to_string(layers) + "x" + std::to_string(hidden);
+    model.json = config;
+    AppendWeights(model.json, weights);
+    model.json += ", \"sample_rate\": 48000}";
+    return model;
+}
+
+// Two layer arrays, as the NAM trainer's standard/lite/feather/nano presets
+static Model MakeWaveNet(const char* name, int channels, bool full) {
+    static const int FULL[] = {1, 2, 4, 8, 16, 32, 64, 128, 256, 512};
+    static const int SHORT_1[] = {1, 2, 4, 8, 16, 32, 64};
+    static const int SHORT_2[] = {128, 256, 512, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512};
+
+    const int* dilations[2] = {full ? FULL : SHORT_1, full ? FULL : SHORT_2};
+    int counts[2] = {full ? 10 : 7, full ? 10 : 13};
+    int arrayChannels[2] = {channels, channels / 2};
+    int inputs[2] = {1, channels};
+    int heads[2] = {channels / 2, 1};
+
+    std::string layers = "[";
+    size_t weights = 0;
+    for (int a = 0; a < 2; a++) {
+        int c = arrayChannels[a];
+        std::string list;
+        for (int i = 0; i < counts[a]; i++) {
+            list += (i ? ", " : "") + std::to_string(dilations[a][i]);
+        }
+        char text[320];
+        snprintf(text, sizeof(text),
+                 "%s{\"input_size\": %d, \"condition_size\": 1, \"head_size\": %d, \"channels\": %d, \"kernel_size\": 3, "
+                 "\"dilations\": [%s], \"activation\": \"Tanh\", \"gated\": false, \"head_bias\": %s}",
+                 a ? ", " : "", inputs[a], heads[a], c, list.c_str(), a ? "true" : "false");
+        layers += text;
+
+        weights += c * inputs[a];
+        weights += counts[a] * (3 * c * c + c + c + c * c + c);
+        weights += heads[a] * c + (a ? heads[a] : 0);
+    }
+    layers += "]";
+    weights += 1;
+
+    Model model;
+    model.name = std::string("WaveNet ") + name;
+    model.json = "{\"version\": \"0.5.0\", \"architecture\": \"WaveNet\", \"config\": {\"layers\": " + layers +
+                 ", \"head\": null, \"head_scale\": 0.02}, ";
+    AppendWeights(model.json, weights);
+    model.json += ", \"sample_rate\": 48000}";
+    return model;
+}
+
+static bool ReadFile(const char* path, std::string& text) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, n);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t blockSize = 64;
+    float sampleRate = 48000.0f;
+    float seconds = 5.0f;
+    size_t pedalArena = 32768;
+    std::vector<Model> models;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            blockSize = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            sampleRate = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--arena") && i + 1 < argc) {
+            pedalArena = static_cast<size_t>(atol(argv[++i]));
+        } else if (argv[i][0] != '-') {
+            Model model;
+            model.name = argv[i];
+            if (!ReadFile(argv[i], model.json)) {
+                fprintf(stderr, "cannot read %s\n", argv[i]);
+                return 1;
+            }
+            models.push_back(model);
+        } else {
+            fprintf(stderr, "usage: %s [--block N] [--rate HZ] [--seconds S] [--arena FLOATS] [file.nam ...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (blockSize < 1) {
+        fprintf(stderr, "block size must be at least 1\n");
+        return 1;
+    }
+
+    if (models.empty()) {
+        models.push_back(MakeLstm(1, 8));
+        models.push_back(MakeLstm(1, 12));
+        models.push_back(MakeLstm(1, 16));
+        models.push_back(MakeLstm(2, 8));
+        models.push_back(MakeWaveNet("nano", 4, false));
+        models.push_back(MakeWaveNet("feather", 8, false));
+        models.push_back(MakeWaveNet("lite", 12, false));
+        models.push_back(MakeWaveNet("standard", 16, true));
+    }
+
+    std::vector<float> arena(HOST_ARENA_FLOATS);
+    std::vector<float> in(blockSize), out(blockSize);
+    size_t blocks = static_cast<size_t>(seconds * sampleRate / static_cast<float>(blockSize));
+    double periodUs = 1e6 * static_cast<double>(blockSize) / sampleRate;
+
+    printf("Block %zu samples at %.0f Hz, pedal arena %zu floats\n", blockSize, sampleRate, pedalArena);
+    printf("%-20s %8s %10s %6s %10s %10s %8s\n", "model", "weights", "arena", "fits", "mean us", "max us", "RTF");
+
+    for (const Model& model : models) {
+        NamModel nam;
+        nam.SetArena(arena.data(), arena.size());
+        NamModel::LoadResult result = nam.Load(model.json.data(), model.json.size(), blockSize);
+        if (result != NamModel::LoadResult::OK) {
+            printf("%-20s %s\n", model.name.c_str(), NamModel::GetResultName(result));
+            continue;
+        }
+
+        float phase = 0.0f;
+        double total = 0.0;
+        double worst = 0.0;
+        for (size_t b = 0; b < blocks; b++) {
+            // Exponential sweep, 40Hz to 4kHz over the run
+            for (size_t i = 0; i < blockSize; i++) {
+                float t = static_cast<float>(b * blockSize + i) / (static_cast<float>(blocks * blockSize));
+                phase += 40.0f * powf(100.0f, t) / sampleRate;
+                phase -= floorf(phase);
+                in[i] = 0.5f * sinf(6.28318530718f * phase);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            nam.Process(in.data(), out.data(), blockSize);
+            auto end = std::chrono::steady_clock::now();
+
+            double us = std::chrono::duration<double, std::micro>(end - start).count();
+            total += us;
+            if (us > worst) worst = us;
+        }
+
+        double mean = total / static_cast<double>(blocks);
+        printf("%-20s %8zu %10zu %6s %10.2f %10.2f %8.4f\n", model.name.c_str(), nam.GetWeightCount(), nam.GetArenaUsed(),
+               nam.GetArenaUsed() <= pedalArena ? "yes" : "no", mean, worst, mean / periodUs);
+    }
+
+    return 0;
+}
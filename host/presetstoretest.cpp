@@ -0,0 +1,202 @@
+// Host test for the preset store.
+//
+// Runs the preset store (presetstore.h/cpp) on SimulatedPresetFlash
+// (presetflash.h/cpp), which behaves like NOR flash, with small sectors so the
+// log goes round the region many times. After every change a second store is
+// started on the same flash, as after a power cycle, and must see the same
+// presets. Checks:
+//   - recall: saved values, effect and audio configuration come back, and
+//     deleted slots stay empty
+//   - wrap: thousands of saves take the log round the region; every slot
+//     still recalls its latest save, and every sector is erased about
+//     equally often
+//   - power: saves cut off after a random number of programmed bytes
+//     (including during a sector change and reclaim) leave every slot at its
+//     previous or its new values, and the store keeps working
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/presetstoretest.cpp presetstore.cpp presetflash.cpp -o presetstoretest
+//
+// Options:
+//   --saves N        saves in the wrap and power tests (default 5000)
+//   --seed N         random seed (default 1)
+
+#include "presetstore.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace perspective;
+
+static constexpr uint32_t SECTOR_SIZE = 512;
+static constexpr uint32_t NUM_SECTORS = 8;
+static constexpr int NUM_SLOTS = 10;
+
+static uint32_t g_seed = 1;
+static int g_saves = 5000;
+
+static uint32_t Random() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+// What a slot should hold, kept alongside the flash
+struct Expected {
+    bool used = false;
+    uint8_t effectId = 0;
+    uint8_t audioConfig = 0;
+    size_t count = 0;
+    float values[PresetStore::MAX_VALUES] = {};
+};
+
+static Expected RandomPreset() {
+    Expected e;
+    e.used = true;
+    e.effectId = static_cast<uint8_t>(Random() % 12);
+    e.audioConfig = static_cast<uint8_t>(Random() % 256);
+    e.count = 1 + Random() % PresetStore::MAX_VALUES;
+    for (size_t i = 0; i < e.count; i++) {
+        e.values[i] = static_cast<float>(Random() % 100000) * 0.01f;
+    }
+    return e;
+}
+
+static bool Save(PresetStore& store, int slot, const Expected& e) {
+    return store.Save(static_cast<uint8_t>(slot), e.effectId, e.values, e.count, e.audioConfig);
+}
+
+static bool Matches(const PresetRecord* record, const Expected& e) {
+    if (!e.used) return record == nullptr;
+    return record && record->effectId == e.effectId && record->audioConfig == e.audioConfig &&
+           record->numValues == e.count && memcmp(record->GetValues(), e.values, e.count * sizeof(float)) == 0;
+}
+
+// A fresh store on the flash, as after a power cycle, holds exactly what is expected
+static bool Reboot(SimulatedPresetFlash& flash, const Expected* expected) {
+    PresetStore store;
+    if (!store.Init(&flash)) return false;
+    for (int slot = 0; slot < PresetStore::MAX_PRESETS; slot++) {
+        Expected none;
+        if (!Matches(store.Find(static_cast<uint8_t>(slot)), slot < NUM_SLOTS ? expected[slot] : none)) return false;
+    }
+    return true;
+}
+
+static bool Check(const char* name, bool ok) {
+    printf("%-10s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool TestRecall() {
+    SimulatedPresetFlash flash(NUM_SECTORS * SECTOR_SIZE, SECTOR_SIZE);
+    PresetStore store;
+    bool ok = store.Init(&flash) && store.GetLatestSlot() == -1 && store.GetNextSlot(-1) == -1;
+
+    Expected expected[NUM_SLOTS];
+    static constexpr int SLOTS[] = {3, 7, 1};
+    for (int slot : SLOTS) {
+        expected[slot] = RandomPreset();
+        ok = ok && Save(store, slot, expected[slot]);
+    }
+    ok = ok && store.GetLatestSlot() == 1 && store.GetNextSlot(1) == 3 && store.GetNextSlot(7) == 1;
+
+    // Saving over a slot replaces it, and a deletion empties it
+    expected[3] = RandomPreset();
+    ok = ok && Save(store, 3, expected[3]) && store.GetLatestSlot() == 3;
+    expected[7] = Expected();
+    ok = ok && store.Delete(7) && store.Find(7) == nullptr;
+
+    for (int slot = 0; slot < NUM_SLOTS && ok; slot++) {
+        ok = Matches(store.Find(static_cast<uint8_t>(slot)), expected[slot]);
+    }
+    ok = ok && Reboot(flash, expected);
+
+    // Out of range slots and value counts
+    float values[PresetStore::MAX_VALUES + 4] = {};
+    ok = ok && !store.Save(PresetStore::MAX_PRESETS, 0, values, 1) && !store.Save(0, PresetStore::DELETED, values, 1);
+    ok = ok && store.Save(0, 0, values, PresetStore::MAX_VALUES + 4) && store.Find(0)->numValues == PresetStore::MAX_VALUES;
+    return Check("recall", ok);
+}
+
+static bool TestWrap() {
+    SimulatedPresetFlash flash(NUM_SECTORS * SECTOR_SIZE, SECTOR_SIZE);
+    PresetStore store;
+    bool ok = store.Init(&flash);
+
+    Expected expected[NUM_SLOTS];
+    for (int i = 0; i < g_saves && ok; i++) {
+        int slot = static_cast<int>(Random() % NUM_SLOTS);
+        expected[slot] = RandomPreset();
+        ok = Save(store, slot, expected[slot]);
+        if (ok && i % 97 == 0) ok = Reboot(flash, expected);
+    }
+    ok = ok && Reboot(flash, expected);
+
+    // Every sector has been used many times over, and evenly
+    uint32_t least = flash.GetMinEraseCount();
+    uint32_t most = flash.GetMaxEraseCount();
+    printf("  %d saves, erases per sector %u to %u\n", g_saves, least, most);
+    ok = ok && least >= 10 && most - least <= 1;
+    return Check("wrap", ok);
+}
+
+static bool TestPower() {
+    SimulatedPresetFlash flash(NUM_SECTORS * SECTOR_SIZE, SECTOR_SIZE);
+    Expected expected[NUM_SLOTS];
+    bool ok = true;
+    int cut = 0;
+
+    for (int i = 0; i < g_saves && ok; i++) {
+        PresetStore store;
+        ok = store.Init(&flash);
+        if (!ok) break;
+
+        // Power goes after a random number of bytes: anywhere in the record,
+        // or in the sector header and copied records when the head moves on
+        int slot = static_cast<int>(Random() % NUM_SLOTS);
+        Expected next = Random() % 8 == 0 ? Expected() : RandomPreset();
+        bool limited = Random() % 2 == 0;
+        uint32_t range = Random() % 4 ? PresetStore::MAX_VALUES * sizeof(float) + sizeof(PresetRecord) : 2 * SECTOR_SIZE;
+        if (limited) flash.SetWriteLimit(static_cast<int32_t>(Random() % range));
+        bool saved = next.used ? Save(store, slot, next) : store.Delete(static_cast<uint8_t>(slot));
+        flash.SetWriteLimit(-1);
+        if (!saved) cut++;
+
+        // After the power cycle the slot holds the old or the new preset,
+        // and the new one when the save reported success
+        PresetStore after;
+        ok = after.Init(&flash);
+        const PresetRecord* record = ok ? after.Find(static_cast<uint8_t>(slot)) : nullptr;
+        if (ok && Matches(record, next)) {
+            expected[slot] = next;
+        } else {
+            ok = ok && !saved && Matches(record, expected[slot]);
+        }
+        ok = ok && Reboot(flash, expected);
+    }
+    printf("  %d saves, %d cut off\n", g_saves, cut);
+    return Check("power", ok && cut > 0);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--saves") && i + 1 < argc) {
+            g_saves = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            g_seed = static_cast<uint32_t>(atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--saves N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (g_saves < 1000) {
+        fprintf(stderr, "at least 1000 saves are needed to wrap the log\n");
+        return 1;
+    }
+
+    bool ok = TestRecall();
+    ok = TestWrap() && ok;
+    ok = TestPower() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+// Host benchmark for the reverb engine.
+//
+// Runs ReverbEngine over a burst of noise followed by silence at each quality
+// step and reports the time per audio block against the block period.
+// Host timings are only a relative guide; the same loop on the pedal is what
+// decides whether a quality step fits the budget.
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/reverbbench.cpp effects/reverbengine.cpp -o reverbbench
+//
+// Options:
+//   --block N        samples per block (default 48)
+//   --rate HZ        sample rate (default 48000)
+//   --seconds S      audio processed per quality step (default 10)
+//   --budget PCT     share of the block period the reverb may use (default 40)
+
+#include "effects/reverbengine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace perspective;
+
+int main(int argc, char** argv) {
+    size_t blockSize = 48;
+    float sampleRate = 48000.0f;
+    float seconds = 10.0f;
+    float budget = 40.0f;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            blockSize = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--rate") && i + 1 < argc) {
+            sampleRate = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = static_cast<float>(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--budget") && i + 1 < argc) {
+            budget = static_cast<float>(atof(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--block N] [--rate HZ] [--seconds S] [--budget PCT]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (blockSize < 1 || blockSize > ReverbChannel::MAX_BLOCK_SIZE) {
+        fprintf(stderr, "block size must be 1-%zu\n", ReverbChannel::MAX_BLOCK_SIZE);
+        return 1;
+    }
+
+    std::vector<ReverbChannel::Memory> memory(2);
+    ReverbEngine engine;
+    engine.Init(sampleRate, &memory[0], &memory[1]);
+    engine.SetDecay(4.0f);
+    engine.SetSize(0.8f);
+    engine.SetDamping(6000.0f);
+    engine.SetDiffusion(0.7f);
+    engine.SetPreDelay(0.02f);
+    engine.SetModulation(0.5f, 0.3f);
+
+    std::vector<float> inL(blockSize), inR(blockSize), outL(blockSize), outR(blockSize);
+    size_t blocks = static_cast<size_t>(seconds * sampleRate / static_cast<float>(blockSize));
+    double periodUs = 1e6 * static_cast<double>(blockSize) / sampleRate;
+
+    printf("Block %zu samples at %.0f Hz, period %.1f us, budget %.0f%%\n", blockSize, sampleRate, periodUs, budget);
+    printf("%-8s %6s %8s %10s %10s %8s\n", "quality", "lines", "stages", "mean us", "max us", "load");
+
+    for (int step = 0; step <= 3; step++) {
+        engine.Clear();
+        engine.SetQuality(static_cast<float>(step) / 3.0f);
+
+        uint32_t noise = 22222;
+        double total = 0.0;
+        double worst = 0.0;
+        for (size_t b = 0; b < blocks; b++) {
+            // One second of noise, then the tail decays into silence
+            bool burst = static_cast<float>(b * blockSize) < sampleRate;
+            for (size_t i = 0; i < blockSize; i++) {
+                noise = noise * 1664525u + 1013904223u;
+                float x = burst ? static_cast<float>(static_cast<int32_t>(noise)) * (0.25f / 2147483648.0f) : 0.0f;
+                inL[i] = x;
+                inR[i] = -x;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            engine.Process(inL.data(), inR.data(), outL.data(), outR.data(), blockSize);
+            auto end = std::chrono::steady_clock::now();
+
+            double us = std::chrono::duration<double, std::micro>(end - start).count();
+            total += us;
+            if (us > worst) worst = us;
+        }
+
+        double mean = total / static_cast<double>(blocks);
+        double load = 100.0 * mean / periodUs;
+        printf("%-8.2f %6d %8d %10.2f %10.2f %7.1f%%%s\n", static_cast<float>(step) / 3.0f,
+               engine.GetLeft().GetLineCount(), engine.GetLeft().GetDiffuserStages(),
+               mean, worst, load, load > budget ? "  over budget" : "");
+    }
+
+    return 0;
+}
@@ -0,0 +1,251 @@
+// Host test for the SD card streaming layer.
+//
+// Writes test files to a temporary directory and streams them through the
+// StreamReader (streamreader.h/cpp) on the directory stand-in for the card
+// (host/directoryfilesource.h/cpp), with block sizes drawn at random from 1
+// to 256 frames (or fixed with --block), and checks:
+//   - bytes: a file comes out byte for byte, with no underruns, when the main
+//     loop services the stream every block
+//   - loop: a looping range repeats exactly, across many wraps
+//   - underrun: a starved stream counts underruns and pads with silence, but
+//     picks up where it left off, so no data is skipped
+//   - wav: 16-bit mono and 24-bit stereo WAV files decode frame for frame,
+//     also through underruns, with halves that are not a whole number of frames
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. -Ihost host/streamtest.cpp streamreader.cpp effects/wavfile.cpp host/directoryfilesource.cpp -o streamtest
+//
+// Options:
+//   --block N        fixed frames per block (default random)
+//   --half N         bytes per buffer half, at least 4096 (default 4099)
+//   --seed N         random seed (default 1)
+
+#include "streamreader.h"
+#include "directoryfilesource.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace perspective;
+
+static uint32_t g_seed = 1;
+static size_t g_block = 0;
+static uint32_t g_half = 4099;
+static std::string g_dir;
+
+static uint32_t Random() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+static size_t NextBlock() {
+    return g_block ? g_block : 1 + Random() % StreamReader::MAX_BLOCK_SIZE;
+}
+
+// Blocks between services that drain both halves and then some
+static size_t Starved(size_t frameBytes) {
+    size_t average = (g_block ? g_block : StreamReader::MAX_BLOCK_SIZE / 2) * frameBytes;
+    return 1 + 3 * g_half / average;
+}
+
+static bool Check(const char* name, bool ok) {
+    printf("%-10s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static void WriteFile(const char* name, const std::vector<uint8_t>& data) {
+    FILE* file = fopen((g_dir + "/" + name).c_str(), "wb");
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+}
+
+static std::vector<uint8_t> RandomBytes(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(Random());
+    }
+    return data;
+}
+
+static void Put16(std::vector<uint8_t>* out, uint32_t value) {
+    out->push_back(static_cast<uint8_t>(value));
+    out->push_back(static_cast<uint8_t>(value >> 8));
+}
+
+static void Put32(std::vector<uint8_t>* out, uint32_t value) {
+    Put16(out, value & 0xFFFF);
+    Put16(out, value >> 16);
+}
+
+// PCM WAV with a LIST chunk ahead of the data, so the data is not at 44
+static std::vector<uint8_t> MakeWav(uint16_t channels, uint16_t bits, const std::vector<int32_t>& samples) {
+    std::vector<uint8_t> out;
+    uint32_t bytes = static_cast<uint32_t>(samples.size()) * (bits / 8);
+    out.insert(out.end(), {'R', 'I', 'F', 'F'});
+    Put32(&out, 4 + 26 + 8 + 16 + 8 + bytes);
+    out.insert(out.end(), {'W', 'A', 'V', 'E', 'L', 'I', 'S', 'T'});
+    Put32(&out, 18);
+    out.insert(out.end(), 18, 0);
+    out.insert(out.end(), {'f', 'm', 't', ' '});
+    Put32(&out, 16);
+    Put16(&out, 1);
+    Put16(&out, channels);
+    Put32(&out, 48000);
+    Put32(&out, 48000 * channels * (bits / 8));
+    Put16(&out, channels * (bits / 8));
+    Put16(&out, bits);
+    out.insert(out.end(), {'d', 'a', 't', 'a'});
+    Put32(&out, bytes);
+    for (int32_t sample : samples) {
+        for (int b = 0; b < bits / 8; b++) {
+            out.push_back(static_cast<uint8_t>(sample >> (8 * b)));
+        }
+    }
+    return out;
+}
+
+struct Harness {
+    Harness() : files(g_dir.c_str()), buffer(2 * g_half) { stream.Init(&files, buffer.data(), g_half); }
+
+    // Blocks of 4-byte frames as the callback would take them, servicing the
+    // stream every 'every' blocks, until 'bytes' have been delivered or the
+    // stream has finished; returns the bytes delivered, in order
+    std::vector<uint8_t> Run(size_t bytes, size_t every) {
+        std::vector<uint8_t> delivered;
+        uint8_t block[StreamReader::MAX_BLOCK_SIZE * 4];
+        for (size_t pass = 0; delivered.size() < bytes && !stream.IsFinished() && pass < 10000000; pass++) {
+            if (pass % every == 0) stream.Service();
+            size_t n = NextBlock() * 4;
+            if (n > bytes - delivered.size()) n = bytes - delivered.size();
+            size_t got = stream.Read(block, n);
+            for (size_t i = got; i < n; i++) {
+                if (block[i] != 0) return {};  // Shortfall must be silence
+            }
+            delivered.insert(delivered.end(), block, block + got);
+        }
+        return delivered;
+    }
+
+    DirectoryFileSource files;
+    std::vector<uint8_t> buffer;
+    StreamReader stream;
+};
+
+static bool TestBytes() {
+    std::vector<uint8_t> data = RandomBytes(100000 + Random() % 50000);
+    WriteFile("bytes.bin", data);
+
+    Harness h;
+    bool ok = h.stream.Open("bytes.bin");
+    std::vector<uint8_t> out = h.Run(data.size() + 1000, 1);
+    ok = ok && out == data && h.stream.GetUnderruns() == 0 && h.stream.IsFinished();
+
+    // Missing files and empty ranges are refused
+    ok = ok && !h.stream.Open("missing.bin") && !h.stream.Open("bytes.bin", static_cast<uint32_t>(data.size()));
+    return Check("bytes", ok);
+}
+
+static bool TestLoop() {
+    std::vector<uint8_t> data = RandomBytes(20000);
+    WriteFile("loop.bin", data);
+
+    // A range shorter than a half, so a half holds several wraps
+    Harness h;
+    uint32_t offset = 100 + Random() % 1000;
+    uint32_t length = 1000 + Random() % 3000;
+    bool ok = h.stream.Open("loop.bin", offset, length, true);
+    std::vector<uint8_t> out = h.Run(50 * length, 1);
+    for (size_t i = 0; i < out.size() && ok; i++) {
+        ok = out[i] == data[offset + i % length];
+    }
+    ok = ok && out.size() == 50 * length && h.stream.GetUnderruns() == 0 && !h.stream.IsFinished();
+    return Check("loop", ok);
+}
+
+static bool TestUnderrun() {
+    std::vector<uint8_t> data = RandomBytes(200000);
+    WriteFile("underrun.bin", data);
+
+    // Serviced far less often than the halves drain
+    Harness h;
+    bool ok = h.stream.Open("underrun.bin");
+    std::vector<uint8_t> out = h.Run(data.size() + 1000, Starved(4));
+    ok = ok && h.stream.GetUnderruns() > 0 && out == data;
+    return Check("underrun", ok);
+}
+
+static bool TestWav() {
+    bool ok = true;
+    const uint16_t channels[] = {1, 2};
+    const uint16_t bits[] = {16, 24};
+    for (int format = 0; format < 2 && ok; format++) {
+        size_t frames = 30000 + Random() % 10000;
+        std::vector<int32_t> samples(frames * channels[format]);
+        int32_t range = 1 << (bits[format] - 1);
+        for (int32_t& sample : samples) {
+            sample = static_cast<int32_t>(Random() % (2 * range)) - range;
+        }
+        WriteFile("track.wav", MakeWav(channels[format], bits[format], samples));
+
+        // Starved every other format, to show underruns keep frames whole
+        Harness h;
+        ok = h.stream.OpenWav("track.wav") && h.stream.GetFormat().frames == frames;
+        size_t every = format == 1 ? Starved(channels[format] * bits[format] / 8) : 1;
+        float left[StreamReader::MAX_BLOCK_SIZE], right[StreamReader::MAX_BLOCK_SIZE];
+        size_t frame = 0;
+        for (size_t pass = 0; frame < frames && pass < 10000000 && ok; pass++) {
+            if (pass % every == 0) h.stream.Service();
+            size_t got = h.stream.ReadFrames(left, right, NextBlock());
+            for (size_t i = 0; i < got && ok; i++, frame++) {
+                int32_t l = samples[frame * channels[format]];
+                int32_t r = samples[frame * channels[format] + channels[format] - 1];
+                ok = left[i] == static_cast<float>(l) / static_cast<float>(range) &&
+                     right[i] == static_cast<float>(r) / static_cast<float>(range);
+            }
+        }
+        ok = ok && frame == frames && (every == 1) == (h.stream.GetUnderruns() == 0);
+    }
+    return Check("wav", ok);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            g_block = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--half") && i + 1 < argc) {
+            g_half = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            g_seed = static_cast<uint32_t>(atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--block N] [--half N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (g_block > StreamReader::MAX_BLOCK_SIZE || g_half < 4096) {
+        fprintf(stderr, "block size must be 1-%zu, half at least 4096 bytes\n", StreamReader::MAX_BLOCK_SIZE);
+        return 1;
+    }
+
+    char dir[] = "/tmp/streamtestXXXXXX";
+    if (!mkdtemp(dir)) {
+        fprintf(stderr, "cannot create a temporary directory\n");
+        return 1;
+    }
+    g_dir = dir;
+
+    bool ok = TestBytes();
+    ok = TestLoop() && ok;
+    ok = TestUnderrun() && ok;
+    ok = TestWav() && ok;
+
+    const char* names[] = {"bytes.bin", "loop.bin", "underrun.bin", "track.wav"};
+    for (const char* name : names) {
+        unlink((g_dir + "/" + name).c_str());
+    }
+    rmdir(dir);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+// Host test for the parallel switch debouncer.
+//
+// Feeds SwitchBank (ui/switchbank.h/cpp) simulated GPIO port traces through
+// PortSnapshot::Load(), one snapshot per control scan, the way the control
+// timer does after PortSnapshot::Capture(). Lanes sit on several ports, mostly
+// pressed LOW (as wired on the panel) with one pressed HIGH, and the other pins
+// of each port carry noise. Each press and release bounces for a while, in
+// runs shorter than the debounce window, before it settles. Checks:
+//   - edges: exactly one press edge and one release edge per press, never
+//     during the bounce, and Pressed() only between them (from the scan after
+//     the press edge; it drops out while a release bounces)
+//   - latency: every edge comes on the lane's HISTORY - 1th settled sample, the
+//     same for every lane, and lanes that settle on the same scan give their
+//     edges on the same scan
+//   - state: State() equals Switch's 8-bit shift register of the lane's samples
+//   - idle: ActiveMask() clears once every lane has settled
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -Ihost -I. host/switchbanktest.cpp ui/switchbank.cpp -o switchbanktest
+//
+// Options:
+//   --presses N      presses per lane (default 200)
+//   --bounce N       longest bounce, in scans (default 20)
+//   --seed N         random seed (default 1)
+
+#include "ui/switchbank.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace daisy;
+using namespace perspective;
+
+static uint32_t g_seed = 1;
+static int g_presses = 200;
+static int g_bounce = 20;
+
+static uint32_t Random() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+// Scans from the first settled sample to the edge: the edge comes once the
+// HISTORY - 1 newest samples are all the new level
+static constexpr int LATENCY = SwitchBank::HISTORY - 2;
+// Longest run of one level inside a bounce; a run of HISTORY - 1 would be a press
+static constexpr int MAX_RUN = 3;
+
+struct Lane {
+    Pin pin;
+    bool inverted;
+};
+
+static const Lane LANES[] = {
+    {Pin(PORTA, 0), true},  {Pin(PORTA, 3), true},  {Pin(PORTA, 15), true},
+    {Pin(PORTB, 2), true},  {Pin(PORTB, 9), false}, {Pin(PORTG, 11), true},
+    {Pin(PORTK, 1), true},
+};
+static constexpr int NUM_LANES = sizeof(LANES) / sizeof(LANES[0]);
+
+// Pressed level of one lane for every scan, and the scans where it settles
+struct Trace {
+    std::vector<bool> level;
+    std::vector<size_t> pressSettles, releaseSettles;
+};
+
+// Bounce for up to g_bounce scans, then settle at 'to' from the returned scan on
+static size_t Transition(std::vector<bool>& level, bool to) {
+    int length = g_bounce ? static_cast<int>(Random() % (g_bounce + 1)) : 0;
+    bool current = !to;
+    int run = 0;
+    for (int i = 0; i < length; i++) {
+        bool flip = run >= MAX_RUN || Random() % 2 == 0;
+        if (flip) {
+            current = !current;
+            run = 0;
+        }
+        run++;
+        level.push_back(current);
+    }
+    // The sample before the settle is the old level, so the settle scan is exact
+    level.push_back(!to);
+    size_t settle = level.size();
+    return settle;
+}
+
+static void Hold(std::vector<bool>& level, bool value, size_t scans) {
+    level.insert(level.end(), scans, value);
+}
+
+static Trace MakeTrace(size_t start) {
+    Trace trace;
+    Hold(trace.level, false, start);
+    for (int i = 0; i < g_presses; i++) {
+        trace.pressSettles.push_back(Transition(trace.level, true));
+        Hold(trace.level, true, SwitchBank::HISTORY + Random() % 40);
+        trace.releaseSettles.push_back(Transition(trace.level, false));
+        Hold(trace.level, false, SwitchBank::HISTORY + Random() % 40);
+    }
+    return trace;
+}
+
+struct Run {
+    // Scans on which each lane gave a press or release edge
+    std::vector<size_t> rising[NUM_LANES], falling[NUM_LANES];
+    bool pressedOk = true, stateOk = true, idleOk = true;
+};
+
+// Every lane's level per scan into the port registers, scan by scan
+static Run Play(const std::vector<bool>* levels, size_t scans) {
+    SwitchBank bank;
+    for (const Lane& lane : LANES) bank.AddLane(lane.pin, lane.inverted);
+
+    Run run;
+    uint8_t state[NUM_LANES] = {};
+    bool pressed[NUM_LANES] = {};
+    for (size_t scan = 0; scan < scans; scan++) {
+        // Noise on every pin, then each lane's pin at its level
+        PortSnapshot snapshot;
+        uint32_t idr[PortSnapshot::NUM_PORTS];
+        for (uint32_t& port : idr) port = Random() & 0xFFFF;
+        for (int i = 0; i < NUM_LANES; i++) {
+            bool level = scan < levels[i].size() ? levels[i][scan] : false;
+            bool high = level != LANES[i].inverted;
+            uint32_t bit = 1u << LANES[i].pin.pin;
+            idr[LANES[i].pin.port] = high ? (idr[LANES[i].pin.port] | bit) : (idr[LANES[i].pin.port] & ~bit);
+            state[i] = static_cast<uint8_t>((state[i] << 1) | (level ? 1 : 0));
+        }
+        for (int port = 0; port < PortSnapshot::NUM_PORTS; port++) {
+            snapshot.Load(static_cast<GPIOPort>(port), idr[port]);
+        }
+        bank.Process(snapshot);
+
+        for (int i = 0; i < NUM_LANES; i++) {
+            if (bank.RisingEdge(i)) {
+                run.rising[i].push_back(scan);
+                pressed[i] = true;
+            }
+            if (bank.FallingEdge(i)) {
+                run.falling[i].push_back(scan);
+                pressed[i] = false;
+            }
+            // Held from the scan after the press edge, and never outside a press
+            if (bank.Pressed(i) && !pressed[i]) run.pressedOk = false;
+            if (!run.rising[i].empty() && run.rising[i].back() + 1 == scan && !bank.Pressed(i)) run.pressedOk = false;
+            if (scan >= SwitchBank::HISTORY && bank.State(i) != state[i]) run.stateOk = false;
+        }
+    }
+    run.idleOk = bank.ActiveMask() == 0 && bank.PressedMask() == 0;
+    return run;
+}
+
+static bool Check(const char* name, bool ok) {
+    printf("%-10s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// Edges on exactly the settle scans plus LATENCY
+static bool Matches(const std::vector<size_t>& edges, const std::vector<size_t>& settles) {
+    if (edges.size() != settles.size()) return false;
+    for (size_t i = 0; i < edges.size(); i++) {
+        if (edges[i] != settles[i] + LATENCY) return false;
+    }
+    return true;
+}
+
+static bool TestBounce() {
+    // Each lane starts at a different time and bounces on its own
+    Trace traces[NUM_LANES];
+    std::vector<bool> levels[NUM_LANES];
+    size_t scans = 0;
+    for (int i = 0; i < NUM_LANES; i++) {
+        traces[i] = MakeTrace(SwitchBank::HISTORY + Random() % 100);
+        levels[i] = traces[i].level;
+        if (levels[i].size() > scans) scans = levels[i].size();
+    }
+    Run run = Play(levels, scans + 2 * SwitchBank::HISTORY);
+
+    bool edges = run.pressedOk;
+    bool latency = true;
+    for (int i = 0; i < NUM_LANES; i++) {
+        edges = edges && run.rising[i].size() == static_cast<size_t>(g_presses) &&
+                run.falling[i].size() == static_cast<size_t>(g_presses);
+        latency = latency && Matches(run.rising[i], traces[i].pressSettles) &&
+                  Matches(run.falling[i], traces[i].releaseSettles);
+    }
+    printf("  %d lanes, %d presses each, %zu scans\n", NUM_LANES, g_presses, scans);
+    bool ok = Check("edges", edges);
+    ok = Check("latency", latency) && ok;
+    ok = Check("state", run.stateOk) && ok;
+    return Check("idle", run.idleOk) && ok;
+}
+
+static bool TestTogether() {
+    // Every lane settles on the same scans, each after its own bounce
+    std::vector<bool> levels[NUM_LANES];
+    std::vector<size_t> settles;
+    size_t scan = SwitchBank::HISTORY;
+    for (int press = 0; press < g_presses; press++) {
+        for (int edge = 0; edge < 2; edge++) {
+            scan += SwitchBank::HISTORY + g_bounce + 1 + Random() % 20;
+            bool to = edge == 0;
+            for (std::vector<bool>& level : levels) {
+                std::vector<bool> bounce;
+                Transition(bounce, to);
+                Hold(level, !to, scan - bounce.size() - level.size());
+                level.insert(level.end(), bounce.begin(), bounce.end());
+            }
+            settles.push_back(scan);
+        }
+    }
+    for (std::vector<bool>& level : levels) Hold(level, false, SwitchBank::HISTORY);
+    Run run = Play(levels, scan + 2 * SwitchBank::HISTORY);
+
+    bool ok = run.pressedOk;
+    for (int i = 0; i < NUM_LANES && ok; i++) {
+        ok = run.rising[i] == run.rising[0] && run.falling[i] == run.falling[0] &&
+             run.rising[i].size() == static_cast<size_t>(g_presses);
+        for (size_t j = 0; j < run.rising[i].size() && ok; j++) {
+            ok = run.rising[i][j] == settles[2 * j] + LATENCY && run.falling[i][j] == settles[2 * j + 1] + LATENCY;
+        }
+    }
+    return Check("together", ok);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--presses") && i + 1 < argc) {
+            g_presses = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--bounce") && i + 1 < argc) {
+            g_bounce = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            g_seed = static_cast<uint32_t>(atoi(argv[++i]));
+        } else {
+            fprintf(stderr, "usage: %s [--presses N] [--bounce N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (g_presses < 1 || g_bounce < 0 || g_bounce > 1000) {
+        fprintf(stderr, "presses must be at least 1, and bounce 0-1000 scans\n");
+        return 1;
+    }
+
+    bool ok = TestBounce();
+    ok = TestTogether() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+// Host test for the tap tempo estimator.
+//
+// Feeds TapTempo (taptempo.h/cpp) tap times around a 120 BPM grid, with a few
+// milliseconds of random timing error on each tap, and checks the fitted
+// tempo and beat phase:
+//   - steady: taps on every beat give 120 BPM, with the grid on the beats
+//   - stray: single extra taps 250-300ms after a beat are left out, and the
+//     tempo and grid stay put
+//   - missed: beats with no tap (one or two in a row) are allowed for, and
+//     the tempo stays at 120 BPM rather than halving
+//   - change: two taps off the grid in a row start a new sequence, which
+//     settles on the new tempo (90 BPM)
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/taptempotest.cpp taptempo.cpp -o taptempotest
+//
+// Options:
+//   --jitter US      timing error of each tap, +/- (default 5000, at most 10000)
+//   --seed N         random seed (default 1)
+//   --verbose        print the tempo after every tap
+
+#include "taptempo.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace perspective;
+
+static constexpr uint32_t PERIOD_US = 500000;  // 120 BPM
+// Allowed error of the fit, plus some for each tap's jitter
+static constexpr float BPM_TOLERANCE = 0.5f;
+static constexpr float PHASE_TOLERANCE = 0.01f;  // Of a beat
+
+static uint32_t g_seed = 1;
+static uint32_t g_jitter = 5000;
+static bool g_verbose = false;
+
+static uint32_t Random() {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+// -jitter to +jitter microseconds
+static int32_t Jitter() {
+    return g_jitter ? static_cast<int32_t>(Random() % (2 * g_jitter + 1)) - static_cast<int32_t>(g_jitter) : 0;
+}
+
+struct Tapper {
+    // A tap at timeUs, fitted straight away as the main loop would on its next pass
+    void Tap(uint32_t timeUs) {
+        tempo.Tap(timeUs);
+        tempo.Process();
+        if (g_verbose) printf("  %8.3fs  %6.2f BPM\n", timeUs * 1e-6, tempo.GetBpm());
+    }
+    // A tap near beat n of a grid starting at startUs
+    void Beat(uint32_t n, uint32_t periodUs = PERIOD_US) { Tap(startUs + n * periodUs + Jitter()); }
+
+    // Phase of the fitted grid at beat n, wrapped to -0.5 to 0.5
+    float PhaseAt(uint32_t n, uint32_t periodUs = PERIOD_US) const {
+        float phase = tempo.GetBeatPhase(startUs + n * periodUs);
+        return phase > 0.5f ? phase - 1.0f : phase;
+    }
+
+    bool On(float bpm, uint32_t n, uint32_t periodUs = PERIOD_US) const {
+        float jitter = static_cast<float>(g_jitter) / static_cast<float>(periodUs);
+        return tempo.IsValid() && fabsf(tempo.GetBpm() - bpm) <= BPM_TOLERANCE + 100.0f * jitter &&
+               fabsf(PhaseAt(n, periodUs)) <= PHASE_TOLERANCE + 2.0f * jitter;
+    }
+
+    TapTempo tempo;
+    uint32_t startUs = 1000000;
+};
+
+static bool Check(const char* name, bool ok, const Tapper& t) {
+    printf("%-10s %s  (%.2f BPM)\n", name, ok ? "ok" : "FAIL", t.tempo.GetBpm());
+    return ok;
+}
+
+static bool TestSteady() {
+    Tapper t;
+    for (uint32_t n = 0; n < 12; n++) t.Beat(n);
+    return Check("steady", t.On(120.0f, 12), t);
+}
+
+static bool TestStray() {
+    Tapper t;
+    for (uint32_t n = 0; n < 4; n++) t.Beat(n);
+
+    // A stray tap after every other beat
+    bool ok = true;
+    for (uint32_t n = 4; n < 16; n++) {
+        t.Beat(n);
+        if (n % 2 == 0) {
+            t.Tap(t.startUs + n * PERIOD_US + 250000 + Random() % 50001);
+            ok = ok && t.On(120.0f, n + 1);
+        }
+    }
+    return Check("stray", ok && t.On(120.0f, 16), t);
+}
+
+static bool TestMissed() {
+    Tapper t;
+    for (uint32_t n = 0; n < 4; n++) t.Beat(n);
+
+    // One beat missed, then two
+    static constexpr uint32_t BEATS[] = {5, 6, 7, 10, 11, 12, 14};
+    bool ok = true;
+    for (uint32_t n : BEATS) {
+        t.Beat(n);
+        ok = ok && t.On(120.0f, n + 1);
+    }
+    return Check("missed", ok, t);
+}
+
+static bool TestChange() {
+    Tapper t;
+    for (uint32_t n = 0; n < 8; n++) t.Beat(n);
+
+    // 90 BPM from beat 8's time on
+    static constexpr uint32_t SLOW_US = 666667;
+    t.startUs += 8 * PERIOD_US;
+    for (uint32_t n = 1; n < 8; n++) t.Beat(n, SLOW_US);
+    return Check("change", t.On(90.0f, 8, SLOW_US), t);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--jitter") && i + 1 < argc) {
+            g_jitter = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            g_seed = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--verbose")) {
+            g_verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [--jitter US] [--seed N] [--verbose]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (g_jitter > PERIOD_US / 50) {
+        fprintf(stderr, "jitter must be at most %u us\n", PERIOD_US / 50);
+        return 1;
+    }
+
+    bool ok = TestSteady();
+    ok = TestStray() && ok;
+    ok = TestMissed() && ok;
+    ok = TestChange() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+// Host test for the audio watchdog.
+//
+// Runs the watchdog (audiowatchdog.h/cpp) against a simulated effect whose
+// cost per block, as a fraction of the block period, is set for each quality
+// level, with the level applied a main loop pass (1ms) late as on the pedal:
+//   - settle: an effect too heavy at full quality steps down to the first
+//     level that fits and stays there
+//   - bypass: an effect too heavy at every level is bypassed, retried after
+//     the recover time, and retried less often each time it relapses
+//   - spike: a single slow block is counted as an overrun but changes nothing
+//   - background: time spent for the callback at a lower priority (the
+//     large-block worker) steps the effect down, but is never an overrun
+//   - reset: a new effect starts at full quality
+//
+// Build (from the repository root):
+//   g++ -std=c++17 -O2 -I. host/watchdogtest.cpp audiowatchdog.cpp -o watchdogtest
+//
+// Options:
+//   --block N        samples per block (default 48)
+//   --verbose        print every change of level
+
+#include "audiowatchdog.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace perspective;
+
+static constexpr float SAMPLE_RATE = 48000.0f;
+static constexpr float BYPASS_COST = 0.05f;  // Dry copy and the rest of the callback
+static size_t g_block = 48;
+static bool g_verbose = false;
+
+struct Simulation {
+    explicit Simulation(const std::vector<float>& costs) : costs(costs) {
+        watchdog.Init(SAMPLE_RATE);
+        watchdog.Reset(static_cast<int>(costs.size()));
+    }
+
+    // Runs for seconds of audio, recording when the bypass comes back on
+    void Run(float seconds) {
+        float period = static_cast<float>(g_block) / SAMPLE_RATE;
+        size_t blocks = static_cast<size_t>(seconds / period);
+        float mainLoop = 0.0f;
+        for (size_t b = 0; b < blocks; b++) {
+            float cost = watchdog.IsBypassed() ? BYPASS_COST : costs[applied];
+            watchdog.Measure(static_cast<uint32_t>(cost * period * 1e6f), g_block);
+            time += period;
+
+            // The main loop picks up the level once per pass
+            mainLoop += period;
+            if (mainLoop >= 0.001f) {
+                mainLoop = 0.0f;
+                applied = watchdog.GetQuality();
+            }
+
+            bool bypassed = watchdog.IsBypassed();
+            if (bypassed != wasBypassed && !bypassed) retries.push_back(time);
+            if (g_verbose && (bypassed != wasBypassed || watchdog.GetQuality() != lastLevel)) {
+                printf("  %7.3fs level %d%s\n", time, watchdog.GetQuality(), bypassed ? " bypass" : "");
+            }
+            wasBypassed = bypassed;
+            lastLevel = watchdog.GetQuality();
+        }
+    }
+
+    std::vector<float> costs;
+    AudioWatchdog watchdog;
+    int applied = 0;
+    int lastLevel = 0;
+    bool wasBypassed = false;
+    double time = 0.0;
+    std::vector<double> retries;
+};
+
+static bool Check(const char* name, bool ok) {
+    printf("%-10s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool TestSettle() {
+    Simulation s({1.2f, 0.7f, 0.4f});
+    s.Run(1.0f);
+    uint32_t overruns = s.watchdog.GetOverruns();
+    s.Run(60.0f);
+
+    // 0.7 is above the recover load, so it never tries full quality again
+    bool ok = s.watchdog.GetQuality() == 1 && !s.watchdog.IsBypassed() && s.watchdog.GetDegrades() == 1 &&
+              s.watchdog.GetOverruns() == overruns && overruns > 0;
+    return Check("settle", ok);
+}
+
+static bool TestBypass() {
+    Simulation s({1.5f, 1.2f});
+    s.Run(120.0f);
+
+    // Each retry relapses, so the gaps between retries grow to the maximum
+    bool ok = s.watchdog.IsBypassed() && s.retries.size() >= 4;
+    for (size_t i = 2; i < s.retries.size() && ok; i++) {
+        double gap = s.retries[i] - s.retries[i - 1];
+        double previous = s.retries[i - 1] - s.retries[i - 2];
+        ok = gap >= previous - 0.01f && gap <= AudioWatchdog::MAX_RECOVER_S + 1.0f;
+    }
+    if (ok) {
+        double first = s.retries[1] - s.retries[0];
+        double last = s.retries.back() - s.retries[s.retries.size() - 2];
+        ok = last > 4.0f * first;
+    }
+    return Check("bypass", ok);
+}
+
+static bool TestSpike() {
+    AudioWatchdog watchdog;
+    watchdog.Init(SAMPLE_RATE);
+    watchdog.Reset(3);
+    float period = static_cast<float>(g_block) / SAMPLE_RATE;
+    uint32_t normal = static_cast<uint32_t>(0.3f * period * 1e6f);
+    for (int b = 0; b < 2000; b++) {
+        watchdog.Measure(b == 1000 ? static_cast<uint32_t>(3.0f * period * 1e6f) : normal, g_block);
+    }
+    bool ok = watchdog.GetOverruns() == 1 && watchdog.GetDegrades() == 0 && watchdog.GetQuality() == 0 &&
+              watchdog.GetPeakLoad() > 2.9f;
+    return Check("spike", ok);
+}
+
+static bool TestBackground() {
+    AudioWatchdog watchdog;
+    watchdog.Init(SAMPLE_RATE);
+    watchdog.Reset(3);
+    float period = static_cast<float>(g_block) / SAMPLE_RATE;
+    uint32_t callback = static_cast<uint32_t>(0.2f * period * 1e6f);
+    uint32_t worker = static_cast<uint32_t>(0.8f * period * 1e6f);
+    for (int b = 0; b < static_cast<int>(0.1f / period); b++) {
+        watchdog.Measure(callback, g_block, worker);
+    }
+    bool ok = watchdog.GetOverruns() == 0 && watchdog.GetDegrades() >= 1 && watchdog.GetQuality() >= 1;
+    return Check("background", ok);
+}
+
+static bool TestReset() {
+    Simulation s({2.0f});
+    s.Run(1.0f);
+    bool ok = s.watchdog.IsBypassed();
+
+    // A new, lighter effect runs at full quality straight away
+    s.watchdog.Reset(3);
+    ok = ok && !s.watchdog.IsBypassed() && s.watchdog.GetQuality() == 0;
+    s.costs = {0.5f, 0.3f, 0.2f};
+    s.applied = 0;
+    s.Run(10.0f);
+    ok = ok && !s.watchdog.IsBypassed() && s.watchdog.GetQuality() == 0;
+    return Check("reset", ok);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            g_block = static_cast<size_t>(atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "--verbose")) {
+            g_verbose = true;
+        } else {
+            fprintf(stderr, "usage: %s [--block N] [--verbose]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (g_block == 0) {
+        fprintf(stderr, "block size must be at least 1\n");
+        return 1;
+    }
+
+    bool ok = TestSettle();
+    ok = TestBypass() && ok;
+    ok = TestSpike() && ok;
+    ok = TestBackground() && ok;
+    ok = TestReset() && ok;
+    return ok ? 0 : 1;
+}
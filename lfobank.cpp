@@ -0,0 +1,184 @@
+#include "lfobank.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+// 256 points plus a guard point for the interpolation
+static constexpr int SINE_BITS = 8;
+static constexpr int SINE_SIZE = 1 << SINE_BITS;
+static constexpr int FRACTION_BITS = 32 - SINE_BITS;
+static float g_sineTable[SINE_SIZE + 1];
+
+static bool InitSineTable() {
+    for (int i = 0; i <= SINE_SIZE; i++) {
+        g_sineTable[i] = sinf(6.28318530718f * static_cast<float>(i) / static_cast<float>(SINE_SIZE));
+    }
+    return true;
+}
+
+static const bool g_sineTableReady = InitSineTable();
+
+// Sine of a 32-bit phase - a table read and a multiply-add
+static inline float SinePhase(uint32_t phase) {
+    uint32_t index = phase >> FRACTION_BITS;
+    float fraction = static_cast<float>(phase & ((1u << FRACTION_BITS) - 1)) * (1.0f / (1u << FRACTION_BITS));
+    float a = g_sineTable[index];
+    return a + (g_sineTable[index + 1] - a) * fraction;
+}
+
+static constexpr uint32_t QUARTER_CYCLE = 0x40000000u;
+static constexpr float PHASE_TO_UNIT = 1.0f / 4294967296.0f;
+
+const float LfoBank::ZERO_BLOCK[LfoBank::MAX_BLOCK_SIZE] = {};
+
+LfoBank::LfoBank()
+    : transport_(nullptr),
+      sampleRate_(48000.0f),
+      count_(0),
+      block_(0),
+      size_(0) {
+}
+
+void LfoBank::Init(const Transport* transport, float sampleRate) {
+    transport_ = transport;
+    sampleRate_ = sampleRate;
+    count_ = 0;
+    block_ = 0;
+    size_ = 0;
+}
+
+int LfoBank::Allocate() {
+    if (count_ >= MAX_LFOS) return -1;
+
+    Voice& voice = voices_[count_];
+    voice.wave = LfoWave::SINE;
+    voice.phase = 0;
+    voice.freeIncrement = 0;
+    voice.offset = 0;
+    voice.cycles = 0;
+    voice.beats = 1;
+    voice.last = 0;
+    voice.rendered = block_ - 1;
+    voice.random = 0x9E3779B9u * static_cast<uint32_t>(count_ + 1);
+    voice.from = 0.0f;
+    voice.to = NextRandom(voice);
+    return count_++;
+}
+
+void LfoBank::SetWaveform(int lfo, LfoWave wave) {
+    if (IsValid(lfo)) voices_[lfo].wave = wave;
+}
+
+void LfoBank::SetFreq(int lfo, float hz) {
+    if (IsValid(lfo)) voices_[lfo].freeIncrement = PhaseIncrement(hz, sampleRate_);
+}
+
+void LfoBank::SetPhaseOffset(int lfo, float cycles) {
+    if (IsValid(lfo)) voices_[lfo].offset = PhaseFromCycles(cycles);
+}
+
+void LfoBank::LockToBeat(int lfo, uint32_t cycles, uint32_t beats) {
+    if (!IsValid(lfo)) return;
+
+    if (beats < 1) beats = 1;
+    if (beats > MAX_BEATS) beats = MAX_BEATS;
+    voices_[lfo].beats = beats;
+    voices_[lfo].cycles = cycles;
+}
+
+void LfoBank::Unlock(int lfo) {
+    if (IsValid(lfo)) voices_[lfo].cycles = 0;
+}
+
+void LfoBank::Process(size_t size) {
+    block_++;
+    size_ = size < MAX_BLOCK_SIZE ? size : MAX_BLOCK_SIZE;
+}
+
+const float* LfoBank::GetBlock(int lfo) {
+    if (!IsValid(lfo)) return ZERO_BLOCK;
+
+    if (voices_[lfo].rendered != block_) {
+        Render(lfo);
+    }
+    return output_[lfo];
+}
+
+float LfoBank::NextRandom(Voice& voice) {
+    // xorshift32, scaled to -1.0 to 1.0
+    uint32_t x = voice.random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    voice.random = x;
+    return static_cast<float>(static_cast<int32_t>(x)) * (1.0f / 2147483648.0f);
+}
+
+void LfoBank::Render(int lfo) {
+    Voice& voice = voices_[lfo];
+    float* out = output_[lfo];
+    size_t size = size_;
+
+    uint32_t phase = voice.phase;
+    uint32_t increment = voice.freeIncrement;
+    if (voice.cycles && transport_) {
+        // Position within the beats-beat group, in 1/2^32 beats, scaled to LFO cycles
+        uint64_t beatPosition = (static_cast<uint64_t>(transport_->GetBeatCount() % voice.beats) << 32) | transport_->GetBeatPhase();
+        phase = static_cast<uint32_t>(beatPosition * voice.cycles / voice.beats);
+        increment = static_cast<uint32_t>(static_cast<uint64_t>(transport_->GetBeatIncrement()) * voice.cycles / voice.beats);
+    }
+
+    uint32_t p = phase + voice.offset;
+    switch (voice.wave) {
+        case LfoWave::SINE:
+            for (size_t i = 0; i < size; i++) {
+                out[i] = SinePhase(p);
+                p += increment;
+            }
+            break;
+
+        case LfoWave::TRIANGLE:
+            // Shifted a quarter cycle so it starts at zero, rising, like the sine
+            p += QUARTER_CYCLE;
+            for (size_t i = 0; i < size; i++) {
+                out[i] = 1.0f - 4.0f * fabsf(static_cast<float>(p) * PHASE_TO_UNIT - 0.5f);
+                p += increment;
+            }
+            break;
+
+        case LfoWave::SMOOTH_RANDOM:
+        case LfoWave::SAMPLE_HOLD: {
+            bool smooth = voice.wave == LfoWave::SMOOTH_RANDOM;
+            uint32_t last = voice.last;
+            for (size_t i = 0; i < size; i++) {
+                if (p < last) {
+                    // Cycle wrapped - move on to the next random target
+                    voice.from = voice.to;
+                    voice.to = NextRandom(voice);
+                }
+                last = p;
+
+                if (smooth) {
+                    // Half cosine ease from the previous target: cos(pi * x) = sin(pi * x + pi / 2)
+                    float ease = 0.5f - 0.5f * SinePhase((p >> 1) + QUARTER_CYCLE);
+                    out[i] = voice.from + (voice.to - voice.from) * ease;
+                } else {
+                    out[i] = voice.to;
+                }
+                p += increment;
+            }
+            voice.last = last;
+            break;
+        }
+
+        default:
+            for (size_t i = 0; i < size; i++) {
+                out[i] = 0.0f;
+            }
+            break;
+    }
+
+    voice.phase = phase + increment * static_cast<uint32_t>(size);
+    voice.rendered = block_;
+}
@@ -0,0 +1,103 @@
+#ifndef PERSPECTIVE_LFOBANK_H
+#define PERSPECTIVE_LFOBANK_H
+
+#include "transport.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+enum class LfoWave {
+    SINE,
+    TRIANGLE,
+    SMOOTH_RANDOM,  // New random target every cycle, eased with a half cosine
+    SAMPLE_HOLD,    // New random value every cycle
+    COUNT
+};
+
+// Waveform from a stepped parameter value (0 to COUNT - 1)
+inline LfoWave LfoWaveFromValue(float value) {
+    int wave = static_cast<int>(value + 0.5f);
+    if (wave < 0) wave = 0;
+    if (wave >= static_cast<int>(LfoWave::COUNT)) wave = static_cast<int>(LfoWave::COUNT) - 1;
+    return static_cast<LfoWave>(wave);
+}
+
+// Shared LFO bank.
+// Effects allocate voices at Init and configure them from Update (main loop).
+// Process() is called once per audio block after the transport; a voice's
+// output for the block is rendered in one pass into the bank's own buffer the
+// first time an effect asks for it, so only the voices of the effect that is
+// actually running cost anything. The phase of every voice lives in one small
+// array next to the shared 256-point sine table, so rendering stays cache
+// resident. Locked voices take their phase from the transport beat, which makes
+// the tempo-synced random waveforms change on the beat.
+class LfoBank {
+public:
+    LfoBank();
+
+    void Init(const Transport* transport, float sampleRate);
+    // Keeps the allocated voices; their owners set the frequencies again
+    void SetSampleRate(float sampleRate) { sampleRate_ = sampleRate; }
+
+    // Returns a voice id, or -1 when the bank is full
+    int Allocate();
+
+    // Main loop side
+    void SetWaveform(int lfo, LfoWave wave);
+    void SetFreq(int lfo, float hz);
+    // Constant phase offset in cycles (e.g. 0.25 for a quadrature channel)
+    void SetPhaseOffset(int lfo, float cycles);
+    // cycles per beats of the transport; Unlock() returns to SetFreq()
+    void LockToBeat(int lfo, uint32_t cycles = 1, uint32_t beats = 1);
+    void Unlock(int lfo);
+
+    // Audio side - call once per block, after Transport::Process
+    void Process(size_t size);
+
+    // The voice's output (-1.0 to 1.0) for each sample of the current block.
+    // Invalid ids get a block of zeros.
+    const float* GetBlock(int lfo);
+
+    inline const Transport* GetTransport() const { return transport_; }
+
+    static constexpr int MAX_LFOS = 16;
+    static constexpr size_t MAX_BLOCK_SIZE = 256;
+    static constexpr uint32_t MAX_BEATS = 16;
+
+    // Block of zeros for effects without an LFO
+    static const float ZERO_BLOCK[MAX_BLOCK_SIZE];
+
+private:
+    struct Voice {
+        LfoWave wave;
+        uint32_t phase;
+        uint32_t freeIncrement;
+        uint32_t offset;
+        uint32_t cycles;    // 0 when free-running
+        uint32_t beats;
+        uint32_t last;      // Phase of the last rendered sample, to spot cycle wraps
+        uint32_t rendered;  // Block number of the output in the buffer
+        uint32_t random;    // xorshift state
+        float from;         // Random waveform end points for the current cycle
+        float to;
+    };
+
+    inline bool IsValid(int lfo) const { return lfo >= 0 && lfo < count_; }
+    void Render(int lfo);
+    static float NextRandom(Voice& voice);
+
+    const Transport* transport_;
+    float sampleRate_;
+    int count_;
+    uint32_t block_;
+    size_t size_;
+
+    Voice voices_[MAX_LFOS];
+    float output_[MAX_LFOS][MAX_BLOCK_SIZE];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_LFOBANK_H
@@ -0,0 +1,275 @@
+#include "midiinput.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+// ---------------------------------------------------------------------------
+// MidiParser
+
+MidiParser::MidiParser() {
+    Reset();
+}
+
+void MidiParser::Reset() {
+    status_ = 0;
+    count_ = 0;
+    needed_ = 0;
+}
+
+bool MidiParser::Parse(uint8_t byte, MidiMessage& message) {
+    // Real-time bytes can appear anywhere and don't affect running status
+    if (byte >= MIDI_CLOCK) return false;
+
+    if (byte & 0x80) {
+        count_ = 0;
+        if (byte == MIDI_SYSEX_START) {
+            status_ = MIDI_SYSEX_START;  // Skip data bytes until the next status
+            return false;
+        }
+        if (byte == MIDI_SYSEX_END) {
+            status_ = 0;
+            return false;
+        }
+        if (byte > MIDI_SYSEX_START) {
+            // System common: song position takes two bytes, MTC and song select one
+            status_ = byte;
+            needed_ = byte == 0xF2 ? 2 : ((byte == 0xF1 || byte == 0xF3) ? 1 : 0);
+            if (needed_ == 0) {
+                message = {byte, 0, 0};
+                status_ = 0;
+                return true;
+            }
+            return false;
+        }
+        status_ = byte;
+        uint8_t type = byte & 0xF0;
+        needed_ = (type == MIDI_PROGRAM_CHANGE || type == MIDI_CHANNEL_PRESSURE) ? 1 : 2;
+        return false;
+    }
+
+    // Data byte
+    if (status_ == 0 || status_ == MIDI_SYSEX_START) return false;
+
+    data_[count_++] = byte;
+    if (count_ < needed_) return false;
+
+    message = {status_, data_[0], needed_ > 1 ? data_[1] : static_cast<uint8_t>(0)};
+    count_ = 0;
+    if (status_ > MIDI_SYSEX_START) status_ = 0;  // No running status for system common
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// MidiClock
+
+MidiClock::MidiClock() {
+    Reset();
+}
+
+void MidiClock::Reset() {
+    lastTick_ = 0;
+    haveLast_ = false;
+    sum_ = 0;
+    count_ = 0;
+    pos_ = 0;
+    rejected_ = 0;
+    outliers_ = 0;
+    smoothed_ = 0.0f;
+    bpm_.store(0.0f, std::memory_order_relaxed);
+    running_.store(false, std::memory_order_relaxed);
+}
+
+void MidiClock::Tick(uint32_t timeUs) {
+    if (!haveLast_) {
+        lastTick_ = timeUs;
+        haveLast_ = true;
+        return;
+    }
+
+    uint32_t interval = timeUs - lastTick_;
+    lastTick_ = timeUs;
+
+    if (interval == 0 || interval > MAX_INTERVAL_US) {
+        // Clock stopped or the source restarted - start measuring again
+        sum_ = 0;
+        count_ = 0;
+        pos_ = 0;
+        return;
+    }
+
+    if (count_ == PPQN) {
+        // Reject ticks far from the mean (a dropped byte, or a delayed one)
+        uint32_t mean = sum_ / PPQN;
+        if (interval > mean + mean / 2 || interval < mean - mean / 2) {
+            rejected_++;
+            if (++outliers_ < PPQN / 4) return;
+
+            // Consistently off: the tempo itself jumped
+            sum_ = 0;
+            count_ = 0;
+            pos_ = 0;
+        }
+        outliers_ = 0;
+    }
+
+    if (count_ < PPQN) {
+        count_++;
+    } else {
+        sum_ -= intervals_[pos_];
+    }
+    intervals_[pos_] = interval;
+    sum_ += interval;
+    pos_ = (pos_ + 1) % PPQN;
+
+    if (count_ == PPQN) {
+        // sum_ is the length of one beat
+        float bpm = 60000000.0f / static_cast<float>(sum_);
+        smoothed_ = smoothed_ > 0.0f ? smoothed_ + BPM_SMOOTHING * (bpm - smoothed_) : bpm;
+        if (fabsf(smoothed_ - bpm_.load(std::memory_order_relaxed)) > BPM_HYSTERESIS) {
+            bpm_.store(smoothed_, std::memory_order_relaxed);
+        }
+    }
+}
+
+void MidiClock::Start() {
+    running_.store(true, std::memory_order_relaxed);
+}
+
+void MidiClock::Stop() {
+    running_.store(false, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// MidiInput
+
+MidiInput::MidiInput()
+    : head_(0),
+      tail_(0),
+      maxQueued_(0),
+      overflows_(0),
+      channel_(OMNI),
+      messages_(0),
+      ccCount_(0),
+      program_(-1),
+      publishedBpm_(0.0f) {
+    for (int i = 0; i < 128; i++) {
+        ccPending_[i] = false;
+    }
+}
+
+void MidiInput::Init(int channel) {
+    channel_ = channel;
+    parser_.Reset();
+    clock_.Reset();
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+    maxQueued_ = 0;
+    overflows_ = 0;
+    messages_ = 0;
+    publishedBpm_ = 0.0f;
+}
+
+void MidiInput::Receive(const uint8_t* data, size_t size, uint32_t timeUs) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+
+    for (size_t i = 0; i < size; i++) {
+        uint8_t byte = data[i];
+
+        if (byte >= MIDI_CLOCK) {
+            switch (byte) {
+                case MIDI_CLOCK:    clock_.Tick(timeUs - static_cast<uint32_t>(size - 1 - i) * BYTE_TIME_US); break;
+                case MIDI_START:
+                case MIDI_CONTINUE: clock_.Start(); break;
+                case MIDI_STOP:     clock_.Stop(); break;
+                default: break;  // Active sensing, reset
+            }
+            continue;
+        }
+
+        if (head - tail >= QUEUE_SIZE) {
+            overflows_++;
+            continue;
+        }
+        queue_[head & (QUEUE_SIZE - 1)] = byte;
+        head++;
+    }
+
+    head_.store(head, std::memory_order_release);
+
+    size_t queued = head - tail;
+    if (queued > maxQueued_) maxQueued_ = queued;
+}
+
+size_t MidiInput::GetQueued() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+}
+
+size_t MidiInput::Process(size_t maxBytes) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    size_t count = head - tail;
+    if (count > maxBytes) count = maxBytes;
+
+    MidiMessage message;
+    for (size_t i = 0; i < count; i++) {
+        if (parser_.Parse(queue_[(tail + i) & (QUEUE_SIZE - 1)], message)) {
+            HandleMessage(message);
+        }
+    }
+    tail_.store(tail + static_cast<uint32_t>(count), std::memory_order_release);
+
+    // Fire what is still coalesced; a pending program change never has CCs after it
+    FlushProgramChange();
+    FlushControlChanges();
+
+    float bpm = clock_.GetBpm();
+    if (bpm > 0.0f && bpm != publishedBpm_) {
+        publishedBpm_ = bpm;
+        if (onTempo_) onTempo_(bpm);
+    }
+
+    return count;
+}
+
+void MidiInput::HandleMessage(const MidiMessage& message) {
+    if (message.status < MIDI_SYSEX_START && channel_ != OMNI && message.GetChannel() != channel_) return;
+    messages_++;
+
+    switch (message.GetType()) {
+        case MIDI_CONTROL_CHANGE:
+            // A program change before this CC goes first, so the CC reaches the new preset
+            FlushProgramChange();
+            if (!ccPending_[message.data1]) {
+                ccPending_[message.data1] = true;
+                ccOrder_[ccCount_++] = message.data1;
+            }
+            ccValue_[message.data1] = message.data2;
+            break;
+        case MIDI_PROGRAM_CHANGE:
+            // CCs before it are meant for the preset it replaces. Program changes
+            // back to back still coalesce to the last one.
+            FlushControlChanges();
+            program_ = message.data1;
+            break;
+        default:
+            break;
+    }
+}
+
+void MidiInput::FlushControlChanges() {
+    for (int i = 0; i < ccCount_; i++) {
+        uint8_t cc = ccOrder_[i];
+        ccPending_[cc] = false;
+        if (onControlChange_) onControlChange_(cc, ccValue_[cc]);
+    }
+    ccCount_ = 0;
+}
+
+void MidiInput::FlushProgramChange() {
+    if (program_ >= 0) {
+        if (onProgramChange_) onProgramChange_(static_cast<uint8_t>(program_));
+        program_ = -1;
+    }
+}
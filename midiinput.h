@@ -0,0 +1,174 @@
+#ifndef PERSPECTIVE_MIDIINPUT_H
+#define PERSPECTIVE_MIDIINPUT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <functional>
+
+namespace perspective {
+
+// Status bytes (channel messages carry the channel in the low nibble)
+enum MidiStatus : uint8_t {
+    MIDI_NOTE_OFF         = 0x80,
+    MIDI_NOTE_ON          = 0x90,
+    MIDI_POLY_PRESSURE    = 0xA0,
+    MIDI_CONTROL_CHANGE   = 0xB0,
+    MIDI_PROGRAM_CHANGE   = 0xC0,
+    MIDI_CHANNEL_PRESSURE = 0xD0,
+    MIDI_PITCH_BEND       = 0xE0,
+    MIDI_SYSEX_START      = 0xF0,
+    MIDI_SYSEX_END        = 0xF7,
+    MIDI_CLOCK            = 0xF8,
+    MIDI_START            = 0xFA,
+    MIDI_CONTINUE         = 0xFB,
+    MIDI_STOP             = 0xFC
+};
+
+struct MidiMessage {
+    uint8_t status;  // Including channel
+    uint8_t data1;
+    uint8_t data2;
+
+    inline uint8_t GetType() const { return status & 0xF0; }
+    inline uint8_t GetChannel() const { return status & 0x0F; }
+};
+
+// Byte stream to channel/system common messages.
+// Handles running status and skips SysEx; real-time bytes are expected to be
+// filtered out before the parser (MidiInput does that on receive).
+class MidiParser {
+public:
+    MidiParser();
+    void Reset();
+
+    // Returns true when byte completes a message
+    bool Parse(uint8_t byte, MidiMessage& message);
+
+private:
+    uint8_t status_;   // Running status, 0 when none
+    uint8_t data_[2];
+    uint8_t count_;    // Data bytes received
+    uint8_t needed_;   // Data bytes the status takes
+};
+
+// MIDI clock (24 PPQN) to tempo.
+// Ticks are timestamped when they arrive. The raw tempo is the length of the
+// last 24 intervals (one beat) and is smoothed per tick, so per-tick jitter
+// averages out; intervals more than 50% away from the running mean are rejected,
+// and the published BPM only moves when it changes by more than BPM_HYSTERESIS.
+// Tick/Start/Stop are called from the receive interrupt; the getters from anywhere.
+class MidiClock {
+public:
+    MidiClock();
+    void Reset();
+
+    void Tick(uint32_t timeUs);
+    void Start();
+    void Stop();
+
+    // 0.0 until a full beat of clean ticks has been seen
+    inline float GetBpm() const { return bpm_.load(std::memory_order_relaxed); }
+    inline bool IsRunning() const { return running_.load(std::memory_order_relaxed); }
+    inline uint32_t GetRejectedCount() const { return rejected_; }
+
+    static constexpr int PPQN = 24;
+    static constexpr float BPM_HYSTERESIS = 0.2f;
+    static constexpr float BPM_SMOOTHING = 0.05f;  // Per tick, ~1 beat time constant
+    static constexpr uint32_t MAX_INTERVAL_US = 125000;  // 20 BPM; a longer gap restarts tracking
+
+private:
+    uint32_t lastTick_;
+    bool haveLast_;
+    uint32_t intervals_[PPQN];
+    uint32_t sum_;
+    int count_;
+    int pos_;
+    uint32_t rejected_;
+    int outliers_;  // Consecutive rejections
+    float smoothed_;
+    std::atomic<float> bpm_;
+    std::atomic<bool> running_;
+};
+
+// MIDI input engine.
+// Receive() is called from the UART DMA callback: clock and transport bytes are
+// handled there and timestamped to within a byte time, everything else goes into a
+// single-producer/single-consumer byte queue. Process() runs in the main loop,
+// parses what has arrived and coalesces it - a burst of CCs costs one callback
+// per controller with its latest value (per program, when a program change
+// splits the burst), so a full-speed 31.25 kbaud stream
+// never builds up work for the UI loop.
+class MidiInput {
+public:
+    using ControlChangeCallback = std::function<void(uint8_t cc, uint8_t value)>;
+    using ProgramChangeCallback = std::function<void(uint8_t program)>;
+    using TempoCallback = std::function<void(float bpm)>;
+
+    MidiInput();
+
+    // channel 0-15, or OMNI
+    void Init(int channel = OMNI);
+    inline void SetChannel(int channel) { channel_ = channel; }
+
+    void SetControlChangeCallback(ControlChangeCallback callback) { onControlChange_ = callback; }
+    void SetProgramChangeCallback(ProgramChangeCallback callback) { onProgramChange_ = callback; }
+    void SetTempoCallback(TempoCallback callback) { onTempo_ = callback; }
+
+    // Producer (interrupt) side. timeUs is when the last byte of the chunk
+    // arrived. The DMA callback fires on line idle, so the bytes of a chunk
+    // came back to back, and each earlier byte is dated BYTE_TIME_US before
+    // the one after it.
+    void Receive(const uint8_t* data, size_t size, uint32_t timeUs);
+
+    // Consumer (main loop) side - parses up to maxBytes queued bytes and fires
+    // the callbacks in arrival order: CCs coalesced before a program change
+    // fire before it, and CCs after it once it has fired. Returns the number
+    // of bytes consumed.
+    size_t Process(size_t maxBytes = QUEUE_SIZE);
+
+    inline const MidiClock& GetClock() const { return clock_; }
+
+    // Diagnostics
+    size_t GetQueued() const;
+    inline size_t GetMaxQueued() const { return maxQueued_; }
+    inline uint32_t GetOverflowCount() const { return overflows_; }
+    inline uint32_t GetMessageCount() const { return messages_; }
+
+    static constexpr int OMNI = -1;
+    static constexpr size_t QUEUE_SIZE = 1024;  // Power of two; ~330ms of continuous MIDI
+    static constexpr uint32_t BYTE_TIME_US = 320;  // 10 bits at 31250 baud
+
+private:
+    void HandleMessage(const MidiMessage& message);
+    void FlushControlChanges();
+    void FlushProgramChange();
+
+    // Byte queue - head_ written only by Receive(), tail_ only by Process()
+    uint8_t queue_[QUEUE_SIZE];
+    std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> tail_;
+    size_t maxQueued_;
+    uint32_t overflows_;
+
+    MidiParser parser_;
+    MidiClock clock_;
+    int channel_;
+    uint32_t messages_;
+
+    // Coalesced state for the current Process() call
+    uint8_t ccValue_[128];
+    uint8_t ccOrder_[128];   // CCs in order of first change
+    bool ccPending_[128];
+    int ccCount_;
+    int program_;            // -1 when none pending
+    float publishedBpm_;
+
+    ControlChangeCallback onControlChange_;
+    ProgramChangeCallback onProgramChange_;
+    TempoCallback onTempo_;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_MIDIINPUT_H
@@ -2,11 +2,43 @@
 #include "effect.h"
 #include "effectparameter.h"
 #include "effects/effectfactory.h"
+#include "fonts/Vanilla_Extract_20p.h"
+#include "ui/textrenderer.h"
+#include "lfobank.h"
+#include "dualrateengine.h"
+#include "denormals.h"
 
 using namespace perspective;
 
 static Perspective* g_perspective = nullptr;
 
+// Decoded glyph/string runs are ~40KB, so keep them out of the Perspective object (which lives on the stack)
+// and out of DTCM; the display reads them at main loop rate
+static TextRenderer DSY_SDRAM_BSS g_textRenderer;
+
+// LFO outputs for a block are ~16KB, so the bank lives here too
+static LfoBank g_lfoBank;
+
+// Read-ahead buffer for the backing track stream: two 32KB halves, 170ms of
+// 16-bit stereo each. SDRAM, which the SD card's DMA can write to
+static constexpr uint32_t STREAM_HALF_SIZE = 32768;
+static uint8_t DSY_SDRAM_BSS g_streamBuffer[2 * STREAM_HALF_SIZE] __attribute__((aligned(32)));
+
+// Block FIFOs to and from the large-block worker, ~16KB
+static DualRateEngine g_dualRate;
+
+// The large-block worker is the HDMI-CEC interrupt, which nothing on the Seed
+// uses (libDaisy already defines PendSV_Handler). Pended from the audio
+// callback and set to the lowest priority, it runs between audio blocks and
+// ahead of the main loop.
+static constexpr IRQn_Type WORKER_IRQ = CEC_IRQn;
+
+extern "C" void CEC_IRQHandler() {
+    if (g_perspective) {
+        g_perspective->ProcessLargeBlocks();
+    }
+}
+
 static void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size) {
     if (g_perspective) {
         g_perspective->AudioCallbackImpl(in, out, size);
@@ -22,15 +54,59 @@ Perspective::~Perspective() {
 
 }
 
+static SaiHandle::Config::SampleRate SaiRate(AudioConfig::Rate rate) {
+    switch (rate) {
+        case AudioConfig::Rate::KHZ_32: return SaiHandle::Config::SampleRate::SAI_32KHZ;
+        case AudioConfig::Rate::KHZ_96: return SaiHandle::Config::SampleRate::SAI_96KHZ;
+        default: return SaiHandle::Config::SampleRate::SAI_48KHZ;
+    }
+}
+
 void Perspective::Init() {
     hardware.Init(GetEventHandler());
 
+    // Feedback paths decaying in silence flush to zero rather than running on
+    // subnormals: FPDSCR is the FPSCR every interrupt handler starts with
+    FPU->FPDSCR |= FPU_FPDSCR_FZ_Msk;
+    SetFlushToZero(true);
+    hardware.SetAudioSampleRate(SaiRate(audioConfig_.rate));
+    hardware.SetAudioBlockSize(audioConfig_.blockSize);
+
+    expression_.Init(hardware.GetExpressionAdc(), hardware.AudioSampleRate(), hardware.AudioBlockSize());
+    transport_.Init(hardware.AudioSampleRate());
+    g_lfoBank.Init(&transport_, hardware.AudioSampleRate());
+
+    modelFlash_.Init(&hardware.qspi, MODEL_FLASH_OFFSET, MODEL_FLASH_SIZE);
+    cabinetFlash_.Init(&hardware.qspi, CABINET_FLASH_OFFSET, CABINET_FLASH_SIZE);
+#ifdef PERSPECTIVE_SD_CARD
+    sdCard_.Init();
+    backingTrack_.Init(&sdCard_, g_streamBuffer, STREAM_HALF_SIZE);
+#else
+    backingTrack_.Init(nullptr, g_streamBuffer, STREAM_HALF_SIZE);
+#endif
     LoadEffects(); // Load effects before registering listeners so we can populate effect selection menu
 
+    watchdog_.Init(hardware.AudioSampleRate());
+    watchdogFadeStep_ = 1.0f / (WATCHDOG_FADE_S * hardware.AudioSampleRate());
+    if (currentEffect_) watchdog_.Reset(WatchdogLevels(currentEffect_));
+
     // Initialize perspective-specific UI elements
     RegisterEventListeners();
+    RegisterMidiListeners();
+    hardware.SetTapTempo(&tapTempo_, SWITCH_3_IDX);
+    InitDisplay();
+
+    // Restore the last saved preset so the pedal comes up as it was left
+    presetFlash_.Init(&hardware.qspi);
+    if (presets_.Init(&presetFlash_)) {
+        RecallPreset(presets_.GetLatestSlot());
+    }
+
+    NVIC_SetPriority(WORKER_IRQ, (1u << __NVIC_PRIO_BITS) - 1);
+    NVIC_EnableIRQ(WORKER_IRQ);
 
     hardware.StartAudio(AudioCallback);
+    audioRunning_ = true;
 }
 
 void Perspective::Exec() {
@@ -39,8 +115,35 @@ void Perspective::Exec() {
 
         eventHandler_.ProcessEvents();
 
+        HandleTapTempo();
+
+        hardware.GetMidi().Process(MIDI_BYTES_PER_PASS);
+        if (midiParameterChanged_ && currentEffect_) {
+            midiParameterChanged_ = false;
+            currentEffect_->Update();
+        }
+
+        // Effects that derive state from the swept parameter in Update() follow it at main loop rate
+        if (expressionMoved_ && currentEffect_) {
+            expressionMoved_ = false;
+            currentEffect_->Update();
+        }
+
+        // Follow the watchdog's level; effects reconfigure in Update(), so this is main loop work
+        FollowWatchdog();
+        FollowAudioCCs();
+
         hardware.SetProcessing(false); // Done processing controls/events
 
+        // Refill drained stream buffers before the display takes its share of the pass
+        backingTrack_.Service();
+
+        // Display work only runs once pending control events are drained, and is time-boxed
+        if (eventHandler_.GetQueueSize() == 0) {
+            UpdateDisplay();
+            renderer_.Render(DISPLAY_BUDGET_US);
+        }
+
         hardware.DelayMs(1); // Small delay to allow events to accumulate
     }
 }
@@ -50,10 +153,82 @@ void Perspective::LightLed(bool on) {
 }
 
 void Perspective::AudioCallbackImpl(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size) {
-    if (currentEffect_ && !bypassMode_) {
+    uint32_t startUs = System::GetUs();
+
+    // Already the handler default (FPDSCR, see Init); set again in case the
+    // default ever changes. A read-modify-write of FPSCR, a few instructions
+    SetFlushToZero(true);
+
+    // Effects read the beat as of this block's first sample
+    transport_.Process(size);
+    g_lfoBank.Process(size);
+
+    // Expression pedal ramp for this block (nullptr when unplugged or unassigned)
+    const float* pedal = hardware.IsExpressionConnected() ? expression_.Process(size) : nullptr;
+    const float* volume = nullptr;
+
+    if (pedal && expression_.GetTarget() == ExpressionPedal::Target::VOLUME) {
+        volume = pedal;
+        pedal = nullptr;
+    }
+
+    // While the effect runs in large blocks it has no per-sample pedal values,
+    // only the block-end value below
+    bool largeBlocks = g_dualRate.IsActive();
+
+    if (currentEffect_) {
+        int slot = expression_.GetSlot();
+        currentEffect_->SetModulation(slot, largeBlocks ? nullptr : pedal);
+
+        // The block-end value is also the parameter's value, for code that reads it once per block.
+        // The slot is checked against this effect, in case it was set for another one
+        if (pedal && slot >= 0 && static_cast<size_t>(slot) < currentEffect_->GetParameterCount()) {
+            float* value = &currentEffect_->GetParameterValues()[slot];
+            float next = pedal[size - 1];
+            if (*value != next) {
+                *value = next;
+                expressionMoved_ = true;
+            }
+        }
+    }
+
+    // Once the watchdog's fade to bypass is done the effect is not run at all
+    bool watchdogBypass = watchdog_.IsBypassed();
+    bool runEffect = currentEffect_ && !bypassMode_ && !(watchdogBypass && watchdogMix_ <= 0.0f);
+
+    // The large-block path always takes the input, so it stays primed through
+    // bypass, and gives back its output from DualRateEngine::LATENCY samples ago
+    if (largeBlocks && g_dualRate.Process(in[0], in[1], out[0], out[1], size, runEffect)) {
+        NVIC_SetPendingIRQ(WORKER_IRQ);
+    }
+
+    if (runEffect) {
         // Process with current effect
         // Note: ProcessStereo requires non-const pointers, but won't modify input
-        currentEffect_->ProcessStereo(const_cast<float*>(in[0]), const_cast<float*>(in[1]), out[0], out[1], size);
+        if (!largeBlocks) {
+            currentEffect_->ProcessStereo(const_cast<float*>(in[0]), const_cast<float*>(in[1]), out[0], out[1], size);
+        }
+
+        // The large-block path only carries the wet signal; the dry signal
+        // goes straight through, without its latency
+        Effect* source = largeBlocks ? largeBlockEffect_ : currentEffect_;
+        if (source->IsWetOnly()) {
+            float dry = source->GetDryGain();
+            for (size_t i = 0; i < size; i++) {
+                out[0][i] += in[0][i] * dry;
+                out[1][i] += in[1][i] * dry;
+            }
+        }
+
+        if (watchdogBypass || watchdogMix_ < 1.0f) {
+            float step = watchdogBypass ? -watchdogFadeStep_ : watchdogFadeStep_;
+            for (size_t i = 0; i < size; i++) {
+                watchdogMix_ += step;
+                watchdogMix_ = watchdogMix_ < 0.0f ? 0.0f : (watchdogMix_ > 1.0f ? 1.0f : watchdogMix_);
+                out[0][i] = in[0][i] + (out[0][i] - in[0][i]) * watchdogMix_;
+                out[1][i] = in[1][i] + (out[1][i] - in[1][i]) * watchdogMix_;
+            }
+        }
     } else {
         // Bypass mode - pass through
         for (size_t i = 0; i < size; i++){
@@ -61,6 +236,56 @@ void Perspective::AudioCallbackImpl(AudioHandle::InputBuffer in, AudioHandle::Ou
             out[1][i] = in[1][i];
         }
     }
+
+    if (volume) {
+        for (size_t i = 0; i < size; i++) {
+            out[0][i] *= volume[i];
+            out[1][i] *= volume[i];
+        }
+    }
+
+    // The worker's share of this block counts towards the load too, so the
+    // watchdog steps the effect down when the two together leave no time
+    uint32_t elapsedUs = System::GetUs() - startUs;
+    uint32_t workerUs = 0;
+    if (largeBlocks && runEffect) {
+        workerUs = static_cast<uint32_t>(workerBlockUs_.load(std::memory_order_relaxed) * size /
+                                         DualRateEngine::BLOCK_SIZE);
+    }
+    callbackUs_.store(callbackUs_.load(std::memory_order_relaxed) + elapsedUs, std::memory_order_relaxed);
+    watchdog_.Measure(elapsedUs, size, workerUs);
+}
+
+void Perspective::ProcessLargeBlocks() {
+    Effect* effect = largeBlockEffect_;
+    if (!effect || !g_dualRate.IsActive()) return;
+
+    // The worker's own time: wall time less the callbacks that preempted it
+    uint32_t startUs = System::GetUs();
+    uint32_t startCallbackUs = callbackUs_.load(std::memory_order_relaxed);
+    uint32_t usedUs = 0;
+    uint32_t blocks = 0;
+
+    DualRateEngine::Job job;
+    while (g_dualRate.BeginBlock(&job)) {
+        effect->ProcessStereo(const_cast<float*>(job.inL), const_cast<float*>(job.inR), job.outL, job.outR,
+                              DualRateEngine::BLOCK_SIZE);
+        g_dualRate.EndBlock();
+        blocks++;
+
+        // A worker that has fallen behind would take the main loop's time
+        // with it; whatever queued up meanwhile is dropped
+        usedUs = (System::GetUs() - startUs) - (callbackUs_.load(std::memory_order_relaxed) - startCallbackUs);
+        if (usedUs >= workerBudgetUs_) {
+            g_dualRate.SkipBlocks();
+            break;
+        }
+    }
+    if (blocks > 0) workerBlockUs_.store(usedUs / blocks, std::memory_order_relaxed);
+}
+
+uint32_t Perspective::GetLargeBlockUnderruns() const {
+    return g_dualRate.GetUnderruns();
 }
 
 void Perspective::RegisterEventListeners() {
@@ -71,20 +296,17 @@ void Perspective::RegisterEventListeners() {
         [this](const UIEvent& event) {
             if (!currentEffect_) return;
             
-            // Find parameter with matching index
-            for (size_t i = 0; i < currentEffect_->GetParameterCount(); i++) {
-                EffectParameter* param = currentEffect_->GetParameter(i);
-                if (param && param->GetIndex() == event.controlIndex) {
-                    // Update parameter based on type
-                    if (param->GetType() == ParameterType::POTENTIOMETER) {
-                        PotentiometerParameter* potParam = static_cast<PotentiometerParameter*>(param);
-                        potParam->SetNormalizedValueWithCurve(event.value);
-                    }
-                    // Update effect with new parameter value
-                    currentEffect_->Update();
-                    break;
-                }
+            // Knob events carry the raw 16-bit ADC value
+            int slot = controlMap_.HandleKnob(event.controlIndex, event.value / 65535.0f);
+            if (slot < 0) return;
+
+            if (event.controlIndex < NUM_KNOBS - 1) {
+                parameterBars_[event.controlIndex].SetValue(controlMap_.GetNormalizedValue(slot));
             }
+            valueLabel_.SetParameter(controlMap_.GetName(slot), controlMap_.GetValue(slot));
+
+            // Update effect with new parameter value
+            currentEffect_->Update();
         },
         UIEventType::KNOB_CHANGED
     );
@@ -94,24 +316,13 @@ void Perspective::RegisterEventListeners() {
         [this](const UIEvent& event) {
             if (!currentEffect_) return;
             
-            // Find parameter with matching index
-            for (size_t i = 0; i < currentEffect_->GetParameterCount(); i++) {
-                EffectParameter* param = currentEffect_->GetParameter(i);
-                if (param && param->GetIndex() == event.controlIndex) {
-                    // Update parameter based on type
-                    if (param->GetType() == ParameterType::ENCODER) {
-                        EncoderParameter* encParam = static_cast<EncoderParameter*>(param);
-                        if (event.value > 0) {
-                            encParam->Increment(event.value);
-                        } else if (event.value < 0) {
-                            encParam->Decrement(-event.value);
-                        }
-                    }
-                    // Update effect with new parameter value
-                    currentEffect_->Update();
-                    break;
-                }
-            }
+            int slot = controlMap_.HandleEncoder(event.controlIndex, event.value);
+            if (slot < 0) return;
+
+            valueLabel_.SetParameter(controlMap_.GetName(slot), controlMap_.GetValue(slot));
+
+            // Update effect with new parameter value
+            currentEffect_->Update();
         },
         UIEventType::ENCODER_CHANGED
     );
@@ -121,20 +332,10 @@ void Perspective::RegisterEventListeners() {
         [this](const UIEvent& event) {
             if (!currentEffect_) return;
             
-            // Find parameter with matching index
-            for (size_t i = 0; i < currentEffect_->GetParameterCount(); i++) {
-                EffectParameter* param = currentEffect_->GetParameter(i);
-                if (param && param->GetIndex() == event.controlIndex) {
-                    // Update parameter based on type
-                    if (param->GetType() == ParameterType::TOGGLE) {
-                        ToggleParameter* toggleParam = static_cast<ToggleParameter*>(param);
-                        toggleParam->Toggle();
-                    }
-                    // Update effect with new parameter value
-                    currentEffect_->Update();
-                    break;
-                }
-            }
+            if (controlMap_.HandleButton(event.controlIndex) < 0) return;
+
+            // Update effect with new parameter value
+            currentEffect_->Update();
         },
         UIEventType::BUTTON_PRESSED
     );
@@ -160,18 +361,103 @@ void Perspective::RegisterEventListeners() {
         UIEventType::BUTTON_RELEASED,
         1  // Index 1 = Switch_2
     );
-    
-    // Register listener for Switch_3 being pressed (tap tempo)
+
+    // Switch_3 (tap tempo) is sampled directly by the hardware - see HandleTapTempo
+
+    // Register listener for Switch_4 being held (save the current preset)
     eventHandler_.RegisterListenerByIndex(
         [this](const UIEvent& event) {
-            HandleTapTempo();
+            presetSaved_ = true;
+            SavePreset(currentPreset_ < 0 ? 0 : currentPreset_);
         },
-        UIEventType::BUTTON_PRESSED,
-        2  // Index 2 = Switch_3
+        UIEventType::BUTTON_HELD,
+        SWITCH_4_IDX
+    );
+
+    // Register listener for Switch_4 being released (step to the next preset)
+    eventHandler_.RegisterListenerByIndex(
+        [this](const UIEvent& event) {
+            if (!presetSaved_) {
+                RecallPreset(presets_.GetNextSlot(currentPreset_));
+            }
+            presetSaved_ = false;
+        },
+        UIEventType::BUTTON_RELEASED,
+        SWITCH_4_IDX
     );
 
 }
 
+void Perspective::RegisterMidiListeners() {
+    MidiInput& midi = hardware.GetMidi();
+
+    // CCs go through the control map (CC 20 + slot by default); 14 and 15 set
+    // the block size and sample rate, and 16 chooses what the expression pedal sweeps
+    midi.SetControlChangeCallback([this](uint8_t cc, uint8_t value) {
+        if (cc == BLOCK_SIZE_CC || cc == SAMPLE_RATE_CC) {
+            // Each change restarts audio (and a rate change clears the effects' delay
+            // memory), so a sweep only takes effect once it has settled - see FollowAudioCCs
+            AudioConfig& config = pendingAudioConfig_;
+            if (!audioConfigPending_) config = audioConfig_;
+            if (cc == BLOCK_SIZE_CC) {
+                config.blockSize = AudioConfig::BLOCK_STEP * (1 + value * 63 / 127);
+                valueLabel_.SetParameter("Block Size", static_cast<float>(config.blockSize));
+            } else {
+                config.rate = value < 43 ? AudioConfig::Rate::KHZ_32
+                                         : (value < 86 ? AudioConfig::Rate::KHZ_48 : AudioConfig::Rate::KHZ_96);
+                valueLabel_.SetParameter("Sample Rate", config.GetSampleRate() * 0.001f);
+            }
+            audioConfigPending_ = true;
+            audioConfigChangedUs_ = System::GetUs();
+            return;
+        }
+
+        if (!currentEffect_) return;
+
+        if (cc == EXPRESSION_CC) {
+            // Holds until the next effect change, which goes back to the effect's own
+            // mapping. Only continuous parameters can be swept; toggles and encoder
+            // steps are left alone.
+            int chosen = value - 1;
+            if (value == 0) {
+                controlMap_.Build(currentEffect_);
+            } else if (chosen >= controlMap_.GetSlotCount() || controlMap_.GetType(chosen) == ParameterType::POTENTIOMETER) {
+                controlMap_.AssignKnob(KNOB_EXP_IDX, chosen);
+            } else {
+                return;
+            }
+            AssignExpression();
+            int target = controlMap_.GetKnobSlot(KNOB_EXP_IDX);
+            valueLabel_.SetText(target >= 0 ? controlMap_.GetName(target) : "Volume");
+            return;
+        }
+
+        int slot = controlMap_.HandleCC(cc, value);
+        if (slot < 0) return;
+
+        for (int i = 0; i < NUM_KNOBS - 1; i++) {
+            if (controlMap_.GetKnobSlot(i) == slot) {
+                parameterBars_[i].SetValue(controlMap_.GetNormalizedValue(slot));
+            }
+        }
+        valueLabel_.SetParameter(controlMap_.GetName(slot), controlMap_.GetValue(slot));
+        midiParameterChanged_ = true;
+    });
+
+    // Program change n recalls preset slot n
+    midi.SetProgramChangeCallback([this](uint8_t program) {
+        RecallPreset(program);
+    });
+
+    // MIDI clock follows the same path as tap tempo
+    midi.SetTempoCallback([this](float bpm) {
+        transport_.SetTempo(bpm / 60.0f);
+        if (currentEffect_) {
+            currentEffect_->SetTempo(bpm / 60.0f);
+        }
+    });
+}
+
 void Perspective::toggleBypass() {
     bypassMode_ = !bypassMode_;    
 }
@@ -179,32 +465,276 @@ void Perspective::toggleBypass() {
 void Perspective::LoadEffects() {
     // Populate effects vector using the factory function
     float sampleRate = hardware.AudioSampleRate();
-    PopulateEffects(&effects_, sampleRate);
+    PopulateEffects(&effects_, sampleRate, &g_lfoBank, &modelFlash_, &cabinetFlash_, &backingTrack_);
     
     // Set the first effect as current
     if (!effects_.empty()) {
         currentEffect_ = effects_[0];
+        controlMap_.Build(currentEffect_);
+        AssignExpression();
+    }
+
+    // Keep a typed handle on the tuner so the display can poll it
+    for (Effect* effect : effects_) {
+        if (effect->GetName() == "Tuner") {
+            tuner_ = static_cast<TunerEffect*>(effect);
+        }
     }
 }
 
-void Perspective::HandleTapTempo() {
+void Perspective::InitDisplay() {
+    // Decode the font once, and pre-layout the strings that are drawn most often
+    if (!g_textRenderer.Init(&__Vanilla_Extract_20p)) {
+        hardware.PrintLine("Font needs more than %d glyph runs", TextRenderer::MAX_GLYPH_RUNS);
+    }
+    for (Effect* effect : effects_) {
+        g_textRenderer.CacheString(effect->GetName().c_str());
+        for (size_t i = 0; i < effect->GetParameterCount(); i++) {
+            g_textRenderer.CacheString(effect->GetParameter(i).GetName());
+        }
+    }
+    for (const char* note : NOTE_NAMES) {
+        g_textRenderer.CacheString(note);
+    }
+
+    // Layout for the 320x240 panel (rotated 90 degrees)
+    effectName_ = TextLabel(10, 4, 300, 36);
+    tunerNeedle_ = TunerNeedle(40, 44, 240, 50);
+    valueLabel_ = ValueLabel(10, 98, 300, 36);
+    for (int i = 0; i < NUM_KNOBS - 1; i++) {
+        parameterBars_[i] = ParameterBar(14 + i * 50, 142, 42, 88);
+    }
+    effectName_.SetTextRenderer(&g_textRenderer);
+    valueLabel_.SetTextRenderer(&g_textRenderer);
+
+    renderer_.Init(hardware.GetDisplay(), hardware.GetForegroundLayer());
+    renderer_.AddWidget(&effectName_);
+    renderer_.AddWidget(&tunerNeedle_);
+    renderer_.AddWidget(&valueLabel_);
+    for (int i = 0; i < NUM_KNOBS - 1; i++) {
+        renderer_.AddWidget(&parameterBars_[i]);
+    }
+
+    RefreshDisplay();
+}
+
+void Perspective::RefreshDisplay() {
+    // Rebuild widget content for the current effect
+    for (int i = 0; i < NUM_KNOBS - 1; i++) {
+        parameterBars_[i].SetVisible(false);
+    }
+    tunerNeedle_.SetVisible(currentEffect_ != nullptr && currentEffect_ == tuner_);
+
+    valueLabel_.SetText("");
+
+    if (!currentEffect_) {
+        effectName_.SetText("");
+        return;
+    }
+
+    effectName_.SetText(currentEffect_->GetName().c_str());
+
+    for (size_t i = 0; i < currentEffect_->GetParameterCount(); i++) {
+        EffectParameter param = currentEffect_->GetParameter(i);
+        int index = param.GetIndex();
+        if (param.GetType() == ParameterType::POTENTIOMETER && index >= 0 && index < NUM_KNOBS - 1) {
+            parameterBars_[index].SetVisible(true);
+            parameterBars_[index].SetValue(param.GetNormalizedValue());
+        }
+    }
+}
+
+void Perspective::UpdateDisplay() {
+    // Poll values that change without a control event
+    if (tuner_ && currentEffect_ == tuner_) {
+        tunerNeedle_.SetCents(tuner_->GetCentsOffset(), tuner_->IsSignalDetected());
+        valueLabel_.SetText(tuner_->GetNoteName());
+    }
+}
+
+void Perspective::SelectEffect(size_t index) {
+    if (index >= effects_.size()) return;
+
+    // Stop the pedal writing into the old effect's slot before switching
+    expression_.Unassign();
+
+    // The new effect starts at full quality, and the old one is put back to
+    // full for the next time it is selected
+    Effect* previous = currentEffect_;
+    watchdog_.Reset(WatchdogLevels(effects_[index]));
+    currentEffectIndex_ = index;
+    currentEffect_ = effects_[index];
+    if (previous && previous != currentEffect_) previous->SetQuality(0);
+    controlMap_.Build(currentEffect_);
+    AssignExpression();
+    RefreshDisplay();
+    RouteEffect(false);
+}
+
+bool Perspective::CanUseLargeBlocks(const Effect* effect) const {
+    // Large blocks only pay off when the audio blocks are smaller
+    return effect && effect->UsesLargeBlocks() && audioConfig_.blockSize < DualRateEngine::BLOCK_SIZE;
+}
+
+int Perspective::WatchdogLevels(const Effect* effect) const {
+    // With the large-block path, the first step down moves the effect onto
+    // the worker at full quality, and its own levels follow there
+    return effect->GetQualityLevels() + (CanUseLargeBlocks(effect) ? 1 : 0);
+}
+
+void Perspective::FollowWatchdog() {
     if (!currentEffect_) return;
-    
-    uint32_t currentTime = hardware.system.GetNow();
-    
-    // Check if this is a valid tap (within timeout)
-    if (lastTapTime_ > 0 && (currentTime - lastTapTime_) < TAP_TIMEOUT_MS) {
-        // Calculate interval between taps
-        tapInterval_ = currentTime - lastTapTime_;
-        
-        // Convert interval to frequency (Hz)
-        // interval is in milliseconds, so frequency = 1000 / interval
-        float tempoHz = 1000.0f / static_cast<float>(tapInterval_);
-        
-        // Set tempo on effect
-        currentEffect_->SetTempo(tempoHz);
+
+    int level = watchdog_.GetQuality();
+    bool largeBlocks = CanUseLargeBlocks(currentEffect_) && level > 0;
+    RouteEffect(largeBlocks);
+
+    int quality = largeBlocks ? level - 1 : level;
+    if (quality != currentEffect_->GetQuality()) {
+        currentEffect_->SetQuality(quality);
+    }
+}
+
+void Perspective::RouteEffect(bool largeBlocks) {
+    Effect* effect = largeBlocks ? currentEffect_ : nullptr;
+    if (effect == largeBlockEffect_) return;
+
+    // The worker only runs ahead of the main loop, so it is idle here; while
+    // the engine is stopped the callback runs the current effect itself, and
+    // mixes in the dry signal for as long as the effect is still wet only
+    g_dualRate.Stop();
+    if (largeBlockEffect_) largeBlockEffect_->SetWetOnly(false);
+    largeBlockEffect_ = effect;
+    if (effect) {
+        effect->SetWetOnly(true);
+        workerBudgetUs_ = static_cast<uint32_t>(WORKER_BUDGET * DualRateEngine::BLOCK_SIZE * 1e6f /
+                                                audioConfig_.GetSampleRate());
+        workerBlockUs_.store(0, std::memory_order_relaxed);
+        g_dualRate.Start();
+    }
+    ReportLatency();
+}
+
+void Perspective::ReportLatency() {
+    // Input to output in ms, plus the large-block path's fixed delay on the wet signal when the effect is on it
+    float latency = audioConfig_.GetRoundTripLatencyMs();
+    if (largeBlockEffect_) {
+        latency += static_cast<float>(DualRateEngine::LATENCY) * 1000.0f / audioConfig_.GetSampleRate();
+    }
+    valueLabel_.SetParameter("Latency", latency);
+}
+
+void Perspective::AssignExpression() {
+    // The parameter mapped to KNOB_EXP_IDX is swept across its full range;
+    // without one the pedal sets the volume
+    int slot = controlMap_.GetKnobSlot(KNOB_EXP_IDX);
+    if (currentEffect_ && slot >= 0) {
+        EffectParameter param = currentEffect_->GetParameter(static_cast<size_t>(slot));
+        expression_.AssignParameter(slot, param.GetMin(), param.GetMax(), param.GetCurve());
+    } else {
+        expression_.AssignVolume();
+    }
+}
+
+bool Perspective::RecallPreset(int slot) {
+    if (slot < 0) return false;
+
+    const PresetRecord* record = presets_.Find(static_cast<uint8_t>(slot));
+    if (!record || record->effectId >= effects_.size()) return false;
+
+    // Parameters are read straight from memory-mapped flash and set before the
+    // effect is switched in, so the whole preset takes effect on the next audio block
+    // A preset saved with an audio configuration brings it back first, since a
+    // rate change re-initializes the effects. It replaces a CC 14/15 change
+    // that has not settled yet, which came before the recall.
+    AudioConfig config;
+    if (AudioConfig::Unpack(record->audioConfig, &config)) {
+        audioConfigPending_ = false;
+        ConfigureAudio(config);
+    }
+
+    // Values go through SetValue(), so they are clamped to the effect's current ranges
+    Effect* effect = effects_[record->effectId];
+    const float* values = record->GetValues();
+    for (size_t i = 0; i < record->numValues && i < effect->GetParameterCount(); i++) {
+        effect->GetParameter(i).SetValue(values[i]);
+    }
+    effect->Update();
+    currentPreset_ = slot;
+    SelectEffect(record->effectId);
+    return true;
+}
+
+bool Perspective::SavePreset(int slot) {
+    if (!currentEffect_ || slot < 0) return false;
+
+    // Erasing a flash sector can take tens of milliseconds; audio keeps running from DMA
+    if (!presets_.Save(static_cast<uint8_t>(slot), static_cast<uint8_t>(currentEffectIndex_),
+                       currentEffect_->GetParameterValues(), currentEffect_->GetParameterCount(),
+                       audioConfig_.Pack())) {
+        return false;
+    }
+    currentPreset_ = slot;
+    return true;
+}
+
+void Perspective::FollowAudioCCs() {
+    if (!audioConfigPending_ || System::GetUs() - audioConfigChangedUs_ < AUDIO_CC_SETTLE_US) return;
+
+    audioConfigPending_ = false;
+    ConfigureAudio(pendingAudioConfig_);
+}
+
+bool Perspective::ConfigureAudio(AudioConfig config) {
+    config = config.Validated();
+    if (config == audioConfig_) return false;
+
+    bool rateChanged = config.rate != audioConfig_.rate;
+    audioConfig_ = config;
+
+    // Everything below runs with the callback stopped, so nothing is reconfigured under it
+    if (audioRunning_) hardware.StopAudio();
+    if (rateChanged) hardware.SetAudioSampleRate(SaiRate(config.rate));
+    hardware.SetAudioBlockSize(config.blockSize);
+
+    float sampleRate = hardware.AudioSampleRate();
+    expression_.Init(hardware.GetExpressionAdc(), sampleRate, hardware.AudioBlockSize());
+    if (rateChanged) {
+        // Effects re-initialize at the new rate, so delay lines and loops start over
+        transport_.Init(sampleRate);
+        g_lfoBank.SetSampleRate(sampleRate);
+        for (Effect* effect : effects_) {
+            effect->SetSampleRate(sampleRate);
+        }
+        watchdog_.Init(sampleRate);
+        watchdogFadeStep_ = 1.0f / (WATCHDOG_FADE_S * sampleRate);
+    }
+
+    // The load measured at the old configuration no longer applies
+    if (currentEffect_) {
+        currentEffect_->SetQuality(0);
+        watchdog_.Reset(WatchdogLevels(currentEffect_));
+    }
+
+    // The effect starts back in the callback; the watchdog moves it onto the
+    // worker again if the new block size needs it
+    RouteEffect(false);
+
+    if (audioRunning_) hardware.StartAudio(AudioCallback);
+
+    ReportLatency();
+    return true;
+}
+
+void Perspective::HandleTapTempo() {
+    // Fit any taps queued since the last pass
+    if (!tapTempo_.Process()) return;
+
+    // The beat clock takes the fitted tempo, and its beats land on the taps
+    transport_.SetTempo(tapTempo_.GetTempoHz());
+    transport_.AlignBeat(tapTempo_.GetBeatPhase(System::GetUs()));
+
+    if (currentEffect_) {
+        currentEffect_->SetTempo(tapTempo_.GetTempoHz());
     }
-    
-    // Store current tap time for next tap
-    lastTapTime_ = currentTime;
 }
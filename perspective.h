@@ -3,12 +3,29 @@
 
 #include "hardware.h"
 #include "ui/ui.h"
+#include "ui/renderer.h"
+#include "ui/widgets.h"
+#include "controls.h"
+#include "presetstore.h"
+#include "qspipresetflash.h"
+#include "streamreader.h"
+#ifdef PERSPECTIVE_SD_CARD
+#include "sdfilesource.h"
+#endif
+#include "controlmap.h"
+#include "expressionpedal.h"
+#include "taptempo.h"
+#include "transport.h"
+#include "audiowatchdog.h"
+#include "audioconfig.h"
 
+#include <atomic>
 #include <vector>
 
 namespace perspective {
 
 class Effect;  // Forward declaration
+class TunerEffect;
 
 class Perspective : public UI {
 public:
@@ -20,23 +37,121 @@ public:
     void LightLed(bool on);
     
     void AudioCallbackImpl(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size);
+    // Large-block worker interrupt: runs the queued blocks through the effect
+    void ProcessLargeBlocks();
+
+    // Callback load, overrun count and the current effect's degrade state
+    inline const AudioWatchdog& GetWatchdog() const { return watchdog_; }
+    // Large blocks not back from the worker in time, or dropped over its budget
+    uint32_t GetLargeBlockUnderruns() const;
+
+    // Restarts audio with a new block size and sample rate (validated first);
+    // on a rate change every effect is re-initialized with its values kept.
+    // Returns false when the configuration was already in use.
+    bool ConfigureAudio(AudioConfig config);
+    inline const AudioConfig& GetAudioConfig() const { return audioConfig_; }
     
 protected:
     void RegisterEventListeners();
+    void RegisterMidiListeners();
     void LoadEffects();
     void toggleBypass();
     void HandleTapTempo();
+    void InitDisplay();
+    void RefreshDisplay();
+    void UpdateDisplay();
+    void SelectEffect(size_t index);
+    bool RecallPreset(int slot);
+    bool SavePreset(int slot);
+    void AssignExpression();
+    bool CanUseLargeBlocks(const Effect* effect) const;
+    int WatchdogLevels(const Effect* effect) const;
+    void FollowWatchdog();
+    void FollowAudioCCs();
+    void RouteEffect(bool largeBlocks);
+    void ReportLatency();
     
     Hardware hardware;
     Effect* currentEffect_;
+    size_t currentEffectIndex_ = 0;
+    ControlMap controlMap_;  // Control index -> parameter slot for the current effect
+    TunerEffect* tuner_ = nullptr;
     std::vector<Effect*> effects_;
 
+    // Expression pedal - drives the parameter mapped to KNOB_EXP_IDX (the
+    // effect's own, or one chosen with EXPRESSION_CC) or the output volume
+    // from the audio callback, one value per sample
+    ExpressionPedal expression_;
+    volatile bool expressionMoved_ = false;  // Block value changed, Update() due from the main loop
+
+    // Display pipeline - widgets only redraw when their value visibly changes
+    Renderer renderer_;
+    TextLabel effectName_;
+    ValueLabel valueLabel_;  // Last touched parameter, or the note name in tuner mode
+    ParameterBar parameterBars_[NUM_KNOBS - 1];  // One per panel knob (expression pedal has no bar)
+    TunerNeedle tunerNeedle_;
+    static constexpr uint32_t DISPLAY_BUDGET_US = 2000;  // Max drawing time per main loop pass
+
+    // Presets - Switch_4 steps through the stored presets, holding it saves
+    QspiPresetFlash presetFlash_;
+    PresetStore presets_;
+    int currentPreset_ = -1;
+    bool presetSaved_ = false;  // Hold already fired for this press
+
+    // Amp model and cabinet IR slots, read by those effects
+    QspiPresetFlash modelFlash_;
+    QspiPresetFlash cabinetFlash_;
+
+    // SD card streams, read ahead once per main loop pass (see StreamReader).
+    // Without the card the stream has no files and never opens.
+#ifdef PERSPECTIVE_SD_CARD
+    SdFileSource sdCard_;
+#endif
+    StreamReader backingTrack_;  // Looper backing track
+
+    // MIDI - CCs from one Process() pass are applied together, then one Update()
+    bool midiParameterChanged_ = false;
+    static constexpr size_t MIDI_BYTES_PER_PASS = 256;  // Bounds the MIDI work per main loop pass
+
     bool bypassMode_ = true;
     
-    // Tap tempo state
-    uint32_t lastTapTime_ = 0;
-    uint32_t tapInterval_ = 0;
-    static constexpr uint32_t TAP_TIMEOUT_MS = 2000;  // Reset if no tap within 2 seconds
+    // Tap tempo - Switch_3 is timestamped by the control timer, the fit runs in the main loop
+    TapTempo tapTempo_;
+
+    // Beat clock shared by every effect's LFOs (see g_lfoBank), advanced at the top of each audio block
+    Transport transport_;
+
+    // Watchdog - times each audio block; on sustained overrun the current effect
+    // drops to a cheaper quality level (applied from the main loop), then fades
+    // to bypass, and comes back once there is headroom again
+    AudioWatchdog watchdog_;
+    float watchdogMix_ = 1.0f;       // Effect (1) to dry (0) while the watchdog bypasses it
+    float watchdogFadeStep_ = 0.0f;  // Per sample
+    static constexpr float WATCHDOG_FADE_S = 0.01f;
+
+    // Block size and sample rate - MIDI CC 14 and 15 set them, and presets
+    // store them, so a CPU-hungry preset can bring its own larger blocks
+    AudioConfig audioConfig_ = {48, AudioConfig::Rate::KHZ_48};
+    bool audioRunning_ = false;
+    // CC 14 and 15 values wait here until the controller has stopped moving
+    AudioConfig pendingAudioConfig_ = audioConfig_;
+    bool audioConfigPending_ = false;
+    uint32_t audioConfigChangedUs_ = 0;
+    static constexpr uint32_t AUDIO_CC_SETTLE_US = 300000;
+
+    // Large-block path - when the watchdog steps an effect that
+    // UsesLargeBlocks() down from full quality in the callback, it runs at
+    // DualRateEngine::BLOCK_SIZE in a low-priority interrupt instead, wet
+    // only; the dry signal, bypass and the watchdog's fade stay in the
+    // callback. Set from the main loop with the engine stopped.
+    Effect* largeBlockEffect_ = nullptr;
+    std::atomic<uint32_t> callbackUs_{0};     // Running total of callback time, so the worker can leave it out
+    std::atomic<uint32_t> workerBlockUs_{0};  // Worker time per large block, for the watchdog
+    uint32_t workerBudgetUs_ = 0;             // Worker time per pend before queued blocks are dropped
+    static constexpr float WORKER_BUDGET = 0.75f;  // Of a large block's period
+    static constexpr uint8_t BLOCK_SIZE_CC = 14;   // 4 to 256 samples across the CC range
+    static constexpr uint8_t SAMPLE_RATE_CC = 15;  // Thirds of the range: 32, 48, 96kHz
+    static constexpr uint8_t EXPRESSION_CC = 16;   // 0: the effect's own pedal mapping, n: slot n - 1, past the last slot: volume
 };
 
 } // namespace perspective
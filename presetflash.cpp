@@ -0,0 +1,64 @@
+#include "presetflash.h"
+
+#include <string.h>
+
+using namespace perspective;
+
+SimulatedPresetFlash::SimulatedPresetFlash(uint32_t size, uint32_t sectorSize)
+    : size_(size),
+      sectorSize_(sectorSize),
+      writeLimit_(-1) {
+    data_ = new uint8_t[size_];
+    memset(data_, 0xFF, size_);
+
+    uint32_t numSectors = size_ / sectorSize_;
+    eraseCounts_ = new uint32_t[numSectors];
+    memset(eraseCounts_, 0, numSectors * sizeof(uint32_t));
+}
+
+SimulatedPresetFlash::~SimulatedPresetFlash() {
+    delete[] data_;
+    delete[] eraseCounts_;
+}
+
+bool SimulatedPresetFlash::EraseSector(uint32_t offset) {
+    if (offset >= size_) return false;
+
+    uint32_t sector = offset / sectorSize_;
+    memset(&data_[sector * sectorSize_], 0xFF, sectorSize_);
+    eraseCounts_[sector]++;
+    return true;
+}
+
+bool SimulatedPresetFlash::Write(uint32_t offset, const uint8_t* data, uint32_t size) {
+    if (offset + size > size_) return false;
+
+    for (uint32_t i = 0; i < size; i++) {
+        if (writeLimit_ == 0) return false;
+        if (writeLimit_ > 0) writeLimit_--;
+
+        // NOR programming can only clear bits
+        data_[offset + i] &= data[i];
+    }
+    return true;
+}
+
+uint32_t SimulatedPresetFlash::GetEraseCount(uint32_t sector) const {
+    return sector < size_ / sectorSize_ ? eraseCounts_[sector] : 0;
+}
+
+uint32_t SimulatedPresetFlash::GetMaxEraseCount() const {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < size_ / sectorSize_; i++) {
+        if (eraseCounts_[i] > count) count = eraseCounts_[i];
+    }
+    return count;
+}
+
+uint32_t SimulatedPresetFlash::GetMinEraseCount() const {
+    uint32_t count = 0xFFFFFFFF;
+    for (uint32_t i = 0; i < size_ / sectorSize_; i++) {
+        if (eraseCounts_[i] < count) count = eraseCounts_[i];
+    }
+    return count;
+}
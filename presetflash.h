@@ -0,0 +1,58 @@
+#ifndef PERSPECTIVE_PRESETFLASH_H
+#define PERSPECTIVE_PRESETFLASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Byte-addressed NOR flash region used by the PresetStore.
+// Offsets are relative to the start of the region. Erased bytes read 0xFF and
+// programming can only clear bits, so a location must be erased before it is
+// rewritten. GetData() returns a pointer into memory-mapped flash.
+class PresetFlash {
+public:
+    virtual ~PresetFlash() {}
+
+    virtual uint32_t GetSize() const = 0;
+    virtual uint32_t GetSectorSize() const = 0;
+
+    virtual bool EraseSector(uint32_t offset) = 0;
+    virtual bool Write(uint32_t offset, const uint8_t* data, uint32_t size) = 0;
+    virtual const uint8_t* GetData(uint32_t offset) const = 0;
+};
+
+// RAM-backed flash with NOR semantics, for running the preset store on a host.
+// Counts erases per sector (for checking wear levelling), and can stop
+// programming part way through a write to simulate power loss.
+class SimulatedPresetFlash : public PresetFlash {
+public:
+    SimulatedPresetFlash(uint32_t size, uint32_t sectorSize);
+    ~SimulatedPresetFlash() override;
+
+    uint32_t GetSize() const override { return size_; }
+    uint32_t GetSectorSize() const override { return sectorSize_; }
+
+    bool EraseSector(uint32_t offset) override;
+    bool Write(uint32_t offset, const uint8_t* data, uint32_t size) override;
+    const uint8_t* GetData(uint32_t offset) const override { return &data_[offset]; }
+
+    // Only the next 'bytes' bytes are programmed, then every write fails
+    // until the limit is cleared (negative = no limit)
+    void SetWriteLimit(int32_t bytes) { writeLimit_ = bytes; }
+
+    uint32_t GetEraseCount(uint32_t sector) const;
+    uint32_t GetMaxEraseCount() const;
+    uint32_t GetMinEraseCount() const;
+
+private:
+    uint8_t* data_;
+    uint32_t* eraseCounts_;
+    uint32_t size_;
+    uint32_t sectorSize_;
+    int32_t writeLimit_;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_PRESETFLASH_H
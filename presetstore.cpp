@@ -0,0 +1,262 @@
+#include "presetstore.h"
+
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace perspective;
+
+PresetStore::PresetStore()
+    : flash_(nullptr),
+      numSectors_(0),
+      sectorSize_(0),
+      headSector_(0),
+      headOffset_(0),
+      sectorSequence_(0),
+      recordSequence_(0) {
+    for (int i = 0; i < MAX_PRESETS; i++) {
+        index_[i] = EMPTY;
+    }
+}
+
+bool PresetStore::Init(PresetFlash* flash) {
+    flash_ = flash;
+    sectorSize_ = flash->GetSectorSize();
+    numSectors_ = flash->GetSize() / sectorSize_;
+    if (numSectors_ > MAX_SECTORS) numSectors_ = MAX_SECTORS;
+    if (numSectors_ < 3) return false;
+
+    for (int i = 0; i < MAX_PRESETS; i++) {
+        index_[i] = EMPTY;
+    }
+    recordSequence_ = 0;
+    sectorSequence_ = 0;
+
+    // Index every sector; the head is the sector entered most recently
+    bool found = false;
+    for (uint32_t s = 0; s < numSectors_; s++) {
+        const SectorHeader* header = reinterpret_cast<const SectorHeader*>(flash_->GetData(s * sectorSize_));
+        if (header->magic == SECTOR_MAGIC) {
+            ScanSector(s, true);
+            if (!found || header->sequence > sectorSequence_) {
+                headSector_ = s;
+                sectorSequence_ = header->sequence;
+                found = true;
+            }
+        } else if (!IsBlank(s)) {
+            // Interrupted erase or foreign data - nothing in it can be trusted
+            flash_->EraseSector(s * sectorSize_);
+        }
+    }
+
+    if (!found) {
+        // Empty region: start the log in sector 0
+        return EnterSector(0) && ReclaimSector(1);
+    }
+
+    headOffset_ = ScanSector(headSector_, false);
+
+    // Finish a reclaim that was interrupted by a power cycle
+    return ReclaimSector((headSector_ + 1) % numSectors_);
+}
+
+bool PresetStore::Save(uint8_t slot, uint8_t effectId, const float* values, size_t count, uint8_t audioConfig) {
+    if (!flash_ || (!values && count > 0) || slot >= MAX_PRESETS || effectId == DELETED) return false;
+
+    uint32_t buffer[MAX_RECORD_SIZE / sizeof(uint32_t)];
+    memset(buffer, 0xFF, sizeof(buffer));  // Padding is left erased
+
+    if (count > MAX_VALUES) count = MAX_VALUES;
+
+    PresetRecord* record = reinterpret_cast<PresetRecord*>(buffer);
+    record->magic = RECORD_MAGIC;
+    record->slot = slot;
+    record->effectId = effectId;
+    record->numValues = static_cast<uint8_t>(count);
+    record->audioConfig = audioConfig;
+    memcpy(record + 1, values, count * sizeof(float));
+
+    return AppendRecord(record);
+}
+
+bool PresetStore::Delete(uint8_t slot) {
+    if (!flash_ || slot >= MAX_PRESETS) return false;
+    if (!Find(slot)) return true;
+
+    PresetRecord record;
+    record.magic = RECORD_MAGIC;
+    record.slot = slot;
+    record.effectId = DELETED;
+    record.numValues = 0;
+    record.audioConfig = 0;
+
+    return AppendRecord(&record);
+}
+
+const PresetRecord* PresetStore::Find(uint8_t slot) const {
+    if (slot >= MAX_PRESETS || index_[slot] == EMPTY) return nullptr;
+
+    const PresetRecord* record = reinterpret_cast<const PresetRecord*>(flash_->GetData(index_[slot]));
+    return record->effectId == DELETED ? nullptr : record;
+}
+
+int PresetStore::GetLatestSlot() const {
+    int latest = -1;
+    for (int i = 0; i < MAX_PRESETS; i++) {
+        if (Find(i) && (latest < 0 || indexSequence_[i] > indexSequence_[latest])) {
+            latest = i;
+        }
+    }
+    return latest;
+}
+
+int PresetStore::GetNextSlot(int slot) const {
+    int start = slot < 0 ? MAX_PRESETS - 1 : slot;
+    for (int i = 1; i <= MAX_PRESETS; i++) {
+        int candidate = (start + i) % MAX_PRESETS;
+        if (Find(candidate)) return candidate;
+    }
+    return -1;
+}
+
+// Walks the records in a sector and returns the offset of the first free byte
+uint32_t PresetStore::ScanSector(uint32_t sector, bool updateIndex) {
+    const uint8_t* base = flash_->GetData(sector * sectorSize_);
+    uint32_t sequence = reinterpret_cast<const SectorHeader*>(base)->sequence;
+    uint32_t offset = sizeof(SectorHeader);
+
+    while (offset + sizeof(PresetRecord) <= sectorSize_) {
+        const PresetRecord* record = reinterpret_cast<const PresetRecord*>(base + offset);
+        if (*reinterpret_cast<const uint32_t*>(record) == EMPTY) break;
+
+        if (!IsValid(record, sectorSize_ - offset)) {
+            // Torn write: skip the largest space it could have programmed
+            offset += MAX_RECORD_SIZE;
+            continue;
+        }
+
+        if (updateIndex) {
+            UpdateIndex(record, sector * sectorSize_ + offset, sequence);
+        }
+        if (record->sequence > recordSequence_) {
+            recordSequence_ = record->sequence;
+        }
+        offset += record->GetSize();
+    }
+    return offset;
+}
+
+bool PresetStore::IsBlank(uint32_t sector) const {
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(flash_->GetData(sector * sectorSize_));
+    for (uint32_t i = 0; i < sectorSize_ / sizeof(uint32_t); i++) {
+        if (words[i] != EMPTY) return false;
+    }
+    return true;
+}
+
+bool PresetStore::IsValid(const PresetRecord* record, uint32_t available) const {
+    if (record->magic != RECORD_MAGIC || record->slot >= MAX_PRESETS || record->numValues > MAX_VALUES) {
+        return false;
+    }
+    if (record->GetSize() > available) return false;
+
+    uint16_t crc = Crc16(reinterpret_cast<const uint8_t*>(record), offsetof(PresetRecord, crc));
+    crc = Crc16(reinterpret_cast<const uint8_t*>(record->GetValues()), record->numValues * sizeof(float), crc);
+    return crc == record->crc;
+}
+
+bool PresetStore::AppendRecord(PresetRecord* record) {
+    record->sequence = ++recordSequence_;
+
+    uint16_t crc = Crc16(reinterpret_cast<const uint8_t*>(record), offsetof(PresetRecord, crc));
+    record->crc = Crc16(reinterpret_cast<const uint8_t*>(record->GetValues()), record->numValues * sizeof(float), crc);
+
+    // Each pass moves the head on one sector; a record always fits in an empty sector
+    for (uint32_t attempt = 0; attempt < numSectors_; attempt++) {
+        if (headOffset_ + record->GetSize() <= sectorSize_) {
+            return WriteAtHead(record);
+        }
+
+        uint32_t next = (headSector_ + 1) % numSectors_;
+        if (!EnterSector(next) || !ReclaimSector((next + 1) % numSectors_)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool PresetStore::WriteAtHead(const PresetRecord* record) {
+    uint32_t size = record->GetSize();
+    if (headOffset_ + size > sectorSize_) return false;
+
+    uint32_t offset = headSector_ * sectorSize_ + headOffset_;
+    if (!flash_->Write(offset, reinterpret_cast<const uint8_t*>(record), size)) {
+        headOffset_ += MAX_RECORD_SIZE;  // Don't program over a partial record (matches ScanSector)
+        return false;
+    }
+
+    headOffset_ += size;
+    UpdateIndex(record, offset, sectorSequence_);
+    return true;
+}
+
+bool PresetStore::EnterSector(uint32_t sector) {
+    // Never erase a sector that still holds the latest record for a slot
+    uint32_t start = sector * sectorSize_;
+    for (int i = 0; i < MAX_PRESETS; i++) {
+        if (index_[i] != EMPTY && index_[i] >= start && index_[i] < start + sectorSize_) return false;
+    }
+
+    if (!IsBlank(sector) && !flash_->EraseSector(start)) return false;
+
+    SectorHeader header;
+    header.magic = SECTOR_MAGIC;
+    header.sequence = sectorSequence_ + 1;
+    if (!flash_->Write(start, reinterpret_cast<const uint8_t*>(&header), sizeof(header))) return false;
+
+    headSector_ = sector;
+    headOffset_ = sizeof(SectorHeader);
+    sectorSequence_ = header.sequence;
+    return true;
+}
+
+// Copies the live records out of a sector to the head, then erases it
+bool PresetStore::ReclaimSector(uint32_t sector) {
+    if (IsBlank(sector)) return true;
+
+    uint32_t start = sector * sectorSize_;
+    uint32_t buffer[MAX_RECORD_SIZE / sizeof(uint32_t)];
+
+    for (int i = 0; i < MAX_PRESETS; i++) {
+        if (index_[i] == EMPTY || index_[i] < start || index_[i] >= start + sectorSize_) continue;
+
+        // Flash can't be read while it is being programmed, so copy the record to RAM first.
+        // The copy keeps its sequence; the newer sector wins the tie on the next scan.
+        const PresetRecord* record = reinterpret_cast<const PresetRecord*>(flash_->GetData(index_[i]));
+        memcpy(buffer, record, record->GetSize());
+        if (!WriteAtHead(reinterpret_cast<const PresetRecord*>(buffer))) return false;
+    }
+
+    return flash_->EraseSector(start);
+}
+
+void PresetStore::UpdateIndex(const PresetRecord* record, uint32_t offset, uint32_t sectorSequence) {
+    uint8_t slot = record->slot;
+    if (index_[slot] == EMPTY || record->sequence > indexSequence_[slot] ||
+        (record->sequence == indexSequence_[slot] && sectorSequence > indexSectorSequence_[slot])) {
+        index_[slot] = offset;
+        indexSequence_[slot] = record->sequence;
+        indexSectorSequence_[slot] = sectorSequence;
+    }
+}
+
+uint16_t PresetStore::Crc16(const uint8_t* data, uint32_t size, uint16_t crc) {
+    // CRC-16/CCITT-FALSE
+    for (uint32_t i = 0; i < size; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
@@ -0,0 +1,99 @@
+#ifndef PERSPECTIVE_PRESETSTORE_H
+#define PERSPECTIVE_PRESETSTORE_H
+
+#include "presetflash.h"
+
+namespace perspective {
+
+// Stored preset: header followed by numValues floats, one per effect parameter
+// in GetParameter() order. Records are padded to a multiple of 4 bytes.
+struct PresetRecord {
+    uint16_t magic;
+    uint8_t slot;
+    uint8_t effectId;   // Index into the effect list
+    uint32_t sequence;  // Higher sequence wins when a slot has several records
+    uint8_t numValues;
+    uint8_t audioConfig;  // AudioConfig::Pack(), 0 when the preset keeps the current one
+    uint16_t crc;       // CRC-16/CCITT over the header (up to crc) and values
+
+    inline const float* GetValues() const { return reinterpret_cast<const float*>(this + 1); }
+    inline uint32_t GetSize() const { return (sizeof(PresetRecord) + numValues * sizeof(float) + 3) & ~3u; }
+};
+
+// Log-structured preset storage.
+// Records are appended to the current sector, and every save or delete writes a
+// new record rather than rewriting the old one. Sectors are used as a ring: when
+// the head moves into a sector, the sector after it is reclaimed by copying its
+// live records forward and erasing it, so there is always one erased sector
+// ahead of the head and every sector is erased equally often. A RAM index holds
+// the flash offset of the latest record for each slot, so a recall is a read of
+// memory-mapped flash with no scanning.
+class PresetStore {
+public:
+    PresetStore();
+
+    // Scans the flash and builds the index; formats the region if it holds no sectors
+    bool Init(PresetFlash* flash);
+
+    // Stores an effect's parameter values (GetParameterValues() order, at
+    // most MAX_VALUES), and optionally the packed audio configuration (block
+    // size and sample rate) to recall with it
+    bool Save(uint8_t slot, uint8_t effectId, const float* values, size_t count, uint8_t audioConfig = 0);
+
+    // Writes a deletion record for the slot
+    bool Delete(uint8_t slot);
+
+    // Latest record for a slot, or nullptr if the slot is empty
+    const PresetRecord* Find(uint8_t slot) const;
+
+    // Most recently saved slot, or -1 if there are no presets
+    int GetLatestSlot() const;
+
+    // Next populated slot after 'slot' (wrapping), or -1 if there are no presets
+    int GetNextSlot(int slot) const;
+
+    static constexpr int MAX_PRESETS = 64;
+    static constexpr int MAX_VALUES = 16;
+    static constexpr int MAX_SECTORS = 64;
+    static constexpr uint8_t DELETED = 0xFF;  // effectId of a deletion record
+
+private:
+    // The magic is programmed last, so a torn header never looks valid
+    struct SectorHeader {
+        uint32_t sequence;  // Incremented each time the head enters a sector
+        uint32_t magic;
+    };
+
+    uint32_t ScanSector(uint32_t sector, bool updateIndex);
+    bool IsBlank(uint32_t sector) const;
+    bool IsValid(const PresetRecord* record, uint32_t available) const;
+    bool AppendRecord(PresetRecord* record);
+    bool WriteAtHead(const PresetRecord* record);
+    bool EnterSector(uint32_t sector);
+    bool ReclaimSector(uint32_t sector);
+    void UpdateIndex(const PresetRecord* record, uint32_t offset, uint32_t sectorSequence);
+
+    static uint16_t Crc16(const uint8_t* data, uint32_t size, uint16_t crc = 0xFFFF);
+
+    static constexpr uint16_t RECORD_MAGIC = 0x5250;      // "PR"
+    static constexpr uint32_t SECTOR_MAGIC = 0x50535431;  // "PST1"
+    static constexpr uint32_t EMPTY = 0xFFFFFFFF;
+    static constexpr uint32_t MAX_RECORD_SIZE = sizeof(PresetRecord) + MAX_VALUES * sizeof(float);
+
+    PresetFlash* flash_;
+    uint32_t numSectors_;
+    uint32_t sectorSize_;
+    uint32_t headSector_;
+    uint32_t headOffset_;      // Offset of the next free byte within the head sector
+    uint32_t sectorSequence_;  // Sequence of the head sector
+    uint32_t recordSequence_;  // Sequence of the last record written
+
+    // Index: flash offset of the latest record for each slot
+    uint32_t index_[MAX_PRESETS];
+    uint32_t indexSequence_[MAX_PRESETS];
+    uint32_t indexSectorSequence_[MAX_PRESETS];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_PRESETSTORE_H
@@ -0,0 +1,43 @@
+#include "qspipresetflash.h"
+
+using namespace perspective;
+
+QspiPresetFlash::QspiPresetFlash()
+    : qspi_(nullptr),
+      baseOffset_(0),
+      size_(0) {
+}
+
+void QspiPresetFlash::Init(QSPIHandle* qspi, uint32_t baseOffset, uint32_t size) {
+    qspi_ = qspi;
+    baseOffset_ = baseOffset;
+    size_ = size;
+}
+
+// The mapped region is cacheable, so drop any lines that now hold stale flash contents
+static void InvalidateMapped(const uint8_t* address, uint32_t size) {
+    uintptr_t start = reinterpret_cast<uintptr_t>(address) & ~static_cast<uintptr_t>(31);
+    uintptr_t end = reinterpret_cast<uintptr_t>(address) + size;
+    SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(start), static_cast<int32_t>(end - start));
+}
+
+bool QspiPresetFlash::EraseSector(uint32_t offset) {
+    if (!qspi_ || offset >= size_) return false;
+
+    bool ok = qspi_->EraseSector(baseOffset_ + offset) == QSPIHandle::Result::OK;
+    InvalidateMapped(GetData(offset - offset % SECTOR_SIZE), SECTOR_SIZE);
+    return ok;
+}
+
+bool QspiPresetFlash::Write(uint32_t offset, const uint8_t* data, uint32_t size) {
+    if (!qspi_ || offset + size > size_) return false;
+
+    // The handle takes a non-const buffer but only reads from it
+    bool ok = qspi_->Write(baseOffset_ + offset, size, const_cast<uint8_t*>(data)) == QSPIHandle::Result::OK;
+    InvalidateMapped(GetData(offset), size);
+    return ok;
+}
+
+const uint8_t* QspiPresetFlash::GetData(uint32_t offset) const {
+    return static_cast<const uint8_t*>(qspi_->GetData(baseOffset_ + offset));
+}
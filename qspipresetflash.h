@@ -0,0 +1,39 @@
+#ifndef PERSPECTIVE_QSPIPRESETFLASH_H
+#define PERSPECTIVE_QSPIPRESETFLASH_H
+
+#include "daisy_seed.h"
+#include "presetflash.h"
+
+using namespace daisy;
+
+// Preset region at the top of the 8MB QSPI flash (16 x 4KB sectors)
+#define PRESET_FLASH_OFFSET 0x007F0000
+#define PRESET_FLASH_SIZE   0x00010000
+
+namespace perspective {
+
+// The Daisy Seed's QSPI flash (IS25LP064A, 4KB erase sectors)
+class QspiPresetFlash : public PresetFlash {
+public:
+    QspiPresetFlash();
+
+    void Init(QSPIHandle* qspi, uint32_t baseOffset = PRESET_FLASH_OFFSET, uint32_t size = PRESET_FLASH_SIZE);
+
+    uint32_t GetSize() const override { return size_; }
+    uint32_t GetSectorSize() const override { return SECTOR_SIZE; }
+
+    bool EraseSector(uint32_t offset) override;
+    bool Write(uint32_t offset, const uint8_t* data, uint32_t size) override;
+    const uint8_t* GetData(uint32_t offset) const override;
+
+    static constexpr uint32_t SECTOR_SIZE = 4096;
+
+private:
+    QSPIHandle* qspi_;
+    uint32_t baseOffset_;
+    uint32_t size_;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_QSPIPRESETFLASH_H
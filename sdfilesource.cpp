@@ -0,0 +1,69 @@
+#include "sdfilesource.h"
+
+using namespace perspective;
+
+// The SDMMC's DMA cannot reach DTCM, where the stack (and so the Perspective
+// object) lives, so the volume and file objects - which hold FatFS's sector
+// buffers - are kept in AXI SRAM here
+static SdmmcHandler g_sdmmc;
+static FatFSInterface g_fatfs;
+static FIL g_files[FileSource::MAX_FILES];
+
+static inline bool IsValid(int file) {
+    return file >= 0 && file < FileSource::MAX_FILES;
+}
+
+SdFileSource::SdFileSource()
+    : mounted_(false) {
+    for (int i = 0; i < MAX_FILES; i++) {
+        open_[i] = false;
+    }
+}
+
+bool SdFileSource::Init() {
+    SdmmcHandler::Config config;
+    config.Defaults();
+    config.speed = SdmmcHandler::Speed::FAST;  // 50MHz, 4-bit
+    if (g_sdmmc.Init(config) != SdmmcHandler::Result::OK) return false;
+
+    g_fatfs.Init(FatFSInterface::Config::MEDIA_SD);
+    mounted_ = f_mount(&g_fatfs.GetSDFileSystem(), g_fatfs.GetSDPath(), 1) == FR_OK;
+    return mounted_;
+}
+
+int SdFileSource::Open(const char* path) {
+    if (!mounted_ || !path) return -1;
+
+    for (int i = 0; i < MAX_FILES; i++) {
+        if (open_[i]) continue;
+        if (f_open(&g_files[i], path, FA_READ | FA_OPEN_EXISTING) != FR_OK) return -1;
+        open_[i] = true;
+        return i;
+    }
+    return -1;
+}
+
+void SdFileSource::Close(int file) {
+    if (!IsValid(file) || !open_[file]) return;
+
+    f_close(&g_files[file]);
+    open_[file] = false;
+}
+
+uint32_t SdFileSource::GetSize(int file) const {
+    if (!IsValid(file) || !open_[file]) return 0;
+    return static_cast<uint32_t>(f_size(&g_files[file]));
+}
+
+bool SdFileSource::Seek(int file, uint32_t offset) {
+    if (!IsValid(file) || !open_[file]) return false;
+    return f_lseek(&g_files[file], offset) == FR_OK;
+}
+
+int32_t SdFileSource::Read(int file, uint8_t* data, uint32_t size) {
+    if (!IsValid(file) || !open_[file]) return -1;
+
+    UINT read = 0;
+    if (f_read(&g_files[file], data, size, &read) != FR_OK) return -1;
+    return static_cast<int32_t>(read);
+}
@@ -0,0 +1,36 @@
+#ifndef PERSPECTIVE_SDFILESOURCE_H
+#define PERSPECTIVE_SDFILESOURCE_H
+
+#include "daisy_seed.h"
+#include "filesource.h"
+
+using namespace daisy;
+
+namespace perspective {
+
+// Files on the FAT volume of the Daisy Seed's micro SD card (SDMMC1, 4-bit).
+// The card is mounted once at Init; a card inserted later is not seen until
+// the next power up.
+class SdFileSource : public FileSource {
+public:
+    SdFileSource();
+
+    // False if there is no card or it holds no FAT volume
+    bool Init();
+    inline bool IsMounted() const { return mounted_; }
+
+    int Open(const char* path) override;
+    void Close(int file) override;
+
+    uint32_t GetSize(int file) const override;
+    bool Seek(int file, uint32_t offset) override;
+    int32_t Read(int file, uint8_t* data, uint32_t size) override;
+
+private:
+    bool mounted_;
+    bool open_[MAX_FILES];
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_SDFILESOURCE_H
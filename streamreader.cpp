@@ -0,0 +1,229 @@
+#include "streamreader.h"
+
+#include <string.h>
+
+using namespace perspective;
+
+StreamReader::StreamReader()
+    : files_(nullptr),
+      buffer_(nullptr),
+      halfSize_(0),
+      file_(-1),
+      start_(0),
+      length_(0),
+      remaining_(0),
+      loop_(false),
+      fillHalf_(0),
+      eof_(false),
+      active_(false),
+      processing_(false),
+      underruns_(0),
+      readHalf_(0),
+      readPos_(0),
+      format_(),
+      frameBytes_(0) {
+    fill_[0].store(0);
+    fill_[1].store(0);
+}
+
+void StreamReader::Init(FileSource* files, uint8_t* buffer, uint32_t halfSize) {
+    Close();
+    files_ = files;
+    buffer_ = buffer;
+    halfSize_ = halfSize;
+}
+
+void StreamReader::Close() {
+    // Take the buffer away from the audio callback, and wait out a read in flight
+    active_.store(false);
+    while (processing_.load()) {
+    }
+
+    if (file_ >= 0) files_->Close(file_);
+    file_ = -1;
+    fill_[0].store(0);
+    fill_[1].store(0);
+    eof_.store(false);
+    fillHalf_ = 0;
+    readHalf_ = 0;
+    readPos_ = 0;
+    frameBytes_ = 0;
+}
+
+bool StreamReader::Open(const char* path, uint32_t offset, uint32_t length, bool loop) {
+    Close();
+    if (!files_ || !buffer_ || halfSize_ == 0) return false;
+
+    file_ = files_->Open(path);
+    if (file_ < 0) return false;
+
+    uint32_t size = files_->GetSize(file_);
+    if (offset >= size) {
+        Close();
+        return false;
+    }
+    if (length == 0 || length > size - offset) length = size - offset;
+    return Start(offset, length, loop);
+}
+
+bool StreamReader::OpenWav(const char* path, bool loop) {
+    Close();
+    if (!files_ || !buffer_ || halfSize_ == 0) return false;
+
+    file_ = files_->Open(path);
+    if (file_ < 0) return false;
+
+    // The stream is not live yet, so the whole buffer can hold the header
+    uint32_t size = files_->GetSize(file_);
+    int32_t read = files_->Read(file_, buffer_, 2 * halfSize_);
+    WavFile wav;
+    if (read <= 0 || !wav.Parse(buffer_, static_cast<size_t>(read)) || wav.channels > 2) {
+        Close();
+        return false;
+    }
+
+    // Parse() clips the data chunk to what it was given; the full length is
+    // in the chunk header, just before the data
+    uint32_t offset = static_cast<uint32_t>(wav.data - buffer_);
+    const uint8_t* p = wav.data - 4;
+    uint32_t length = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                      (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    if (length > size - offset) length = size - offset;
+
+    uint32_t frameBytes = wav.channels * (wav.bitsPerSample / 8);
+    length -= length % frameBytes;
+    if (length == 0) {
+        Close();
+        return false;
+    }
+
+    format_ = wav;
+    format_.data = nullptr;
+    format_.frames = length / frameBytes;
+    frameBytes_ = frameBytes;
+    return Start(offset, length, loop);
+}
+
+bool StreamReader::Start(uint32_t offset, uint32_t length, bool loop) {
+    if (!files_->Seek(file_, offset)) {
+        Close();
+        return false;
+    }
+    start_ = offset;
+    length_ = length;
+    remaining_ = length;
+    loop_ = loop;
+
+    // Prime both halves, so the first underrun can only come a half later
+    underruns_.store(0, std::memory_order_relaxed);
+    if (!FillHalf(0)) {
+        Close();
+        return false;
+    }
+    FillHalf(1);
+    fillHalf_ = 0;
+    active_.store(true);
+    return true;
+}
+
+bool StreamReader::FillHalf(int half) {
+    if (eof_.load()) return false;
+
+    // Whole frames per half, so an underrun never splits one
+    uint32_t limit = frameBytes_ > 0 ? halfSize_ - halfSize_ % frameBytes_ : halfSize_;
+    uint8_t* data = buffer_ + half * halfSize_;
+    uint32_t filled = 0;
+    bool end = false;
+    while (filled < limit) {
+        if (remaining_ == 0) {
+            // Wrap a looping range; the half carries on from its start
+            if (!loop_ || !files_->Seek(file_, start_)) {
+                end = true;
+                break;
+            }
+            remaining_ = length_;
+        }
+
+        uint32_t want = limit - filled < remaining_ ? limit - filled : remaining_;
+        int32_t read = files_->Read(file_, data + filled, want);
+        if (read <= 0) {
+            // Error, or the file is shorter than it was at open
+            end = true;
+            break;
+        }
+        filled += static_cast<uint32_t>(read);
+        remaining_ -= static_cast<uint32_t>(read);
+    }
+
+    if (filled > 0) fill_[half].store(filled, std::memory_order_release);
+    if (end) eof_.store(true);
+    return filled > 0;
+}
+
+bool StreamReader::Service() {
+    if (!active_.load() || eof_.load()) return false;
+
+    // Halves are refilled in the order they are played
+    if (fill_[fillHalf_].load(std::memory_order_acquire) != 0) return false;
+    bool read = FillHalf(fillHalf_);
+    fillHalf_ ^= 1;
+    return read;
+}
+
+size_t StreamReader::Read(uint8_t* data, size_t size) {
+    processing_.store(true);
+    size_t done = 0;
+    if (active_.load()) {
+        while (done < size) {
+            uint32_t fill = fill_[readHalf_].load(std::memory_order_acquire);
+            if (fill == 0) {
+                // Nothing buffered: the main loop is behind, unless the range has run out
+                if (!eof_.load()) underruns_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            size_t count = fill - readPos_ < size - done ? fill - readPos_ : size - done;
+            memcpy(data + done, buffer_ + readHalf_ * halfSize_ + readPos_, count);
+            done += count;
+            readPos_ += static_cast<uint32_t>(count);
+
+            // Hand a drained half back to the main loop
+            if (readPos_ == fill) {
+                fill_[readHalf_].store(0, std::memory_order_release);
+                readHalf_ ^= 1;
+                readPos_ = 0;
+            }
+        }
+    }
+    processing_.store(false);
+
+    if (done < size) memset(data + done, 0, size - done);
+    return done;
+}
+
+size_t StreamReader::ReadFrames(float* left, float* right, size_t frames) {
+    if (frames > MAX_BLOCK_SIZE) frames = MAX_BLOCK_SIZE;
+
+    size_t count = 0;
+    if (frameBytes_ > 0) {
+        count = Read(frames_, frames * frameBytes_) / frameBytes_;
+    }
+
+    WavFile block = format_;
+    block.data = frames_;
+    block.frames = static_cast<uint32_t>(count);
+    uint16_t rightChannel = block.channels > 1 ? 1 : 0;
+    for (size_t i = 0; i < count; i++) {
+        left[i] = block.GetSample(static_cast<uint32_t>(i), 0);
+        right[i] = block.GetSample(static_cast<uint32_t>(i), rightChannel);
+    }
+    for (size_t i = count; i < frames; i++) {
+        left[i] = 0.0f;
+        right[i] = 0.0f;
+    }
+    return count;
+}
+
+bool StreamReader::IsFinished() const {
+    return active_.load() && eof_.load() && fill_[0].load() == 0 && fill_[1].load() == 0;
+}
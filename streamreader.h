@@ -0,0 +1,92 @@
+#ifndef PERSPECTIVE_STREAMREADER_H
+#define PERSPECTIVE_STREAMREADER_H
+
+#include "filesource.h"
+#include "effects/wavfile.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace perspective {
+
+// Read-ahead stream of one file for the audio callback. The buffer is split
+// in two halves: the audio side drains one while the main loop (Service())
+// refills the other, so the callback copies from memory and never waits on
+// the medium. If the main loop falls behind, the audio side gets silence for
+// what is missing and the underrun is counted. A stream can loop over its
+// range (a backing track) or stop at the end of it.
+//
+// Open, Close and Service run in the main loop; Read, ReadFrames and the
+// getters are safe from the audio callback.
+class StreamReader {
+public:
+    static constexpr size_t MAX_BLOCK_SIZE = 256;  // Frames per ReadFrames call
+
+    StreamReader();
+
+    // Buffer of 2 * halfSize bytes (SDRAM on the pedal, 32-byte aligned for
+    // the card's DMA). A half should hold well over one main loop pass of data.
+    void Init(FileSource* files, uint8_t* buffer, uint32_t halfSize);
+
+    // Bytes offset to offset + length of the file (length 0 = to the end).
+    // Both halves are filled before the stream goes live.
+    bool Open(const char* path, uint32_t offset = 0, uint32_t length = 0, bool loop = false);
+    // The sample data of a WAV file, 1 or 2 channels, for ReadFrames()
+    bool OpenWav(const char* path, bool loop = false);
+    void Close();
+
+    // Refills a drained half; returns true if it read from the file
+    bool Service();
+
+    // Copies size bytes, zero filling whatever is not buffered; returns the
+    // bytes copied
+    size_t Read(uint8_t* data, size_t size);
+    // Up to MAX_BLOCK_SIZE frames of an OpenWav() stream, -1.0 to 1.0. A mono
+    // file goes to both sides. Returns the frames copied.
+    size_t ReadFrames(float* left, float* right, size_t frames);
+
+    inline bool IsOpen() const { return active_.load(); }
+    // A non-looping stream has been played to the end
+    bool IsFinished() const;
+    inline const WavFile& GetFormat() const { return format_; }
+
+    // Reads that came up short while the file still had data
+    inline uint32_t GetUnderruns() const { return underruns_.load(std::memory_order_relaxed); }
+    inline void ResetUnderruns() { underruns_.store(0, std::memory_order_relaxed); }
+
+private:
+    bool Start(uint32_t offset, uint32_t length, bool loop);
+    bool FillHalf(int half);
+
+    FileSource* files_;
+    uint8_t* buffer_;
+    uint32_t halfSize_;
+
+    // Main loop side
+    int file_;
+    uint32_t start_;
+    uint32_t length_;
+    uint32_t remaining_;  // Bytes of the range not yet read
+    bool loop_;
+    int fillHalf_;        // Next half to refill
+
+    // Bytes held by each half; 0 = drained, owned by the main loop
+    std::atomic<uint32_t> fill_[2];
+    std::atomic<bool> eof_;         // The last of a non-looping range is buffered
+    std::atomic<bool> active_;
+    std::atomic<bool> processing_;  // Audio side is reading
+    std::atomic<uint32_t> underruns_;
+
+    // Audio side
+    int readHalf_;
+    uint32_t readPos_;
+
+    WavFile format_;
+    uint32_t frameBytes_;
+    uint8_t frames_[MAX_BLOCK_SIZE * 2 * 4];  // Raw frames for ReadFrames
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_STREAMREADER_H
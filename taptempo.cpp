@@ -0,0 +1,132 @@
+#include "taptempo.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+TapTempo::TapTempo()
+    : head_(0),
+      tail_(0) {
+    Reset();
+}
+
+void TapTempo::Reset() {
+    count_ = 0;
+    beat_ = -1;
+    misses_ = 0;
+    lastTapUs_ = 0;
+    strayUs_ = 0;
+    periodUs_ = 0.0f;
+    anchorUs_ = 0;
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+void TapTempo::Tap(uint32_t timeUs) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= QUEUE_SIZE) return;  // Main loop stalled
+
+    queue_[head & (QUEUE_SIZE - 1)] = timeUs;
+    head_.store(head + 1, std::memory_order_release);
+}
+
+bool TapTempo::Process() {
+    bool changed = false;
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+
+    while (tail != head) {
+        uint32_t time = queue_[tail & (QUEUE_SIZE - 1)];
+        tail++;
+
+        int step = 1;  // Beats since the newest tap
+        if (count_ > 0) {
+            uint32_t interval = time - lastTapUs_;
+            if (interval < MIN_INTERVAL_US) continue;  // Double tap
+
+            if (interval > TIMEOUT_US) {
+                count_ = 0;
+                misses_ = 0;
+            } else if (count_ >= 2 && IsValid()) {
+                // Distance from the nearest beat on the current grid, so a
+                // missed beat or two still lands the tap on the right one
+                float beats = static_cast<float>(static_cast<int32_t>(time - anchorUs_)) / periodUs_;
+                long nearest = lroundf(beats);
+                float error = (beats - static_cast<float>(nearest)) * periodUs_;
+                if (nearest >= 1 && fabsf(error) <= OUTLIER_FRACTION * periodUs_) {
+                    step = static_cast<int>(nearest);
+                    misses_ = 0;
+                } else if (++misses_ < 2) {
+                    // Skip a single stray tap; the grid stays where it is
+                    strayUs_ = time;
+                    continue;
+                } else {
+                    // A different tempo - restart from the previous (also off-grid) tap
+                    taps_[0] = strayUs_;
+                    beats_[0] = 0;
+                    beat_ = 0;
+                    count_ = 1;
+                    misses_ = 0;
+                }
+            }
+        }
+
+        if (count_ == 0) {
+            beat_ = -1;
+        }
+        if (count_ == MAX_TAPS) {
+            for (int i = 1; i < MAX_TAPS; i++) {
+                taps_[i - 1] = taps_[i];
+                beats_[i - 1] = beats_[i];
+            }
+            count_--;
+        }
+        beat_ += step;
+        taps_[count_] = time;
+        beats_[count_] = beat_;
+        count_++;
+        lastTapUs_ = time;
+
+        if (count_ >= 2) {
+            changed |= Fit();
+        }
+    }
+
+    tail_.store(tail, std::memory_order_release);
+    return changed;
+}
+
+bool TapTempo::Fit() {
+    // Least squares line through (beat number, tap time); both are relative to
+    // the oldest tap so the sums stay well within float precision
+    float n = static_cast<float>(count_);
+    float sx = 0.0f, sy = 0.0f, sxx = 0.0f, sxy = 0.0f;
+    for (int i = 0; i < count_; i++) {
+        float x = static_cast<float>(beats_[i] - beats_[0]);
+        float y = static_cast<float>(taps_[i] - taps_[0]);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    float denominator = n * sxx - sx * sx;
+    if (denominator <= 0.0f) return false;
+
+    float slope = (n * sxy - sx * sy) / denominator;
+    float intercept = (sy - slope * sx) / n;
+    if (slope <= 0.0f) return false;
+
+    // The fitted time of the newest tap is the beat anchor
+    float anchor = intercept + slope * static_cast<float>(beats_[count_ - 1] - beats_[0]);
+    anchorUs_ = taps_[0] + static_cast<uint32_t>(static_cast<int32_t>(lroundf(anchor)));
+
+    bool changed = slope != periodUs_;
+    periodUs_ = slope;
+    return changed;
+}
+
+float TapTempo::GetBeatPhase(uint32_t timeUs) const {
+    if (!IsValid()) return 0.0f;
+
+    float beats = static_cast<float>(static_cast<int32_t>(timeUs - anchorUs_)) / periodUs_;
+    return beats - floorf(beats);
+}
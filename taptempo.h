@@ -0,0 +1,71 @@
+#ifndef PERSPECTIVE_TAPTEMPO_H
+#define PERSPECTIVE_TAPTEMPO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace perspective {
+
+// Tap tempo estimator.
+// Tap() is called from the control timer interrupt with a microsecond timestamp
+// and only queues it. Process() (main loop) fits a beat grid through the last
+// MAX_TAPS taps by least squares, so every tap in the window counts rather than
+// just the last interval. Each tap is placed on the nearest beat of the current
+// grid, so missed beats are allowed for. A tap more than OUTLIER_FRACTION of a
+// beat from that beat is left out of the fit and leaves the grid alone; two
+// off-grid taps in a row mean the tempo changed, and start a new tap sequence.
+// The fitted grid is also a beat clock: GetBeatPhase() is 0 on each beat,
+// aligned with the taps.
+class TapTempo {
+public:
+    TapTempo();
+    void Reset();
+
+    // Interrupt side
+    void Tap(uint32_t timeUs);
+
+    // Main loop side - returns true when the tempo changed
+    bool Process();
+
+    inline bool IsValid() const { return periodUs_ > 0.0f; }
+    inline float GetPeriodUs() const { return periodUs_; }
+    inline float GetBpm() const { return periodUs_ > 0.0f ? 60000000.0f / periodUs_ : 0.0f; }
+    inline float GetTempoHz() const { return periodUs_ > 0.0f ? 1000000.0f / periodUs_ : 0.0f; }
+
+    // Time of the last beat on the fitted grid
+    inline uint32_t GetBeatAnchorUs() const { return anchorUs_; }
+
+    // Position within the beat at timeUs (0.0 to 1.0)
+    float GetBeatPhase(uint32_t timeUs) const;
+
+    static constexpr int MAX_TAPS = 8;
+    static constexpr uint32_t TIMEOUT_US = 2000000;      // A longer gap starts a new sequence
+    static constexpr uint32_t MIN_INTERVAL_US = 200000;  // 300 BPM
+    static constexpr float OUTLIER_FRACTION = 0.25f;     // Of a beat, from the fitted grid
+
+private:
+    bool Fit();
+
+    // Taps queued by the interrupt
+    static constexpr uint32_t QUEUE_SIZE = 8;  // Power of two
+    uint32_t queue_[QUEUE_SIZE];
+    std::atomic<uint32_t> head_;
+    std::atomic<uint32_t> tail_;
+
+    // Current tap sequence, oldest first, with the beat each tap fell on
+    uint32_t taps_[MAX_TAPS];
+    int beats_[MAX_TAPS];
+    int count_;
+    int beat_;             // Beat number of the newest tap in the sequence
+    int misses_;           // Consecutive taps off the grid
+    uint32_t lastTapUs_;   // Newest tap in the sequence
+    uint32_t strayUs_;     // Newest off-grid tap, where a tempo change restarts from
+
+    float periodUs_;
+    uint32_t anchorUs_;
+};
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_TAPTEMPO_H
@@ -0,0 +1,83 @@
+#include "transport.h"
+
+#include <math.h>
+
+using namespace perspective;
+
+static constexpr float PHASE_SCALE = 4294967296.0f;  // 2^32, one cycle
+static constexpr float MAX_INCREMENT = 2147483648.0f; // Half a cycle per sample
+
+uint32_t perspective::PhaseIncrement(float hz, float sampleRate) {
+    float increment = hz / sampleRate * PHASE_SCALE;
+    if (increment <= 0.0f) return 0;
+    if (increment >= MAX_INCREMENT) increment = MAX_INCREMENT - 1.0f;
+    return static_cast<uint32_t>(increment);
+}
+
+uint32_t perspective::PhaseFromCycles(float cycles) {
+    cycles -= floorf(cycles);
+    return static_cast<uint32_t>(static_cast<double>(cycles) * 4294967296.0);
+}
+
+Transport::Transport()
+    : sampleRate_(48000.0f),
+      tempoHz_(DEFAULT_TEMPO_HZ),
+      phase_(0),
+      beat_(0),
+      sample_(0),
+      increment_(0),
+      blockPhase_(0),
+      blockBeat_(0),
+      blockSample_(0),
+      pendingIncrement_(0),
+      pendingAlign_(0),
+      alignPending_(false) {
+}
+
+void Transport::Init(float sampleRate) {
+    sampleRate_ = sampleRate;
+    phase_ = 0;
+    beat_ = 0;
+    sample_ = 0;
+    SetTempo(tempoHz_);
+    increment_ = pendingIncrement_.load(std::memory_order_relaxed);
+}
+
+void Transport::SetTempo(float tempoHz) {
+    if (tempoHz <= 0.0f) return;
+
+    tempoHz_ = tempoHz;
+    pendingIncrement_.store(PhaseIncrement(tempoHz, sampleRate_), std::memory_order_release);
+}
+
+void Transport::AlignBeat(float phase) {
+    pendingAlign_.store(PhaseFromCycles(phase), std::memory_order_relaxed);
+    alignPending_.store(true, std::memory_order_release);
+}
+
+void Transport::Process(size_t size) {
+    increment_ = pendingIncrement_.load(std::memory_order_acquire);
+
+    if (alignPending_.load(std::memory_order_acquire)) {
+        uint32_t target = pendingAlign_.load(std::memory_order_relaxed);
+        alignPending_.store(false, std::memory_order_relaxed);
+
+        // Snap to the nearest beat boundary so a realign never loses or gains a beat count
+        if (target < phase_ && phase_ - target > 0x80000000u) {
+            beat_++;
+        } else if (target > phase_ && target - phase_ > 0x80000000u) {
+            beat_--;
+        }
+        phase_ = target;
+    }
+
+    blockPhase_ = phase_;
+    blockBeat_ = beat_;
+    blockSample_ = sample_;
+
+    // Advance to the start of the next block, counting beat wraps
+    uint64_t advanced = static_cast<uint64_t>(phase_) + static_cast<uint64_t>(increment_) * size;
+    phase_ = static_cast<uint32_t>(advanced);
+    beat_ += static_cast<uint32_t>(advanced >> 32);
+    sample_ += static_cast<uint32_t>(size);
+}
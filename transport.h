@@ -0,0 +1,70 @@
+#ifndef PERSPECTIVE_TRANSPORT_H
+#define PERSPECTIVE_TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace perspective {
+
+// Shared beat clock.
+// Process() is called once at the top of every audio callback and advances the
+// clock by whole blocks, so its position is sample accurate. The beat phase is
+// a 32-bit accumulator that wraps once per beat. SetTempo() and AlignBeat()
+// come from the main loop (tap tempo, MIDI clock) and take effect at the start
+// of the next block. Effects read the block-start state while they process, so
+// every effect in a block - including all children of a CompoundEffect - sees
+// the same beat.
+class Transport {
+public:
+    Transport();
+
+    void Init(float sampleRate);
+
+    // Main loop side
+    void SetTempo(float tempoHz);
+    // Beat phase (0.0 to 1.0) the clock should have at the start of the next block
+    void AlignBeat(float phase);
+
+    // Audio side - call once per block, before the effects run
+    void Process(size_t size);
+
+    // Block start state
+    inline uint32_t GetBeatPhase() const { return blockPhase_; }
+    inline uint32_t GetBeatCount() const { return blockBeat_; }
+    inline uint32_t GetBeatIncrement() const { return increment_; }  // Per sample
+    inline uint32_t GetSamplePosition() const { return blockSample_; }
+
+    inline float GetSampleRate() const { return sampleRate_; }
+    inline float GetTempoHz() const { return tempoHz_; }
+
+    static constexpr float DEFAULT_TEMPO_HZ = 2.0f;  // 120 BPM until a tempo is set
+
+private:
+    float sampleRate_;
+    float tempoHz_;
+
+    // Free-running clock, advanced by Process()
+    uint32_t phase_;
+    uint32_t beat_;
+    uint32_t sample_;
+    uint32_t increment_;
+
+    // Snapshot at the start of the current block
+    uint32_t blockPhase_;
+    uint32_t blockBeat_;
+    uint32_t blockSample_;
+
+    // Main loop -> audio handoff
+    std::atomic<uint32_t> pendingIncrement_;
+    std::atomic<uint32_t> pendingAlign_;
+    std::atomic<bool> alignPending_;
+};
+
+// Phase helpers - one cycle is 2^32
+uint32_t PhaseIncrement(float hz, float sampleRate);
+uint32_t PhaseFromCycles(float cycles);
+
+} // namespace perspective
+
+#endif // PERSPECTIVE_TRANSPORT_H
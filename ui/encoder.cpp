@@ -8,6 +8,9 @@ void Encoder::Init(Pin a, Pin b, Pin click, float update_rate)
     last_update_  = System::GetNow();
     update_rate_  = update_rate;
 
+    pin_a_ = a;
+    pin_b_ = b;
+
     // Init GPIO for A, and B
     hw_a_.Init(a, GPIO::Mode::INPUT, GPIO::Pull::NOPULL);
     hw_b_.Init(b, GPIO::Mode::INPUT, GPIO::Pull::NOPULL);
@@ -28,20 +31,36 @@ void Encoder::Process()
     if(now - last_update_ >= 1)
     {
         last_update_ = now;
+        Decode(hw_a_.Read(), hw_b_.Read());
+    }
+}
+
+void Encoder::Process(const PortSnapshot& snapshot)
+{
+    // update no faster than 1kHz
+    uint32_t now = System::GetNow();
 
-        // Read raw hardware states and shift into debounced state
-        a_ = (a_ << 1) | hw_a_.Read();
-        b_ = (b_ << 1) | hw_b_.Read();
-
-        // infer increment direction
-        inc_ = 0;
-        if((a_ & 0x03) == 0x02 && (b_ & 0x03) == 0x00)
-        {
-            inc_ = 1;
-        }
-        else if((b_ & 0x03) == 0x02 && (a_ & 0x03) == 0x00)
-        {
-            inc_ = -1;
-        }
+    if(now - last_update_ >= 1)
+    {
+        last_update_ = now;
+        Decode(snapshot.Read(pin_a_), snapshot.Read(pin_b_));
+    }
+}
+
+void Encoder::Decode(bool a, bool b)
+{
+    // Shift raw hardware states into debounced state
+    a_ = (a_ << 1) | a;
+    b_ = (b_ << 1) | b;
+
+    // infer increment direction
+    inc_ = 0;
+    if((a_ & 0x03) == 0x02 && (b_ & 0x03) == 0x00)
+    {
+        inc_ = 1;
+    }
+    else if((b_ & 0x03) == 0x02 && (a_ & 0x03) == 0x00)
+    {
+        inc_ = -1;
     }
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "daisy_core.h"
 #include "per/gpio.h"
 #include "switch.h"
+#include "portsnapshot.h"
 
 using namespace daisy;
 
@@ -37,6 +38,13 @@ class Encoder
      */
     void Process();
 
+    /**
+     * Same as Process(), but samples A/B from a port snapshot
+     * rather than reading the GPIOs individually
+     * @param snapshot Port snapshot captured for this scan
+     */
+    void Process(const PortSnapshot& snapshot);
+
     /**
      * Returns +1 if the encoder was turned clockwise, -1 if counter-clockwise, or 0 if not turned
      */
@@ -68,10 +76,13 @@ class Encoder
     }
 
   private:
+    void Decode(bool a, bool b);
+
     uint32_t last_update_;
     float    update_rate_;
     Switch   sw_;
     GPIO     hw_a_, hw_b_;
+    Pin      pin_a_, pin_b_;
     uint8_t  a_, b_;
     int32_t  inc_;
 };
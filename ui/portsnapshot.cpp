@@ -0,0 +1,20 @@
+#include "portsnapshot.h"
+#include "stm32h7xx_hal.h"
+
+using namespace daisy;
+using namespace perspective;
+
+// Indexed by daisy::GPIOPort
+static GPIO_TypeDef* const kPortRegisters[PortSnapshot::NUM_PORTS] = {
+    GPIOA, GPIOB, GPIOC, GPIOD, GPIOE, GPIOF, GPIOG, GPIOH, GPIOI, GPIOJ, GPIOK
+};
+
+void PortSnapshot::Capture()
+{
+    // One register read per port in use, instead of one HAL call per pin
+    for(int i = 0; i < NUM_PORTS; i++)
+    {
+        if(used_ & (1u << i))
+            idr_[i] = kPortRegisters[i]->IDR;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef PORTSNAPSHOT_H
+#define PORTSNAPSHOT_H
+
+#include "daisy_core.h"
+
+using namespace daisy;
+
+namespace perspective {
+
+/**
+ * @brief Single-read snapshot of the GPIO input data registers
+ * Rather than calling GPIO::Read once per pin, the control scan captures the
+ * IDR of every port that carries a control once, and all switches/encoders
+ * then sample their pins from the snapshot. On host, Load() can be used to
+ * drive the snapshot from a simulated port trace instead of Capture(), with
+ * host/daisy_core.h standing in for libDaisy's (see host/switchbanktest.cpp).
+ * @author Generated for Perspective
+ * @date February 2026
+ */
+class PortSnapshot
+{
+  public:
+    /** Number of GPIO ports on the STM32H750 (PORTA..PORTK) */
+    static constexpr int NUM_PORTS = 11;
+
+    PortSnapshot() : used_(0)
+    {
+        for(int i = 0; i < NUM_PORTS; i++)
+            idr_[i] = 0;
+    }
+    ~PortSnapshot() {}
+
+    /**
+     * Marks the port of a pin as needing to be captured
+     * @param pin Pin that will be sampled from the snapshot
+     */
+    inline void AddPin(Pin pin)
+    {
+        if(pin.port < NUM_PORTS)
+            used_ |= (1u << pin.port);
+    }
+
+    /**
+     * Reads the IDR register of every port registered with AddPin()
+     * Call once per control scan, before processing switches and encoders
+     */
+    void Capture();
+
+    /**
+     * Loads a port value directly (e.g. from a recorded or simulated trace)
+     * @param port GPIO port to load
+     * @param idr Input data register value for that port
+     */
+    inline void Load(GPIOPort port, uint32_t idr)
+    {
+        if(port < NUM_PORTS)
+            idr_[port] = idr;
+    }
+
+    /** @return the raw (non-debounced) level of a pin in the last snapshot */
+    inline bool Read(Pin pin) const
+    {
+        return pin.port < NUM_PORTS && ((idr_[pin.port] >> pin.pin) & 1u);
+    }
+
+    /** @return the captured IDR value of a port */
+    inline uint32_t GetPort(GPIOPort port) const
+    {
+        return port < NUM_PORTS ? idr_[port] : 0;
+    }
+
+  private:
+    uint16_t used_;            // Bit per port that must be captured
+    uint32_t idr_[NUM_PORTS];  // Last captured IDR value per port
+};
+
+} // namespace perspective
+
+#endif // PORTSNAPSHOT_H
@@ -0,0 +1,84 @@
+#include "renderer.h"
+#include "cDisplay.h"
+#include "sys/system.h"
+
+using namespace daisy;
+using namespace perspective;
+
+void Renderer::Init(DadGFX::cDisplay* display, DadGFX::cLayer* layer, float frameRate)
+{
+    display_         = display;
+    layer_           = layer;
+    numWidgets_      = 0;
+    next_            = 0;
+    framePeriodUs_   = static_cast<uint32_t>(1000000.0f / frameRate);
+    lastFrameUs_     = System::GetUs();
+    pendingFlush_    = false;
+    frameCount_      = 0;
+    frameCostUs_     = 0;
+    lastFrameCostUs_ = 0;
+}
+
+bool Renderer::AddWidget(Widget* widget)
+{
+    if(!widget || numWidgets_ >= MAX_WIDGETS)
+        return false;
+
+    widgets_[numWidgets_++] = widget;
+    return true;
+}
+
+void Renderer::InvalidateAll()
+{
+    for(int i = 0; i < numWidgets_; i++)
+        widgets_[i]->Invalidate();
+}
+
+bool Renderer::Render(uint32_t budgetUs)
+{
+    if(!display_ || !layer_)
+        return false;
+
+    uint32_t start = System::GetUs();
+
+    // Frame pacing - don't start a new frame until the period has elapsed
+    if(next_ == 0 && !pendingFlush_ && start - lastFrameUs_ < framePeriodUs_)
+        return false;
+
+    // Draw dirty widgets, resuming where the previous call ran out of budget
+    while(next_ < numWidgets_)
+    {
+        Widget* widget = widgets_[next_++];
+        if(widget->IsDirty())
+        {
+            widget->ClearDirty();
+            widget->Draw(layer_);
+            pendingFlush_ = true;
+
+            if(System::GetUs() - start >= budgetUs && next_ < numWidgets_)
+            {
+                frameCostUs_ += System::GetUs() - start;
+                return false;
+            }
+        }
+    }
+    next_ = 0;
+
+    if(!pendingFlush_)
+    {
+        lastFrameUs_ = start;
+        return false;
+    }
+
+    // Stream only the touched blocks to the panel
+    display_->flush();
+    pendingFlush_ = false;
+
+    uint32_t now     = System::GetUs();
+    lastFrameCostUs_ = frameCostUs_ + (now - start);
+    frameCostUs_     = 0;
+    lastFrameUs_     = start;
+    frameCount_++;
+
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <stdint.h>
+#include "widgets.h"
+
+namespace DadGFX {
+    class cDisplay;
+}
+
+namespace perspective {
+
+/**
+ * @brief Budgeted, dirty-region display renderer
+ * Widgets draw into a layer only when invalidated. The GFX2 display tracks
+ * which of its blocks (NB_BLOC_WIDTH x NB_BLOC_HEIGHT, see UserConfig.h) have
+ * been touched, and flush() streams only those blocks to the panel through
+ * its SPI DMA block FIFO (SIZE_FIFO), so a frame costs in proportion to what
+ * actually changed.
+ *
+ * Render() is called from the main loop with a time budget. Widgets that do
+ * not fit in the budget stay dirty and are drawn on the next call, and the
+ * flush is only issued once every dirty widget of the frame has been drawn.
+ * @author Generated for Perspective
+ * @date February 2026
+ */
+class Renderer
+{
+  public:
+    static constexpr int   MAX_WIDGETS        = 16;
+    static constexpr float DEFAULT_FRAME_RATE = 40.0f; // in Hz
+
+    Renderer()
+        : display_(nullptr), layer_(nullptr), numWidgets_(0), next_(0),
+          framePeriodUs_(0), lastFrameUs_(0), pendingFlush_(false),
+          frameCount_(0), frameCostUs_(0), lastFrameCostUs_(0) {}
+    ~Renderer() {}
+
+    /**
+     * Initializes the renderer
+     * @param display Display to flush
+     * @param layer Layer that the widgets draw into
+     * @param frameRate Maximum frame rate in Hz
+     */
+    void Init(DadGFX::cDisplay* display, DadGFX::cLayer* layer, float frameRate = DEFAULT_FRAME_RATE);
+
+    /**
+     * Registers a widget; widgets are drawn in registration order
+     * @return false if the widget table is full
+     */
+    bool AddWidget(Widget* widget);
+
+    /** Marks every widget dirty (e.g. after switching effect) */
+    void InvalidateAll();
+
+    /**
+     * Draws dirty widgets and flushes touched blocks, within a time budget
+     * @param budgetUs Maximum time to spend drawing in this call, in microseconds
+     * @return true if a frame was flushed
+     */
+    bool Render(uint32_t budgetUs);
+
+    /** @return number of frames flushed since Init */
+    inline uint32_t GetFrameCount() const { return frameCount_; }
+
+    /** @return time spent drawing and flushing the last frame, in microseconds */
+    inline uint32_t GetLastFrameCost() const { return lastFrameCostUs_; }
+
+  private:
+    DadGFX::cDisplay* display_;
+    DadGFX::cLayer*   layer_;
+    Widget*           widgets_[MAX_WIDGETS];
+    int               numWidgets_;
+    int               next_;          // Widget to resume from when the budget ran out
+    uint32_t          framePeriodUs_;
+    uint32_t          lastFrameUs_;
+    bool              pendingFlush_;  // Something has been drawn since the last flush
+    uint32_t          frameCount_;
+    uint32_t          frameCostUs_;   // Accumulates across budgeted Render() calls
+    uint32_t          lastFrameCostUs_;
+};
+
+} // namespace perspective
+
+#endif // RENDERER_H
@@ -80,6 +80,17 @@ class Switch
 
     inline uint8_t DebouncedState() const { return state_; }
 
+    /**
+     * Loads a debounced state computed externally (e.g. by SwitchBank)
+     * @param state 8-bit shift register value, newest sample in bit 0
+     */
+    inline void SetDebouncedState(uint8_t state)
+    {
+        state_ = state;
+        if(state_ == 0x7f)
+            rising_edge_time_ = System::GetNow();
+    }
+
     /** @return the time in microseconds that the button has been held (or toggle has been on) */
     inline int TimeHeld() const
     {
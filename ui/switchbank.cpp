@@ -0,0 +1,74 @@
+#include "switchbank.h"
+
+using namespace daisy;
+using namespace perspective;
+
+void SwitchBank::Init()
+{
+    numLanes_  = 0;
+    laneMask_  = 0;
+    invert_    = 0;
+    head_      = 0;
+    rising_    = 0;
+    falling_   = 0;
+    pressed_   = 0;
+    unsettled_ = 0;
+    active_    = 0;
+
+    for(int i = 0; i < HISTORY; i++)
+        history_[i] = 0;
+}
+
+int SwitchBank::AddLane(Pin pin, bool inverted)
+{
+    if(numLanes_ >= MAX_LANES)
+        return -1;
+
+    int lane     = numLanes_++;
+    pins_[lane]  = pin;
+    laneMask_   |= (1u << lane);
+    if(inverted)
+        invert_ |= (1u << lane);
+
+    return lane;
+}
+
+void SwitchBank::Process(const PortSnapshot& snapshot)
+{
+    // Gather the raw level of every lane into one word; 1 = pressed
+    uint32_t raw = 0;
+    for(int i = 0; i < numLanes_; i++)
+        raw |= static_cast<uint32_t>(snapshot.Read(pins_[i])) << i;
+    raw ^= invert_;
+
+    // Shift every lane at once: the oldest plane is overwritten by the newest
+    head_           = (head_ + 1) & (HISTORY - 1);
+    history_[head_] = raw;
+
+    // Combine the 7 most recent samples, then compare against the oldest
+    uint32_t allRecent = laneMask_;
+    uint32_t anyRecent = 0;
+    for(int age = 0; age < HISTORY - 1; age++)
+    {
+        allRecent &= Plane(age);
+        anyRecent |= Plane(age);
+    }
+    uint32_t oldest = Plane(HISTORY - 1);
+
+    rising_  = allRecent & ~oldest;             // 0x7f
+    falling_ = ~anyRecent & oldest & laneMask_; // 0x80
+    pressed_ = allRecent & oldest;              // 0xff
+
+    // A lane is settled when all 8 samples agree (0x00 or 0xff)
+    uint32_t unsettled = (anyRecent | oldest) & ~(allRecent & oldest);
+    active_            = unsettled | unsettled_;
+    unsettled_         = unsettled;
+}
+
+uint8_t SwitchBank::State(int lane) const
+{
+    uint8_t state = 0;
+    for(int age = HISTORY - 1; age >= 0; age--)
+        state = (state << 1) | ((Plane(age) >> lane) & 1u);
+    return state;
+}
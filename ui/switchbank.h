@@ -0,0 +1,93 @@
+#pragma once
+#ifndef SWITCHBANK_H
+#define SWITCHBANK_H
+
+#include <stdint.h>
+#include "portsnapshot.h"
+
+using namespace daisy;
+
+namespace perspective {
+
+/**
+ * @brief Parallel debouncer for up to 32 switches
+ * Uses the same 8-sample shift register scheme as Switch::state_, but stored
+ * bit-sliced: each history entry holds one sample of every lane, so all
+ * switches are shifted and edge-detected with a handful of bitwise operations.
+ * Debounce timing is therefore identical across buttons.
+ * @author Generated for Perspective
+ * @date February 2026
+ */
+class SwitchBank
+{
+  public:
+    static constexpr int MAX_LANES = 32;
+    static constexpr int HISTORY   = 8; // Same depth as Switch::state_
+
+    SwitchBank() { Init(); }
+    ~SwitchBank() {}
+
+    /** Clears all lanes and history */
+    void Init();
+
+    /**
+     * Adds a switch lane
+     * @param pin Pin to sample from the port snapshot
+     * @param inverted True if the pressed state is LOW (Switch::POLARITY_INVERTED)
+     * @return the lane index, or -1 if the bank is full
+     */
+    int AddLane(Pin pin, bool inverted = true);
+
+    /**
+     * Samples every lane from the snapshot and debounces them in parallel
+     * @param snapshot Port snapshot captured for this scan
+     */
+    void Process(const PortSnapshot& snapshot);
+
+    /** @return mask of lanes that were just pressed (state 0x7f) */
+    inline uint32_t RisingMask() const { return rising_; }
+
+    /** @return mask of lanes that were just released (state 0x80) */
+    inline uint32_t FallingMask() const { return falling_; }
+
+    /** @return mask of lanes that are held down (state 0xff) */
+    inline uint32_t PressedMask() const { return pressed_; }
+
+    /** @return mask of lanes whose history is (or was last scan) not settled at 0x00/0xff */
+    inline uint32_t ActiveMask() const { return active_; }
+
+    inline bool RisingEdge(int lane) const { return (rising_ >> lane) & 1u; }
+    inline bool FallingEdge(int lane) const { return (falling_ >> lane) & 1u; }
+    inline bool Pressed(int lane) const { return (pressed_ >> lane) & 1u; }
+
+    /**
+     * Rebuilds the 8-bit Switch-compatible state of a lane
+     * @return shift register value with the newest sample in bit 0
+     */
+    uint8_t State(int lane) const;
+
+    inline int GetLaneCount() const { return numLanes_; }
+
+  private:
+    // Sample taken `age` scans ago for every lane (age 0 = newest)
+    inline uint32_t Plane(int age) const
+    {
+        return history_[(head_ - age) & (HISTORY - 1)];
+    }
+
+    Pin      pins_[MAX_LANES];
+    int      numLanes_;
+    uint32_t laneMask_;
+    uint32_t invert_;
+    uint32_t history_[HISTORY];
+    int      head_;
+    uint32_t rising_;
+    uint32_t falling_;
+    uint32_t pressed_;
+    uint32_t unsettled_;
+    uint32_t active_;
+};
+
+} // namespace perspective
+
+#endif // SWITCHBANK_H
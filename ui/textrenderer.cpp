@@ -0,0 +1,241 @@
+#include "textrenderer.h"
+
+#include <string.h>
+
+using namespace perspective;
+
+bool TextRenderer::Init(const DadGFX::GFXCFont* font)
+{
+    font_          = font;
+    numGlyphs_     = 0;
+    numGlyphRuns_  = 0;
+    numStrings_    = 0;
+    numStringRuns_ = 0;
+    lineHeight_    = font->yAdvance;
+
+    int count = font->last - font->first + 1;
+    if(count > MAX_GLYPHS)
+        count = MAX_GLYPHS;
+
+    // Decode each glyph row by row into runs of set pixels.
+    // Bitmaps are packed MSB first, continuously across rows.
+    for(int g = 0; g < count; g++)
+    {
+        const DadGFX::GFXglyph& src = font->glyph[g];
+        Glyph&                  dst = glyphs_[g];
+        dst.firstRun                = numGlyphRuns_;
+        dst.runCount                = 0;
+        dst.xAdvance                = src.xAdvance;
+
+        uint32_t bit = src.bitmapOffset * 8;
+        for(int row = 0; row < src.height; row++)
+        {
+            int start = -1;
+            for(int col = 0; col <= src.width; col++)
+            {
+                bool set = false;
+                if(col < src.width)
+                {
+                    set = (font->bitmap[bit >> 3] >> (7 - (bit & 7))) & 1;
+                    bit++;
+                }
+
+                if(set && start < 0)
+                {
+                    start = col;
+                }
+                else if(!set && start >= 0)
+                {
+                    // Out of runs: the rest of the bitmap can't be decoded in
+                    // step, so stop with the glyphs decoded so far. The later
+                    // ones (and this partial one) draw as nothing.
+                    if(numGlyphRuns_ >= MAX_GLYPH_RUNS)
+                    {
+                        numGlyphRuns_ = dst.firstRun;
+                        return false;
+                    }
+
+                    Run& run  = glyphRuns_[numGlyphRuns_++];
+                    run.x      = src.xOffset + start;
+                    run.y      = src.yOffset + row;
+                    run.length = col - start;
+                    dst.runCount++;
+                    start = -1;
+                }
+            }
+        }
+        numGlyphs_++;
+    }
+    return true;
+}
+
+bool TextRenderer::CacheString(const char* text)
+{
+    if(!font_ || FindCached(text))
+        return font_ != nullptr;
+
+    int len = strlen(text);
+    if(len >= MAX_CACHED_TEXT || numStrings_ >= MAX_CACHED_STRINGS)
+        return false;
+
+    // Pen position and run cursor for every character
+    const Glyph* glyphs[MAX_CACHED_TEXT];
+    int16_t      penX[MAX_CACHED_TEXT];
+    uint16_t     cursor[MAX_CACHED_TEXT];
+    int          remaining = 0;
+    int16_t      pen       = 0;
+    for(int i = 0; i < len; i++)
+    {
+        glyphs[i] = GetGlyph(text[i]);
+        penX[i]   = pen;
+        cursor[i] = 0;
+        if(glyphs[i])
+        {
+            pen += glyphs[i]->xAdvance;
+            remaining += glyphs[i]->runCount;
+        }
+    }
+
+    // Emit runs row-major across the whole string, merging runs that touch
+    uint16_t first = numStringRuns_;
+    for(int row = 0; remaining > 0 && row < 256; row++)
+    {
+        int rowStart = numStringRuns_;
+        for(int i = 0; i < len; i++)
+        {
+            const Glyph* glyph = glyphs[i];
+            if(!glyph)
+                continue;
+
+            while(cursor[i] < glyph->runCount && glyphRuns_[glyph->firstRun + cursor[i]].y == row)
+            {
+                Run run = glyphRuns_[glyph->firstRun + cursor[i]++];
+                run.x += penX[i];
+                remaining--;
+
+                Run* last = numStringRuns_ > rowStart ? &stringRuns_[numStringRuns_ - 1] : nullptr;
+                if(last && last->x + last->length == run.x && last->length + run.length <= 255)
+                {
+                    last->length += run.length;
+                }
+                else if(numStringRuns_ < MAX_STRING_RUNS)
+                {
+                    stringRuns_[numStringRuns_++] = run;
+                }
+                else
+                {
+                    numStringRuns_ = first; // Out of run storage - roll back
+                    return false;
+                }
+            }
+        }
+    }
+
+    CachedString& entry = strings_[numStrings_++];
+    entry.hash          = Hash(text);
+    entry.firstRun      = first;
+    entry.runCount      = numStringRuns_ - first;
+    entry.width         = pen;
+    strcpy(entry.text, text);
+
+    return true;
+}
+
+uint16_t TextRenderer::DrawText(DadGFX::cLayer* layer, int16_t x, int16_t y, const char* text,
+                                const DadGFX::sColor& fg)
+{
+    if(!font_)
+        return 0;
+
+    const CachedString* cached = FindCached(text);
+    if(cached)
+    {
+        DrawRuns(layer, x, y, &stringRuns_[cached->firstRun], cached->runCount, fg);
+        return cached->width;
+    }
+
+    // Not cached - draw from the per-glyph runs
+    int16_t pen = 0;
+    for(const char* c = text; *c; c++)
+    {
+        const Glyph* glyph = GetGlyph(*c);
+        if(!glyph)
+            continue;
+
+        DrawRuns(layer, x + pen, y, &glyphRuns_[glyph->firstRun], glyph->runCount, fg);
+        pen += glyph->xAdvance;
+    }
+    return pen;
+}
+
+uint16_t TextRenderer::DrawText(DadGFX::cLayer* layer, int16_t x, int16_t y, const char* text,
+                                const DadGFX::sColor& fg, const DadGFX::sColor& bg)
+{
+    uint16_t width = GetTextWidth(text);
+    if(x >= 0 && y >= 0 && width > 0)
+        layer->drawFillRect(x, y, width, lineHeight_, bg);
+
+    return DrawText(layer, x, y, text, fg);
+}
+
+uint16_t TextRenderer::GetTextWidth(const char* text) const
+{
+    const CachedString* cached = FindCached(text);
+    if(cached)
+        return cached->width;
+
+    uint16_t width = 0;
+    for(const char* c = text; *c; c++)
+    {
+        const Glyph* glyph = GetGlyph(*c);
+        if(glyph)
+            width += glyph->xAdvance;
+    }
+    return width;
+}
+
+uint32_t TextRenderer::Hash(const char* text)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for(const char* c = text; *c; c++)
+    {
+        hash ^= static_cast<uint8_t>(*c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+const TextRenderer::CachedString* TextRenderer::FindCached(const char* text) const
+{
+    if(numStrings_ == 0)
+        return nullptr;
+
+    uint32_t hash = Hash(text);
+    for(int i = 0; i < numStrings_; i++)
+    {
+        if(strings_[i].hash == hash && strcmp(strings_[i].text, text) == 0)
+            return &strings_[i];
+    }
+    return nullptr;
+}
+
+const TextRenderer::Glyph* TextRenderer::GetGlyph(char c) const
+{
+    int index = static_cast<uint8_t>(c) - font_->first;
+    if(index < 0 || index >= numGlyphs_)
+        return nullptr;
+    return &glyphs_[index];
+}
+
+void TextRenderer::DrawRuns(DadGFX::cLayer* layer, int16_t x, int16_t y, const Run* runs, int count,
+                            const DadGFX::sColor& fg)
+{
+    for(int i = 0; i < count; i++)
+    {
+        int16_t px = x + runs[i].x;
+        if(px < 0)
+            continue;
+        layer->drawFillRect(px, y + runs[i].y, runs[i].length, 1, fg);
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+#ifndef TEXTRENDERER_H
+#define TEXTRENDERER_H
+
+#include <stdint.h>
+#include "cDisplay.h"
+
+namespace perspective {
+
+/**
+ * @brief Fast text renderer for GFX2 bitmap fonts
+ * Each glyph bitmap is decoded once at Init into horizontal runs of set
+ * pixels, so drawing a character is a handful of 1-pixel-high fills rather
+ * than a bit test and pixel write per pixel of its bounding box.
+ * Frequently drawn strings (parameter names, note names) can additionally be
+ * laid out ahead of time with CacheString(): their runs are stored row-major
+ * for the whole string with runs that touch across glyph boundaries merged.
+ * @author Generated for Perspective
+ * @date February 2026
+ */
+class TextRenderer
+{
+  public:
+    static constexpr int MAX_GLYPHS         = 96;   // Printable ASCII
+    static constexpr int MAX_GLYPH_RUNS     = 3072;
+    static constexpr int MAX_CACHED_STRINGS = 48;
+    static constexpr int MAX_STRING_RUNS    = 6144;
+    static constexpr int MAX_CACHED_TEXT    = 16;   // Including terminator
+
+    // Init() sets all of the state, so a renderer can live in memory that is
+    // not set up until after static construction (SDRAM)
+    TextRenderer()  = default;
+    ~TextRenderer() = default;
+
+    /**
+     * Decodes every glyph of the font into runs
+     * @param font GFX2 font descriptor
+     * @return false if the font needs more than MAX_GLYPH_RUNS runs; the
+     *         glyphs before the one that ran out still draw
+     */
+    bool Init(const DadGFX::GFXCFont* font);
+
+    /**
+     * Lays out a string ahead of time so it is drawn from the cache
+     * @return false if the string is too long or the cache is full
+     */
+    bool CacheString(const char* text);
+
+    /**
+     * Draws text with its top-left corner at (x, y)
+     * Uses the string cache when the text has been cached
+     * @return width of the drawn text in pixels
+     */
+    uint16_t DrawText(DadGFX::cLayer* layer, int16_t x, int16_t y, const char* text, const DadGFX::sColor& fg);
+
+    /**
+     * Same as DrawText(), but fills the text box with a background colour first
+     */
+    uint16_t DrawText(DadGFX::cLayer* layer, int16_t x, int16_t y, const char* text,
+                      const DadGFX::sColor& fg, const DadGFX::sColor& bg);
+
+    /** @return width of the text in pixels */
+    uint16_t GetTextWidth(const char* text) const;
+
+    /** @return height of a line of text in pixels */
+    inline uint16_t GetLineHeight() const { return lineHeight_; }
+
+    /** @return number of runs used by cached strings (for sizing the pools) */
+    inline int GetCachedRunCount() const { return numStringRuns_; }
+
+  private:
+    struct Run
+    {
+        int16_t x;      // Relative to the text (or glyph) origin
+        uint8_t y;      // Row from the top of the line
+        uint8_t length;
+    };
+
+    struct Glyph
+    {
+        uint16_t firstRun;
+        uint16_t runCount;
+        uint8_t  xAdvance;
+    };
+
+    struct CachedString
+    {
+        uint32_t hash;
+        uint16_t firstRun;
+        uint16_t runCount;
+        uint16_t width;
+        char     text[MAX_CACHED_TEXT];
+    };
+
+    static uint32_t Hash(const char* text);
+    const CachedString* FindCached(const char* text) const;
+    const Glyph* GetGlyph(char c) const;
+    void DrawRuns(DadGFX::cLayer* layer, int16_t x, int16_t y, const Run* runs, int count,
+                  const DadGFX::sColor& fg);
+
+    const DadGFX::GFXCFont* font_;
+    Glyph        glyphs_[MAX_GLYPHS];
+    int          numGlyphs_;
+    Run          glyphRuns_[MAX_GLYPH_RUNS];
+    int          numGlyphRuns_;
+    CachedString strings_[MAX_CACHED_STRINGS];
+    int          numStrings_;
+    Run          stringRuns_[MAX_STRING_RUNS];
+    int          numStringRuns_;
+    uint16_t     lineHeight_;
+};
+
+} // namespace perspective
+
+#endif // TEXTRENDERER_H
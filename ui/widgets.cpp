@@ -0,0 +1,144 @@
+#include "widgets.h"
+#include "textrenderer.h"
+#include "cDisplay.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace perspective;
+
+// Widget palette (background colours are drawn by Hardware::InitGFX2Display)
+static const DadGFX::sColor kTransparent(0, 0, 0, 0);
+static const DadGFX::sColor kTrackColour(4, 60, 82, 255);
+static const DadGFX::sColor kFillColour(240, 240, 240, 255);
+static const DadGFX::sColor kTextColour(255, 255, 255, 255);
+static const DadGFX::sColor kNeedleColour(250, 170, 40, 255);
+static const DadGFX::sColor kInTuneColour(60, 220, 90, 255);
+
+void Widget::Clear(DadGFX::cLayer* layer)
+{
+    layer->drawFillRect(x_, y_, w_, h_, kTransparent);
+}
+
+// ========== ParameterBar ==========
+
+void ParameterBar::SetValue(float normalized)
+{
+    normalized = normalized < 0.0f ? 0.0f : (normalized > 1.0f ? 1.0f : normalized);
+    uint16_t fill = static_cast<uint16_t>(normalized * h_ + 0.5f);
+    if(fill != fill_)
+    {
+        fill_ = fill;
+        Invalidate();
+    }
+}
+
+void ParameterBar::Draw(DadGFX::cLayer* layer)
+{
+    if(!visible_)
+    {
+        Clear(layer);
+        return;
+    }
+
+    // Unfilled track above, filled part from the bottom up
+    if(fill_ < h_)
+        layer->drawFillRect(x_, y_, w_, h_ - fill_, kTrackColour);
+    if(fill_ > 0)
+        layer->drawFillRect(x_, y_ + h_ - fill_, w_, fill_, kFillColour);
+}
+
+// ========== TextLabel ==========
+
+void TextLabel::SetText(const char* text)
+{
+    if(strncmp(text, text_, MAX_TEXT - 1) == 0)
+        return;
+
+    strncpy(text_, text, MAX_TEXT - 1);
+    text_[MAX_TEXT - 1] = '\0';
+    Invalidate();
+}
+
+void TextLabel::Draw(DadGFX::cLayer* layer)
+{
+    Clear(layer);
+    if(!visible_ || !font_)
+        return;
+
+    font_->DrawText(layer, x_, y_, text_, kTextColour);
+}
+
+// ========== ValueLabel ==========
+
+void ValueLabel::SetParameter(const char* name, float value)
+{
+    char formatted[MAX_VALUE];
+    snprintf(formatted, MAX_VALUE, "%.2f", value);
+
+    if(strncmp(name, text_, MAX_TEXT - 1) == 0 && strcmp(formatted, value_) == 0)
+        return;
+
+    strncpy(text_, name, MAX_TEXT - 1);
+    text_[MAX_TEXT - 1] = '\0';
+    strcpy(value_, formatted);
+    Invalidate();
+}
+
+void ValueLabel::SetText(const char* text)
+{
+    if(value_[0] != '\0')
+    {
+        value_[0] = '\0';
+        Invalidate();
+    }
+    TextLabel::SetText(text);
+}
+
+void ValueLabel::Draw(DadGFX::cLayer* layer)
+{
+    Clear(layer);
+    if(!visible_ || !font_)
+        return;
+
+    // Name comes from the string cache, the value is drawn from glyph runs
+    uint16_t width = font_->DrawText(layer, x_, y_, text_, kTextColour);
+    if(value_[0] != '\0')
+        font_->DrawText(layer, x_ + width + 10, y_, value_, kTextColour);
+}
+
+// ========== TunerNeedle ==========
+
+void TunerNeedle::SetCents(float cents, bool active)
+{
+    cents = cents < -50.0f ? -50.0f : (cents > 50.0f ? 50.0f : cents);
+
+    // Map -50..+50 cents onto the usable width of the widget
+    float    span     = static_cast<float>(w_ - NEEDLE_WIDTH);
+    uint16_t position = static_cast<uint16_t>((cents + 50.0f) * 0.01f * span + 0.5f);
+    bool     inTune   = active && (cents > -IN_TUNE_CENTS && cents < IN_TUNE_CENTS);
+
+    if(position != position_ || inTune != inTune_ || active != active_)
+    {
+        position_ = position;
+        inTune_   = inTune;
+        active_   = active;
+        Invalidate();
+    }
+}
+
+void TunerNeedle::Draw(DadGFX::cLayer* layer)
+{
+    Clear(layer);
+    if(!visible_)
+        return;
+
+    // Centre marker
+    layer->drawFillRect(x_ + (w_ - NEEDLE_WIDTH) / 2, y_ + h_ - 6, NEEDLE_WIDTH, 6, kTrackColour);
+
+    if(active_)
+    {
+        layer->drawFillRect(x_ + position_, y_, NEEDLE_WIDTH, h_ - 8,
+                            inTune_ ? kInTuneColour : kNeedleColour);
+    }
+}
@@ -0,0 +1,158 @@
+#pragma once
+#ifndef WIDGETS_H
+#define WIDGETS_H
+
+#include <stdint.h>
+
+namespace DadGFX {
+    class cLayer;
+}
+
+namespace perspective {
+
+class TextRenderer;
+
+/**
+ * @brief Base class for a rectangular region of the display
+ * A widget is only redrawn when it has been invalidated. Setters on the
+ * concrete widgets only invalidate when the change is visible (i.e. it moves
+ * at least one pixel), so the display blocks it covers stay clean otherwise.
+ * @author Generated for Perspective
+ * @date February 2026
+ */
+class Widget
+{
+  public:
+    Widget(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+        : x_(x), y_(y), w_(w), h_(h), dirty_(true), visible_(true) {}
+    virtual ~Widget() {}
+
+    /**
+     * Draws the widget into its layer
+     * Only called by the Renderer when the widget is dirty
+     */
+    virtual void Draw(DadGFX::cLayer* layer) = 0;
+
+    inline void Invalidate() { dirty_ = true; }
+    inline bool IsDirty() const { return dirty_; }
+    inline void ClearDirty() { dirty_ = false; }
+
+    /** Hidden widgets clear their area to transparent on the next draw */
+    inline void SetVisible(bool visible)
+    {
+        if(visible != visible_)
+        {
+            visible_ = visible;
+            dirty_   = true;
+        }
+    }
+    inline bool IsVisible() const { return visible_; }
+
+  protected:
+    /** Clears the widget area to transparent so lower layers show through */
+    void Clear(DadGFX::cLayer* layer);
+
+    uint16_t x_, y_, w_, h_;
+    bool     dirty_;
+    bool     visible_;
+};
+
+/**
+ * @brief Vertical bar showing a normalised parameter value (0.0 to 1.0)
+ */
+class ParameterBar : public Widget
+{
+  public:
+    ParameterBar(uint16_t x = 0, uint16_t y = 0, uint16_t w = 0, uint16_t h = 0)
+        : Widget(x, y, w, h), fill_(0) {}
+
+    /** Sets the value; only invalidates when the filled height changes */
+    void SetValue(float normalized);
+
+    void Draw(DadGFX::cLayer* layer) override;
+
+  private:
+    uint16_t fill_; // Filled height in pixels
+};
+
+/**
+ * @brief Single line of text (effect name, parameter name, etc.)
+ */
+class TextLabel : public Widget
+{
+  public:
+    static constexpr int MAX_TEXT = 24;
+
+    TextLabel(uint16_t x = 0, uint16_t y = 0, uint16_t w = 0, uint16_t h = 0)
+        : Widget(x, y, w, h), font_(nullptr) { text_[0] = '\0'; }
+
+    /** Sets the renderer used to draw the text (shared between labels) */
+    inline void SetTextRenderer(TextRenderer* font) { font_ = font; Invalidate(); }
+
+    /** Sets the text; only invalidates when it differs from the current text */
+    void SetText(const char* text);
+    inline const char* GetText() const { return text_; }
+
+    void Draw(DadGFX::cLayer* layer) override;
+
+  protected:
+    TextRenderer* font_;
+    char          text_[MAX_TEXT];
+};
+
+/**
+ * @brief Parameter name followed by its value, e.g. "Mix 0.52"
+ * The name is drawn separately so it can come from the string cache,
+ * leaving only the digits to be drawn glyph by glyph as a knob turns.
+ */
+class ValueLabel : public TextLabel
+{
+  public:
+    static constexpr int MAX_VALUE = 12;
+
+    ValueLabel(uint16_t x = 0, uint16_t y = 0, uint16_t w = 0, uint16_t h = 0)
+        : TextLabel(x, y, w, h) { value_[0] = '\0'; }
+
+    /** Sets name and value; only invalidates when the displayed text changes */
+    void SetParameter(const char* name, float value);
+
+    /** Shows a plain string with no value (e.g. a note name) */
+    void SetText(const char* text);
+
+    void Draw(DadGFX::cLayer* layer) override;
+
+  private:
+    char value_[MAX_VALUE];
+};
+
+/**
+ * @brief Tuner needle showing the offset from the nearest note (-50 to +50 cents)
+ */
+class TunerNeedle : public Widget
+{
+  public:
+    TunerNeedle(uint16_t x = 0, uint16_t y = 0, uint16_t w = 0, uint16_t h = 0)
+        : Widget(x, y, w, h), position_(0), inTune_(false), active_(false) {}
+
+    /**
+     * Sets the needle position; only invalidates when the needle moves a pixel
+     * @param cents Offset from the nearest note in cents
+     * @param active False when no signal is detected (needle hidden)
+     */
+    void SetCents(float cents, bool active);
+
+    void Draw(DadGFX::cLayer* layer) override;
+
+    static constexpr float IN_TUNE_CENTS = 3.0f;
+
+  private:
+    static constexpr uint16_t NEEDLE_WIDTH = 4;
+
+    uint16_t position_; // Needle x offset within the widget
+    bool     inTune_;
+    bool     active_;
+};
+
+} // namespace perspective
+
+#endif // WIDGETS_H